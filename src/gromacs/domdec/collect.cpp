@@ -55,30 +55,20 @@
 #include "distribute.h"
 #include "domdec_internal.h"
 
-static void dd_collect_cg(gmx_domdec_t* dd, const t_state* state_local)
+gmx::ArrayRef<const int> dd_home_atom_global_indices(const gmx_domdec_t& dd,
+                                                     const t_state&      localState)
 {
-    if (state_local->ddp_count == dd->comm->master_cg_ddp_count)
-    {
-        /* The master has the correct distribution */
-        return;
-    }
-
-    gmx::ArrayRef<const int> atomGroups;
-    int                      nat_home = 0;
-
-    if (state_local->ddp_count == dd->ddp_count)
+    if (localState.ddp_count == dd.ddp_count)
     {
         /* The local state and DD are in sync, use the DD indices */
-        atomGroups = gmx::constArrayRefFromArray(dd->globalAtomGroupIndices.data(), dd->ncg_home);
-        nat_home   = dd->comm->atomRanges.numHomeAtoms();
+        return gmx::constArrayRefFromArray(dd.globalAtomGroupIndices.data(), dd.ncg_home);
     }
-    else if (state_local->ddp_count_cg_gl == state_local->ddp_count)
+    else if (localState.ddp_count_cg_gl == localState.ddp_count)
     {
         /* The DD is out of sync with the local state, but we have stored
          * the cg indices with the local state, so we can use those.
          */
-        atomGroups = state_local->cg_gl;
-        nat_home   = atomGroups.size();
+        return localState.cg_gl;
     }
     else
     {
@@ -86,6 +76,18 @@ static void dd_collect_cg(gmx_domdec_t* dd, const t_state* state_local)
                 "Attempted to collect a vector for a state for which the charge group distribution "
                 "is unknown");
     }
+}
+
+static void dd_collect_cg(gmx_domdec_t* dd, const t_state* state_local)
+{
+    if (state_local->ddp_count == dd->comm->master_cg_ddp_count)
+    {
+        /* The master has the correct distribution */
+        return;
+    }
+
+    gmx::ArrayRef<const int> atomGroups = dd_home_atom_global_indices(*dd, *state_local);
+    int                      nat_home   = atomGroups.size();
 
     AtomDistribution* ma = dd->ma.get();
 
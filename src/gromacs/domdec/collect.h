@@ -53,6 +53,13 @@ class ArrayRef;
 struct gmx_domdec_t;
 class t_state;
 
+/*! \brief Returns the global atom indices of the home atoms in \p localState
+ *
+ * The order matches that of the home atoms in the local state vectors.
+ */
+gmx::ArrayRef<const int> dd_home_atom_global_indices(const gmx_domdec_t& dd,
+                                                     const t_state&      localState);
+
 /*! \brief Gathers rvec arrays \p localVector to \p globalVector on the master rank */
 void dd_collect_vec(gmx_domdec_t*                  dd,
                     const t_state*                 localState,
@@ -47,7 +47,6 @@
 #include "gromacs/math/vec.h"
 #include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/gmxassert.h"
-#include "gromacs/utility/smalloc.h"
 
 static void make_dft_mod(real* mod, const double* data, int splineOrder, int ndata)
 {
@@ -84,22 +83,14 @@ static void make_dft_mod(real* mod, const double* data, int splineOrder, int nda
     }
 }
 
-void make_bspline_moduli(splinevec bsp_mod, int nx, int ny, int nz, int pme_order)
+/* Return the values of the cardinal B-spline of order splineOrder at the integer points */
+static std::vector<double> bsplineValues(int splineOrder)
 {
     /* We use double precision, since this is only called once per grid.
      * But for single precision bsp_mod, single precision also seems
      * to give full accuracy.
      */
-    double* data;
-
-    /* In GROMACS we, confusingly, defined pme-order as the order
-     * of the cardinal B-spline + 1. This probably happened because
-     * the smooth PME paper only talks about "n" which is the number
-     * of points we spread to and that was chosen to be pme-order.
-     */
-    const int splineOrder = pme_order - 1;
-
-    snew(data, splineOrder);
+    std::vector<double> data(splineOrder);
 
     data[0] = 1;
     for (int k = 1; k < splineOrder; k++)
@@ -117,11 +108,7 @@ void make_bspline_moduli(splinevec bsp_mod, int nx, int ny, int nz, int pme_orde
         data[0] = div * data[0];
     }
 
-    make_dft_mod(bsp_mod[XX], data, splineOrder, nx);
-    make_dft_mod(bsp_mod[YY], data, splineOrder, ny);
-    make_dft_mod(bsp_mod[ZZ], data, splineOrder, nz);
-
-    sfree(data);
+    return data;
 }
 
 /* Return the P3M optimal influence function */
@@ -189,10 +176,34 @@ static void make_p3m_bspline_moduli_dim(real* bsp_mod, int n, int order)
     }
 }
 
-/* Calculate the P3M B-spline moduli */
-void make_p3m_bspline_moduli(splinevec bsp_mod, int nx, int ny, int nz, int order)
+PmeSplineModuliCache::PmeSplineModuliCache(int pmeOrder, bool useP3M) :
+    pmeOrder_(pmeOrder),
+    useP3M_(useP3M)
+{
+}
+
+const std::vector<real>& PmeSplineModuliCache::moduli(int n)
 {
-    make_p3m_bspline_moduli_dim(bsp_mod[XX], nx, order);
-    make_p3m_bspline_moduli_dim(bsp_mod[YY], ny, order);
-    make_p3m_bspline_moduli_dim(bsp_mod[ZZ], nz, order);
+    auto entry = moduli_.find(n);
+    if (entry == moduli_.end())
+    {
+        std::vector<real> mod(n);
+        if (useP3M_)
+        {
+            make_p3m_bspline_moduli_dim(mod.data(), n, pmeOrder_);
+        }
+        else
+        {
+            /* In GROMACS we, confusingly, defined pme-order as the order
+             * of the cardinal B-spline + 1. This probably happened because
+             * the smooth PME paper only talks about "n" which is the number
+             * of points we spread to and that was chosen to be pme-order.
+             */
+            const int splineOrder = pmeOrder_ - 1;
+            make_dft_mod(mod.data(), bsplineValues(splineOrder).data(), splineOrder, n);
+        }
+        entry = moduli_.emplace(n, std::move(mod)).first;
+    }
+
+    return entry->second;
 }
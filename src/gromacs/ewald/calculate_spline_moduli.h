@@ -37,12 +37,33 @@
 #ifndef GMX_EWALD_CALCULATE_SPLINE_MODULI_H
 #define GMX_EWALD_CALCULATE_SPLINE_MODULI_H
 
-#include "spline_vectors.h"
+#include <map>
+#include <vector>
 
-/* Calulate plain SPME B-spline interpolation */
-void make_bspline_moduli(splinevec bsp_mod, int nx, int ny, int nz, int order);
+#include "gromacs/utility/real.h"
 
-/* Calculate the P3M B-spline moduli */
-void make_p3m_bspline_moduli(splinevec bsp_mod, int nx, int ny, int nz, int order);
+/*! \brief Cache of the B-spline moduli for the grid sizes along a dimension
+ *
+ * The moduli along a dimension only depend on the number of grid points,
+ * the interpolation order and the interpolation method. PME tuning creates
+ * PME structures for many grids, which share the moduli through this cache.
+ */
+class PmeSplineModuliCache
+{
+public:
+    //! Constructor, \p useP3M selects the P3M influence function
+    PmeSplineModuliCache(int pmeOrder, bool useP3M);
+
+    //! Returns the moduli for \p n grid points, computes them on first use
+    const std::vector<real>& moduli(int n);
+
+private:
+    //! The PME interpolation order
+    int pmeOrder_;
+    //! Whether we use the P3M influence function
+    bool useP3M_;
+    //! The moduli for each grid size used
+    std::map<int, std::vector<real>> moduli_;
+};
 
 #endif
@@ -82,6 +82,7 @@
 
 #include <algorithm>
 #include <list>
+#include <memory>
 
 #include "gromacs/domdec/domdec.h"
 #include "gromacs/ewald/ewald_utils.h"
@@ -208,6 +209,10 @@ bool pme_gpu_supports_input(const t_inputrec& ir, const gmx_mtop_t& mtop, std::s
                 "Cannot compute PME interactions on a GPU, because PME GPU requires a dynamical "
                 "integrator (md, sd, etc).");
     }
+    if (ir.useMts)
+    {
+        errorReasons.emplace_back("multiple time stepping");
+    }
     return addMessageIfNotSupported(errorReasons, error);
 }
 
@@ -576,7 +581,8 @@ gmx_pme_t* gmx_pme_init(const t_commrec*     cr,
                         const DeviceContext* deviceContext,
                         const DeviceStream*  deviceStream,
                         const PmeGpuProgram* pmeGpuProgram,
-                        const gmx::MDLogger& /*mdlog*/)
+                        const gmx::MDLogger& /*mdlog*/,
+                        gmx_pme_t*           pmeToReuseFrom)
 {
     int  use_threads, sum_use_threads, i;
     ivec ndata;
@@ -814,6 +820,10 @@ gmx_pme_t* gmx_pme_init(const t_commrec*     cr,
                                  &pme->fshz);
 
     pme->spline_work = make_pme_spline_work(pme->pme_order);
+    /* Computing the splines in the gather, for all atoms in a SIMD register
+     * at once, avoids storing and loading the spline derivatives and is faster.
+     */
+    pme->gatherComputesSplines = gather_f_bsplines_can_compute_splines(pme->pme_order);
 
     ndata[0] = pme->nkx;
     ndata[1] = pme->nky;
@@ -849,20 +859,29 @@ gmx_pme_t* gmx_pme_init(const t_commrec*     cr,
             const auto allocateRealGridForGpu = (pme->runMode == PmeRunMode::Mixed)
                                                         ? gmx::PinningPolicy::PinnedIfSupported
                                                         : gmx::PinningPolicy::CannotBePinned;
+            /* Grids of the PME structure we derive from are used when large enough */
+            gmx_parallel_3dfft_t fftGridSource = (pmeToReuseFrom != nullptr && i < pmeToReuseFrom->ngrids)
+                                                         ? pmeToReuseFrom->pfft_setup[i]
+                                                         : nullptr;
             gmx_parallel_3dfft_init(&pme->pfft_setup[i], ndata, &pme->fftgrid[i], &pme->cfftgrid[i],
-                                    pme->mpi_comm_d, bReproducible, pme->nthread, allocateRealGridForGpu);
+                                    pme->mpi_comm_d, bReproducible, pme->nthread,
+                                    allocateRealGridForGpu, fftGridSource);
         }
     }
 
-    if (!pme->bP3M)
+    /* Use plain SPME B-spline interpolation or the P3M grid-optimized influence function */
+    if (pmeToReuseFrom != nullptr)
     {
-        /* Use plain SPME B-spline interpolation */
-        make_bspline_moduli(pme->bsp_mod, pme->nkx, pme->nky, pme->nkz, pme->pme_order);
+        pme->splineModuliCache = pmeToReuseFrom->splineModuliCache;
     }
     else
     {
-        /* Use the P3M grid-optimized influence function */
-        make_p3m_bspline_moduli(pme->bsp_mod, pme->nkx, pme->nky, pme->nkz, pme->pme_order);
+        pme->splineModuliCache = std::make_shared<PmeSplineModuliCache>(pme->pme_order, pme->bP3M);
+    }
+    for (int d = 0; d < DIM; d++)
+    {
+        const std::vector<real>& moduli = pme->splineModuliCache->moduli(ndata[d]);
+        std::copy(moduli.begin(), moduli.end(), pme->bsp_mod[d]);
     }
 
     /* Use atc[0] for spreading */
@@ -933,7 +952,7 @@ void gmx_pme_reinit(struct gmx_pme_t** pmedata,
         NumPmeDomains numPmeDomains = { pme_src->nnodes_major, pme_src->nnodes_minor };
         *pmedata = gmx_pme_init(cr, numPmeDomains, &irc, pme_src->bFEP_q, pme_src->bFEP_lj, FALSE,
                                 ewaldcoeff_q, ewaldcoeff_lj, pme_src->nthread, pme_src->runMode,
-                                pme_src->gpu, nullptr, nullptr, nullptr, dummyLogger);
+                                pme_src->gpu, nullptr, nullptr, nullptr, dummyLogger, pme_src);
         /* When running PME on the CPU not using domain decomposition,
          * the atom data is allocated once only in gmx_pme_(re)init().
          */
@@ -945,9 +964,10 @@ void gmx_pme_reinit(struct gmx_pme_t** pmedata,
     }
     GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
 
-    /* We can easily reuse the allocated pme grids in pme_src */
+    /* We can easily reuse the allocated pme grids in pme_src,
+     * the fft grids and spline moduli are reused in gmx_pme_init().
+     */
     reuse_pmegrids(&pme_src->pmegrid[PME_GRID_QA], &(*pmedata)->pmegrid[PME_GRID_QA]);
-    /* We would like to reuse the fft grids, but that's harder */
 }
 
 void gmx_pme_calc_energy(gmx_pme_t* pme, gmx::ArrayRef<const gmx::RVec> x, gmx::ArrayRef<const real> q, real* V)
@@ -1201,48 +1221,70 @@ int gmx_pme_do(struct gmx_pme_t*              pme,
                 thread = gmx_omp_get_thread_num();
                 int loop_count;
 
-                /* do 3d-fft */
-                if (thread == 0)
+                if (grid_index < DO_Q && gmx_parallel_3dfft_can_fuse_convolution(pfft_setup))
                 {
-                    wallcycle_start(wcycle, ewcPME_FFT);
-                }
-                gmx_parallel_3dfft_execute(pfft_setup, GMX_FFT_REAL_TO_COMPLEX, thread, wcycle);
-                if (thread == 0)
-                {
-                    wallcycle_stop(wcycle, ewcPME_FFT);
-                }
-
-                /* solve in k-space for our local cells */
-                if (thread == 0)
-                {
-                    wallcycle_start(wcycle, (grid_index < DO_Q ? ewcPME_SOLVE : ewcLJPME));
-                }
-                if (grid_index < DO_Q)
-                {
-                    loop_count = solve_pme_yzx(
-                            pme, cfftgrid, scaledBox[XX][XX] * scaledBox[YY][YY] * scaledBox[ZZ][ZZ],
-                            computeEnergyAndVirial, pme->nthread, thread);
+                    /* Without decomposition we solve tiles of the grid directly
+                     * after their FFT, while they are in cache. The solve
+                     * time is then included in the FFT time.
+                     */
+                    if (thread == 0)
+                    {
+                        wallcycle_start(wcycle, ewcPME_FFT);
+                    }
+                    loop_count = fft_solve_pme_yzx(
+                            pme, pfft_setup, cfftgrid,
+                            scaledBox[XX][XX] * scaledBox[YY][YY] * scaledBox[ZZ][ZZ],
+                            computeEnergyAndVirial, thread);
+                    if (thread == 0)
+                    {
+                        inc_nrnb(nrnb, eNR_SOLVEPME, loop_count);
+                    }
                 }
                 else
                 {
-                    loop_count =
-                            solve_pme_lj_yzx(pme, &cfftgrid, FALSE,
-                                             scaledBox[XX][XX] * scaledBox[YY][YY] * scaledBox[ZZ][ZZ],
-                                             computeEnergyAndVirial, pme->nthread, thread);
-                }
+                    /* do 3d-fft */
+                    if (thread == 0)
+                    {
+                        wallcycle_start(wcycle, ewcPME_FFT);
+                    }
+                    gmx_parallel_3dfft_execute(pfft_setup, GMX_FFT_REAL_TO_COMPLEX, thread, wcycle);
+                    if (thread == 0)
+                    {
+                        wallcycle_stop(wcycle, ewcPME_FFT);
+                    }
 
-                if (thread == 0)
-                {
-                    wallcycle_stop(wcycle, (grid_index < DO_Q ? ewcPME_SOLVE : ewcLJPME));
-                    inc_nrnb(nrnb, eNR_SOLVEPME, loop_count);
-                }
+                    /* solve in k-space for our local cells */
+                    if (thread == 0)
+                    {
+                        wallcycle_start(wcycle, (grid_index < DO_Q ? ewcPME_SOLVE : ewcLJPME));
+                    }
+                    if (grid_index < DO_Q)
+                    {
+                        loop_count = solve_pme_yzx(
+                                pme, cfftgrid, scaledBox[XX][XX] * scaledBox[YY][YY] * scaledBox[ZZ][ZZ],
+                                computeEnergyAndVirial, pme->nthread, thread);
+                    }
+                    else
+                    {
+                        loop_count = solve_pme_lj_yzx(
+                                pme, &cfftgrid, FALSE,
+                                scaledBox[XX][XX] * scaledBox[YY][YY] * scaledBox[ZZ][ZZ],
+                                computeEnergyAndVirial, pme->nthread, thread);
+                    }
 
-                /* do 3d-invfft */
-                if (thread == 0)
-                {
-                    wallcycle_start(wcycle, ewcPME_FFT);
+                    if (thread == 0)
+                    {
+                        wallcycle_stop(wcycle, (grid_index < DO_Q ? ewcPME_SOLVE : ewcLJPME));
+                        inc_nrnb(nrnb, eNR_SOLVEPME, loop_count);
+                    }
+
+                    /* do 3d-invfft */
+                    if (thread == 0)
+                    {
+                        wallcycle_start(wcycle, ewcPME_FFT);
+                    }
+                    gmx_parallel_3dfft_execute(pfft_setup, GMX_FFT_COMPLEX_TO_REAL, thread, wcycle);
                 }
-                gmx_parallel_3dfft_execute(pfft_setup, GMX_FFT_COMPLEX_TO_REAL, thread, wcycle);
                 if (thread == 0)
                 {
                     wallcycle_stop(wcycle, ewcPME_FFT);
@@ -128,6 +128,10 @@ bool gmx_pme_check_restrictions(int  pme_order,
                                 bool errorsAreFatal);
 
 /*! \brief Construct PME data
+ *
+ * When \p pmeToReuseFrom is not null, its FFT grids are used when they are large
+ * enough and its cache of spline moduli is shared. \p pmeToReuseFrom should then
+ * outlive the returned structure and the two should not be used concurrently.
  *
  * \throws   gmx::InconsistentInputError if input grid sizes/PME order are inconsistent.
  * \returns  Pointer to newly allocated and initialized PME data.
@@ -151,10 +155,13 @@ gmx_pme_t* gmx_pme_init(const t_commrec*     cr,
                         const DeviceContext* deviceContext,
                         const DeviceStream*  deviceStream,
                         const PmeGpuProgram* pmeGpuProgram,
-                        const gmx::MDLogger& mdlog);
+                        const gmx::MDLogger& mdlog,
+                        gmx_pme_t*           pmeToReuseFrom = nullptr);
 
 /*! \brief As gmx_pme_init, but takes most settings, except the grid/Ewald coefficients, from
  * pme_src. This is only called when the PME cut-off/grid size changes.
+ * The grids and spline moduli of pme_src are reused where possible, so pme_src
+ * should outlive *pmedata.
  */
 void gmx_pme_reinit(gmx_pme_t**       pmedata,
                     const t_commrec*  cr,
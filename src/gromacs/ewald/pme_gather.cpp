@@ -40,6 +40,8 @@
 
 #include "pme_gather.h"
 
+#include <algorithm>
+
 #include "gromacs/math/vec.h"
 #include "gromacs/simd/simd.h"
 #include "gromacs/utility/basedefinitions.h"
@@ -77,16 +79,25 @@ using namespace gmx; // TODO: Remove when this file is moved into gmx namespace
  */
 struct do_fspline
 {
+    /* The spline values theta and derivatives dtheta point to the order
+     * values for the atom along each dimension, idx is the grid index of the atom.
+     */
     do_fspline(const gmx_pme_t* pme,
                const real* gmx_restrict grid,
-               const PmeAtomComm* gmx_restrict atc,
-               const splinedata_t* gmx_restrict spline,
-               int                              nn) :
+               const int* gmx_restrict idx,
+               const real* const        theta[DIM],
+               const real* const        dtheta[DIM]) :
         pme(pme),
         grid(grid),
-        atc(atc),
-        spline(spline),
-        nn(nn)
+        thx(theta[XX]),
+        thy(theta[YY]),
+        thz(theta[ZZ]),
+        dthx(dtheta[XX]),
+        dthy(dtheta[YY]),
+        dthz(dtheta[ZZ]),
+        idxX(idx[XX]),
+        idxY(idx[YY]),
+        idxZ(idx[ZZ])
     {
     }
 
@@ -96,16 +107,6 @@ struct do_fspline
         static_assert(isIntegralConstant<Int, int>::value || std::is_same<Int, int>::value,
                       "'order' needs to be either of type integral_constant<int,N> or int.");
 
-        const int norder = nn * order;
-
-        /* Pointer arithmetic alert, next six statements */
-        const real* const gmx_restrict thx  = spline->theta.coefficients[XX] + norder;
-        const real* const gmx_restrict thy  = spline->theta.coefficients[YY] + norder;
-        const real* const gmx_restrict thz  = spline->theta.coefficients[ZZ] + norder;
-        const real* const gmx_restrict dthx = spline->dtheta.coefficients[XX] + norder;
-        const real* const gmx_restrict dthy = spline->dtheta.coefficients[YY] + norder;
-        const real* const gmx_restrict dthz = spline->dtheta.coefficients[ZZ] + norder;
-
         RVec f(0, 0, 0);
 
         for (int ithx = 0; (ithx < order); ithx++)
@@ -144,15 +145,6 @@ struct do_fspline
      */
     RVec operator()(std::integral_constant<int, 4> /*unused*/) const
     {
-        const int norder = nn * 4;
-        /* Pointer arithmetic alert, next six statements */
-        const real* const gmx_restrict thx  = spline->theta.coefficients[XX] + norder;
-        const real* const gmx_restrict thy  = spline->theta.coefficients[YY] + norder;
-        const real* const gmx_restrict thz  = spline->theta.coefficients[ZZ] + norder;
-        const real* const gmx_restrict dthx = spline->dtheta.coefficients[XX] + norder;
-        const real* const gmx_restrict dthy = spline->dtheta.coefficients[YY] + norder;
-        const real* const gmx_restrict dthz = spline->dtheta.coefficients[ZZ] + norder;
-
         Simd4NReal fx_S = setZero();
         Simd4NReal fy_S = setZero();
         Simd4NReal fz_S = setZero();
@@ -223,17 +215,9 @@ struct do_fspline
     template<int Order>
     std::enable_if_t<Order == 4 || Order == 5, RVec> operator()(std::integral_constant<int, Order> order) const
     {
-        const int norder = nn * order;
         GMX_ASSERT(gridNZ % 4 == 0,
                    "For aligned SIMD4 operations the grid size has to be padded up to a multiple "
                    "of 4");
-        /* Pointer arithmetic alert, next six statements */
-        const real* const gmx_restrict thx  = spline->theta.coefficients[XX] + norder;
-        const real* const gmx_restrict thy  = spline->theta.coefficients[YY] + norder;
-        const real* const gmx_restrict thz  = spline->theta.coefficients[ZZ] + norder;
-        const real* const gmx_restrict dthx = spline->dtheta.coefficients[XX] + norder;
-        const real* const gmx_restrict dthy = spline->dtheta.coefficients[YY] + norder;
-        const real* const gmx_restrict dthz = spline->dtheta.coefficients[ZZ] + norder;
 
         struct pme_spline_work* const work = pme->spline_work;
 
@@ -287,20 +271,202 @@ struct do_fspline
 private:
     const gmx_pme_t* const pme;
     const real* const gmx_restrict grid;
-    const PmeAtomComm* const gmx_restrict atc;
-    const splinedata_t* const gmx_restrict spline;
-    const int                              nn;
+
+    const real* const gmx_restrict thx;
+    const real* const gmx_restrict thy;
+    const real* const gmx_restrict thz;
+    const real* const gmx_restrict dthx;
+    const real* const gmx_restrict dthy;
+    const real* const gmx_restrict dthz;
 
     const int gridNY = pme->pmegrid_ny;
     const int gridNZ = pme->pmegrid_nz;
 
-    const int* const idxptr = atc->idx[spline->ind[nn]];
-    const int        idxX   = idxptr[XX];
-    const int        idxY   = idxptr[YY];
-    const int        idxZ   = idxptr[ZZ];
+    const int idxX;
+    const int idxY;
+    const int idxZ;
 };
 
 
+#if PME_SIMD_GATHER_SPLINES
+/* Computes the B-spline values theta and derivatives dtheta of order Order
+ * for the fractions dr of GMX_SIMD_REAL_WIDTH atoms along a dimension.
+ * This does the same as CALC_SPLINE in pme_spread.cpp.
+ */
+template<int Order>
+static inline void calc_splines_simd(SimdReal dr, SimdReal theta[Order], SimdReal dtheta[Order])
+{
+    const SimdReal one(1.0_real);
+    SimdReal       data[Order];
+
+    /* dr is relative offset from lower cell limit */
+    data[Order - 1] = setZero();
+    data[1]         = dr;
+    data[0]         = one - dr;
+
+    for (int k = 3; k < Order; k++)
+    {
+        const SimdReal div(1.0_real / (k - 1));
+        data[k - 1] = div * dr * data[k - 2];
+        for (int l = 1; l < k - 1; l++)
+        {
+            data[k - l - 1] = div
+                              * ((dr + SimdReal(l)) * data[k - l - 2]
+                                 + (SimdReal(k - l) - dr) * data[k - l - 1]);
+        }
+        data[0] = div * (one - dr) * data[0];
+    }
+    /* differentiate */
+    dtheta[0] = -data[0];
+    for (int k = 1; k < Order; k++)
+    {
+        dtheta[k] = data[k - 1] - data[k];
+    }
+
+    const SimdReal div(1.0_real / (Order - 1));
+    data[Order - 1] = div * dr * data[Order - 2];
+    for (int l = 1; l < Order - 1; l++)
+    {
+        data[Order - l - 1] = div
+                              * ((dr + SimdReal(l)) * data[Order - l - 2]
+                                 + (SimdReal(Order - l) - dr) * data[Order - l - 1]);
+    }
+    data[0] = div * (one - dr) * data[0];
+
+    for (int k = 0; k < Order; k++)
+    {
+        theta[k] = data[k];
+    }
+}
+
+/* Gather for pme_order=Order, computes the splines from the fractional
+ * coordinates instead of loading the splines stored by make_bsplines().
+ * Both the splines and the grid interpolation are computed with SIMD
+ * for GMX_SIMD_REAL_WIDTH atoms at once. The Order grid values along z
+ * of each atom are loaded transposed with two gathers of three values.
+ */
+template<int Order>
+static void gather_f_bsplines_compute_splines(const gmx_pme_t*    pme,
+                                              const real*         grid,
+                                              gmx_bool            bClearF,
+                                              const PmeAtomComm*  atc,
+                                              const splinedata_t* spline,
+                                              real                scale)
+{
+    static_assert(Order == 4 || Order == 5, "The z-gathers below only support order 4 and 5");
+
+    constexpr int c_simdWidth = GMX_SIMD_REAL_WIDTH;
+
+    const int nx     = pme->nkx;
+    const int ny     = pme->nky;
+    const int nz     = pme->nkz;
+    const int gridNY = pme->pmegrid_ny;
+    const int gridNZ = pme->pmegrid_nz;
+
+    const real rxx = pme->recipbox[XX][XX];
+    const real ryx = pme->recipbox[YY][XX];
+    const real ryy = pme->recipbox[YY][YY];
+    const real rzx = pme->recipbox[ZZ][XX];
+    const real rzy = pme->recipbox[ZZ][YY];
+    const real rzz = pme->recipbox[ZZ][ZZ];
+
+    /* Extract the buffer for force output */
+    rvec* gmx_restrict force = as_rvec_array(atc->f.data());
+
+    /* Per atom data with atoms in the minor index */
+    alignas(GMX_SIMD_ALIGNMENT) real         fraction[DIM][c_simdWidth];
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t gridIndex[c_simdWidth];
+    alignas(GMX_SIMD_ALIGNMENT) std::int32_t rowIndex[c_simdWidth];
+    alignas(GMX_SIMD_ALIGNMENT) real         fBuffer[DIM][c_simdWidth];
+
+    for (int nnStart = 0; nnStart < spline->n; nnStart += c_simdWidth)
+    {
+        const int numAtoms = std::min(c_simdWidth, spline->n - nnStart);
+
+        for (int i = 0; i < c_simdWidth; i++)
+        {
+            /* Pad with the last atom */
+            const int  n   = spline->ind[nnStart + std::min(i, numAtoms - 1)];
+            const int* idx = atc->idx[n];
+            for (int d = 0; d < DIM; d++)
+            {
+                fraction[d][i] = atc->fractx[n][d];
+            }
+            gridIndex[i] = (idx[XX] * gridNY + idx[YY]) * gridNZ + idx[ZZ];
+        }
+
+        SimdReal theta[DIM][Order];
+        SimdReal dtheta[DIM][Order];
+        for (int d = 0; d < DIM; d++)
+        {
+            calc_splines_simd<Order>(load<SimdReal>(fraction[d]), theta[d], dtheta[d]);
+        }
+
+        SimdReal fx_S = setZero();
+        SimdReal fy_S = setZero();
+        SimdReal fz_S = setZero();
+
+        for (int ithx = 0; ithx < Order; ithx++)
+        {
+            for (int ithy = 0; ithy < Order; ithy++)
+            {
+                const int rowOffset = (ithx * gridNY + ithy) * gridNZ;
+                for (int i = 0; i < c_simdWidth; i++)
+                {
+                    rowIndex[i] = gridIndex[i] + rowOffset;
+                }
+
+                /* The two gathers overlap by 2 values with order 4 and 1 with order 5 */
+                SimdReal gval[Order];
+                gatherLoadUTranspose<1>(grid, rowIndex, &gval[0], &gval[1], &gval[2]);
+                gatherLoadUTranspose<1>(grid + Order - 3, rowIndex, &gval[Order - 3],
+                                        &gval[Order - 2], &gval[Order - 1]);
+
+                SimdReal fxy1_S = theta[ZZ][0] * gval[0];
+                SimdReal fz1_S  = dtheta[ZZ][0] * gval[0];
+                for (int ithz = 1; ithz < Order; ithz++)
+                {
+                    fxy1_S = fma(theta[ZZ][ithz], gval[ithz], fxy1_S);
+                    fz1_S  = fma(dtheta[ZZ][ithz], gval[ithz], fz1_S);
+                }
+
+                fx_S = fma(dtheta[XX][ithx] * theta[YY][ithy], fxy1_S, fx_S);
+                fy_S = fma(theta[XX][ithx] * dtheta[YY][ithy], fxy1_S, fy_S);
+                fz_S = fma(theta[XX][ithx] * theta[YY][ithy], fz1_S, fz_S);
+            }
+        }
+
+        store(fBuffer[XX], fx_S);
+        store(fBuffer[YY], fy_S);
+        store(fBuffer[ZZ], fz_S);
+
+        for (int i = 0; i < numAtoms; i++)
+        {
+            const int  n           = spline->ind[nnStart + i];
+            const real coefficient = scale * atc->coefficient[n];
+            const real fx          = fBuffer[XX][i];
+            const real fy          = fBuffer[YY][i];
+            const real fz          = fBuffer[ZZ][i];
+
+            if (bClearF)
+            {
+                force[n][XX] = 0;
+                force[n][YY] = 0;
+                force[n][ZZ] = 0;
+            }
+            force[n][XX] += -coefficient * (fx * nx * rxx);
+            force[n][YY] += -coefficient * (fx * nx * ryx + fy * ny * ryy);
+            force[n][ZZ] += -coefficient * (fx * nx * rzx + fy * ny * rzy + fz * nz * rzz);
+        }
+    }
+}
+#endif
+
+bool gather_f_bsplines_can_compute_splines(int pme_order)
+{
+    return PME_SIMD_GATHER_SPLINES && (pme_order == 4 || pme_order == 5);
+}
+
 void gather_f_bsplines(const gmx_pme_t*    pme,
                        const real*         grid,
                        gmx_bool            bClearF,
@@ -308,6 +474,22 @@ void gather_f_bsplines(const gmx_pme_t*    pme,
                        const splinedata_t* spline,
                        real                scale)
 {
+#if PME_SIMD_GATHER_SPLINES
+    if (pme->gatherComputesSplines)
+    {
+        switch (pme->pme_order)
+        {
+            case 4:
+                gather_f_bsplines_compute_splines<4>(pme, grid, bClearF, atc, spline, scale);
+                return;
+            case 5:
+                gather_f_bsplines_compute_splines<5>(pme, grid, bClearF, atc, spline, scale);
+                return;
+            default: GMX_RELEASE_ASSERT(false, "Splines can only be computed for order 4 and 5");
+        }
+    }
+#endif
+
     /* sum forces for local particles */
 
     const int order = pme->pme_order;
@@ -341,8 +523,16 @@ void gather_f_bsplines(const gmx_pme_t*    pme,
         }
         if (coefficient != 0)
         {
+            const int         norder      = nn * order;
+            const real* const theta[DIM]  = { spline->theta.coefficients[XX] + norder,
+                                             spline->theta.coefficients[YY] + norder,
+                                             spline->theta.coefficients[ZZ] + norder };
+            const real* const dtheta[DIM] = { spline->dtheta.coefficients[XX] + norder,
+                                              spline->dtheta.coefficients[YY] + norder,
+                                              spline->dtheta.coefficients[ZZ] + norder };
+
             RVec       f;
-            const auto spline_func = do_fspline(pme, grid, atc, spline, nn);
+            const auto spline_func = do_fspline(pme, grid, atc->idx[n], theta, dtheta);
 
             switch (order)
             {
@@ -42,6 +42,13 @@ class PmeAtomComm;
 struct gmx_pme_t;
 struct splinedata_t;
 
+/* Returns whether gather_f_bsplines() can compute the splines itself for pme_order */
+bool gather_f_bsplines_can_compute_splines(int pme_order);
+
+/* Gathers the forces on the atoms in spline from grid.
+ * With pme->gatherComputesSplines, the spline values and derivatives are
+ * computed from atc->fractx, otherwise they are read from spline.
+ */
 void gather_f_bsplines(const struct gmx_pme_t* pme,
                        const real*             grid,
                        gmx_bool                bClearF,
@@ -524,6 +524,15 @@ static void set_gridsize_alignment(int gmx_unused* gridsize, int gmx_unused pme_
     }
 #    endif
 #endif
+#if PME_SIMD_GATHER_SPLINES
+    if (pme_order == 4 || pme_order == 5)
+    {
+        /* The gather with spline computation loads GMX_SIMD_REAL_WIDTH
+         * unaligned elements, which can start at the last grid element.
+         */
+        *gridsize += GMX_SIMD_REAL_WIDTH;
+    }
+#endif
 }
 
 void pmegrid_init(pmegrid_t* grid,
@@ -56,6 +56,7 @@
 
 #include "config.h"
 
+#include <memory>
 #include <vector>
 
 #include "gromacs/math/gmxcomplex.h"
@@ -299,6 +300,8 @@ struct pmegrids_t
 /*! \brief Data structure for spline-interpolation working buffers */
 struct pme_spline_work;
 
+class PmeSplineModuliCache;
+
 /*! \brief Data structure for working buffers */
 struct pme_solve_work_t;
 
@@ -381,6 +384,9 @@ struct gmx_pme_t
 
     /* Work data for spreading and gathering */
     pme_spline_work* spline_work;
+    /* Whether the force gathering computes the splines from fractx, then
+     * only the spline values and not the derivatives are stored */
+    bool gatherComputesSplines;
 
     real** fftgrid; /* Grids for FFT. With 1D FFT decomposition this can be a pointer */
     /* inside the interpolation grid, but separate for 2D PME decomp. */
@@ -399,6 +405,8 @@ struct gmx_pme_t
     matrix                   recipbox;
     real                     boxVolume;
     splinevec                bsp_mod;
+    /* The cache of moduli shared with the PME structures for other grids */
+    std::shared_ptr<PmeSplineModuliCache> splineModuliCache;
     /* Buffers to store data for local atoms for L-B combination rule
      * calculations in LJ-PME. lb_buf1 stores either the coefficients
      * for spreading/gathering (in serial), or the C6 coefficient for
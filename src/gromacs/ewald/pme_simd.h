@@ -67,4 +67,11 @@
 #    define PME_4NSIMD_GATHER 0
 #endif
 
+/* Check if we can compute the splines in the gather with full-width SIMD */
+#if GMX_SIMD_HAVE_REAL
+#    define PME_SIMD_GATHER_SPLINES 1
+#else
+#    define PME_SIMD_GATHER_SPLINES 0
+#endif
+
 #endif
@@ -329,13 +329,23 @@ using PME_T = SimdReal;
 using PME_T = real;
 #endif
 
-int solve_pme_yzx(const gmx_pme_t* pme, t_complex* grid, real vol, bool computeEnergyAndVirial, int nthread, int thread)
+/*! \brief Solves lines \p iyz0 to \p iyz1 of the local complex grid
+ *
+ * The energy and virial are added to those in the work struct of \p thread.
+ */
+static void solve_pme_yzx_lines(const gmx_pme_t* pme,
+                                t_complex*       grid,
+                                real             vol,
+                                bool             computeEnergyAndVirial,
+                                int              iyz0,
+                                int              iyz1,
+                                int              thread)
 {
     /* do recip sum over local cells in grid */
     /* y major, z middle, x minor or continuous */
     t_complex*               p0;
     int                      kx, ky, kz, maxkx, maxky;
-    int                      nx, ny, nz, iyz0, iyz1, iyz, iy, iz, kxstart, kxend;
+    int                      nx, ny, nz, iyz, iy, iz, kxstart, kxend;
     real                     mx, my, mz;
     real                     ewaldcoeff = pme->ewaldcoeff_q;
     real                     factor     = M_PI * M_PI / (ewaldcoeff * ewaldcoeff);
@@ -384,9 +394,6 @@ int solve_pme_yzx(const gmx_pme_t* pme, t_complex* grid, real vol, bool computeE
     eterm = work->eterm;
     m2inv = work->m2inv;
 
-    iyz0 = local_ndata[YY] * local_ndata[ZZ] * thread / nthread;
-    iyz1 = local_ndata[YY] * local_ndata[ZZ] * (thread + 1) / nthread;
-
     for (iyz = iyz0; iyz < iyz1; iyz++)
     {
         iy = iyz / local_ndata[ZZ];
@@ -571,16 +578,89 @@ int solve_pme_yzx(const gmx_pme_t* pme, t_complex* grid, real vol, bool computeE
          * experiencing problems on semiisotropic membranes.
          * IS THAT COMMENT STILL VALID??? (DvdS, 2001/02/07).
          */
-        work->vir_q[XX][XX] = 0.25 * virxx;
-        work->vir_q[YY][YY] = 0.25 * viryy;
-        work->vir_q[ZZ][ZZ] = 0.25 * virzz;
-        work->vir_q[XX][YY] = work->vir_q[YY][XX] = 0.25 * virxy;
-        work->vir_q[XX][ZZ] = work->vir_q[ZZ][XX] = 0.25 * virxz;
-        work->vir_q[YY][ZZ] = work->vir_q[ZZ][YY] = 0.25 * viryz;
+        work->vir_q[XX][XX] += 0.25 * virxx;
+        work->vir_q[YY][YY] += 0.25 * viryy;
+        work->vir_q[ZZ][ZZ] += 0.25 * virzz;
+        work->vir_q[XX][YY] += 0.25 * virxy;
+        work->vir_q[XX][ZZ] += 0.25 * virxz;
+        work->vir_q[YY][ZZ] += 0.25 * viryz;
+        work->vir_q[YY][XX] = work->vir_q[XX][YY];
+        work->vir_q[ZZ][XX] = work->vir_q[XX][ZZ];
+        work->vir_q[ZZ][YY] = work->vir_q[YY][ZZ];
 
         /* This energy should be corrected for a charged system */
-        work->energy_q = 0.5 * energy;
+        work->energy_q += 0.5 * energy;
     }
+}
+
+int solve_pme_yzx(const gmx_pme_t* pme, t_complex* grid, real vol, bool computeEnergyAndVirial, int nthread, int thread)
+{
+    ivec complex_order, local_ndata, local_offset, local_size;
+
+    gmx_parallel_3dfft_complex_limits(pme->pfft_setup[PME_GRID_QA], complex_order, local_ndata,
+                                      local_offset, local_size);
+
+    if (computeEnergyAndVirial)
+    {
+        clear_mat(pme->solve_work[thread].vir_q);
+        pme->solve_work[thread].energy_q = 0;
+    }
+
+    int iyz0 = local_ndata[YY] * local_ndata[ZZ] * thread / nthread;
+    int iyz1 = local_ndata[YY] * local_ndata[ZZ] * (thread + 1) / nthread;
+
+    solve_pme_yzx_lines(pme, grid, vol, computeEnergyAndVirial, iyz0, iyz1, thread);
+
+    /* Return the loop count */
+    return local_ndata[YY] * local_ndata[XX];
+}
+
+namespace
+{
+
+//! Parameters of solve_pme_yzx_lines() for use with gmx_parallel_3dfft_execute_convolution()
+struct SolvePmeYzxLinesData
+{
+    //! The PME struct
+    const gmx_pme_t* pme;
+    //! The complex grid
+    t_complex* grid;
+    //! The volume of the unit cell
+    real vol;
+    //! Whether to compute energy and virial
+    bool computeEnergyAndVirial;
+};
+
+//! Solves a range of lines, called between the forward and backward FFT
+void solvePmeYzxLinesOperation(int lineStart, int lineEnd, int thread, void* data)
+{
+    const auto* params = static_cast<const SolvePmeYzxLinesData*>(data);
+
+    solve_pme_yzx_lines(params->pme, params->grid, params->vol, params->computeEnergyAndVirial,
+                        lineStart, lineEnd, thread);
+}
+
+} // namespace
+
+int fft_solve_pme_yzx(const gmx_pme_t*    pme,
+                      gmx_parallel_3dfft* pfft_setup,
+                      t_complex*          grid,
+                      real                vol,
+                      bool                computeEnergyAndVirial,
+                      int                 thread)
+{
+    ivec complex_order, local_ndata, local_offset, local_size;
+
+    gmx_parallel_3dfft_complex_limits(pfft_setup, complex_order, local_ndata, local_offset, local_size);
+
+    if (computeEnergyAndVirial)
+    {
+        clear_mat(pme->solve_work[thread].vir_q);
+        pme->solve_work[thread].energy_q = 0;
+    }
+
+    SolvePmeYzxLinesData data = { pme, grid, vol, computeEnergyAndVirial };
+    gmx_parallel_3dfft_execute_convolution(pfft_setup, solvePmeYzxLinesOperation, &data, thread);
 
     /* Return the loop count */
     return local_ndata[YY] * local_ndata[XX];
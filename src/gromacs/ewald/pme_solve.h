@@ -42,6 +42,7 @@
 
 struct pme_solve_work_t;
 struct gmx_pme_t;
+struct gmx_parallel_3dfft;
 struct PmeOutput;
 
 /*! \brief Allocates array of work structures
@@ -71,6 +72,22 @@ void get_pme_ener_vir_lj(pme_solve_work_t* work, int nthread, PmeOutput* output)
 
 int solve_pme_yzx(const gmx_pme_t* pme, t_complex* grid, real vol, bool computeEnergyAndVirial, int nthread, int thread);
 
+/*! \brief Forward FFT, solve and backward FFT of a Coulomb grid with the solve fused into the FFTs
+ *
+ * Gives the same result as gmx_parallel_3dfft_execute() in both directions with
+ * solve_pme_yzx() in between, but each tile of complex lines is solved directly
+ * after its last forward FFT, while it is still in cache, and then passes
+ * directly on to the first backward FFT step. Requires
+ * gmx_parallel_3dfft_can_fuse_convolution() to return true for \p pfft_setup.
+ * Must be called by all PME threads.
+ */
+int fft_solve_pme_yzx(const gmx_pme_t*    pme,
+                      gmx_parallel_3dfft* pfft_setup,
+                      t_complex*          grid,
+                      real                vol,
+                      bool                computeEnergyAndVirial,
+                      int                 thread);
+
 int solve_pme_lj_yzx(const gmx_pme_t* pme,
                      t_complex**      grid,
                      gmx_bool         bLB,
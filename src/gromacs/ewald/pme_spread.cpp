@@ -243,10 +243,13 @@ static void make_thread_local_ind(const PmeAtomComm* atc, int thread, splinedata
                 data[0] = div * (1 - dr) * data[0];                                                      \
             }                                                                                            \
             /* differentiate */                                                                          \
-            dtheta[j][i * (order) + 0] = -data[0];                                                       \
-            for (int k = 1; (k < (order)); k++)                                                          \
+            if (computeDerivatives)                                                                      \
             {                                                                                            \
-                dtheta[j][i * (order) + k] = data[k - 1] - data[k];                                      \
+                dtheta[j][i * (order) + 0] = -data[0];                                                   \
+                for (int k = 1; (k < (order)); k++)                                                      \
+                {                                                                                        \
+                    dtheta[j][i * (order) + k] = data[k - 1] - data[k];                                  \
+                }                                                                                        \
             }                                                                                            \
                                                                                                          \
             div             = 1.0 / ((order)-1);                                                         \
@@ -272,7 +275,8 @@ static void make_bsplines(splinevec  theta,
                           int        nr,
                           const int  ind[],
                           const real coefficient[],
-                          gmx_bool   bDoSplines)
+                          gmx_bool   bDoSplines,
+                          bool       computeDerivatives)
 {
     /* construct splines for local atoms */
     int   i, ii;
@@ -927,7 +931,8 @@ void spread_on_grid(const gmx_pme_t*  pme,
             {
                 make_bsplines(spline->theta.coefficients, spline->dtheta.coefficients,
                               pme->pme_order, as_rvec_array(atc->fractx.data()), spline->n,
-                              spline->ind.data(), atc->coefficient.data(), bDoSplines);
+                              spline->ind.data(), atc->coefficient.data(), bDoSplines,
+                              !pme->gatherComputesSplines);
             }
 
             if (bSpread)
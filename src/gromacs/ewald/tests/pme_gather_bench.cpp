@@ -0,0 +1,181 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Benchmarking tool for the CPU PME spreading and force gathering.
+ *
+ * Times spreading and gathering on a single thread for random charges,
+ * both with the splines computed in the gather and with the splines
+ * stored during spreading. Usage:
+ *
+ *     pme-gather-bench [number of atoms] [PME order]
+ *
+ * \ingroup module_ewald
+ */
+#include "gmxpre.h"
+
+#include <cstdio>
+#include <cstdlib>
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "gromacs/domdec/domdec.h"
+#include "gromacs/ewald/pme.h"
+#include "gromacs/ewald/pme_gather.h"
+#include "gromacs/ewald/pme_grid.h"
+#include "gromacs/ewald/pme_internal.h"
+#include "gromacs/ewald/pme_spread.h"
+#include "gromacs/math/invertmatrix.h"
+#include "gromacs/mdtypes/commrec.h"
+#include "gromacs/mdtypes/inputrec.h"
+#include "gromacs/utility/logger.h"
+
+namespace
+{
+
+//! Runs spreading and gathering, returns the spread and gather times in seconds
+void spreadAndGather(gmx_pme_t*               pme,
+                     gmx::ArrayRef<gmx::RVec> forces,
+                     double*                  spreadTime,
+                     double*                  gatherTime)
+{
+    PmeAtomComm* atc     = &pme->atc[0];
+    real*        pmegrid = pme->pmegrid[0].grid.grid;
+    real*        fftgrid = pme->fftgrid[0];
+
+    const auto start = std::chrono::steady_clock::now();
+    spread_on_grid(pme, atc, &pme->pmegrid[0], true, true, fftgrid, true, 0);
+    wrap_periodic_pmegrid(pme, pmegrid);
+    copy_pmegrid_to_fftgrid(pme, pmegrid, fftgrid, 0);
+    const auto spreadDone = std::chrono::steady_clock::now();
+
+    atc->f = forces;
+    copy_fftgrid_to_pmegrid(pme, fftgrid, pmegrid, 0, pme->nthread, 0);
+    unwrap_periodic_pmegrid(pme, pmegrid);
+    gather_f_bsplines(pme, pmegrid, true, atc, &atc->spline[0], 1.0);
+    const auto gatherDone = std::chrono::steady_clock::now();
+
+    *spreadTime += std::chrono::duration<double>(spreadDone - start).count();
+    *gatherTime += std::chrono::duration<double>(gatherDone - spreadDone).count();
+}
+
+} // namespace
+
+/*! \internal \brief
+ * The main function for the PME gather benchmarking tool.
+ */
+int main(int argc, char* argv[])
+{
+    const int numAtoms = (argc > 1 ? std::atoi(argv[1]) : 200000);
+    const int pmeOrder = (argc > 2 ? std::atoi(argv[2]) : 4);
+    const int numSteps = 20;
+
+    if (numAtoms <= 0 || pmeOrder < 3 || pmeOrder > PME_ORDER_MAX)
+    {
+        fprintf(stderr, "Usage: %s [number of atoms] [PME order]\n", argv[0]);
+        return 1;
+    }
+
+    const matrix box = { { 4.0, 0.0, 0.0 }, { 0.0, 3.5, 0.0 }, { 1.2, 0.7, 3.2 } };
+
+    t_inputrec inputRec;
+    inputRec.nkx         = 40;
+    inputRec.nky         = 36;
+    inputRec.nkz         = 32;
+    inputRec.pme_order   = pmeOrder;
+    inputRec.coulombtype = eelPME;
+    inputRec.epsilon_r   = 1.0;
+
+    std::default_random_engine            rng(pmeOrder);
+    std::uniform_real_distribution<float> unitDist;
+
+    std::vector<gmx::RVec> coordinates(numAtoms);
+    std::vector<real>      charges(numAtoms);
+    for (int i = 0; i < numAtoms; i++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            coordinates[i][d] = unitDist(rng) * box[d][d];
+        }
+        charges[i] = 2.0F * unitDist(rng) - 1.0F;
+    }
+
+    const gmx::MDLogger dummyLogger;
+    t_commrec           dummyCommrec  = { 0 };
+    NumPmeDomains       numPmeDomains = { 1, 1 };
+    gmx_pme_t*          pme = gmx_pme_init(&dummyCommrec, numPmeDomains, &inputRec, false, false, true,
+                                  1.0, 0.0, 1, PmeRunMode::CPU, nullptr, nullptr, nullptr, nullptr,
+                                  dummyLogger);
+    gmx::invertBoxMatrix(box, pme->recipbox);
+
+    PmeAtomComm* atc = &pme->atc[0];
+    atc->x           = coordinates;
+    atc->coefficient = charges;
+    gmx_pme_reinit_atoms(pme, numAtoms, charges.data());
+    atc->spline[0].n = numAtoms;
+
+    std::vector<gmx::RVec> forces(numAtoms);
+    const bool             defaultComputesSplines = pme->gatherComputesSplines;
+    for (bool gatherComputesSplines : { false, true })
+    {
+        if (gatherComputesSplines && !gather_f_bsplines_can_compute_splines(pmeOrder))
+        {
+            continue;
+        }
+        pme->gatherComputesSplines = gatherComputesSplines;
+
+        double spreadTime = 0;
+        double gatherTime = 0;
+        /* Warm up */
+        spreadAndGather(pme, forces, &spreadTime, &gatherTime);
+
+        spreadTime = 0;
+        gatherTime = 0;
+        for (int step = 0; step < numSteps; step++)
+        {
+            spreadAndGather(pme, forces, &spreadTime, &gatherTime);
+        }
+        printf("PME order %d, %d atoms, splines %s%s: spread %.2f ms, gather %.2f ms\n", pmeOrder,
+               numAtoms, gatherComputesSplines ? "computed in gather" : "stored            ",
+               gatherComputesSplines == defaultComputesSplines ? " (default)" : "          ",
+               1000 * spreadTime / numSteps, 1000 * gatherTime / numSteps);
+    }
+
+    gmx_pme_destroy(pme);
+
+    return 0;
+}
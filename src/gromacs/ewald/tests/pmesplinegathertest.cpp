@@ -0,0 +1,158 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests that the PME force gathering which computes the splines itself
+ * gives the same forces as the gathering with stored splines.
+ *
+ * \ingroup module_ewald
+ */
+
+#include "gmxpre.h"
+
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/ewald/pme_gather.h"
+#include "gromacs/ewald/pme_internal.h"
+#include "gromacs/mdtypes/inputrec.h"
+
+#include "testutils/testasserts.h"
+
+#include "pmetestcommon.h"
+#include "testhardwarecontext.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! A CPU PME setup with random atoms, the atom data is referred to by \p pme
+struct RandomPmeSystem
+{
+    //! The coordinates
+    CoordinatesVector coordinates;
+    //! The charges
+    std::vector<real> charges;
+    //! The PME data
+    PmeSafePointer pme;
+};
+
+//! Sets up CPU PME with \p numAtoms random charges in a triclinic box
+void initRandomPme(int pmeOrder, const IVec& gridSize, int numAtoms, RandomPmeSystem* system)
+{
+    const Matrix3x3 box = { { 4.0F, 0.0F, 0.0F, 0.0F, 3.5F, 0.0F, 1.2F, 0.7F, 3.2F } };
+
+    t_inputrec inputRec;
+    inputRec.nkx         = gridSize[XX];
+    inputRec.nky         = gridSize[YY];
+    inputRec.nkz         = gridSize[ZZ];
+    inputRec.pme_order   = pmeOrder;
+    inputRec.coulombtype = eelPME;
+    inputRec.epsilon_r   = 1.0;
+
+    std::default_random_engine            rng(pmeOrder);
+    std::uniform_real_distribution<float> unitDist;
+
+    system->coordinates.resize(numAtoms);
+    system->charges.resize(numAtoms);
+    for (int i = 0; i < numAtoms; i++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            /* Sample outside the unit cell as well, to exercise the periodic wrapping */
+            system->coordinates[i][d] = (1.2F * unitDist(rng) - 0.1F) * box[d * DIM + d];
+        }
+        /* Include some zero charges, which are skipped */
+        system->charges[i] = (i % 7 == 3) ? 0.0F : 2.0F * unitDist(rng) - 1.0F;
+    }
+
+    system->pme = pmeInitEmpty(&inputRec, CodePath::CPU, nullptr, nullptr, nullptr, box, 1.0F, 0.0F);
+    pmeInitAtoms(system->pme.get(), nullptr, CodePath::CPU, system->coordinates, system->charges);
+}
+
+//! Runs spline computation, spreading and gathering with or without stored spline derivatives
+void runSplineSpreadAndGather(gmx_pme_t* pme, bool gatherComputesSplines, ForcesVector forces)
+{
+    pme->gatherComputesSplines = gatherComputesSplines;
+    pmePerformSplineAndSpread(pme, CodePath::CPU, true, true);
+    pmePerformGather(pme, CodePath::CPU, forces);
+}
+
+//! Test fixture for the gathering with spline computation
+class PmeSplineGatherTest : public ::testing::TestWithParam<int>
+{
+};
+
+TEST_P(PmeSplineGatherTest, MatchesGatherWithStoredSplines)
+{
+    const int pmeOrder = GetParam();
+    if (!gather_f_bsplines_can_compute_splines(pmeOrder))
+    {
+        return;
+    }
+
+    /* An odd atom count to have a partially filled last SIMD pack */
+    const int       numAtoms = 101;
+    RandomPmeSystem system;
+    initRandomPme(pmeOrder, IVec{ 20, 18, 17 }, numAtoms, &system);
+
+    std::vector<RVec> referenceForces(numAtoms);
+    runSplineSpreadAndGather(system.pme.get(), false, referenceForces);
+
+    std::vector<RVec> forces(numAtoms);
+    runSplineSpreadAndGather(system.pme.get(), true, forces);
+
+    /* The splines are computed with a different operation order */
+    const FloatingPointTolerance tolerance = relativeToleranceAsFloatingPoint(1.0, 1e-4);
+    for (int i = 0; i < numAtoms; i++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            EXPECT_REAL_EQ_TOL(referenceForces[i][d], forces[i][d], tolerance)
+                    << "for atom " << i << " dimension " << d;
+        }
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(SaneInput, PmeSplineGatherTest, ::testing::Values(4, 5));
+
+} // namespace
+} // namespace test
+} // namespace gmx
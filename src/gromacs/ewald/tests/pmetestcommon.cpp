@@ -124,6 +124,8 @@ PmeSafePointer pmeInitWrapper(const t_inputrec*    inputRec,
                                          ewaldCoeff_q, ewaldCoeff_lj, 1, runMode, nullptr,
                                          deviceContext, deviceStream, pmeGpuProgram, dummyLogger);
     PmeSafePointer pme(pmeDataRaw); // taking ownership
+    // The tests set and check the stored spline values and derivatives
+    pme->gatherComputesSplines = false;
 
     // TODO get rid of this with proper matrix type
     matrix boxTemp;
@@ -148,12 +148,49 @@ static int vmax(const int* a, int s)
     return max;
 }
 
+/* Number of chunks a pipelined transpose is split into, has to be equal on all ranks */
+static const int c_numPipelineChunks = 4;
+
+/* Tile size in lines along K and M. With 8 complex numbers the transposed
+   output of a tile is written in runs of 64 bytes in single precision. */
+static const int c_tileSizeK = 8;
+static const int c_tileSizeM = 8;
+/* Minimum number of tiles per thread, for load balancing */
+static const int c_minTilesPerThread = 4;
+
+static int numTiles(int pK, int pM, int tileK, int tileM)
+{
+    return ((pK + tileK - 1) / tileK) * ((pM + tileM - 1) / tileM);
+}
+
+/* Returns the tile size for a step with pK x pM lines, the tiles are reduced
+   in size when there are not enough of them to distribute over the threads */
+static void fft5d_tile_size(int pK, int pM, int nthreads, int* tileK, int* tileM)
+{
+    *tileK = std::max(std::min(c_tileSizeK, pK), 1);
+    *tileM = std::max(std::min(c_tileSizeM, pM), 1);
+    while (numTiles(pK, pM, *tileK, *tileM) < c_minTilesPerThread * nthreads
+           && (*tileK > 1 || *tileM > 1))
+    {
+        if (*tileM >= *tileK)
+        {
+            *tileM /= 2;
+        }
+        else
+        {
+            *tileK /= 2;
+        }
+    }
+}
+
 
 /* NxMxK the size of the data
  * comm communicator to use for fft5d
  * P0 number of processor in 1st axes (can be null for automatic)
  * lin is allocated by fft5d because size of array is only known after planning phase
  * rlout2 is only used as intermediate buffer - only returned after allocation to reuse for back transform - should not be used by caller
+ * bufferSource, when not null, is a plan whose buffers are used instead of allocating new ones, when they are large enough
+ * and have the same layout; bufferSource should then outlive this plan and the two plans should not be used concurrently
  */
 fft5d_plan fft5d_plan_3d(int                NG,
                          int                MG,
@@ -165,7 +202,8 @@ fft5d_plan fft5d_plan_3d(int                NG,
                          t_complex**        rlout2,
                          t_complex**        rlout3,
                          int                nthreads,
-                         gmx::PinningPolicy realGridAllocationPinningPolicy)
+                         gmx::PinningPolicy realGridAllocationPinningPolicy,
+                         fft5d_plan         bufferSource)
 {
 
     int  P[2], prank[2], i;
@@ -428,8 +466,49 @@ fft5d_plan fft5d_plan_3d(int                NG,
     /* int lsize = fmax(N[0]*M[0]*K[0]*nP[0],N[1]*M[1]*K[1]*nP[1]); */
     lsize = std::max(N[0] * M[0] * K[0] * nP[0], std::max(N[1] * M[1] * K[1] * nP[1], C[2] * M[2] * K[2]));
     /* int lsize = fmax(C[0]*M[0]*K[0],fmax(C[1]*M[1]*K[1],C[2]*M[2]*K[2])); */
-    if (!(flags & FFT5D_NOMALLOC))
+
+    /* Without decomposition we transform and transpose in tiles, unless FFTW does the whole 3D FFT */
+    bool useTiles = (P[0] == 1 && P[1] == 1
+                     && !(flags & (FFT5D_NOTILING | FFT5D_DEBUG | FFT5D_INPLACE)));
+#if GMX_FFT_FFTW3
+    if (nthreads == 1)
+    {
+        useTiles = false;
+    }
+#endif
+    /* With decomposition the transposes can be pipelined in chunks */
+    bool pipelined = ((flags & FFT5D_PIPELINE) && (P[0] > 1 || P[1] > 1));
+#ifdef FFT5D_MPI_TRANSPOSE
+    pipelined = false;
+#endif
+
+    /* We need extra transpose buffers to avoid OpenMP barriers
+       and to not overwrite chunks in flight with pipelining */
+    const bool useSeparateBuffers = (nthreads > 1 || pipelined);
+    /* A fused forward and backward transform needs a buffer separate from lin and lout */
+    const bool useSeparateLout3 = (useSeparateBuffers || useTiles);
+
+    /* The buffers of another plan can be used when they are large enough and
+       separate wherever we need separate buffers */
+    const bool reuseBuffers =
+            (!(flags & FFT5D_NOMALLOC) && bufferSource != nullptr && bufferSource->bufferSize >= lsize
+             && bufferSource->pinningPolicy == realGridAllocationPinningPolicy
+             && (!useSeparateBuffers || bufferSource->lout2 != bufferSource->lin)
+             && (!useSeparateLout3 || bufferSource->lout3 != bufferSource->lout));
+    int  bufferSize  = lsize;
+    bool ownsBuffers = false;
+
+    if (reuseBuffers)
     {
+        lin        = bufferSource->lin;
+        lout       = bufferSource->lout;
+        lout2      = useSeparateBuffers ? bufferSource->lout2 : lin;
+        lout3      = useSeparateLout3 ? bufferSource->lout3 : lout;
+        bufferSize = bufferSource->bufferSize;
+    }
+    else if (!(flags & FFT5D_NOMALLOC))
+    {
+        ownsBuffers = true;
         // only needed for PME GPU mixed mode
         if (realGridAllocationPinningPolicy == gmx::PinningPolicy::PinnedIfSupported && GMX_GPU == GMX_GPU_CUDA)
         {
@@ -442,9 +521,8 @@ fft5d_plan fft5d_plan_3d(int                NG,
             snew_aligned(lin, lsize, 32);
         }
         snew_aligned(lout, lsize, 32);
-        if (nthreads > 1)
+        if (useSeparateBuffers)
         {
-            /* We need extra transpose buffers to avoid OpenMP barriers */
             snew_aligned(lout2, lsize, 32);
             snew_aligned(lout3, lsize, 32);
         }
@@ -453,22 +531,18 @@ fft5d_plan fft5d_plan_3d(int                NG,
             /* We can reuse the buffers to avoid cache misses */
             lout2 = lin;
             lout3 = lout;
+            if (useSeparateLout3)
+            {
+                snew_aligned(lout3, lsize, 32);
+            }
         }
     }
     else
     {
-        lin  = *rlin;
-        lout = *rlout;
-        if (nthreads > 1)
-        {
-            lout2 = *rlout2;
-            lout3 = *rlout3;
-        }
-        else
-        {
-            lout2 = lin;
-            lout3 = lout;
-        }
+        lin   = *rlin;
+        lout  = *rlout;
+        lout2 = useSeparateBuffers ? *rlout2 : lin;
+        lout3 = useSeparateLout3 ? *rlout3 : lout;
     }
 
     plan = static_cast<fft5d_plan>(calloc(1, sizeof(struct fft5d_plan_t)));
@@ -621,7 +695,36 @@ fft5d_plan fft5d_plan_3d(int                NG,
                 fprintf(debug, "FFT5D: Plan s %d rC %d M %d pK %d C %d lsize %d\n", s, rC[s], M[s],
                         pK[s], C[s], lsize);
             }
-            plan->p1d[s] = static_cast<gmx_fft_t*>(malloc(sizeof(gmx_fft_t) * nthreads));
+            /* With tiles, only the last step is executed in lines per thread */
+            if (!useTiles || s == 2)
+            {
+                plan->p1d[s] = static_cast<gmx_fft_t*>(malloc(sizeof(gmx_fft_t) * nthreads));
+            }
+            if (pipelined && s < 2)
+            {
+                plan->p1dLine[s] = static_cast<gmx_fft_t*>(malloc(sizeof(gmx_fft_t) * nthreads));
+            }
+            if (useTiles)
+            {
+                fft5d_tile_size(pK[s], pM[s], nthreads, &plan->tileK[s], &plan->tileM[s]);
+                plan->p1dTile[s] = static_cast<gmx_fft_t*>(calloc(nthreads, sizeof(gmx_fft_t)));
+                plan->p1dTileTail[s] = static_cast<gmx_fft_t*>(calloc(nthreads, sizeof(gmx_fft_t)));
+            }
+
+            const bool realStep = ((flags & FFT5D_REALCOMPLEX)
+                                   && ((!(flags & FFT5D_BACKWARD) && s == 0)
+                                       || ((flags & FFT5D_BACKWARD) && s == 2)));
+            const gmx_fft_flag fftFlags = (flags & FFT5D_NOMEASURE) ? GMX_FFT_FLAG_CONSERVATIVE : 0;
+            auto initManyPlan = [&](gmx_fft_t* fft, int howmany) {
+                if (realStep)
+                {
+                    gmx_fft_init_many_1d_real(fft, rC[s], howmany, fftFlags);
+                }
+                else
+                {
+                    gmx_fft_init_many_1d(fft, C[s], howmany, fftFlags);
+                }
+            };
 
             /* Make sure that the init routines are only called by one thread at a time and in order
                (later is only important to not confuse valgrind)
@@ -633,20 +736,23 @@ fft5d_plan fft5d_plan_3d(int                NG,
                 {
                     try
                     {
-                        int tsize = ((t + 1) * pM[s] * pK[s] / nthreads) - (t * pM[s] * pK[s] / nthreads);
+                        if (plan->p1d[s])
+                        {
+                            int tsize = ((t + 1) * pM[s] * pK[s] / nthreads) - (t * pM[s] * pK[s] / nthreads);
 
-                        if ((flags & FFT5D_REALCOMPLEX)
-                            && ((!(flags & FFT5D_BACKWARD) && s == 0)
-                                || ((flags & FFT5D_BACKWARD) && s == 2)))
+                            initManyPlan(&plan->p1d[s][t], tsize);
+                        }
+                        if (pipelined && s < 2)
                         {
-                            gmx_fft_init_many_1d_real(
-                                    &plan->p1d[s][t], rC[s], tsize,
-                                    (flags & FFT5D_NOMEASURE) ? GMX_FFT_FLAG_CONSERVATIVE : 0);
+                            initManyPlan(&plan->p1dLine[s][t], 1);
                         }
-                        else
+                        if (useTiles)
                         {
-                            gmx_fft_init_many_1d(&plan->p1d[s][t], C[s], tsize,
-                                                 (flags & FFT5D_NOMEASURE) ? GMX_FFT_FLAG_CONSERVATIVE : 0);
+                            initManyPlan(&plan->p1dTile[s][t], plan->tileM[s]);
+                            if (pM[s] % plan->tileM[s] != 0)
+                            {
+                                initManyPlan(&plan->p1dTileTail[s][t], pM[s] % plan->tileM[s]);
+                            }
                         }
                     }
                     GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
@@ -654,6 +760,20 @@ fft5d_plan fft5d_plan_3d(int                NG,
             }
         }
 
+        if (useTiles)
+        {
+            int tileBufferSize = 0;
+            for (s = 0; s < 3; s++)
+            {
+                tileBufferSize = std::max(tileBufferSize, plan->tileK[s] * plan->tileM[s] * C[s]);
+            }
+            plan->tileBuffer = static_cast<t_complex**>(malloc(sizeof(t_complex*) * nthreads));
+            for (int t = 0; t < nthreads; t++)
+            {
+                snew_aligned(plan->tileBuffer[t], tileBufferSize, 32);
+            }
+        }
+
 #if GMX_FFT_FFTW3
     }
 #endif
@@ -688,10 +808,12 @@ fft5d_plan fft5d_plan_3d(int                NG,
 #endif
 
 
-    plan->lin   = lin;
-    plan->lout  = lout;
-    plan->lout2 = lout2;
-    plan->lout3 = lout3;
+    plan->lin         = lin;
+    plan->lout        = lout;
+    plan->lout2       = lout2;
+    plan->lout3       = lout3;
+    plan->bufferSize  = bufferSize;
+    plan->ownsBuffers = ownsBuffers;
 
     plan->NG = NG;
     plan->MG = MG;
@@ -727,6 +849,15 @@ fft5d_plan fft5d_plan_3d(int                NG,
     plan->flags         = flags;
     plan->nthreads      = nthreads;
     plan->pinningPolicy = realGridAllocationPinningPolicy;
+    plan->useTiles      = useTiles;
+    plan->pipelined     = pipelined;
+#if GMX_MPI
+    if (pipelined)
+    {
+        plan->requests = static_cast<MPI_Request*>(
+                malloc(sizeof(MPI_Request) * 2 * std::max(P[0], P[1]) * c_numPipelineChunks));
+    }
+#endif
     *rlin               = lin;
     *rlout              = lout;
     *rlout2             = lout2;
@@ -815,7 +946,8 @@ static void splitaxes(t_complex*       lout,
    variables see above
    the major, middle, minor order is only correct for x,y,z (N,M,K) for the input
    N,M,K local dimensions
-   KG global size*/
+   KG global size
+   only the part chunk of numChunks along K of each processor is joined*/
 static void joinAxesTrans13(t_complex*       lout,
                             const t_complex* lin,
                             int              maxN,
@@ -829,7 +961,9 @@ static void joinAxesTrans13(t_complex*       lout,
                             int              starty,
                             int              startx,
                             int              endy,
-                            int              endx)
+                            int              endx,
+                            int              chunk,
+                            int              numChunks)
 {
     int i, x, y, z;
     int out_i, in_i, out_x, in_x, out_z, in_z;
@@ -861,7 +995,7 @@ static void joinAxesTrans13(t_complex*       lout,
         {
             out_i = out_x + oK[i];
             in_i  = in_x + i * maxM * maxN * maxK;
-            for (z = 0; z < K[i]; z++) /*3.l*/
+            for (z = chunk * K[i] / numChunks; z < (chunk + 1) * K[i] / numChunks; z++) /*3.l*/
             {
                 out_z = out_i + z;
                 in_z  = in_i + z * maxM * maxN;
@@ -1096,6 +1230,311 @@ static void print_localdata(const t_complex* lin, const char* txt, int s, fft5d_
     }
 }
 
+/*FFT of the last step on the lines of this thread, from lin to lout*/
+static void fft5d_execute_last_step(fft5d_plan plan, int thread)
+{
+    t_complex* lin  = plan->lin;
+    t_complex* lout = (plan->flags & FFT5D_INPLACE) ? plan->lin : plan->lout;
+    int        s    = 2;
+    int        tstart;
+
+    tstart = (thread * plan->pM[s] * plan->pK[s] / plan->nthreads) * plan->C[s];
+    if ((plan->flags & FFT5D_REALCOMPLEX) && (plan->flags & FFT5D_BACKWARD))
+    {
+        gmx_fft_many_1d_real(plan->p1d[s][thread],
+                             (plan->flags & FFT5D_BACKWARD) ? GMX_FFT_COMPLEX_TO_REAL : GMX_FFT_REAL_TO_COMPLEX,
+                             lin + tstart, lout + tstart);
+    }
+    else
+    {
+        gmx_fft_many_1d(plan->p1d[s][thread],
+                        (plan->flags & FFT5D_BACKWARD) ? GMX_FFT_BACKWARD : GMX_FFT_FORWARD,
+                        lin + tstart, lout + tstart);
+    }
+}
+
+/*FFT of numLines consecutive lines of step s,
+   numLines is either the tile size along M or the remainder*/
+static void fft5d_tile_lines(fft5d_plan plan, int s, int thread, int numLines, t_complex* in, t_complex* out)
+{
+    gmx_fft_t fft = (numLines == plan->tileM[s]) ? plan->p1dTile[s][thread]
+                                                 : plan->p1dTileTail[s][thread];
+
+    if ((plan->flags & FFT5D_REALCOMPLEX)
+        && ((!(plan->flags & FFT5D_BACKWARD) && s == 0) || ((plan->flags & FFT5D_BACKWARD) && s == 2)))
+    {
+        gmx_fft_many_1d_real(fft,
+                             (plan->flags & FFT5D_BACKWARD) ? GMX_FFT_COMPLEX_TO_REAL : GMX_FFT_REAL_TO_COMPLEX,
+                             in, out);
+    }
+    else
+    {
+        gmx_fft_many_1d(fft, (plan->flags & FFT5D_BACKWARD) ? GMX_FFT_BACKWARD : GMX_FFT_FORWARD,
+                        in, out);
+    }
+}
+
+/*FFT of step s for the tile with lines k0 to k0+nk-1 along K and m0 to m0+nm-1 along M,
+   followed by the local transpose of the tile into lout for step s+1.
+   The tile is transformed into the thread local tile buffer, so the transpose
+   reads from cache and writes contiguous runs of nm (K stays major) or nk
+   (K and C swapped) elements, instead of single elements with large strides.
+   Without decomposition the layout of step s is K x M x C, C contiguous.*/
+static void fft5d_tile(fft5d_plan plan,
+                       int        s,
+                       int        thread,
+                       t_complex* lin,
+                       t_complex* lout,
+                       int        k0,
+                       int        nk,
+                       int        m0,
+                       int        nm)
+{
+    const int  C   = plan->C[s];
+    const int  pM  = plan->pM[s];
+    const int  pK  = plan->pK[s];
+    t_complex* buf = plan->tileBuffer[thread];
+    int        k, m, c;
+
+    for (k = 0; k < nk; k++)
+    {
+        fft5d_tile_lines(plan, s, thread, nm, lin + ((k0 + k) * pM + m0) * C, buf + k * nm * C);
+    }
+
+    if ((s == 0 && !(plan->flags & FFT5D_ORDER_YZ)) || (s == 1 && (plan->flags & FFT5D_ORDER_YZ)))
+    {
+        /*swap K and C: the layout of step s+1 is C x M x K*/
+        for (c = 0; c < C; c++)
+        {
+            for (m = 0; m < nm; m++)
+            {
+                t_complex*       out = lout + (c * pM + m0 + m) * pK + k0;
+                const t_complex* in  = buf + m * C + c;
+                for (k = 0; k < nk; k++)
+                {
+                    out[k] = in[k * nm * C];
+                }
+            }
+        }
+    }
+    else
+    {
+        /*swap M and C: the layout of step s+1 is K x C x M*/
+        for (k = 0; k < nk; k++)
+        {
+            for (c = 0; c < C; c++)
+            {
+                t_complex*       out = lout + ((k0 + k) * C + c) * pM + m0;
+                const t_complex* in  = buf + k * nm * C + c;
+                for (m = 0; m < nm; m++)
+                {
+                    out[m] = in[m * C];
+                }
+            }
+        }
+    }
+}
+
+/*range of tiles of step s for this thread, tiles are ordered K major*/
+static void fft5d_thread_tiles(fft5d_plan plan, int s, int thread, int* tileStart, int* tileEnd)
+{
+    int nTiles = numTiles(plan->pK[s], plan->pM[s], plan->tileK[s], plan->tileM[s]);
+
+    *tileStart = (thread * nTiles) / plan->nthreads;
+    *tileEnd   = ((thread + 1) * nTiles) / plan->nthreads;
+}
+
+/*the K and M extent of a tile*/
+static void fft5d_tile_extent(fft5d_plan plan, int s, int tile, int* k0, int* nk, int* m0, int* nm)
+{
+    int numTilesM = (plan->pM[s] + plan->tileM[s] - 1) / plan->tileM[s];
+
+    *k0 = (tile / numTilesM) * plan->tileK[s];
+    *m0 = (tile % numTilesM) * plan->tileM[s];
+    *nk = std::min(plan->tileK[s], plan->pK[s] - *k0);
+    *nm = std::min(plan->tileM[s], plan->pM[s] - *m0);
+}
+
+/*FFT and transpose of step s for all tiles of this thread*/
+static void fft5d_execute_tiles(fft5d_plan plan, int s, int thread, t_complex* lin, t_complex* lout)
+{
+    int tileStart, tileEnd, tile, k0, nk, m0, nm;
+
+    fft5d_thread_tiles(plan, s, thread, &tileStart, &tileEnd);
+    for (tile = tileStart; tile < tileEnd; tile++)
+    {
+        fft5d_tile_extent(plan, s, tile, &k0, &nk, &m0, &nm);
+        fft5d_tile(plan, s, thread, lin, lout, k0, nk, m0, nm);
+    }
+}
+
+/*First two steps without decomposition, the result of the second transpose is in lin.
+   lout is only written in the last step, so we can use it for the first transpose.*/
+static void fft5d_execute_tiled_steps(fft5d_plan plan, int thread)
+{
+    /*the tiles do not match the partitioning of the lines over the threads used by the caller*/
+#pragma omp barrier
+    fft5d_execute_tiles(plan, 0, thread, plan->lin, plan->lout);
+#pragma omp barrier
+    fft5d_execute_tiles(plan, 1, thread, plan->lout, plan->lin);
+#pragma omp barrier
+}
+
+#ifdef NOGMX
+#    define fft5d_sub_start(times, thread, subCounter)
+#    define fft5d_sub_stop(times, thread, subCounter)
+#else
+/*sub-cycle counting of the FFT compute and communication, done by the master thread*/
+static void fft5d_sub_start(fft5d_time times, int thread, int subCounter)
+{
+    if (thread == 0)
+    {
+        wallcycle_sub_start(times, subCounter);
+    }
+}
+
+static void fft5d_sub_stop(fft5d_time times, int thread, int subCounter)
+{
+    if (thread == 0)
+    {
+        wallcycle_sub_stop(times, subCounter);
+    }
+}
+#endif
+
+#if GMX_MPI && !defined FFT5D_MPI_TRANSPOSE
+/*FFT of step s and the transpose to step s+1 in chunks along K.
+  Each chunk is sent to all processors as soon as it is transformed and split,
+  so the communication overlaps with the FFTs of the following chunks.
+  The received chunks are joined as they arrive. The joins write to lin,
+  which is the FFT input, so they can only start after all FFTs of this step.*/
+static void fft5d_execute_pipelined_step(fft5d_plan plan, int s, int thread, fft5d_time times)
+{
+    t_complex*   lin      = plan->lin;
+    t_complex*   lout     = plan->lout;
+    t_complex*   lout2    = plan->lout2;
+    t_complex*   lout3    = plan->lout3;
+    MPI_Request* requests = plan->requests;
+    int *N = plan->N, *M = plan->M, *K = plan->K, *pN = plan->pN, *pM = plan->pM, *pK = plan->pK,
+        *C = plan->C, *P = plan->P;
+    int chunk, i, line, lineStart, lineEnd;
+
+    const bool realStep =
+            ((plan->flags & FFT5D_REALCOMPLEX) && !(plan->flags & FFT5D_BACKWARD) && s == 0);
+    const bool trans13 = ((s == 0 && !(plan->flags & FFT5D_ORDER_YZ))
+                          || (s == 1 && (plan->flags & FFT5D_ORDER_YZ)));
+    /*the block for each processor is N x M x K (max sizes) with K as major dimension*/
+    const int blockSize = N[s] * M[s] * K[s];
+    const int planeSize = N[s] * M[s];
+    const int numReals  = sizeof(t_complex) / sizeof(real);
+
+    /*the input lines are not divided over the threads as in the previous step*/
+#pragma omp barrier
+    for (chunk = 0; chunk < c_numPipelineChunks; chunk++)
+    {
+        const int k0 = chunk * pK[s] / c_numPipelineChunks;
+        const int k1 = (chunk + 1) * pK[s] / c_numPipelineChunks;
+
+        if (pM[s] > 0)
+        {
+            lineStart = k0 * pM[s] + thread * (k1 - k0) * pM[s] / plan->nthreads;
+            lineEnd   = k0 * pM[s] + (thread + 1) * (k1 - k0) * pM[s] / plan->nthreads;
+
+            fft5d_sub_start(times, thread, ewcsPME_FFT_COMPUTE);
+            for (line = lineStart; line < lineEnd; line++)
+            {
+                if (realStep)
+                {
+                    gmx_fft_many_1d_real(plan->p1dLine[s][thread], GMX_FFT_REAL_TO_COMPLEX,
+                                         lin + line * C[s], lout + line * C[s]);
+                }
+                else
+                {
+                    gmx_fft_many_1d(plan->p1dLine[s][thread],
+                                    (plan->flags & FFT5D_BACKWARD) ? GMX_FFT_BACKWARD : GMX_FFT_FORWARD,
+                                    lin + line * C[s], lout + line * C[s]);
+                }
+            }
+            fft5d_sub_stop(times, thread, ewcsPME_FFT_COMPUTE);
+
+            splitaxes(lout2, lout, N[s], M[s], K[s], pM[s], P[s], C[s], plan->iNout[s],
+                      plan->oNout[s], lineStart % pM[s], lineStart / pM[s], lineEnd % pM[s],
+                      lineEnd / pM[s]);
+        }
+#pragma omp barrier /*the whole chunk has to be split before it is sent*/
+
+        if (thread == 0)
+        {
+            MPI_Request* chunkRequests = requests + 2 * P[s] * chunk;
+
+            wallcycle_start(times, ewcPME_FFTCOMM);
+            fft5d_sub_start(times, thread, ewcsPME_FFT_COMM);
+            for (i = 0; i < P[s]; i++)
+            {
+                /*when K is the dimension that is joined, each processor has its own range along K*/
+                const int numK  = trans13 ? plan->iNin[s + 1][i] : pK[s];
+                const int recvK0 = chunk * numK / c_numPipelineChunks;
+                const int recvK1 = (chunk + 1) * numK / c_numPipelineChunks;
+
+                MPI_Irecv(reinterpret_cast<real*>(lout3 + i * blockSize + recvK0 * planeSize),
+                          (recvK1 - recvK0) * planeSize * numReals, GMX_MPI_REAL, i, chunk,
+                          plan->cart[s], &chunkRequests[i]);
+            }
+            for (i = 0; i < P[s]; i++)
+            {
+                MPI_Isend(reinterpret_cast<real*>(lout2 + i * blockSize + k0 * planeSize),
+                          (k1 - k0) * planeSize * numReals, GMX_MPI_REAL, i, chunk, plan->cart[s],
+                          &chunkRequests[P[s] + i]);
+            }
+            fft5d_sub_stop(times, thread, ewcsPME_FFT_COMM);
+            wallcycle_stop(times, ewcPME_FFTCOMM);
+        }
+    }
+
+    for (chunk = 0; chunk < c_numPipelineChunks; chunk++)
+    {
+        if (thread == 0)
+        {
+            wallcycle_start(times, ewcPME_FFTCOMM);
+            fft5d_sub_start(times, thread, ewcsPME_FFT_COMM);
+            MPI_Waitall(2 * P[s], requests + 2 * P[s] * chunk, MPI_STATUSES_IGNORE);
+            fft5d_sub_stop(times, thread, ewcsPME_FFT_COMM);
+            wallcycle_stop(times, ewcPME_FFTCOMM);
+        }
+#pragma omp barrier /*wait for the chunk to have arrived*/
+
+        if (trans13)
+        {
+            if (pM[s] > 0)
+            {
+                lineStart = thread * pM[s] * pN[s] / plan->nthreads;
+                lineEnd   = (thread + 1) * pM[s] * pN[s] / plan->nthreads;
+                joinAxesTrans13(lin, lout3, N[s], pM[s], K[s], pM[s], P[s], C[s + 1],
+                                plan->iNin[s + 1], plan->oNin[s + 1], lineStart % pM[s],
+                                lineStart / pM[s], lineEnd % pM[s], lineEnd / pM[s], chunk,
+                                c_numPipelineChunks);
+            }
+        }
+        else
+        {
+            if (pN[s] > 0)
+            {
+                const int k0 = chunk * pK[s] / c_numPipelineChunks;
+                const int k1 = (chunk + 1) * pK[s] / c_numPipelineChunks;
+
+                lineStart = k0 * pN[s] + thread * (k1 - k0) * pN[s] / plan->nthreads;
+                lineEnd   = k0 * pN[s] + (thread + 1) * (k1 - k0) * pN[s] / plan->nthreads;
+                joinAxesTrans12(lin, lout3, N[s], M[s], pK[s], pN[s], P[s], C[s + 1],
+                                plan->iNin[s + 1], plan->oNin[s + 1], lineStart % pN[s],
+                                lineStart / pN[s], lineEnd % pN[s], lineEnd / pN[s]);
+            }
+        }
+    }
+    /*the next step divides the lines differently over the threads*/
+#pragma omp barrier
+}
+#endif
+
 void fft5d_execute(fft5d_plan plan, int thread, fft5d_time times)
 {
     t_complex* lin   = plan->lin;
@@ -1143,6 +1582,15 @@ void fft5d_execute(fft5d_plan plan, int thread, fft5d_time times)
     }
 #endif
 
+    if (plan->useTiles)
+    {
+        fft5d_sub_start(times, thread, ewcsPME_FFT_COMPUTE);
+        fft5d_execute_tiled_steps(plan, thread);
+        fft5d_execute_last_step(plan, thread);
+        fft5d_sub_stop(times, thread, ewcsPME_FFT_COMPUTE);
+        return;
+    }
+
     s = 0;
 
     /*lin: x,y,z*/
@@ -1165,6 +1613,14 @@ void fft5d_execute(fft5d_plan plan, int thread, fft5d_time times)
             bParallelDim = 0;
         }
 
+#if GMX_MPI && !defined FFT5D_MPI_TRANSPOSE
+        if (bParallelDim && plan->pipelined)
+        {
+            fft5d_execute_pipelined_step(plan, s, thread, times);
+            continue;
+        }
+#endif
+
         /* ---------- START FFT ------------ */
 #ifdef NOGMX
         if (times != 0 && thread == 0)
@@ -1190,6 +1646,7 @@ void fft5d_execute(fft5d_plan plan, int thread, fft5d_time times)
         }
 
         tstart = (thread * pM[s] * pK[s] / plan->nthreads) * C[s];
+        fft5d_sub_start(times, thread, ewcsPME_FFT_COMPUTE);
         if ((plan->flags & FFT5D_REALCOMPLEX) && !(plan->flags & FFT5D_BACKWARD) && s == 0)
         {
             gmx_fft_many_1d_real(p1d[s][thread],
@@ -1203,6 +1660,7 @@ void fft5d_execute(fft5d_plan plan, int thread, fft5d_time times)
                             (plan->flags & FFT5D_BACKWARD) ? GMX_FFT_BACKWARD : GMX_FFT_FORWARD,
                             lin + tstart, fftout + tstart);
         }
+        fft5d_sub_stop(times, thread, ewcsPME_FFT_COMPUTE);
 
 #ifdef NOGMX
         if (times != NULL && thread == 0)
@@ -1255,6 +1713,7 @@ void fft5d_execute(fft5d_plan plan, int thread, fft5d_time times)
                 }
 #else
                 wallcycle_start(times, ewcPME_FFTCOMM);
+                wallcycle_sub_start(times, ewcsPME_FFT_COMM);
 #endif
 #ifdef FFT5D_MPI_TRANSPOSE
                 FFTW(execute)(mpip[s]);
@@ -1287,6 +1746,7 @@ void fft5d_execute(fft5d_plan plan, int thread, fft5d_time times)
                     time_mpi[s] = MPI_Wtime() - time;
                 }
 #else
+                wallcycle_sub_stop(times, ewcsPME_FFT_COMM);
                 wallcycle_stop(times, ewcPME_FFTCOMM);
 #endif
             }       /*master*/
@@ -1323,7 +1783,8 @@ void fft5d_execute(fft5d_plan plan, int thread, fft5d_time times)
                 tstart = (thread * pM[s] * pN[s] / plan->nthreads);
                 tend   = ((thread + 1) * pM[s] * pN[s] / plan->nthreads);
                 joinAxesTrans13(lin, joinin, N[s], pM[s], K[s], pM[s], P[s], C[s + 1], iNin[s + 1],
-                                oNin[s + 1], tstart % pM[s], tstart / pM[s], tend % pM[s], tend / pM[s]);
+                                oNin[s + 1], tstart % pM[s], tstart / pM[s], tend % pM[s],
+                                tend / pM[s], 0, 1);
             }
         }
         else
@@ -1363,18 +1824,9 @@ void fft5d_execute(fft5d_plan plan, int thread, fft5d_time times)
         lout = lin; /*in place currently not supported*/
     }
     /*  ----------- FFT ----------- */
-    tstart = (thread * pM[s] * pK[s] / plan->nthreads) * C[s];
-    if ((plan->flags & FFT5D_REALCOMPLEX) && (plan->flags & FFT5D_BACKWARD))
-    {
-        gmx_fft_many_1d_real(p1d[s][thread],
-                             (plan->flags & FFT5D_BACKWARD) ? GMX_FFT_COMPLEX_TO_REAL : GMX_FFT_REAL_TO_COMPLEX,
-                             lin + tstart, lout + tstart);
-    }
-    else
-    {
-        gmx_fft_many_1d(p1d[s][thread], (plan->flags & FFT5D_BACKWARD) ? GMX_FFT_BACKWARD : GMX_FFT_FORWARD,
-                        lin + tstart, lout + tstart);
-    }
+    fft5d_sub_start(times, thread, ewcsPME_FFT_COMPUTE);
+    fft5d_execute_last_step(plan, thread);
+    fft5d_sub_stop(times, thread, ewcsPME_FFT_COMPUTE);
     /* ------------ END FFT ---------*/
 
 #ifdef NOGMX
@@ -1395,6 +1847,55 @@ void fft5d_execute(fft5d_plan plan, int thread, fft5d_time times)
     }
 }
 
+bool fft5d_can_fuse(fft5d_plan forwardPlan, fft5d_plan backwardPlan)
+{
+    /*the forward output lines need to be the backward input lines with the same tiles*/
+    return (forwardPlan->useTiles && backwardPlan->useTiles && !(forwardPlan->flags & FFT5D_BACKWARD)
+            && (backwardPlan->flags & FFT5D_BACKWARD) && forwardPlan->lout == backwardPlan->lin
+            && forwardPlan->nthreads == backwardPlan->nthreads
+            && forwardPlan->pK[2] == backwardPlan->pK[0] && forwardPlan->pM[2] == backwardPlan->pM[0]
+            && forwardPlan->C[2] == backwardPlan->C[0]
+            && forwardPlan->tileK[2] == backwardPlan->tileK[0]
+            && forwardPlan->tileM[2] == backwardPlan->tileM[0]
+            && backwardPlan->lout3 != forwardPlan->lin && backwardPlan->lout3 != forwardPlan->lout);
+}
+
+/*Forward transform, op and backward transform without decomposition.
+   The last forward step, op and the first backward step are done tile by tile,
+   so the complex data of a tile is still in cache for op and the backward FFT.*/
+void fft5d_execute_fused(fft5d_plan           forwardPlan,
+                         fft5d_plan           backwardPlan,
+                         fft5d_line_operation op,
+                         void*                opData,
+                         int                  thread)
+{
+    int tileStart, tileEnd, tile, k0, nk, m0, nm, k;
+
+    GMX_ASSERT(fft5d_can_fuse(forwardPlan, backwardPlan), "The plans should be fusable");
+
+    fft5d_execute_tiled_steps(forwardPlan, thread);
+
+    const int C  = forwardPlan->C[2];
+    const int pM = forwardPlan->pM[2];
+    fft5d_thread_tiles(forwardPlan, 2, thread, &tileStart, &tileEnd);
+    for (tile = tileStart; tile < tileEnd; tile++)
+    {
+        fft5d_tile_extent(forwardPlan, 2, tile, &k0, &nk, &m0, &nm);
+        for (k = k0; k < k0 + nk; k++)
+        {
+            int line = k * pM + m0;
+            fft5d_tile_lines(forwardPlan, 2, thread, nm, forwardPlan->lin + line * C,
+                             forwardPlan->lout + line * C);
+            op(line, line + nm, thread, opData);
+        }
+        fft5d_tile(backwardPlan, 0, thread, backwardPlan->lin, backwardPlan->lout3, k0, nk, m0, nm);
+    }
+#pragma omp barrier
+    fft5d_execute_tiles(backwardPlan, 1, thread, backwardPlan->lout3, backwardPlan->lin);
+#pragma omp barrier
+    fft5d_execute_last_step(backwardPlan, thread);
+}
+
 void fft5d_destroy(fft5d_plan plan)
 {
     int s, t;
@@ -1409,6 +1910,27 @@ void fft5d_destroy(fft5d_plan plan)
             }
             free(plan->p1d[s]);
         }
+        if (plan->p1dTile[s])
+        {
+            for (t = 0; t < plan->nthreads; t++)
+            {
+                gmx_many_fft_destroy(plan->p1dTile[s][t]);
+                if (plan->p1dTileTail[s][t])
+                {
+                    gmx_many_fft_destroy(plan->p1dTileTail[s][t]);
+                }
+            }
+            free(plan->p1dTile[s]);
+            free(plan->p1dTileTail[s]);
+        }
+        if (s < 2 && plan->p1dLine[s])
+        {
+            for (t = 0; t < plan->nthreads; t++)
+            {
+                gmx_many_fft_destroy(plan->p1dLine[s][t]);
+            }
+            free(plan->p1dLine[s]);
+        }
         if (plan->iNin[s])
         {
             free(plan->iNin[s]);
@@ -1445,7 +1967,7 @@ void fft5d_destroy(fft5d_plan plan)
     FFTW_UNLOCK
 #endif /* GMX_FFT_FFTW3 */
 
-    if (!(plan->flags & FFT5D_NOMALLOC))
+    if (plan->ownsBuffers)
     {
         // only needed for PME GPU mixed mode
         if (plan->pinningPolicy == gmx::PinningPolicy::PinnedIfSupported && isHostMemoryPinned(plan->lin))
@@ -1454,12 +1976,29 @@ void fft5d_destroy(fft5d_plan plan)
         }
         sfree_aligned(plan->lin);
         sfree_aligned(plan->lout);
-        if (plan->nthreads > 1)
+        if (plan->lout2 != plan->lin)
         {
             sfree_aligned(plan->lout2);
+        }
+        if (plan->lout3 != plan->lout)
+        {
             sfree_aligned(plan->lout3);
         }
     }
+    if (plan->tileBuffer)
+    {
+        for (t = 0; t < plan->nthreads; t++)
+        {
+            sfree_aligned(plan->tileBuffer[t]);
+        }
+        free(plan->tileBuffer);
+    }
+#if GMX_MPI
+    if (plan->requests)
+    {
+        free(plan->requests);
+    }
+#endif
 
 #ifdef FFT5D_THREADS
 #    ifdef FFT5D_FFTW_THREADS
@@ -89,13 +89,17 @@ typedef enum fft5d_flags_t
     FFT5D_DEBUG       = 8,
     FFT5D_NOMEASURE   = 16,
     FFT5D_INPLACE     = 32,
-    FFT5D_NOMALLOC    = 64
+    FFT5D_NOMALLOC    = 64,
+    FFT5D_NOTILING    = 128,
+    FFT5D_PIPELINE    = 256
 } fft5d_flags;
 
 struct fft5d_plan_t
 {
     t_complex* lin;
     t_complex *lout, *lout2, *lout3;
+    int        bufferSize;  /*allocated number of complex values in each of the buffers above*/
+    bool       ownsBuffers; /*whether the buffers are freed by fft5d_destroy*/
     gmx_fft_t* p1d[3]; /*1D plans*/
 #if GMX_FFT_FFTW3
     FFTW(plan) p2d; /*2D plan: used for 1D decomposition if FFT supports transposed output*/
@@ -123,10 +127,28 @@ struct fft5d_plan_t
     int                coor[2];
     int                nthreads;
     gmx::PinningPolicy pinningPolicy;
+
+    /* Without decomposition the first two steps are done in tiles of lines,
+       each tile is transformed into a thread local buffer and transposed from there */
+    bool       useTiles;
+    int        tileK[3], tileM[3];           /*tile size along K and M*/
+    gmx_fft_t* p1dTile[3], *p1dTileTail[3]; /*1D plans for full tiles and for the remainder along M*/
+    t_complex** tileBuffer;                  /*per thread buffer for one transformed tile*/
+
+    /* With decomposition and FFT5D_PIPELINE the transposes are split into chunks along K,
+       the communication of a chunk is overlapped with the FFTs of the following chunks */
+    bool       pipelined;
+    gmx_fft_t* p1dLine[2]; /*1D plans for a single line, for the steps followed by a transpose*/
+#if GMX_MPI
+    MPI_Request* requests; /*send and receive requests for all chunks*/
+#endif
 };
 
 typedef struct fft5d_plan_t* fft5d_plan;
 
+/*operation on lines lineStart to lineEnd of the complex output of a forward plan*/
+typedef void (*fft5d_line_operation)(int lineStart, int lineEnd, int thread, void* data);
+
 void       fft5d_execute(fft5d_plan plan, int thread, fft5d_time times);
 fft5d_plan fft5d_plan_3d(int         N,
                          int         M,
@@ -138,7 +160,14 @@ fft5d_plan fft5d_plan_3d(int         N,
                          t_complex** lout2,
                          t_complex** lout3,
                          int         nthreads,
-                         gmx::PinningPolicy realGridAllocationPinningPolicy = gmx::PinningPolicy::CannotBePinned);
+                         gmx::PinningPolicy realGridAllocationPinningPolicy = gmx::PinningPolicy::CannotBePinned,
+                         fft5d_plan bufferSource = nullptr);
+bool       fft5d_can_fuse(fft5d_plan forwardPlan, fft5d_plan backwardPlan);
+void       fft5d_execute_fused(fft5d_plan           forwardPlan,
+                               fft5d_plan           backwardPlan,
+                               fft5d_line_operation op,
+                               void*                opData,
+                               int                  thread);
 void       fft5d_local_size(fft5d_plan plan, int* N1, int* M0, int* K0, int* K1, int** coor);
 void       fft5d_destroy(fft5d_plan plan);
 fft5d_plan fft5d_plan_3d_cart(int         N,
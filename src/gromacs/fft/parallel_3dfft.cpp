@@ -53,6 +53,12 @@ struct gmx_parallel_3dfft
     fft5d_plan p1, p2;
 };
 
+/* Minimum number of complex grid points for which the FFT steps are done in
+ * tiles. Smaller grids stay in the outer cache level, where the transposes
+ * over whole lines are as fast as the tiled transposes.
+ */
+static const int c_minTiledFftGridSize = 512 * 1024;
+
 int gmx_parallel_3dfft_init(gmx_parallel_3dfft_t* pfft_setup,
                             const ivec            ndata,
                             real**                real_data,
@@ -60,7 +66,8 @@ int gmx_parallel_3dfft_init(gmx_parallel_3dfft_t* pfft_setup,
                             MPI_Comm              comm[2],
                             gmx_bool              bReproducible,
                             int                   nthreads,
-                            gmx::PinningPolicy    realGridAllocation)
+                            gmx::PinningPolicy    realGridAllocation,
+                            gmx_parallel_3dfft_t  bufferSource)
 {
     int        rN = ndata[2], M = ndata[1], K = ndata[0];
     int        flags   = FFT5D_REALCOMPLEX | FFT5D_ORDER_YZ; /* FFT5D_DEBUG */
@@ -73,6 +80,14 @@ int gmx_parallel_3dfft_init(gmx_parallel_3dfft_t* pfft_setup,
     {
         flags |= FFT5D_NOMEASURE;
     }
+    if ((rN / 2 + 1) * M * K < c_minTiledFftGridSize || getenv("GMX_FFT_NO_TILING") != nullptr)
+    {
+        flags |= FFT5D_NOTILING;
+    }
+    if (getenv("GMX_FFT_PIPELINE") != nullptr)
+    {
+        flags |= FFT5D_PIPELINE;
+    }
 
     if (!(flags & FFT5D_ORDER_YZ))
     {
@@ -88,7 +103,8 @@ int gmx_parallel_3dfft_init(gmx_parallel_3dfft_t* pfft_setup,
     }
 
     (*pfft_setup)->p1 = fft5d_plan_3d(rN, M, K, rcomm, flags, reinterpret_cast<t_complex**>(real_data),
-                                      complex_data, &buf1, &buf2, nthreads, realGridAllocation);
+                                      complex_data, &buf1, &buf2, nthreads, realGridAllocation,
+                                      bufferSource != nullptr ? bufferSource->p1 : nullptr);
 
     (*pfft_setup)->p2 = fft5d_plan_3d(
             Nb, Mb, Kb, rcomm, (flags | FFT5D_BACKWARD | FFT5D_NOMALLOC) ^ FFT5D_ORDER_YZ,
@@ -182,6 +198,24 @@ int gmx_parallel_3dfft_execute(gmx_parallel_3dfft_t   pfft_setup,
     return 0;
 }
 
+bool gmx_parallel_3dfft_can_fuse_convolution(gmx_parallel_3dfft_t pfft_setup)
+{
+    return fft5d_can_fuse(pfft_setup->p1, pfft_setup->p2);
+}
+
+int gmx_parallel_3dfft_execute_convolution(gmx_parallel_3dfft_t             pfft_setup,
+                                           gmx_parallel_3dfft_line_operation op,
+                                           void*                            opData,
+                                           int                              thread)
+{
+    if (!gmx_parallel_3dfft_can_fuse_convolution(pfft_setup))
+    {
+        gmx_fatal(FARGS, "Invalid transform. The setup does not support fused convolutions");
+    }
+    fft5d_execute_fused(pfft_setup->p1, pfft_setup->p2, op, opData, thread);
+    return 0;
+}
+
 int gmx_parallel_3dfft_destroy(gmx_parallel_3dfft_t pfft_setup)
 {
     if (pfft_setup)
@@ -47,6 +47,16 @@
 
 typedef struct gmx_parallel_3dfft* gmx_parallel_3dfft_t;
 
+/*! \brief Operation on the local complex lines \p lineStart to \p lineEnd
+ *
+ * The lines are in the order of the local complex grid as returned by
+ * gmx_parallel_3dfft_complex_limits(), each line runs along the minor dimension.
+ */
+typedef void (*gmx_parallel_3dfft_line_operation)(int   lineStart,
+                                                  int   lineEnd,
+                                                  int   thread,
+                                                  void* data);
+
 
 /*! \brief Initialize parallel MPI-based 3D-FFT.
  *
@@ -71,6 +81,10 @@ typedef struct gmx_parallel_3dfft* gmx_parallel_3dfft_t;
  *  \param nthreads       Run in parallel using n threads
  *  \param realGridAllocation  Whether to make real grid use allocation pinned for GPU transfers.
  *                             Only used in PME mixed CPU+GPU mode.
+ *  \param bufferSource  When not null, the grids of this setup are used instead of
+ *                       allocating new ones, when they are large enough. This setup
+ *                       should then outlive \p pfft_setup and the two setups should
+ *                       not be executed concurrently.
  *
  *  \return 0 or a standard error code.
  */
@@ -81,7 +95,8 @@ int gmx_parallel_3dfft_init(gmx_parallel_3dfft_t* pfft_setup,
                             MPI_Comm              comm[2],
                             gmx_bool              bReproducible,
                             int                   nthreads,
-                            gmx::PinningPolicy realGridAllocation = gmx::PinningPolicy::CannotBePinned);
+                            gmx::PinningPolicy realGridAllocation = gmx::PinningPolicy::CannotBePinned,
+                            gmx_parallel_3dfft_t bufferSource = nullptr);
 
 
 /*! \brief Get direct space grid index limits
@@ -107,6 +122,37 @@ int gmx_parallel_3dfft_execute(gmx_parallel_3dfft_t   pfft_setup,
                                gmx_wallcycle_t        wcycle);
 
 
+/*! \brief Returns whether gmx_parallel_3dfft_execute_convolution() can be used
+ *
+ * This is the case for grids that are not decomposed and large enough
+ * to pass the complex lines through the last forward and the first
+ * backward FFT step in cache-sized tiles.
+ */
+bool gmx_parallel_3dfft_can_fuse_convolution(gmx_parallel_3dfft_t pfft_setup);
+
+/*! \brief Real-to-complex FFT, \p op on all complex lines and complex-to-real FFT
+ *
+ * Does the same as gmx_parallel_3dfft_execute() for both directions with
+ * \p op applied to the complex data in between, but applies \p op to
+ * tiles of lines directly after their last forward FFT and
+ * before their first backward FFT. This saves two passes over the complex grid.
+ * The lines passed to \p op on a thread are not those of the default
+ * division of the lines over the threads. Must be called by all \p nthreads
+ * threads passed to gmx_parallel_3dfft_init() and requires
+ * gmx_parallel_3dfft_can_fuse_convolution() to return true.
+ *
+ * \param pfft_setup  Parallel 3dfft setup.
+ * \param op          Operation to apply to the complex lines.
+ * \param opData      Data passed to \p op.
+ * \param thread      The thread index.
+ *
+ * \return 0 or a standard error code.
+ */
+int gmx_parallel_3dfft_execute_convolution(gmx_parallel_3dfft_t             pfft_setup,
+                                           gmx_parallel_3dfft_line_operation op,
+                                           void*                            opData,
+                                           int                              thread);
+
 /*! \brief Release all data in parallel fft setup
  *
  *  All temporary storage and FFT plans are released. The structure itself
@@ -52,7 +52,9 @@
 
 #include <gtest/gtest.h>
 
+#include "gromacs/fft/fft5d.h"
 #include "gromacs/fft/parallel_3dfft.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/stringutil.h"
 
 #include "testutils/refdata.h"
@@ -316,4 +318,221 @@ TEST_F(FFFTest3D, Real5_6_9)
     }
 }
 
+/*! \brief Forward and backward fft5d plans set up as by gmx_parallel_3dfft_init()
+ *
+ * Used to compare the default transforms, which use tiles without
+ * decomposition, with the line-based transforms selected by FFT5D_NOTILING.
+ */
+class Fft5dPlans
+{
+public:
+    Fft5dPlans(const int ndata[3], int nthreads, int extraFlags, fft5d_plan bufferSource = nullptr)
+    {
+        int      flags   = FFT5D_REALCOMPLEX | FFT5D_ORDER_YZ | FFT5D_NOMEASURE | extraFlags;
+        MPI_Comm comm[2] = { MPI_COMM_NULL, MPI_COMM_NULL };
+        t_complex *buf1, *buf2;
+
+        forward_ = fft5d_plan_3d(ndata[2], ndata[1], ndata[0], comm, flags, &realData_, &complexData_,
+                                 &buf1, &buf2, nthreads, gmx::PinningPolicy::CannotBePinned, bufferSource);
+        backward_ = fft5d_plan_3d(ndata[0], ndata[2], ndata[1], comm,
+                                  (flags | FFT5D_BACKWARD | FFT5D_NOMALLOC) ^ FFT5D_ORDER_YZ,
+                                  &complexData_, &realData_, &buf1, &buf2, nthreads);
+    }
+    ~Fft5dPlans()
+    {
+        fft5d_destroy(backward_);
+        fft5d_destroy(forward_);
+    }
+
+    //! Executes \p plan on \p nthreads threads
+    static void execute(fft5d_plan plan, int nthreads)
+    {
+#pragma omp parallel num_threads(nthreads)
+        {
+            fft5d_execute(plan, gmx_omp_get_thread_num(), nullptr);
+        }
+    }
+
+    //! Number of complex values in the forward input and output
+    int numComplex() const { return forward_->C[0] * forward_->pM[0] * forward_->pK[0]; }
+
+    fft5d_plan forward_;
+    fft5d_plan backward_;
+    t_complex* realData_    = nullptr;
+    t_complex* complexData_ = nullptr;
+};
+
+//! Fills \p data with \p size complex values from inputdata
+void fillComplex(t_complex* data, int size)
+{
+    const int numInput = sizeof(inputdata) / sizeof(inputdata[0]);
+    for (int i = 0; i < size; i++)
+    {
+        data[i].re = inputdata[(2 * i) % numInput];
+        data[i].im = inputdata[(2 * i + 1) % numInput];
+    }
+}
+
+//! Scales line \p line of the complex grid with 1 + line/10, mimics the PME solve
+void scaleLines(int lineStart, int lineEnd, int /*thread*/, void* data)
+{
+    const auto* plans = static_cast<const Fft5dPlans*>(data);
+    const int   C     = plans->forward_->C[2];
+    for (int line = lineStart; line < lineEnd; line++)
+    {
+        for (int i = line * C; i < (line + 1) * C; i++)
+        {
+            plans->complexData_[i].re *= 1 + 0.1 * line;
+            plans->complexData_[i].im *= 1 + 0.1 * line;
+        }
+    }
+}
+
+//! Returns the thread counts to test with
+std::vector<int> threadCounts()
+{
+    std::vector<int> counts;
+    // With FFTW a single thread uses a 3D FFTW plan instead of tiles
+    if (!GMX_FFT_FFTW3)
+    {
+        counts.push_back(1);
+    }
+    if (GMX_OPENMP)
+    {
+        counts.push_back(3);
+    }
+    return counts;
+}
+
+// The sizes give partial tiles in all dimensions
+const int c_tiledNdata[3] = { 19, 14, 22 };
+
+TEST(Fft5dTest, TiledMatchesUntiled)
+{
+    for (int nthreads : threadCounts())
+    {
+        SCOPED_TRACE(gmx::formatString("Using %d threads", nthreads));
+        Fft5dPlans tiled(c_tiledNdata, nthreads, 0);
+        Fft5dPlans untiled(c_tiledNdata, nthreads, FFT5D_NOTILING);
+        ASSERT_TRUE(tiled.forward_->useTiles);
+        ASSERT_FALSE(untiled.forward_->useTiles);
+
+        const int  size = tiled.numComplex();
+        const auto tolerance =
+                gmx::test::relativeToleranceAsPrecisionDependentUlp(10.0 * size, 64, 512);
+
+        fillComplex(tiled.realData_, size);
+        fillComplex(untiled.realData_, size);
+        Fft5dPlans::execute(tiled.forward_, nthreads);
+        Fft5dPlans::execute(untiled.forward_, nthreads);
+        for (int i = 0; i < size; i++)
+        {
+            EXPECT_REAL_EQ_TOL(untiled.complexData_[i].re, tiled.complexData_[i].re, tolerance);
+            EXPECT_REAL_EQ_TOL(untiled.complexData_[i].im, tiled.complexData_[i].im, tolerance);
+        }
+
+        fillComplex(tiled.complexData_, size);
+        fillComplex(untiled.complexData_, size);
+        Fft5dPlans::execute(tiled.backward_, nthreads);
+        Fft5dPlans::execute(untiled.backward_, nthreads);
+        const int lineSize = 2 * tiled.forward_->C[0];
+        for (int line = 0; line < c_tiledNdata[0] * c_tiledNdata[1]; line++)
+        {
+            const real* tiledLine   = reinterpret_cast<real*>(tiled.realData_) + line * lineSize;
+            const real* untiledLine = reinterpret_cast<real*>(untiled.realData_) + line * lineSize;
+            for (int i = 0; i < c_tiledNdata[2]; i++)
+            {
+                EXPECT_REAL_EQ_TOL(untiledLine[i], tiledLine[i], tolerance);
+            }
+        }
+    }
+}
+
+TEST(Fft5dTest, FusedConvolutionMatchesSeparateTransforms)
+{
+    for (int nthreads : threadCounts())
+    {
+        SCOPED_TRACE(gmx::formatString("Using %d threads", nthreads));
+        Fft5dPlans fused(c_tiledNdata, nthreads, 0);
+        Fft5dPlans separate(c_tiledNdata, nthreads, FFT5D_NOTILING);
+        ASSERT_TRUE(fft5d_can_fuse(fused.forward_, fused.backward_));
+        ASSERT_FALSE(fft5d_can_fuse(separate.forward_, separate.backward_));
+
+        const int  size = fused.numComplex();
+        const auto tolerance =
+                gmx::test::relativeToleranceAsPrecisionDependentUlp(10.0 * size, 64, 512);
+
+        fillComplex(fused.realData_, size);
+        fillComplex(separate.realData_, size);
+#pragma omp parallel num_threads(nthreads)
+        {
+            fft5d_execute_fused(fused.forward_, fused.backward_, scaleLines, &fused,
+                                gmx_omp_get_thread_num());
+        }
+        Fft5dPlans::execute(separate.forward_, nthreads);
+        scaleLines(0, separate.forward_->pK[2] * separate.forward_->pM[2], 0, &separate);
+        Fft5dPlans::execute(separate.backward_, nthreads);
+
+        const int lineSize = 2 * fused.forward_->C[0];
+        for (int line = 0; line < c_tiledNdata[0] * c_tiledNdata[1]; line++)
+        {
+            const real* fusedLine    = reinterpret_cast<real*>(fused.realData_) + line * lineSize;
+            const real* separateLine = reinterpret_cast<real*>(separate.realData_) + line * lineSize;
+            for (int i = 0; i < c_tiledNdata[2]; i++)
+            {
+                EXPECT_REAL_EQ_TOL(separateLine[i], fusedLine[i], tolerance);
+            }
+        }
+    }
+}
+
+TEST(Fft5dTest, ReusedBuffersMatchAllocatedBuffers)
+{
+    const int smallNdata[3] = { 16, 12, 18 };
+    for (int nthreads : threadCounts())
+    {
+        SCOPED_TRACE(gmx::formatString("Using %d threads", nthreads));
+        Fft5dPlans large(c_tiledNdata, nthreads, 0);
+        Fft5dPlans reusing(smallNdata, nthreads, 0, large.forward_);
+        Fft5dPlans allocating(smallNdata, nthreads, 0);
+        ASSERT_EQ(large.realData_, reusing.realData_);
+        ASSERT_EQ(large.complexData_, reusing.complexData_);
+        ASSERT_NE(large.realData_, allocating.realData_);
+        {
+            // The buffers of a smaller grid are too small to be reused
+            Fft5dPlans notReusing(c_tiledNdata, nthreads, 0, allocating.forward_);
+            ASSERT_NE(allocating.realData_, notReusing.realData_);
+        }
+
+        const int  size = allocating.numComplex();
+        const auto tolerance =
+                gmx::test::relativeToleranceAsPrecisionDependentUlp(10.0 * size, 64, 512);
+
+        // Fill the reused buffers with the data of the larger grid first
+        fillComplex(large.realData_, large.numComplex());
+        Fft5dPlans::execute(large.forward_, nthreads);
+
+        fillComplex(reusing.realData_, size);
+        fillComplex(allocating.realData_, size);
+#pragma omp parallel num_threads(nthreads)
+        {
+            fft5d_execute_fused(reusing.forward_, reusing.backward_, scaleLines, &reusing,
+                                gmx_omp_get_thread_num());
+            fft5d_execute_fused(allocating.forward_, allocating.backward_, scaleLines, &allocating,
+                                gmx_omp_get_thread_num());
+        }
+
+        const int lineSize = 2 * allocating.forward_->C[0];
+        for (int line = 0; line < smallNdata[0] * smallNdata[1]; line++)
+        {
+            const real* reusingLine = reinterpret_cast<real*>(reusing.realData_) + line * lineSize;
+            const real* allocatingLine = reinterpret_cast<real*>(allocating.realData_) + line * lineSize;
+            for (int i = 0; i < smallNdata[2]; i++)
+            {
+                EXPECT_REAL_EQ_TOL(allocatingLine[i], reusingLine[i], tolerance);
+            }
+        }
+    }
+}
+
 } // namespace
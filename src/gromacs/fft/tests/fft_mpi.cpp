@@ -0,0 +1,244 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests the decomposed fft5d transforms, with and without pipelined transposes.
+ *
+ * \ingroup module_fft
+ */
+#include "gmxpre.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fft/fft5d.h"
+#include "gromacs/utility/gmxmpi.h"
+#include "gromacs/utility/gmxomp.h"
+#include "gromacs/utility/stringutil.h"
+
+#include "testutils/mpitest.h"
+#include "testutils/testasserts.h"
+
+namespace
+{
+
+/*! \brief Forward and backward fft5d plans set up as by gmx_parallel_3dfft_init()
+ *
+ * \p comm are the PME communicators along the major and minor dimension,
+ * MPI_COMM_NULL for a dimension that is not decomposed.
+ */
+class Fft5dPlans
+{
+public:
+    Fft5dPlans(const int ndata[3], MPI_Comm comm[2], int nthreads, int extraFlags)
+    {
+        int        flags    = FFT5D_REALCOMPLEX | FFT5D_ORDER_YZ | FFT5D_NOMEASURE | extraFlags;
+        MPI_Comm   rcomm[2] = { comm[1], comm[0] };
+        t_complex *buf1, *buf2;
+
+        forward_ = fft5d_plan_3d(ndata[2], ndata[1], ndata[0], rcomm, flags, &realData_,
+                                 &complexData_, &buf1, &buf2, nthreads);
+        backward_ = fft5d_plan_3d(ndata[0], ndata[2], ndata[1], rcomm,
+                                  (flags | FFT5D_BACKWARD | FFT5D_NOMALLOC) ^ FFT5D_ORDER_YZ,
+                                  &complexData_, &realData_, &buf1, &buf2, nthreads);
+    }
+    ~Fft5dPlans()
+    {
+        fft5d_destroy(backward_);
+        fft5d_destroy(forward_);
+    }
+
+    //! Executes \p plan on \p nthreads threads
+    static void execute(fft5d_plan plan, int nthreads)
+    {
+#pragma omp parallel num_threads(nthreads)
+        {
+            fft5d_execute(plan, gmx_omp_get_thread_num(), nullptr);
+        }
+    }
+
+    fft5d_plan forward_;
+    fft5d_plan backward_;
+    t_complex* realData_    = nullptr;
+    t_complex* complexData_ = nullptr;
+};
+
+//! Returns the index in the input data of \p plan of the line with global indices \p k, \p m
+int lineIndex(fft5d_plan plan, int k, int m)
+{
+    return ((k - plan->oK[0]) * plan->pM[0] + m - plan->oM[0]) * plan->C[0];
+}
+
+/*! \brief Calls \p f(index, serialIndex) for all local input lines of \p plan
+ *
+ * \p serialPlan is the same transform without decomposition, serialIndex
+ * is the index of the line in its input data.
+ */
+template<typename F>
+void forLocalLines(fft5d_plan plan, fft5d_plan serialPlan, F f)
+{
+    for (int k = plan->oK[0]; k < plan->oK[0] + plan->pK[0]; k++)
+    {
+        for (int m = plan->oM[0]; m < plan->oM[0] + plan->pM[0]; m++)
+        {
+            f(lineIndex(plan, k, m), lineIndex(serialPlan, k, m));
+        }
+    }
+}
+
+//! Returns a deterministic input value for grid point \p index
+real inputValue(int index)
+{
+    return ((index * 2654435761U) % 199) * 0.1 - 9.9;
+}
+
+//! Returns the thread counts to test with
+std::vector<int> threadCounts()
+{
+    std::vector<int> counts = { 1 };
+    if (GMX_OPENMP)
+    {
+        counts.push_back(2);
+    }
+    return counts;
+}
+
+//! Number of PME ranks along the major and minor dimension
+struct Decomposition
+{
+    int numMajor;
+    int numMinor;
+};
+
+// The grid sizes are not multiples of the rank counts, so the ranks have different line counts
+const int c_ndata[3] = { 19, 14, 22 };
+
+TEST(Fft5dMpiTest, DecomposedTransformsMatchSerialTransforms)
+{
+    GMX_MPI_TEST(6);
+
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    // The transforms without decomposition are the reference
+    MPI_Comm   noComm[2] = { MPI_COMM_NULL, MPI_COMM_NULL };
+    Fft5dPlans serial(c_ndata, noComm, 1, 0);
+    real*      serialReal   = reinterpret_cast<real*>(serial.realData_);
+    const int  realLineSize = 2 * serial.forward_->C[0];
+    for (int line = 0; line < c_ndata[0] * c_ndata[1]; line++)
+    {
+        for (int i = 0; i < c_ndata[2]; i++)
+        {
+            serialReal[line * realLineSize + i] = inputValue(line * c_ndata[2] + i);
+        }
+    }
+    const std::vector<real> input(serialReal, serialReal + c_ndata[0] * c_ndata[1] * realLineSize);
+    Fft5dPlans::execute(serial.forward_, 1);
+    const int complexLineSize = serial.backward_->C[0];
+    const int numComplex      = serial.backward_->pK[0] * serial.backward_->pM[0] * complexLineSize;
+    const std::vector<t_complex> serialComplex(serial.complexData_,
+                                               serial.complexData_ + numComplex);
+    Fft5dPlans::execute(serial.backward_, 1);
+    const auto tolerance =
+            gmx::test::relativeToleranceAsPrecisionDependentUlp(10.0 * numComplex, 64, 512);
+
+    // With 5 ranks one rank is idle
+    const Decomposition decompositions[] = { { 2, 1 }, { 5, 1 }, { 1, 5 }, { 3, 2 }, { 2, 3 } };
+    const int           transposeFlags[] = { 0, FFT5D_PIPELINE };
+    for (const Decomposition& decomposition : decompositions)
+    {
+        const int numRanks = decomposition.numMajor * decomposition.numMinor;
+        MPI_Comm  commActive;
+        MPI_Comm_split(MPI_COMM_WORLD, rank < numRanks ? 0 : MPI_UNDEFINED, rank, &commActive);
+        if (commActive == MPI_COMM_NULL)
+        {
+            continue;
+        }
+        const int majorIndex = rank / decomposition.numMinor;
+        const int minorIndex = rank % decomposition.numMinor;
+        MPI_Comm  commMajor, commMinor;
+        MPI_Comm_split(commActive, minorIndex, majorIndex, &commMajor);
+        MPI_Comm_split(commActive, majorIndex, minorIndex, &commMinor);
+        MPI_Comm comm[2] = { decomposition.numMajor > 1 ? commMajor : MPI_COMM_NULL,
+                             decomposition.numMinor > 1 ? commMinor : MPI_COMM_NULL };
+
+        for (int nthreads : threadCounts())
+        {
+            for (int extraFlags : transposeFlags)
+            {
+                SCOPED_TRACE(gmx::formatString("Using %dx%d ranks, %d threads, %s transposes",
+                                               decomposition.numMajor, decomposition.numMinor,
+                                               nthreads, extraFlags ? "pipelined" : "blocking"));
+                Fft5dPlans plans(c_ndata, comm, nthreads, extraFlags);
+                ASSERT_EQ(extraFlags != 0, plans.forward_->pipelined);
+                ASSERT_EQ(extraFlags != 0, plans.backward_->pipelined);
+                real* realData = reinterpret_cast<real*>(plans.realData_);
+
+                forLocalLines(plans.forward_, serial.forward_, [&](int index, int serialIndex) {
+                    for (int i = 0; i < c_ndata[2]; i++)
+                    {
+                        realData[2 * index + i] = input[2 * serialIndex + i];
+                    }
+                });
+                Fft5dPlans::execute(plans.forward_, nthreads);
+                forLocalLines(plans.backward_, serial.backward_, [&](int index, int serialIndex) {
+                    for (int i = 0; i < complexLineSize; i++)
+                    {
+                        EXPECT_REAL_EQ_TOL(serialComplex[serialIndex + i].re,
+                                           plans.complexData_[index + i].re, tolerance);
+                        EXPECT_REAL_EQ_TOL(serialComplex[serialIndex + i].im,
+                                           plans.complexData_[index + i].im, tolerance);
+                    }
+                });
+
+                Fft5dPlans::execute(plans.backward_, nthreads);
+                forLocalLines(plans.forward_, serial.forward_, [&](int index, int serialIndex) {
+                    for (int i = 0; i < c_ndata[2]; i++)
+                    {
+                        EXPECT_REAL_EQ_TOL(serialReal[2 * serialIndex + i], realData[2 * index + i],
+                                           tolerance);
+                    }
+                });
+            }
+        }
+
+        MPI_Comm_free(&commMinor);
+        MPI_Comm_free(&commMajor);
+        MPI_Comm_free(&commActive);
+    }
+}
+
+} // namespace
@@ -0,0 +1,534 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements lossless block compression of rvec arrays.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "compressedrvecarray.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <exception>
+#include <type_traits>
+#include <vector>
+
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/gmxomp.h"
+#include "gromacs/utility/iserializer.h"
+#include "gromacs/utility/stringutil.h"
+
+namespace gmx
+{
+
+namespace
+{
+
+//! The number of rvecs per independently compressed block
+constexpr int c_blockSize = 16384;
+
+//! The maximum number of decimals used for the scaled integer encoding
+constexpr int c_maxNumDecimals = 6;
+
+//! The maximum absolute scaled integer value, well within the range of integers exact in double
+constexpr double c_maxScaledValue = 1e15;
+
+//! The encodings of a block, stored in the first byte of the block
+enum class BlockEncoding : unsigned char
+{
+    XorDifference, //!< XOR with the previous value of the same dimension, leading zeros omitted
+    ScaledInteger  //!< Differences of the values scaled to integers by a power of ten
+};
+
+//! Unsigned integer type with the size of \p Real
+template<typename Real>
+using BitsType = std::conditional_t<sizeof(Real) == sizeof(uint32_t), uint32_t, uint64_t>;
+
+//! Returns the bit pattern of \p value
+template<typename Real>
+BitsType<Real> toBits(Real value)
+{
+    BitsType<Real> bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+//! Returns the value with bit pattern \p bits
+template<typename Real>
+Real fromBits(BitsType<Real> bits)
+{
+    Real value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+//! Returns 10 to the power \p numDecimals
+double decimalScale(int numDecimals)
+{
+    double scale = 1;
+    for (int i = 0; i < numDecimals; i++)
+    {
+        scale *= 10;
+    }
+    return scale;
+}
+
+//! Returns the value represented by \p scaledValue, used for both encoding and decoding
+template<typename Real>
+Real unscale(int64_t scaledValue, double scale)
+{
+    return static_cast<Real>(static_cast<double>(scaledValue) / scale);
+}
+
+//! Returns whether all \p values are reproduced bit for bit when scaled to integers with \p scale
+template<typename Real>
+bool valuesAreExactWithScale(ArrayRef<const Real> values, double scale)
+{
+    for (const Real value : values)
+    {
+        const double scaledValue = std::round(static_cast<double>(value) * scale);
+        // Note that this check also fails for NaN
+        if (!(std::fabs(scaledValue) <= c_maxScaledValue)
+            || toBits(unscale<Real>(static_cast<int64_t>(scaledValue), scale)) != toBits(value))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+//! Maps signed to unsigned integers such that values of small magnitude map to small values
+uint64_t zigzagEncode(int64_t value)
+{
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+//! Inverse of zigzagEncode()
+int64_t zigzagDecode(uint64_t value)
+{
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+//! Appends \p value to \p buffer in 7 bits per byte, the high bit set on all but the last byte
+void appendVarint(uint64_t value, std::vector<char>* buffer)
+{
+    while (value >= 0x80)
+    {
+        buffer->push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    buffer->push_back(static_cast<char>(value));
+}
+
+//! Sequential reader of the bytes of a compressed block, throws on reading past the end
+class BlockReader
+{
+public:
+    //! Constructor
+    explicit BlockReader(ArrayRef<const char> data) : data_(data), position_(0) {}
+
+    //! Reads \p numBytes bytes
+    ArrayRef<const char> readBytes(std::size_t numBytes)
+    {
+        if (numBytes > data_.size() - position_)
+        {
+            GMX_THROW(FileIOError("Compressed coordinate block is truncated"));
+        }
+        ArrayRef<const char> bytes = data_.subArray(position_, numBytes);
+        position_ += numBytes;
+        return bytes;
+    }
+
+    //! Reads a single byte
+    unsigned char readByte() { return static_cast<unsigned char>(readBytes(1)[0]); }
+
+    //! Reads a value written by appendVarint()
+    uint64_t readVarint()
+    {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            const unsigned char byte = readByte();
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0)
+            {
+                return value;
+            }
+        }
+        GMX_THROW(FileIOError("Invalid integer in compressed coordinate block"));
+    }
+
+    //! Returns whether all data has been read
+    bool atEnd() const { return position_ == data_.size(); }
+
+private:
+    //! The data of the block
+    ArrayRef<const char> data_;
+    //! The read position in \p data_
+    std::size_t position_;
+};
+
+//! Appends \p values to \p buffer as differences of integers scaled by \p scale
+template<typename Real>
+void encodeScaledInteger(ArrayRef<const Real> values, double scale, std::vector<char>* buffer)
+{
+    int64_t previous[DIM] = { 0, 0, 0 };
+    for (std::size_t i = 0; i < values.size(); i++)
+    {
+        const int64_t scaledValue =
+                static_cast<int64_t>(std::round(static_cast<double>(values[i]) * scale));
+        appendVarint(zigzagEncode(scaledValue - previous[i % DIM]), buffer);
+        previous[i % DIM] = scaledValue;
+    }
+}
+
+//! Decodes values written by encodeScaledInteger()
+template<typename Real>
+void decodeScaledInteger(BlockReader* reader, double scale, ArrayRef<Real> values)
+{
+    int64_t previous[DIM] = { 0, 0, 0 };
+    for (std::size_t i = 0; i < values.size(); i++)
+    {
+        // Unsigned addition avoids undefined behavior with corrupted data
+        const int64_t scaledValue = static_cast<int64_t>(
+                static_cast<uint64_t>(previous[i % DIM])
+                + static_cast<uint64_t>(zigzagDecode(reader->readVarint())));
+        values[i]         = unscale<Real>(scaledValue, scale);
+        previous[i % DIM] = scaledValue;
+    }
+}
+
+/*! \brief Appends \p values to \p buffer as XOR differences without leading zero bytes
+ *
+ * The number of remaining bytes for each value is stored in 4 bits,
+ * two per byte, before the value bytes, which are stored most
+ * significant byte first.
+ */
+template<typename Real>
+void encodeXorDifference(ArrayRef<const Real> values, std::vector<char>* buffer)
+{
+    const std::size_t countsStart = buffer->size();
+    buffer->resize(countsStart + (values.size() + 1) / 2, 0);
+    BitsType<Real> previous[DIM] = { 0, 0, 0 };
+    for (std::size_t i = 0; i < values.size(); i++)
+    {
+        const BitsType<Real> bits       = toBits(values[i]);
+        const BitsType<Real> difference = bits ^ previous[i % DIM];
+        previous[i % DIM]               = bits;
+
+        int numBytes = 0;
+        while (numBytes < static_cast<int>(sizeof(difference))
+               && (difference >> (8 * numBytes)) != 0)
+        {
+            numBytes++;
+        }
+        (*buffer)[countsStart + i / 2] |= static_cast<char>(numBytes << (4 * (i % 2)));
+        for (int byte = numBytes - 1; byte >= 0; byte--)
+        {
+            buffer->push_back(static_cast<char>((difference >> (8 * byte)) & 0xFF));
+        }
+    }
+}
+
+//! Decodes values written by encodeXorDifference()
+template<typename Real>
+void decodeXorDifference(BlockReader* reader, ArrayRef<Real> values)
+{
+    const ArrayRef<const char> counts        = reader->readBytes((values.size() + 1) / 2);
+    BitsType<Real>             previous[DIM] = { 0, 0, 0 };
+    for (std::size_t i = 0; i < values.size(); i++)
+    {
+        const int numBytes = (static_cast<unsigned char>(counts[i / 2]) >> (4 * (i % 2))) & 0xF;
+        if (numBytes > static_cast<int>(sizeof(BitsType<Real>)))
+        {
+            GMX_THROW(FileIOError("Invalid byte count in compressed coordinate block"));
+        }
+        BitsType<Real> difference = 0;
+        for (int byte = 0; byte < numBytes; byte++)
+        {
+            difference = (difference << 8) | reader->readByte();
+        }
+        previous[i % DIM] ^= difference;
+        values[i] = fromBits<Real>(previous[i % DIM]);
+    }
+}
+
+//! Returns \p values compressed into a block
+template<typename Real>
+std::vector<char> encodeBlock(ArrayRef<const Real> values)
+{
+    std::vector<char> buffer;
+    for (int numDecimals = 0; numDecimals <= c_maxNumDecimals; numDecimals++)
+    {
+        const double scale = decimalScale(numDecimals);
+        if (valuesAreExactWithScale(values, scale))
+        {
+            buffer.push_back(static_cast<char>(BlockEncoding::ScaledInteger));
+            buffer.push_back(static_cast<char>(numDecimals));
+            encodeScaledInteger(values, scale, &buffer);
+            return buffer;
+        }
+    }
+    buffer.push_back(static_cast<char>(BlockEncoding::XorDifference));
+    encodeXorDifference(values, &buffer);
+    return buffer;
+}
+
+//! Decompresses the block \p data, stored with precision \p Real, into \p values
+template<typename Real>
+void decodeBlock(ArrayRef<const char> data, ArrayRef<Real> values)
+{
+    BlockReader reader(data);
+    const auto  encoding = static_cast<BlockEncoding>(reader.readByte());
+    if (encoding == BlockEncoding::ScaledInteger)
+    {
+        const int numDecimals = reader.readByte();
+        if (numDecimals > c_maxNumDecimals)
+        {
+            GMX_THROW(FileIOError("Invalid number of decimals in compressed coordinate block"));
+        }
+        decodeScaledInteger(&reader, decimalScale(numDecimals), values);
+    }
+    else if (encoding == BlockEncoding::XorDifference)
+    {
+        decodeXorDifference(&reader, values);
+    }
+    else
+    {
+        GMX_THROW(FileIOError("Unknown encoding of compressed coordinate block"));
+    }
+    if (!reader.atEnd())
+    {
+        GMX_THROW(FileIOError("Compressed coordinate block contains trailing data"));
+    }
+}
+
+//! Decompresses the block \p data, stored with precision \p FileReal, into \p values
+template<typename FileReal>
+void decodeBlockToReal(ArrayRef<const char> data, ArrayRef<real> values)
+{
+    if constexpr (std::is_same_v<FileReal, real>)
+    {
+        decodeBlock<real>(data, values);
+    }
+    else
+    {
+        std::vector<FileReal> fileValues(values.size());
+        decodeBlock<FileReal>(data, fileValues);
+        std::transform(fileValues.begin(), fileValues.end(), values.begin(),
+                       [](FileReal value) { return static_cast<real>(value); });
+    }
+}
+
+//! The header of a compressed array
+struct CompressedArrayHeader
+{
+    //! The size of the stored floating point values in bytes
+    int valueSize;
+    //! The number of rvecs per block
+    int blockSize;
+    //! The size of each compressed block in bytes
+    std::vector<int64_t> blockSizesInBytes;
+};
+
+//! Reads the header of a compressed array
+CompressedArrayHeader readHeader(ISerializer* serializer)
+{
+    CompressedArrayHeader header;
+    int                   numBlocks;
+    serializer->doInt(&header.valueSize);
+    serializer->doInt(&header.blockSize);
+    serializer->doInt(&numBlocks);
+    if ((header.valueSize != sizeof(float) && header.valueSize != sizeof(double))
+        || header.blockSize <= 0 || numBlocks < 0)
+    {
+        GMX_THROW(FileIOError("Invalid header of compressed coordinate array"));
+    }
+    header.blockSizesInBytes.resize(numBlocks);
+    serializer->doInt64Array(header.blockSizesInBytes.data(), numBlocks);
+    for (const int64_t blockSizeInBytes : header.blockSizesInBytes)
+    {
+        if (blockSizeInBytes < 0)
+        {
+            GMX_THROW(FileIOError("Invalid block size in compressed coordinate array"));
+        }
+    }
+    return header;
+}
+
+//! Returns the values of block \p block out of \p values
+template<typename Real>
+ArrayRef<Real> blockValues(ArrayRef<Real> values, int block, int blockSize)
+{
+    const std::size_t start = std::size_t(DIM) * block * blockSize;
+    return values.subArray(start, std::min(std::size_t(DIM) * blockSize, values.size() - start));
+}
+
+/*! \brief Rethrows the first of the exceptions caught by the threads, if any
+ *
+ * Exceptions can not propagate out of an OpenMP parallel region,
+ * so each thread stores the exception it caught in \p exceptions.
+ */
+void rethrowFirstException(ArrayRef<const std::exception_ptr> exceptions)
+{
+    for (const std::exception_ptr& exception : exceptions)
+    {
+        if (exception)
+        {
+            std::rethrow_exception(exception);
+        }
+    }
+}
+
+} // namespace
+
+void serializeCompressedRvecArray(ISerializer* serializer, rvec* values, int numValues)
+{
+    const ArrayRef<real> flatValues =
+            (numValues > 0 ? arrayRefFromArray(values[0], std::size_t(DIM) * numValues)
+                           : ArrayRef<real>());
+    const int                       numThreads = gmx_omp_get_max_threads();
+    std::vector<std::exception_ptr> threadExceptions(numThreads);
+
+    if (!serializer->reading())
+    {
+        int valueSize = sizeof(real);
+        int blockSize = c_blockSize;
+        int numBlocks = (numValues + blockSize - 1) / blockSize;
+
+        std::vector<std::vector<char>> blocks(numBlocks);
+#pragma omp parallel for num_threads(numThreads) schedule(dynamic)
+        for (int block = 0; block < numBlocks; block++)
+        {
+            try
+            {
+                blocks[block] = encodeBlock<real>(blockValues(flatValues, block, blockSize));
+            }
+            catch (...)
+            {
+                threadExceptions[gmx_omp_get_thread_num()] = std::current_exception();
+            }
+        }
+        rethrowFirstException(threadExceptions);
+
+        serializer->doInt(&valueSize);
+        serializer->doInt(&blockSize);
+        serializer->doInt(&numBlocks);
+        for (const auto& blockData : blocks)
+        {
+            int64_t blockSizeInBytes = blockData.size();
+            serializer->doInt64(&blockSizeInBytes);
+        }
+        // The blocks are written as one opaque, as they are read, since serializers
+        // such as XDR may pad each opaque
+        std::vector<char> data;
+        for (const auto& blockData : blocks)
+        {
+            data.insert(data.end(), blockData.begin(), blockData.end());
+        }
+        if (!data.empty())
+        {
+            serializer->doOpaque(data.data(), data.size());
+        }
+    }
+    else
+    {
+        const CompressedArrayHeader header    = readHeader(serializer);
+        const int                   numBlocks = header.blockSizesInBytes.size();
+        if (numBlocks != (numValues + header.blockSize - 1) / header.blockSize)
+        {
+            GMX_THROW(FileIOError(formatString(
+                    "Compressed coordinate array has %d blocks of %d vectors, which does not match "
+                    "the expected number of vectors %d",
+                    numBlocks, header.blockSize, numValues)));
+        }
+
+        std::vector<std::size_t> blockStart(numBlocks + 1, 0);
+        for (int block = 0; block < numBlocks; block++)
+        {
+            blockStart[block + 1] = blockStart[block] + header.blockSizesInBytes[block];
+        }
+        std::vector<char> data(blockStart[numBlocks]);
+        if (!data.empty())
+        {
+            serializer->doOpaque(data.data(), data.size());
+        }
+
+#pragma omp parallel for num_threads(numThreads) schedule(dynamic)
+        for (int block = 0; block < numBlocks; block++)
+        {
+            try
+            {
+                const ArrayRef<const char> blockData(data.data() + blockStart[block],
+                                                     data.data() + blockStart[block + 1]);
+                const ArrayRef<real> valuesOfBlock =
+                        blockValues(flatValues, block, header.blockSize);
+                if (header.valueSize == sizeof(float))
+                {
+                    decodeBlockToReal<float>(blockData, valuesOfBlock);
+                }
+                else
+                {
+                    decodeBlockToReal<double>(blockData, valuesOfBlock);
+                }
+            }
+            catch (...)
+            {
+                threadExceptions[gmx_omp_get_thread_num()] = std::current_exception();
+            }
+        }
+        rethrowFirstException(threadExceptions);
+    }
+}
+
+std::size_t readCompressedRvecArrayDataSize(ISerializer* serializer)
+{
+    const CompressedArrayHeader header = readHeader(serializer);
+    std::size_t                 size   = 0;
+    for (const int64_t blockSizeInBytes : header.blockSizesInBytes)
+    {
+        size += blockSizeInBytes;
+    }
+    return size;
+}
+
+} // namespace gmx
@@ -0,0 +1,91 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ * \brief
+ * Declares lossless block compression of rvec arrays for run input files.
+ *
+ * The values are split into blocks of a fixed number of rvecs that are
+ * compressed independently, so both compression and decompression are
+ * performed in parallel over blocks. Two encodings are used:
+ * - When all values in a block are exactly reproduced by a decimal
+ *   number with at most six decimals, as is the case for coordinates
+ *   read from gro and pdb files, the values are stored as scaled
+ *   integers, difference encoded with respect to the same dimension of
+ *   the previous vector, using a variable number of bytes.
+ * - Otherwise the bit patterns of the values are XOR-ed with the same
+ *   dimension of the previous vector and leading zero bytes are omitted.
+ *
+ * Both encodings reproduce the original bit patterns exactly.
+ *
+ * \inlibraryapi
+ * \ingroup module_fileio
+ */
+#ifndef GMX_FILEIO_COMPRESSEDRVECARRAY_H
+#define GMX_FILEIO_COMPRESSEDRVECARRAY_H
+
+#include <cstddef>
+
+#include "gromacs/math/vectypes.h"
+
+namespace gmx
+{
+class ISerializer;
+
+/*! \brief Serializes an rvec array in compressed form
+ *
+ * The precision of the values that are written is that of \c real.
+ * When reading, values that were written in other precision are
+ * converted to \c real.
+ *
+ * \param[in]     serializer  The serializer
+ * \param[in,out] values      The values, when reading \p numValues rvecs should be allocated
+ * \param[in]     numValues   The number of rvecs to serialize
+ *
+ * \throws FileIOError when reading data that is inconsistent with \p numValues or corrupted.
+ */
+void serializeCompressedRvecArray(ISerializer* serializer, rvec* values, int numValues);
+
+/*! \brief Reads the header of a compressed rvec array and returns the size of the data that follows
+ *
+ * This allows for skipping over compressed arrays without decompressing them.
+ *
+ * \param[in] serializer  Deserializer positioned at the start of a compressed rvec array
+ * \returns the number of bytes following the header that hold the compressed data
+ */
+std::size_t readCompressedRvecArrayDataSize(ISerializer* serializer);
+
+} // namespace gmx
+
+#endif
@@ -94,6 +94,7 @@ struct ener_file
     t_fileio*  fio;
     int        framenr;
     real       frametime;
+    gmx_bool   bDouble; /* Are the energies stored in double precision? */
 };
 
 static void enxsubblock_init(t_enxsubblock* sb)
@@ -828,6 +829,7 @@ ener_file_t open_enx(const char* fn, const char* mode)
                  && (nre * 4 * static_cast<long int>(sizeof(float)) == fr->e_size))))
         {
             fprintf(stderr, "Opened %s as single precision energy file\n", fn);
+            ef->bDouble = FALSE;
             free_enxnms(nre, nms);
         }
         else
@@ -845,6 +847,7 @@ ener_file_t open_enx(const char* fn, const char* mode)
                   && (nre * 4 * static_cast<long int>(sizeof(double)) == fr->e_size))))
             {
                 fprintf(stderr, "Opened %s as double precision energy file\n", fn);
+                ef->bDouble = TRUE;
             }
             else
             {
@@ -1131,6 +1134,211 @@ gmx_bool do_enx(ener_file_t ef, t_enxframe* fr)
     return TRUE;
 }
 
+/*! \brief Returns the size in the file of the data in \p sub, -1 when it depends on the data */
+static gmx_off_t enxsubblock_file_size(const t_enxsubblock& sub)
+{
+    switch (sub.type)
+    {
+        case xdr_datatype_float:
+        case xdr_datatype_int: return 4 * static_cast<gmx_off_t>(sub.nr);
+        case xdr_datatype_double:
+        case xdr_datatype_int64: return 8 * static_cast<gmx_off_t>(sub.nr);
+        default: return -1;
+    }
+}
+
+gmx_bool build_enx_frame_index(ener_file_t ef, t_enxframeindex* index)
+{
+    if (ef->eo.bOldFileOpen)
+    {
+        return FALSE;
+    }
+
+    const gmx_off_t start = gmx_fio_ftell(ef->fio);
+    FILE*           fp    = gmx_fio_getfp(ef->fio);
+    if (gmx_fseek(fp, 0, SEEK_END) != 0)
+    {
+        gmx_file(gmx_fio_getname(ef->fio));
+    }
+    const gmx_off_t fileSize = gmx_ftell(fp);
+    gmx_fio_seek(ef->fio, start);
+
+    const gmx_off_t realSize = ef->bDouble ? sizeof(double) : sizeof(float);
+
+    *index         = t_enxframeindex();
+    index->bDouble = ef->bDouble;
+
+    t_enxframe fr;
+    init_enxframe(&fr);
+    int      file_version = -1;
+    gmx_bool bOK          = TRUE;
+    while (do_eheader(ef, &file_version, &fr, -1, nullptr, &bOK))
+    {
+        if (file_version == 1)
+        {
+            /* Old style frames store full simulation sums, which need sequential reading */
+            free_enxframe(&fr);
+            *index = t_enxframeindex();
+            gmx_fio_seek(ef->fio, start);
+            return FALSE;
+        }
+
+        const gmx_off_t offset = gmx_fio_ftell(ef->fio);
+        /* Sums are only stored with more than one term */
+        gmx_off_t pos = offset + fr.nre * (fr.nsum > 0 ? 3 : 1) * realSize;
+
+        /* Skip the block data, only data with variable size is read */
+        for (int b = 0; b < fr.nblock && bOK; b++)
+        {
+            for (int i = 0; i < fr.block[b].nsub && bOK; i++)
+            {
+                t_enxsubblock*  sub  = &(fr.block[b].sub[i]);
+                const gmx_off_t size = enxsubblock_file_size(*sub);
+                if (size >= 0)
+                {
+                    pos += size;
+                    continue;
+                }
+                gmx_fio_seek(ef->fio, pos);
+                enxsubblock_alloc(sub);
+                switch (sub->type)
+                {
+                    case xdr_datatype_char:
+                        bOK = gmx_fio_ndo_uchar(ef->fio, sub->cval, sub->nr);
+                        break;
+                    case xdr_datatype_string:
+                        bOK = gmx_fio_ndo_string(ef->fio, sub->sval, sub->nr);
+                        break;
+                    default:
+                        gmx_incons(
+                                "Reading unknown block data type: this file is corrupted or from "
+                                "the future");
+                }
+                pos = gmx_fio_ftell(ef->fio);
+            }
+        }
+        if (!bOK || pos > fileSize)
+        {
+            bOK = FALSE;
+            break;
+        }
+
+        index->offset.push_back(offset);
+        index->t.push_back(fr.t);
+        index->step.push_back(fr.step);
+        index->nsteps.push_back(fr.nsteps);
+        index->nsum.push_back(fr.nsum);
+        index->nre.push_back(fr.nre);
+
+        if ((ef->framenr < 20 || ef->framenr % 10 == 0) && (ef->framenr < 200 || ef->framenr % 100 == 0)
+            && (ef->framenr < 2000 || ef->framenr % 1000 == 0))
+        {
+            fprintf(stderr, "\rIndexing energy frame %6d time %8.3f         ", ef->framenr, fr.t);
+        }
+        ef->framenr++;
+        ef->frametime = fr.t;
+
+        gmx_fio_seek(ef->fio, pos);
+    }
+    fprintf(stderr, "\rLast energy frame read %d time %8.3f         ", ef->framenr - 1, ef->frametime);
+    if (!bOK)
+    {
+        fprintf(stderr, "\nWARNING: Incomplete energy frame: nr %d time %8.3f\n", ef->framenr, fr.t);
+    }
+    fflush(stderr);
+    free_enxframe(&fr);
+
+    return TRUE;
+}
+
+/*! \brief Decodes a real with XDR (big endian) encoding */
+static real xdr_real_from_bytes(const unsigned char* data, gmx_bool bDouble)
+{
+    if (bDouble)
+    {
+        uint64_t bits = 0;
+        for (int i = 0; i < 8; i++)
+        {
+            bits = (bits << 8) | data[i];
+        }
+        double d;
+        std::memcpy(&d, &bits, sizeof(d));
+        return d;
+    }
+    else
+    {
+        uint32_t bits = 0;
+        for (int i = 0; i < 4; i++)
+        {
+            bits = (bits << 8) | data[i];
+        }
+        float f;
+        std::memcpy(&f, &bits, sizeof(f));
+        return f;
+    }
+}
+
+void read_enx_columns(ener_file_t              ef,
+                      const t_enxframeindex&   index,
+                      gmx::ArrayRef<const int> frames,
+                      gmx::ArrayRef<const int> terms,
+                      gmx_bool                 bSums,
+                      t_enxcolumns*            columns)
+{
+    const int numFrames = frames.ssize();
+    columns->e.assign(terms.size(), std::vector<real>(numFrames, 0));
+    columns->eav.assign(bSums ? terms.size() : 0, std::vector<real>(numFrames, 0));
+    columns->esum.assign(bSums ? terms.size() : 0, std::vector<real>(numFrames, 0));
+    if (terms.empty())
+    {
+        return;
+    }
+
+    const int realSize = index.bDouble ? sizeof(double) : sizeof(float);
+    const int minTerm  = *std::min_element(terms.begin(), terms.end());
+    const int maxTerm  = *std::max_element(terms.begin(), terms.end());
+    GMX_RELEASE_ASSERT(minTerm >= 0, "Energy terms should be non-negative");
+
+    FILE*                      fp = gmx_fio_getfp(ef->fio);
+    std::vector<unsigned char> buffer;
+    for (int k = 0; k < numFrames; k++)
+    {
+        const int f = frames[k];
+        GMX_RELEASE_ASSERT(f >= 0 && f < gmx::ssize(index.offset), "Frames should be in the index");
+        if (index.nre[f] == 0)
+        {
+            continue;
+        }
+        if (maxTerm >= index.nre[f])
+        {
+            gmx_fatal(FARGS, "Energy term %d was requested, but frame %d of %s has only %d terms",
+                      maxTerm, f, gmx_fio_getname(ef->fio), index.nre[f]);
+        }
+        /* Read the range of values from the first to the last requested term at once */
+        const int stride    = (index.nsum[f] > 0 ? 3 : 1);
+        const int numValues = (maxTerm - minTerm) * stride + (bSums ? stride : 1);
+        buffer.resize(static_cast<size_t>(numValues) * realSize);
+        const gmx_off_t offset = index.offset[f] + static_cast<gmx_off_t>(minTerm) * stride * realSize;
+        gmx_fio_seek(ef->fio, offset);
+        if (fread(buffer.data(), realSize, numValues, fp) != static_cast<size_t>(numValues))
+        {
+            gmx_fatal(FARGS, "Could not read energy frame %d of %s", f, gmx_fio_getname(ef->fio));
+        }
+
+        for (int c = 0; c < gmx::ssize(terms); c++)
+        {
+            const unsigned char* data = buffer.data() + (terms[c] - minTerm) * stride * realSize;
+
+            columns->e[c][k] = xdr_real_from_bytes(data, index.bDouble);
+            if (bSums && stride == 3)
+            {
+                columns->eav[c][k] = xdr_real_from_bytes(data + realSize, index.bDouble);
+                columns->esum[c][k] = xdr_real_from_bytes(data + 2 * realSize, index.bDouble);
+            }
+        }
+    }
+}
+
 static real find_energy(const char* name, int nre, gmx_enxnm_t* enm, t_enxframe* fr)
 {
     int i;
@@ -38,8 +38,14 @@
 #ifndef GMX_FILEIO_ENXIO_H
 #define GMX_FILEIO_ENXIO_H
 
+#include <cstdint>
+
+#include <vector>
+
 #include "gromacs/fileio/xdr_datatype.h"
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/basedefinitions.h"
+#include "gromacs/utility/futil.h"
 #include "gromacs/utility/real.h"
 
 struct SimulationGroups;
@@ -178,6 +184,68 @@ void free_enxnms(int n, gmx_enxnm_t* nms);
 gmx_bool do_enx(ener_file_t ef, t_enxframe* fr);
 /* Reads enx_frames, memory in fr is (re)allocated if necessary */
 
+/*! \brief Index of the frames in an energy file, for random access to energy terms
+ *
+ * All per-frame data is stored in contiguous arrays, entry f describes frame f.
+ */
+struct t_enxframeindex
+{
+    //! Whether the energies in the file are stored in double precision
+    gmx_bool bDouble = FALSE;
+    //! File offset of the energy terms of each frame
+    std::vector<gmx_off_t> offset;
+    //! Time of each frame
+    std::vector<double> t;
+    //! MD step of each frame
+    std::vector<int64_t> step;
+    //! The number of steps since the previous frame
+    std::vector<int64_t> nsteps;
+    //! The number of terms in the energy sums
+    std::vector<int> nsum;
+    //! Number of energy terms, can be 0 for frames with only blocks
+    std::vector<int> nre;
+};
+
+/*! \brief Energy term columns read by read_enx_columns()
+ *
+ * Column c holds the values of the c-th requested term for all read frames.
+ * \p eav and \p esum are only filled when requested; they are zero for
+ * frames without sums.
+ */
+struct t_enxcolumns
+{
+    //! Instantaneous values
+    std::vector<std::vector<real>> e;
+    //! Sums of squared fluctuations over the steps since the previous frame
+    std::vector<std::vector<real>> eav;
+    //! Sums over the steps since the previous frame
+    std::vector<std::vector<real>> esum;
+};
+
+/*! \brief Builds the frame index of an energy file opened for reading
+ *
+ * Reads from the current position, i.e. after do_enxnms(), to the end of
+ * the file. Only the frame headers are decoded, the energy terms and
+ * the block data are skipped.
+ *
+ * \returns FALSE when the file is in the pre-4.1 format, which does not support
+ * random access; do_enx() should then be used instead.
+ */
+gmx_bool build_enx_frame_index(ener_file_t ef, t_enxframeindex* index);
+
+/*! \brief Reads energy terms \p terms of the frames with indices \p frames in \p index
+ *
+ * Only the requested terms are decoded. The sums are only read when
+ * \p bSums is TRUE. Terms of frames without energies are set to zero.
+ * The file position is undefined after this call.
+ */
+void read_enx_columns(ener_file_t              ef,
+                      const t_enxframeindex&   index,
+                      gmx::ArrayRef<const int> frames,
+                      gmx::ArrayRef<const int> terms,
+                      gmx_bool                 bSums,
+                      t_enxcolumns*            columns);
+
 void get_enx_state(const char* fn, real t, const SimulationGroups& groups, t_inputrec* ir, t_state* state);
 /*
  * Reads state variables from enx file fn at time t.
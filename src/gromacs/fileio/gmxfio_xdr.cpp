@@ -750,7 +750,28 @@ gmx_bool gmx_fio_ndoe_string(t_fileio* fio, char* item[], int n, const char* des
     gmx_fio_lock(fio);
     for (i = 0; i < n; i++)
     {
-        ret = ret && do_xdr(fio, &(item[i]), 1, eioSTRING, desc, srcfile, line);
+        if (fio->bRead)
+        {
+            /* do_xdr can only read into a buffer of known size, so we read
+             * the length here and (re)allocate item[i] to fit the string.
+             */
+            int slen = 0;
+            ret      = ret && (xdr_int(fio->xdr, &slen) > 0);
+            if (ret && slen > 0)
+            {
+                srenew(item[i], slen);
+                ret = (xdr_string(fio->xdr, &(item[i]), slen) > 0);
+            }
+            else if (ret)
+            {
+                sfree(item[i]);
+                item[i] = nullptr;
+            }
+        }
+        else
+        {
+            ret = ret && do_xdr(fio, item[i], 1, eioSTRING, desc, srcfile, line);
+        }
     }
     gmx_fio_unlock(fio);
     return ret;
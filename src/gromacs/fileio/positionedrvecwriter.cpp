@@ -0,0 +1,181 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements gmx::PositionedRvecWriter.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "positionedrvecwriter.h"
+
+#include "config.h"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include <algorithm>
+#include <numeric>
+#include <type_traits>
+
+#if defined(HAVE_UNISTD_H) && !defined(__MINGW32__)
+#    include <fcntl.h>
+#    include <unistd.h>
+#endif
+
+#include "gromacs/utility/fatalerror.h"
+#include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/stringutil.h"
+
+namespace gmx
+{
+
+namespace
+{
+
+//! The unsigned integer type with the size of real
+using RealBits = std::conditional_t<sizeof(real) == sizeof(uint64_t), uint64_t, uint32_t>;
+
+//! Stores \p value at \p data in big-endian byte order, as XDR does
+void encodeXdrReal(real value, unsigned char* data)
+{
+    RealBits bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    for (int b = sizeof(bits) - 1; b >= 0; b--)
+    {
+        data[b] = static_cast<unsigned char>(bits & 0xff);
+        bits >>= 8;
+    }
+}
+
+} // namespace
+
+bool PositionedRvecWriter::isSupported()
+{
+#if defined(HAVE_UNISTD_H) && !defined(__MINGW32__)
+    return true;
+#else
+    return false;
+#endif
+}
+
+PositionedRvecWriter::PositionedRvecWriter(const std::string& fileName) :
+    fileName_(fileName),
+    fileDescriptor_(-1)
+{
+    GMX_RELEASE_ASSERT(isSupported(), "Positioned writes should be supported");
+#if defined(HAVE_UNISTD_H) && !defined(__MINGW32__)
+    fileDescriptor_ = open(fileName.c_str(), O_WRONLY);
+#endif
+    if (fileDescriptor_ < 0)
+    {
+        gmx_fatal(FARGS, "Could not open file '%s' for positioned writing: %s", fileName.c_str(),
+                  std::strerror(errno));
+    }
+}
+
+PositionedRvecWriter::~PositionedRvecWriter()
+{
+#if defined(HAVE_UNISTD_H) && !defined(__MINGW32__)
+    close(fileDescriptor_);
+#endif
+}
+
+void PositionedRvecWriter::write(gmx_off_t            arrayOffset,
+                                 ArrayRef<const int>  indices,
+                                 ArrayRef<const RVec> values)
+{
+    GMX_RELEASE_ASSERT(indices.size() == values.size(), "We need as many indices as values");
+
+    constexpr size_t c_rvecSize = DIM * sizeof(real);
+
+    /* Write in order of increasing index, so consecutive indices,
+     * which are common with domain decomposition, end up in one write.
+     */
+    order_.resize(indices.size());
+    std::iota(order_.begin(), order_.end(), 0);
+    std::sort(order_.begin(), order_.end(),
+              [indices](int a, int b) { return indices[a] < indices[b]; });
+
+    buffer_.resize(indices.size() * c_rvecSize);
+    for (size_t i = 0; i < order_.size(); i++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            encodeXdrReal(values[order_[i]][d], buffer_.data() + i * c_rvecSize + d * sizeof(real));
+        }
+    }
+
+    size_t runStart = 0;
+    while (runStart < order_.size())
+    {
+        size_t runEnd = runStart + 1;
+        while (runEnd < order_.size() && indices[order_[runEnd]] == indices[order_[runEnd - 1]] + 1)
+        {
+            runEnd++;
+        }
+
+        const unsigned char* data         = buffer_.data() + runStart * c_rvecSize;
+        size_t               numBytesLeft = (runEnd - runStart) * c_rvecSize;
+        gmx_off_t            offset =
+                arrayOffset + indices[order_[runStart]] * static_cast<gmx_off_t>(c_rvecSize);
+        while (numBytesLeft > 0)
+        {
+            std::ptrdiff_t numBytesWritten = -1;
+#if defined(HAVE_UNISTD_H) && !defined(__MINGW32__)
+            numBytesWritten = pwrite(fileDescriptor_, data, numBytesLeft, offset);
+#endif
+            if (numBytesWritten < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (numBytesWritten <= 0)
+            {
+                gmx_file(formatString("Cannot write to file '%s'; maybe you are out of disk space?",
+                                      fileName_.c_str()));
+            }
+            data += numBytesWritten;
+            numBytesLeft -= numBytesWritten;
+            offset += numBytesWritten;
+        }
+
+        runStart = runEnd;
+    }
+}
+
+} // namespace gmx
@@ -0,0 +1,112 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ * \brief
+ * Declares a writer for scattered rvec data at fixed positions in a file.
+ *
+ * This enables ranks that each own a subset of the atoms to store
+ * their part of an XDR encoded rvec array, such as the coordinate
+ * array of a trajectory frame, directly in a shared file, without
+ * first collecting all values on a single rank.
+ *
+ * \inlibraryapi
+ * \ingroup module_fileio
+ */
+#ifndef GMX_FILEIO_POSITIONEDRVECWRITER_H
+#define GMX_FILEIO_POSITIONEDRVECWRITER_H
+
+#include <string>
+#include <vector>
+
+#include "gromacs/math/vectypes.h"
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/classhelpers.h"
+#include "gromacs/utility/futil.h"
+
+namespace gmx
+{
+
+/*! \libinternal
+ * \brief Writes subsets of rvec arrays in XDR format at given positions in an existing file
+ *
+ * Multiple writers, possibly on different ranks, can open the same file
+ * and write disjoint sets of elements of the same array concurrently.
+ * The writer does not change the file size beyond the data written and
+ * never moves the file position of other handles to the file.
+ * Synchronization between writers and with other handles is
+ * the responsibility of the caller.
+ */
+class PositionedRvecWriter
+{
+public:
+    //! Returns whether positioned writes are supported on this platform
+    static bool isSupported();
+
+    /*! \brief Opens existing file \p fileName for writing
+     *
+     * Should only be called when isSupported() returns true.
+     */
+    explicit PositionedRvecWriter(const std::string& fileName);
+
+    ~PositionedRvecWriter();
+
+    /*! \brief Writes \p values at positions \p indices in an array starting at \p arrayOffset
+     *
+     * Element \p indices[i] of the array, with the array stored in the same
+     * format as gmx_fio_ndo_rvec() uses, is set to \p values[i].
+     * Consecutive indices are combined into single write calls.
+     *
+     * \param[in] arrayOffset  The offset in bytes in the file of the first element of the array
+     * \param[in] indices      The array indices of the values, should be unique
+     * \param[in] values       The values to write
+     */
+    void write(gmx_off_t arrayOffset, ArrayRef<const int> indices, ArrayRef<const RVec> values);
+
+private:
+    //! The name of the file, used for error messages
+    std::string fileName_;
+    //! The file descriptor
+    int fileDescriptor_;
+    //! Buffer for the order of the values sorted on index
+    std::vector<int> order_;
+    //! Buffer for the encoded values
+    std::vector<unsigned char> buffer_;
+
+    GMX_DISALLOW_COPY_AND_ASSIGN(PositionedRvecWriter);
+};
+
+} // namespace gmx
+
+#endif
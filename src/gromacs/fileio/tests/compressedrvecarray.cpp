@@ -0,0 +1,234 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for compressed serialization of rvec arrays.
+ *
+ * \ingroup module_fileio
+ */
+
+#include "gmxpre.h"
+
+#include "gromacs/fileio/compressedrvecarray.h"
+
+#include <cmath>
+#include <cstring>
+
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fileio/gmxfio.h"
+#include "gromacs/fileio/gmxfio_xdr.h"
+#include "gromacs/math/vectypes.h"
+#include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/inmemoryserializer.h"
+
+#include "testutils/testfilemanager.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Serializes \p values and returns the serialized buffer
+std::vector<char> serializeValues(std::vector<RVec> values)
+{
+    InMemorySerializer serializer;
+    serializeCompressedRvecArray(&serializer, as_rvec_array(values.data()), values.size());
+    return serializer.finishAndGetBuffer();
+}
+
+//! Deserializes \p numValues rvecs from \p buffer
+std::vector<RVec> deserializeValues(const std::vector<char>& buffer, int numValues)
+{
+    std::vector<RVec>    values(numValues);
+    InMemoryDeserializer deserializer(buffer, std::is_same<real, double>::value);
+    serializeCompressedRvecArray(&deserializer, as_rvec_array(values.data()), numValues);
+    return values;
+}
+
+//! Checks that \p values survive a round trip bit for bit and returns the serialized size
+std::size_t checkRoundTrip(const std::vector<RVec>& values)
+{
+    const std::vector<char> buffer       = serializeValues(values);
+    const std::vector<RVec> deserialized = deserializeValues(buffer, values.size());
+    EXPECT_EQ(0, std::memcmp(values.data(), deserialized.data(), values.size() * sizeof(values[0])));
+    return buffer.size();
+}
+
+//! Returns the size of \p values when stored uncompressed
+std::size_t uncompressedSize(const std::vector<RVec>& values)
+{
+    return values.size() * sizeof(values[0]);
+}
+
+TEST(CompressedRvecArrayTest, RoundTripsDecimalValuesCompactly)
+{
+    // Coordinates with three decimals as read from a gro file, spanning multiple blocks
+    std::mt19937                       rng(1234);
+    std::uniform_int_distribution<int> distribution(0, 9999);
+    std::vector<RVec>                  values(40000);
+    for (RVec& value : values)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            value[d] = static_cast<real>(distribution(rng) * 0.001);
+        }
+    }
+    EXPECT_LT(checkRoundTrip(values), uncompressedSize(values) * 3 / 4);
+}
+
+TEST(CompressedRvecArrayTest, RoundTripsArbitraryValues)
+{
+    std::mt19937                         rng(4321);
+    std::uniform_real_distribution<real> distribution(-10, 10);
+    std::vector<RVec>                    values(20000);
+    for (RVec& value : values)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            value[d] = distribution(rng);
+        }
+    }
+    checkRoundTrip(values);
+}
+
+TEST(CompressedRvecArrayTest, RoundTripsSpecialValues)
+{
+    const real        inf    = std::numeric_limits<real>::infinity();
+    std::vector<RVec> values = { { 0.0, -0.0, 1.5 },
+                                 { inf, -inf, std::numeric_limits<real>::quiet_NaN() },
+                                 { std::numeric_limits<real>::denorm_min(),
+                                   std::numeric_limits<real>::max(),
+                                   std::numeric_limits<real>::lowest() },
+                                 { 1e20, -1e-20, 0.123 } };
+    checkRoundTrip(values);
+}
+
+TEST(CompressedRvecArrayTest, RoundTripsEmptyArray)
+{
+    EXPECT_EQ(0, deserializeValues(serializeValues({}), 0).size());
+}
+
+TEST(CompressedRvecArrayTest, DataSizeAllowsSkipping)
+{
+    const int          marker = 42;
+    std::vector<RVec>  values = { { 1.0, 2.0, 3.0 }, { 0.1, 0.2, 0.3 } };
+    InMemorySerializer serializer;
+    serializeCompressedRvecArray(&serializer, as_rvec_array(values.data()), values.size());
+    int markerToWrite = marker;
+    serializer.doInt(&markerToWrite);
+    const std::vector<char> buffer = serializer.finishAndGetBuffer();
+
+    InMemoryDeserializer deserializer(buffer, std::is_same<real, double>::value);
+    std::vector<char>    data(readCompressedRvecArrayDataSize(&deserializer));
+    deserializer.doOpaque(data.data(), data.size());
+    int markerRead = 0;
+    deserializer.doInt(&markerRead);
+    EXPECT_EQ(marker, markerRead);
+}
+
+TEST(CompressedRvecArrayTest, ThrowsOnMismatchingNumberOfValues)
+{
+    const std::vector<char> buffer = serializeValues(std::vector<RVec>(10, { 1.0, 2.0, 3.0 }));
+    EXPECT_THROW(deserializeValues(buffer, 0), FileIOError);
+}
+
+TEST(CompressedRvecArrayTest, ThrowsOnCorruptedBlock)
+{
+    // Two blocks, so the exception is thrown inside the threaded decoding
+    std::vector<char> buffer = serializeValues(std::vector<RVec>(20000, { 1.0, 2.0, 3.0 }));
+    InMemoryDeserializer deserializer(buffer, std::is_same<real, double>::value);
+    int                  valueSize, blockSize, numBlocks;
+    deserializer.doInt(&valueSize);
+    deserializer.doInt(&blockSize);
+    deserializer.doInt(&numBlocks);
+    ASSERT_EQ(2, numBlocks);
+    std::vector<int64_t> blockSizesInBytes(numBlocks);
+    deserializer.doInt64Array(blockSizesInBytes.data(), numBlocks);
+    const std::size_t secondBlockOffset = deserializer.position() + blockSizesInBytes[0];
+    // Overwrite the encoding byte of the second block with an invalid value
+    buffer[secondBlockOffset] = 0x7f;
+    EXPECT_THROW(deserializeValues(buffer, 20000), FileIOError);
+}
+
+TEST(CompressedRvecArrayTest, RoundTripsThroughXdrFile)
+{
+    // XDR pads opaque data, so this checks that blocks of sizes that are
+    // not a multiple of four are written and read consistently
+    std::mt19937                         rng(1234);
+    std::uniform_real_distribution<real> distribution(-10, 10);
+    std::vector<RVec>                    values(20001);
+    for (RVec& value : values)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            value[d] = distribution(rng);
+        }
+    }
+    const int       marker = 42;
+    TestFileManager fileManager;
+    // Use an extension that gmx_fio_open opens as binary XDR
+    const std::string fileName = fileManager.getTemporaryFilePath("values.edr");
+    {
+        t_fileio*           file = gmx_fio_open(fileName.c_str(), "w");
+        FileIOXdrSerializer serializer(file);
+        serializeCompressedRvecArray(&serializer, as_rvec_array(values.data()), values.size());
+        int markerToWrite = marker;
+        serializer.doInt(&markerToWrite);
+        gmx_fio_close(file);
+    }
+    std::vector<RVec> valuesRead(values.size());
+    int               markerRead = 0;
+    {
+        t_fileio*           file = gmx_fio_open(fileName.c_str(), "r");
+        FileIOXdrSerializer serializer(file);
+        serializeCompressedRvecArray(&serializer, as_rvec_array(valuesRead.data()),
+                                     valuesRead.size());
+        serializer.doInt(&markerRead);
+        gmx_fio_close(file);
+    }
+    EXPECT_EQ(0, std::memcmp(values.data(), valuesRead.data(), values.size() * sizeof(values[0])));
+    EXPECT_EQ(marker, markerRead);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -0,0 +1,240 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements tests for random access reading of energy files
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fileio/enxio.h"
+#include "gromacs/trajectory/energyframe.h"
+#include "gromacs/utility/smalloc.h"
+
+#include "testutils/testasserts.h"
+#include "testutils/testfilemanager.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Number of energy terms in the test file
+const int c_numTerms = 5;
+//! Number of frames in the test file
+const int c_numFrames = 6;
+//! The strings stored in a block of the odd frames in the test file
+const std::array<const char*, 2> c_blockStrings = { "a string", "a longer string" };
+
+//! Writes an energy file with frames with and without sums, blocks and energies
+void writeTestEnergyFile(const std::string& filename)
+{
+    ener_file_t ef = open_enx(filename.c_str(), "w");
+
+    std::vector<std::string> names(c_numTerms);
+    gmx_enxnm_t*             nms;
+    snew(nms, c_numTerms);
+    for (int i = 0; i < c_numTerms; i++)
+    {
+        names[i]    = "Term " + std::to_string(i);
+        nms[i].name = const_cast<char*>(names[i].c_str());
+        nms[i].unit = const_cast<char*>("kJ/mol");
+    }
+    int nre = c_numTerms;
+    do_enxnms(ef, &nre, &nms);
+    sfree(nms);
+
+    // The block data is owned here, the frame only points to it
+    std::vector<float>         blockValues = { 1.5, 2.5, 3.5 };
+    std::vector<unsigned char> blockChars  = { 'x', 'y', 'z', 'w' };
+    std::vector<std::string>   blockStrings(c_blockStrings.begin(), c_blockStrings.end());
+    std::vector<char*>         blockStringPointers;
+    for (auto& string : blockStrings)
+    {
+        blockStringPointers.push_back(&string[0]);
+    }
+
+    t_enxframe fr;
+    init_enxframe(&fr);
+    snew(fr.ener, c_numTerms);
+    fr.e_alloc = c_numTerms;
+    for (int f = 0; f < c_numFrames; f++)
+    {
+        fr.t      = 0.5 * f;
+        fr.step   = 10 * f;
+        fr.nsteps = (f == 0 ? 1 : 10);
+        fr.nsum   = (f == 0 ? 1 : 10);
+        // Frame 3 only contains blocks
+        fr.nre = (f == 3 ? 0 : c_numTerms);
+        for (int i = 0; i < c_numTerms; i++)
+        {
+            fr.ener[i].e    = 100 * f + i;
+            fr.ener[i].eav  = 0.25 * (f + i);
+            fr.ener[i].esum = 10 * fr.ener[i].e;
+        }
+        fr.nblock = 0;
+        if (f % 2 == 1)
+        {
+            add_blocks_enxframe(&fr, 1);
+            add_subblocks_enxblock(&fr.block[0], 3);
+            fr.block[0].id          = enxAWH;
+            fr.block[0].sub[0].nr   = blockValues.size();
+            fr.block[0].sub[0].type = xdr_datatype_float;
+            fr.block[0].sub[0].fval = blockValues.data();
+            fr.block[0].sub[1].nr   = blockStringPointers.size();
+            fr.block[0].sub[1].type = xdr_datatype_string;
+            fr.block[0].sub[1].sval = blockStringPointers.data();
+            fr.block[0].sub[2].nr   = blockChars.size();
+            fr.block[0].sub[2].type = xdr_datatype_char;
+            fr.block[0].sub[2].cval = blockChars.data();
+        }
+        do_enx(ef, &fr);
+    }
+    fr.nblock = 0;
+    free_enxframe(&fr);
+    done_ener_file(ef);
+}
+
+TEST(EnergyFrameIndexTest, ReadsColumnsIdenticalToSequentialReading)
+{
+    TestFileManager   fileManager;
+    const std::string filename = fileManager.getTemporaryFilePath("columns.edr");
+    writeTestEnergyFile(filename);
+
+    // Read all frames sequentially as reference
+    std::vector<t_enxframe> frames;
+    {
+        ener_file_t  ef  = open_enx(filename.c_str(), "r");
+        int          nre = 0;
+        gmx_enxnm_t* nms = nullptr;
+        do_enxnms(ef, &nre, &nms);
+        t_enxframe fr;
+        init_enxframe(&fr);
+        while (do_enx(ef, &fr))
+        {
+            // Check that the variable size block data is read back correctly
+            if (fr.nblock > 0)
+            {
+                ASSERT_EQ(3, fr.block[0].nsub);
+                const t_enxsubblock& strings = fr.block[0].sub[1];
+                ASSERT_EQ(xdr_datatype_string, strings.type);
+                ASSERT_EQ(gmx::ssize(c_blockStrings), strings.nr);
+                for (int i = 0; i < strings.nr; i++)
+                {
+                    EXPECT_STREQ(c_blockStrings[i], strings.sval[i]);
+                }
+                const t_enxsubblock& chars = fr.block[0].sub[2];
+                ASSERT_EQ(xdr_datatype_char, chars.type);
+                ASSERT_EQ(4, chars.nr);
+                EXPECT_EQ('x', chars.cval[0]);
+                EXPECT_EQ('w', chars.cval[3]);
+            }
+            t_enxframe copy = fr;
+            snew(copy.ener, c_numTerms);
+            for (int i = 0; i < fr.nre; i++)
+            {
+                copy.ener[i] = fr.ener[i];
+            }
+            copy.nblock = 0;
+            copy.block  = nullptr;
+            frames.push_back(copy);
+        }
+        free_enxframe(&fr);
+        free_enxnms(nre, nms);
+        done_ener_file(ef);
+    }
+    ASSERT_EQ(c_numFrames, gmx::ssize(frames));
+
+    ener_file_t  ef  = open_enx(filename.c_str(), "r");
+    int          nre = 0;
+    gmx_enxnm_t* nms = nullptr;
+    do_enxnms(ef, &nre, &nms);
+    t_enxframeindex index;
+    ASSERT_TRUE(build_enx_frame_index(ef, &index));
+    ASSERT_EQ(c_numFrames, gmx::ssize(index.t));
+
+    // Read the frames in reverse order to check random access
+    const std::vector<int> frameSelection = { 5, 4, 3, 2, 1, 0 };
+    const std::vector<int> terms          = { 3, 1 };
+    t_enxcolumns           columns;
+    read_enx_columns(ef, index, frameSelection, terms, TRUE, &columns);
+    ASSERT_EQ(terms.size(), columns.e.size());
+
+    for (size_t k = 0; k < frameSelection.size(); k++)
+    {
+        const t_enxframe& ref = frames[frameSelection[k]];
+        SCOPED_TRACE("Frame " + std::to_string(frameSelection[k]));
+        EXPECT_EQ(ref.t, index.t[frameSelection[k]]);
+        EXPECT_EQ(ref.step, index.step[frameSelection[k]]);
+        EXPECT_EQ(ref.nsteps, index.nsteps[frameSelection[k]]);
+        EXPECT_EQ(ref.nsum, index.nsum[frameSelection[k]]);
+        EXPECT_EQ(ref.nre, index.nre[frameSelection[k]]);
+        for (size_t c = 0; c < terms.size(); c++)
+        {
+            const real refE = (ref.nre > 0 ? ref.ener[terms[c]].e : 0);
+            EXPECT_REAL_EQ_TOL(refE, columns.e[c][k], defaultRealTolerance());
+            if (ref.nre > 0 && ref.nsum > 0)
+            {
+                EXPECT_REAL_EQ_TOL(ref.ener[terms[c]].eav, columns.eav[c][k], defaultRealTolerance());
+                EXPECT_REAL_EQ_TOL(ref.ener[terms[c]].esum, columns.esum[c][k], defaultRealTolerance());
+            }
+            else
+            {
+                EXPECT_EQ(0, columns.eav[c][k]);
+                EXPECT_EQ(0, columns.esum[c][k]);
+            }
+        }
+    }
+
+    for (auto& fr : frames)
+    {
+        sfree(fr.ener);
+    }
+    free_enxnms(nre, nms);
+    done_ener_file(ef);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
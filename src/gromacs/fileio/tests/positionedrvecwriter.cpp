@@ -0,0 +1,192 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for writing rvec data at given positions in a trajectory file.
+ *
+ * \ingroup module_fileio
+ */
+
+#include "gmxpre.h"
+
+#include "gromacs/fileio/positionedrvecwriter.h"
+
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/fileio/gmxfio.h"
+#include "gromacs/fileio/trrio.h"
+#include "gromacs/math/vectypes.h"
+
+#include "testutils/testasserts.h"
+#include "testutils/testfilemanager.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Returns the contents of file \p fileName
+std::vector<char> readFileContents(const std::string& fileName)
+{
+    std::ifstream stream(fileName, std::ios::binary);
+    return { std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>() };
+}
+
+class PositionedRvecWriterTest : public ::testing::Test
+{
+public:
+    PositionedRvecWriterTest() : x_(c_numAtoms), v_(c_numAtoms)
+    {
+        for (int i = 0; i < c_numAtoms; i++)
+        {
+            x_[i] = { 0.1_real * i, -0.25_real * i, 1.0_real / (i + 1) };
+            v_[i] = { -1.5_real * i, 3.0_real, 0.001_real * i * i };
+        }
+    }
+
+    //! Writes a frame to \p fileName with each value written by one of two interleaved writers
+    void writeFrameInParts(const std::string& fileName)
+    {
+        t_fileio*     fio = gmx_trr_open(fileName.c_str(), "w");
+        const int64_t offset =
+                gmx_trr_write_frame_header(fio, c_step, c_time, c_lambda, box_, c_numAtoms, TRUE,
+                                           TRUE, FALSE);
+        gmx_fio_flush(fio);
+
+        /* Let writer 0 own two blocks of consecutive atoms and writer 1 the rest,
+         * listed in reverse order to check that the writer sorts on index.
+         */
+        std::vector<int>  indices[2];
+        std::vector<RVec> x[2];
+        std::vector<RVec> v[2];
+        for (int i = c_numAtoms - 1; i >= 0; i--)
+        {
+            const int part = ((i / 3) % 2 == 0 ? 0 : 1);
+            indices[part].push_back(i);
+            x[part].push_back(x_[i]);
+            v[part].push_back(v_[i]);
+        }
+        for (int part = 0; part < 2; part++)
+        {
+            PositionedRvecWriter writer(fileName);
+            writer.write(offset, indices[part], x[part]);
+            writer.write(offset + c_numAtoms * sizeof(rvec), indices[part], v[part]);
+        }
+
+        gmx_trr_close(fio);
+    }
+
+    //! The number of atoms
+    static constexpr int c_numAtoms = 11;
+    //! The step
+    static constexpr int64_t c_step = 12;
+    //! The time
+    static constexpr real c_time = 0.024;
+    //! The lambda value
+    static constexpr real c_lambda = 0.5;
+    //! The box
+    matrix box_ = { { 2, 0, 0 }, { 0.5, 3, 0 }, { 0.25, 0.75, 4 } };
+    //! The coordinates
+    std::vector<RVec> x_;
+    //! The velocities
+    std::vector<RVec> v_;
+    //! Manages the temporary files
+    TestFileManager fileManager_;
+};
+
+TEST_F(PositionedRvecWriterTest, ProducesSameFileAsSerialWrite)
+{
+    if (!PositionedRvecWriter::isSupported())
+    {
+        return;
+    }
+
+    const std::string referenceFileName = fileManager_.getTemporaryFilePath("ref.trr");
+    const std::string testFileName      = fileManager_.getTemporaryFilePath("test.trr");
+
+    t_fileio* fio = gmx_trr_open(referenceFileName.c_str(), "w");
+    gmx_trr_write_frame(fio, c_step, c_time, c_lambda, box_, c_numAtoms, as_rvec_array(x_.data()),
+                        as_rvec_array(v_.data()), nullptr);
+    gmx_trr_close(fio);
+
+    writeFrameInParts(testFileName);
+
+    EXPECT_EQ(readFileContents(referenceFileName), readFileContents(testFileName));
+}
+
+TEST_F(PositionedRvecWriterTest, FrameCanBeReadBack)
+{
+    if (!PositionedRvecWriter::isSupported())
+    {
+        return;
+    }
+
+    const std::string fileName = fileManager_.getTemporaryFilePath("test.trr");
+    writeFrameInParts(fileName);
+
+    int64_t           step;
+    real              time;
+    real              lambda;
+    matrix            box;
+    int               numAtoms;
+    std::vector<RVec> x(c_numAtoms);
+    std::vector<RVec> v(c_numAtoms);
+    t_fileio*         fio = gmx_trr_open(fileName.c_str(), "r");
+    ASSERT_TRUE(gmx_trr_read_frame(fio, &step, &time, &lambda, box, &numAtoms,
+                                   as_rvec_array(x.data()), as_rvec_array(v.data()), nullptr));
+    gmx_trr_close(fio);
+
+    EXPECT_EQ(c_step, step);
+    EXPECT_EQ(c_numAtoms, numAtoms);
+    for (int i = 0; i < c_numAtoms; i++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            EXPECT_EQ(x_[i][d], x[i][d]);
+            EXPECT_EQ(v_[i][d], v[i][d]);
+        }
+    }
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
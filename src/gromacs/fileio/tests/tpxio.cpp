@@ -0,0 +1,153 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for on-demand reading of TPR files.
+ *
+ * \ingroup module_fileio
+ */
+#include "gmxpre.h"
+
+#include "gromacs/fileio/tpxio.h"
+
+#include <gtest/gtest.h>
+
+#include "gromacs/mdtypes/inputrec.h"
+#include "gromacs/mdtypes/state.h"
+#include "gromacs/topology/topology.h"
+
+#include "testutils/tprfilegenerator.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+class TprFileReaderTest : public ::testing::Test
+{
+public:
+    TprFileReaderTest() : tprHandle_("lysozyme")
+    {
+        read_tpx_state(tprHandle_.tprName().c_str(), &ir_, &state_, &mtop_);
+    }
+
+    //! Generates the TPR file
+    TprAndFileManager tprHandle_;
+    //! Reference input record from reading the whole file
+    t_inputrec ir_;
+    //! Reference state from reading the whole file
+    t_state state_;
+    //! Reference topology from reading the whole file
+    gmx_mtop_t mtop_;
+};
+
+TEST_F(TprFileReaderTest, ReadsSectionsInAnyOrder)
+{
+    TprFileReader reader(tprHandle_.tprName().c_str(), false);
+    EXPECT_EQ(reader.header().natoms, state_.natoms);
+
+    // The inputrec and coordinates are behind the topology, which has
+    // to be walked over when it has not been read yet.
+    t_inputrec    ir;
+    const PbcType pbcType = reader.readInputrec(&ir);
+    EXPECT_EQ(pbcType, ir_.pbcType);
+    EXPECT_EQ(ir.nsteps, ir_.nsteps);
+    EXPECT_EQ(ir.rlist, ir_.rlist);
+
+    std::vector<RVec> x(reader.header().natoms);
+    EXPECT_TRUE(reader.readCoordinates(as_rvec_array(x.data())));
+    for (int a = 0; a < state_.natoms; a++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            EXPECT_EQ(x[a][d], state_.x[a][d]);
+        }
+    }
+
+    // Absent sections are reported instead of being an error
+    std::vector<RVec> v(reader.header().natoms);
+    EXPECT_EQ(reader.header().bV, reader.readVelocities(as_rvec_array(v.data())));
+
+    gmx_mtop_t mtop;
+    reader.readTopology(&mtop);
+    EXPECT_EQ(mtop.natoms, mtop_.natoms);
+    ASSERT_EQ(mtop.moltype.size(), mtop_.moltype.size());
+    for (size_t mt = 0; mt < mtop.moltype.size(); mt++)
+    {
+        EXPECT_STREQ(*mtop.moltype[mt].name, *mtop_.moltype[mt].name);
+        EXPECT_EQ(mtop.moltype[mt].atoms.nr, mtop_.moltype[mt].atoms.nr);
+    }
+
+    matrix box;
+    reader.readBox(box);
+    for (int d = 0; d < DIM; d++)
+    {
+        for (int e = 0; e < DIM; e++)
+        {
+            EXPECT_EQ(box[d][e], state_.box[d][e]);
+        }
+    }
+}
+
+TEST_F(TprFileReaderTest, ReadTpxOnlyReadsRequestedParts)
+{
+    gmx_mtop_t mtop;
+    matrix     box;
+    int        natoms = 0;
+    PbcType    pbcType =
+            read_tpx(tprHandle_.tprName().c_str(), nullptr, box, &natoms, nullptr, nullptr, &mtop);
+    EXPECT_EQ(pbcType, ir_.pbcType);
+    EXPECT_EQ(natoms, mtop_.natoms);
+
+    t_state state;
+    read_tpx_state(tprHandle_.tprName().c_str(), nullptr, &state, nullptr);
+    TprFileReader reader(tprHandle_.tprName().c_str(), true);
+    t_state       lazyState;
+    reader.readState(&lazyState);
+    ASSERT_EQ(lazyState.natoms, state.natoms);
+    for (int a = 0; a < state.natoms; a++)
+    {
+        for (int d = 0; d < DIM; d++)
+        {
+            EXPECT_EQ(lazyState.x[a][d], state.x[a][d]);
+        }
+    }
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -200,5 +200,50 @@ TEST_F(XvgioTest, readXvgDeprecatedWorks)
     sfree(xvgTestData);
 }
 
+TEST_F(XvgioTest, readXvgLegendWorks)
+{
+    useStringAsXvgFile(
+            "# comment\n"
+            "@    title \"dH/d\\xl\\f{} and \\xD\\f{}H\"\n"
+            "@ subtitle \"T = 300 (K) \\xl\\f{} state 0: fep-lambda = 0.0000\"\n"
+            "@ s0 legend \"dH/d\\xl\\f{} fep-lambda = 0.0000\"\n"
+            "@ s1 legend \"\\xD\\f{}H \\xl\\f{} to 0.1000\"\n"
+            "0.0 1.5 -2.5e-1\n"
+            "  0.2   3 4  \n"
+            "0.4 5\n"
+            "&\n"
+            "0.6 7 8\n");
+    writeXvgFile();
+
+    double** xvgTestData = nullptr;
+    int      testNumColumns;
+    char*    subtitle;
+    char**   legend;
+    int      testNumRows = read_xvg_legend(referenceFilename().c_str(), &xvgTestData,
+                                      &testNumColumns, &subtitle, &legend);
+
+    std::vector<std::vector<double>> xvgRefData = { { 0.0, 0.2, 0.4 }, { 1.5, 3, 5 }, { -0.25, 4, 0 } };
+
+    ASSERT_EQ(3, testNumColumns);
+    ASSERT_EQ(3, testNumRows);
+    for (int column = 0; column < testNumColumns; column++)
+    {
+        for (int row = 0; row < testNumRows; row++)
+        {
+            EXPECT_DOUBLE_EQ(xvgRefData[column][row], xvgTestData[column][row]);
+        }
+        sfree(xvgTestData[column]);
+    }
+    sfree(xvgTestData);
+
+    EXPECT_STREQ("T = 300 (K) \\xl\\f{} state 0: fep-lambda = 0.0000", subtitle);
+    EXPECT_STREQ("dH/d\\xl\\f{} fep-lambda = 0.0000", legend[0]);
+    EXPECT_STREQ("\\xD\\f{}H \\xl\\f{} to 0.1000", legend[1]);
+    sfree(subtitle);
+    sfree(legend[0]);
+    sfree(legend[1]);
+    sfree(legend);
+}
+
 } // namespace test
 } // namespace gmx
@@ -41,6 +41,8 @@
 
 #include "tpxio.h"
 
+#include "config.h"
+
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
@@ -49,6 +51,16 @@
 #include <memory>
 #include <vector>
 
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#if defined(HAVE_UNISTD_H) && !defined(__MINGW32__)
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <unistd.h>
+#endif
+
+#include "gromacs/fileio/compressedrvecarray.h"
 #include "gromacs/fileio/filetypes.h"
 #include "gromacs/fileio/gmxfio.h"
 #include "gromacs/fileio/gmxfio_xdr.h"
@@ -132,6 +144,8 @@ enum tpxv
     tpxv_AddSizeField, /**< Added field with information about the size of the serialized tpr file in bytes, excluding the header */
     tpxv_StoreNonBondedInteractionExclusionGroup, /**< Store the non bonded interaction exclusion group in the topology */
     tpxv_VSite1,                                  /**< Added 1 type virtual site */
+    tpxv_CompressedCoordinates, /**< Store coordinates, velocities and position restraint references compressed */
+    tpxv_MultipleTimeStepping,  /**< Added multiple time stepping for the PME mesh */
     tpxv_Count                                    /**< the total number of tpxv versions */
 };
 
@@ -1082,6 +1096,17 @@ static void do_inputrec(gmx::ISerializer* serializer, t_inputrec* ir, int file_v
 
     serializer->doInt(&ir->simulation_part);
 
+    if (file_version >= tpxv_MultipleTimeStepping)
+    {
+        serializer->doBool(&ir->useMts);
+        serializer->doInt(&ir->mtsFactor);
+    }
+    else
+    {
+        ir->useMts    = FALSE;
+        ir->mtsFactor = 1;
+    }
+
     if (file_version >= 67)
     {
         serializer->doInt(&ir->nstcalcenergy);
@@ -2452,7 +2477,30 @@ static void do_moltype(gmx::ISerializer* serializer, gmx_moltype_t* molt, t_symt
     doListOfLists(serializer, &molt->excls);
 }
 
-static void do_molblock(gmx::ISerializer* serializer, gmx_molblock_t* molb, int numAtomsPerMolecule)
+/*! \brief Serializes coordinate-like vectors, compressed with new file versions
+ *
+ * This is used for the coordinates and velocities in the state and
+ * the position restraint reference coordinates, which can be large.
+ */
+static void doCoordinateArray(gmx::ISerializer* serializer,
+                              rvec*             values,
+                              int               numValues,
+                              int               file_version)
+{
+    if (file_version >= tpxv_CompressedCoordinates)
+    {
+        gmx::serializeCompressedRvecArray(serializer, values, numValues);
+    }
+    else
+    {
+        serializer->doRvecArray(values, numValues);
+    }
+}
+
+static void do_molblock(gmx::ISerializer* serializer,
+                        gmx_molblock_t*   molb,
+                        int               numAtomsPerMolecule,
+                        int               file_version)
 {
     serializer->doInt(&molb->type);
     serializer->doInt(&molb->nmol);
@@ -2470,7 +2518,29 @@ static void do_molblock(gmx::ISerializer* serializer, gmx_molblock_t* molb, int
         {
             molb->posres_xA.resize(numPosres_xA);
         }
-        serializer->doRvecArray(as_rvec_array(molb->posres_xA.data()), numPosres_xA);
+        doCoordinateArray(serializer, as_rvec_array(molb->posres_xA.data()), numPosres_xA,
+                          file_version);
+    }
+    /* Without B-state references, grompp sets B equal to A, store these only once */
+    bool posres_xBIsCopyOfA = false;
+    if (file_version >= tpxv_CompressedCoordinates)
+    {
+        if (!serializer->reading())
+        {
+            const std::size_t numBytes = molb->posres_xA.size() * sizeof(molb->posres_xA[0]);
+            posres_xBIsCopyOfA =
+                    (!molb->posres_xA.empty() && molb->posres_xB.size() == molb->posres_xA.size()
+                     && std::memcmp(molb->posres_xB.data(), molb->posres_xA.data(), numBytes) == 0);
+        }
+        serializer->doBool(&posres_xBIsCopyOfA);
+    }
+    if (posres_xBIsCopyOfA)
+    {
+        if (serializer->reading())
+        {
+            molb->posres_xB = molb->posres_xA;
+        }
+        return;
     }
     int numPosres_xB = molb->posres_xB.size();
     serializer->doInt(&numPosres_xB);
@@ -2480,7 +2550,8 @@ static void do_molblock(gmx::ISerializer* serializer, gmx_molblock_t* molb, int
         {
             molb->posres_xB.resize(numPosres_xB);
         }
-        serializer->doRvecArray(as_rvec_array(molb->posres_xB.data()), numPosres_xB);
+        doCoordinateArray(serializer, as_rvec_array(molb->posres_xB.data()), numPosres_xB,
+                          file_version);
     }
 }
 
@@ -2541,7 +2612,7 @@ static void do_mtop(gmx::ISerializer* serializer, gmx_mtop_t* mtop, int file_ver
     for (gmx_molblock_t& molblock : mtop->molblock)
     {
         int numAtomsPerMolecule = (serializer->reading() ? 0 : mtop->moltype[molblock.type].atoms.nr);
-        do_molblock(serializer, &molblock, numAtomsPerMolecule);
+        do_molblock(serializer, &molblock, numAtomsPerMolecule, file_version);
     }
     serializer->doInt(&mtop->natoms);
 
@@ -2905,7 +2976,7 @@ static void do_tpx_state_second(gmx::ISerializer* serializer, TpxFileHeader* tpx
         {
             state->flags |= (1 << estX);
         }
-        serializer->doRvecArray(x, tpx->natoms);
+        doCoordinateArray(serializer, x, tpx->natoms, tpx->fileVersion);
     }
 
     do_test(serializer, tpx->bV, v);
@@ -2918,11 +2989,12 @@ static void do_tpx_state_second(gmx::ISerializer* serializer, TpxFileHeader* tpx
         if (!v)
         {
             std::vector<gmx::RVec> dummyVelocities(tpx->natoms);
-            serializer->doRvecArray(as_rvec_array(dummyVelocities.data()), tpx->natoms);
+            doCoordinateArray(serializer, as_rvec_array(dummyVelocities.data()), tpx->natoms,
+                              tpx->fileVersion);
         }
         else
         {
-            serializer->doRvecArray(v, tpx->natoms);
+            doCoordinateArray(serializer, v, tpx->natoms, tpx->fileVersion);
         }
     }
 
@@ -3307,25 +3379,31 @@ PartialDeserializedTprFile read_tpx_state(const char* fn, t_inputrec* ir, t_stat
 
 PbcType read_tpx(const char* fn, t_inputrec* ir, matrix box, int* natoms, rvec* x, rvec* v, gmx_mtop_t* mtop)
 {
-    t_fileio* fio;
-    t_state   state;
+    GMX_RELEASE_ASSERT(!(x == nullptr && v != nullptr), "Passing x==NULL and v!=NULL is not supported");
 
-    TpxFileHeader tpx;
-    fio = open_tpx(fn, "r");
-    gmx::FileIOXdrSerializer serializer(fio);
-    do_tpxheader(&serializer, &tpx, fn, fio, ir == nullptr);
-    PartialDeserializedTprFile partialDeserializedTpr =
-            readTpxBody(&tpx, &serializer, ir, &state, x, v, mtop);
-    close_tpx(fio);
-    if (mtop != nullptr && natoms != nullptr)
+    // Only decode the parts that were asked for
+    gmx::TprFileReader reader(fn, ir == nullptr);
+    if (box)
     {
-        *natoms = mtop->natoms;
+        reader.readBox(box);
     }
-    if (box)
+    if (mtop)
+    {
+        reader.readTopology(mtop);
+        if (natoms != nullptr)
+        {
+            *natoms = mtop->natoms;
+        }
+    }
+    if (x)
+    {
+        reader.readCoordinates(x);
+    }
+    if (v)
     {
-        copy_mat(state.box, box);
+        reader.readVelocities(v);
     }
-    return partialDeserializedTpr.pbcType;
+    return reader.readInputrec(ir);
 }
 
 PbcType read_tpx_top(const char* fn, t_inputrec* ir, matrix box, int* natoms, rvec* x, rvec* v, t_topology* top)
@@ -3340,6 +3418,328 @@ PbcType read_tpx_top(const char* fn, t_inputrec* ir, matrix box, int* natoms, rv
     return pbcType;
 }
 
+namespace gmx
+{
+
+namespace
+{
+
+/*! \brief Read-only contents of a file
+ *
+ * The file is memory mapped when the platform supports this,
+ * otherwise it is read into memory.
+ */
+class FileContents
+{
+public:
+    explicit FileContents(const char* fileName)
+    {
+#if defined(HAVE_UNISTD_H) && !defined(__MINGW32__)
+        const int fd = open(fileName, O_RDONLY);
+        if (fd >= 0)
+        {
+            struct stat fileStat;
+            if (fstat(fd, &fileStat) == 0 && fileStat.st_size > 0)
+            {
+                void* mapping = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapping != MAP_FAILED)
+                {
+                    mapping_     = mapping;
+                    mappingSize_ = fileStat.st_size;
+                }
+            }
+            close(fd);
+        }
+        if (mapping_ != nullptr)
+        {
+            return;
+        }
+#endif
+        FILE* fp = gmx_ffopen(fileName, "rb");
+        gmx_fseek(fp, 0, SEEK_END);
+        storage_.resize(gmx_ftell(fp));
+        gmx_fseek(fp, 0, SEEK_SET);
+        if (fread(storage_.data(), 1, storage_.size(), fp) != storage_.size())
+        {
+            gmx_file(fileName);
+        }
+        gmx_ffclose(fp);
+    }
+
+    ~FileContents()
+    {
+#if defined(HAVE_UNISTD_H) && !defined(__MINGW32__)
+        if (mapping_ != nullptr)
+        {
+            munmap(mapping_, mappingSize_);
+        }
+#endif
+    }
+
+    //! Returns the contents of the file
+    ArrayRef<const char> data() const
+    {
+        if (mapping_ != nullptr)
+        {
+            const char* begin = static_cast<const char*>(mapping_);
+            return { begin, begin + mappingSize_ };
+        }
+        return storage_;
+    }
+
+private:
+    //! The memory mapped file, nullptr when not mapped
+    void* mapping_ = nullptr;
+    //! The size of the mapping
+    std::size_t mappingSize_ = 0;
+    //! The file contents when the file is not mapped
+    std::vector<char> storage_;
+
+    GMX_DISALLOW_COPY_AND_ASSIGN(FileContents);
+};
+
+} // namespace
+
+class TprFileReader::Impl
+{
+public:
+    Impl(const char* fileName, bool canReadTopologyOnly);
+
+    //! Returns a deserializer for the body starting at byte \p offset
+    std::unique_ptr<InMemoryDeserializer> bodyDeserializer(std::size_t offset) const
+    {
+        // See the comment in write_tpx_state() on the endianness
+        return std::make_unique<InMemoryDeserializer>(
+                body_.subArray(offset, body_.size() - offset), header_.isDouble,
+                EndianSwapBehavior::SwapIfHostIsLittleEndian);
+    }
+    //! Returns the offset of the coordinates in the body, walks over the topology if needed
+    std::size_t stateSecondOffset();
+    //! Returns the size of one uncompressed vector of natoms rvecs in the body
+    std::size_t rvecArraySize() const
+    {
+        return static_cast<std::size_t>(header_.natoms) * DIM
+               * (header_.isDouble ? sizeof(double) : sizeof(float));
+    }
+    //! Returns the size of the coordinate or velocity vector stored at byte \p offset in the body
+    std::size_t coordinateArraySize(std::size_t offset) const
+    {
+        if (header_.fileVersion >= tpxv_CompressedCoordinates)
+        {
+            auto              deserializer = bodyDeserializer(offset);
+            const std::size_t dataSize     = readCompressedRvecArrayDataSize(deserializer.get());
+            return deserializer->position() + dataSize;
+        }
+        return rvecArraySize();
+    }
+    //! Reads a file without body size field as a stream, passing nullptr skips a part
+    PbcType readStream(t_inputrec* ir, t_state* state, rvec* x, rvec* v, gmx_mtop_t* mtop);
+
+    //! The file name
+    std::string fileName_;
+    //! Whether the inputrec can be skipped
+    bool canReadTopologyOnly_;
+    //! The file header
+    TpxFileHeader header_;
+    //! Whether the body is stored as a single block of known size
+    bool haveBodyBlock_;
+    //! The file contents, only present with a body block
+    std::unique_ptr<FileContents> contents_;
+    //! The body, view of \p contents_
+    ArrayRef<const char> body_;
+    //! The offset of the topology in the body
+    std::size_t mtopOffset_ = 0;
+    //! The offset of the coordinates in the body, -1 when not yet known
+    std::ptrdiff_t stateSecondOffset_ = -1;
+};
+
+TprFileReader::Impl::Impl(const char* fileName, bool canReadTopologyOnly) :
+    fileName_(fileName),
+    canReadTopologyOnly_(canReadTopologyOnly)
+{
+    t_fileio*                fio = open_tpx(fileName, "r");
+    gmx::FileIOXdrSerializer serializer(fio);
+    do_tpxheader(&serializer, &header_, fileName, fio, canReadTopologyOnly);
+    const gmx_off_t bodyOffset = gmx_fio_ftell(fio);
+    close_tpx(fio);
+
+    haveBodyBlock_ = (header_.fileVersion >= tpxv_AddSizeField && header_.fileGeneration >= 27);
+    if (haveBodyBlock_)
+    {
+        contents_ = std::make_unique<FileContents>(fileName);
+        if (bodyOffset + header_.sizeOfTprBody > contents_->data().ssize())
+        {
+            gmx_fatal(FARGS, "The run input file %s is truncated", fileName);
+        }
+        body_ = contents_->data().subArray(bodyOffset, header_.sizeOfTprBody);
+
+        // The first state part is small and has a size that is not stored,
+        // so we decode it to find the start of the topology.
+        t_state state;
+        auto    deserializer = bodyDeserializer(0);
+        do_tpx_state_first(deserializer.get(), &header_, &state);
+        mtopOffset_ = deserializer->position();
+    }
+}
+
+std::size_t TprFileReader::Impl::stateSecondOffset()
+{
+    if (stateSecondOffset_ < 0)
+    {
+        auto deserializer = bodyDeserializer(mtopOffset_);
+        do_tpx_mtop(deserializer.get(), &header_, nullptr);
+        stateSecondOffset_ = mtopOffset_ + deserializer->position();
+    }
+    return stateSecondOffset_;
+}
+
+PbcType TprFileReader::Impl::readStream(t_inputrec* ir, t_state* state, rvec* x, rvec* v, gmx_mtop_t* mtop)
+{
+    t_state   dummyState;
+    t_fileio* fio = open_tpx(fileName_.c_str(), "r");
+    gmx::FileIOXdrSerializer serializer(fio);
+    TpxFileHeader            tpx;
+    do_tpxheader(&serializer, &tpx, fileName_.c_str(), fio, canReadTopologyOnly_);
+    PbcType pbcType =
+            do_tpx_body(&serializer, &tpx, ir, state ? state : &dummyState, x, v, mtop);
+    close_tpx(fio);
+    return pbcType;
+}
+
+TprFileReader::TprFileReader(const char* fileName, bool canReadTopologyOnly) :
+    impl_(new Impl(fileName, canReadTopologyOnly))
+{
+}
+
+TprFileReader::~TprFileReader() = default;
+
+const TpxFileHeader& TprFileReader::header() const
+{
+    return impl_->header_;
+}
+
+void TprFileReader::readBox(matrix box)
+{
+    t_state state;
+    if (impl_->haveBodyBlock_)
+    {
+        auto deserializer = impl_->bodyDeserializer(0);
+        do_tpx_state_first(deserializer.get(), &impl_->header_, &state);
+    }
+    else
+    {
+        impl_->readStream(nullptr, &state, nullptr, nullptr, nullptr);
+    }
+    copy_mat(state.box, box);
+}
+
+void TprFileReader::readTopology(gmx_mtop_t* mtop)
+{
+    if (impl_->haveBodyBlock_)
+    {
+        auto deserializer = impl_->bodyDeserializer(impl_->mtopOffset_);
+        do_tpx_mtop(deserializer.get(), &impl_->header_, mtop);
+        impl_->stateSecondOffset_ = impl_->mtopOffset_ + deserializer->position();
+    }
+    else
+    {
+        impl_->readStream(nullptr, nullptr, nullptr, nullptr, mtop);
+    }
+}
+
+bool TprFileReader::readCoordinates(rvec* x)
+{
+    if (!impl_->header_.bX)
+    {
+        return false;
+    }
+    if (impl_->haveBodyBlock_)
+    {
+        auto deserializer = impl_->bodyDeserializer(impl_->stateSecondOffset());
+        doCoordinateArray(deserializer.get(), x, impl_->header_.natoms, impl_->header_.fileVersion);
+    }
+    else
+    {
+        impl_->readStream(nullptr, nullptr, x, nullptr, nullptr);
+    }
+    return true;
+}
+
+bool TprFileReader::readVelocities(rvec* v)
+{
+    if (!impl_->header_.bV)
+    {
+        return false;
+    }
+    if (impl_->haveBodyBlock_)
+    {
+        std::size_t offset = impl_->stateSecondOffset();
+        if (impl_->header_.bX)
+        {
+            offset += impl_->coordinateArraySize(offset);
+        }
+        auto deserializer = impl_->bodyDeserializer(offset);
+        doCoordinateArray(deserializer.get(), v, impl_->header_.natoms, impl_->header_.fileVersion);
+    }
+    else
+    {
+        std::vector<RVec> x(impl_->header_.natoms);
+        impl_->readStream(nullptr, nullptr, as_rvec_array(x.data()), v, nullptr);
+    }
+    return true;
+}
+
+void TprFileReader::readState(t_state* state)
+{
+    if (impl_->haveBodyBlock_)
+    {
+        auto deserializer = impl_->bodyDeserializer(0);
+        do_tpx_state_first(deserializer.get(), &impl_->header_, state);
+        deserializer = impl_->bodyDeserializer(impl_->stateSecondOffset());
+        do_tpx_state_second(deserializer.get(), &impl_->header_, state, nullptr, nullptr);
+    }
+    else
+    {
+        impl_->readStream(nullptr, state, nullptr, nullptr, nullptr);
+    }
+}
+
+PbcType TprFileReader::readInputrec(t_inputrec* ir)
+{
+    if (impl_->haveBodyBlock_)
+    {
+        const TpxFileHeader& tpx    = impl_->header_;
+        std::size_t          offset = impl_->stateSecondOffset();
+        // The coordinates, velocities and (old) forces are stored before the inputrec
+        if (tpx.bX)
+        {
+            offset += impl_->coordinateArraySize(offset);
+        }
+        if (tpx.bV)
+        {
+            offset += impl_->coordinateArraySize(offset);
+        }
+        if (tpx.bF)
+        {
+            offset += impl_->rvecArraySize();
+        }
+        auto    deserializer = impl_->bodyDeserializer(offset);
+        PbcType pbcType      = do_tpx_ir(deserializer.get(), &impl_->header_, ir);
+        // Files with a body block are too new to need the topology for finalizing
+        do_tpx_finalize(&impl_->header_, ir, nullptr, nullptr);
+        return pbcType;
+    }
+    else
+    {
+        // Files before version 57 set the distance restraint type from the topology
+        gmx_mtop_t mtop;
+        const bool needTopology = (ir != nullptr && impl_->header_.fileVersion < 57);
+        return impl_->readStream(ir, nullptr, nullptr, nullptr, needTopology ? &mtop : nullptr);
+    }
+}
+
+} // namespace gmx
+
 gmx_bool fn2bTPX(const char* file)
 {
     return (efTPR == fn2ftp(file));
@@ -45,6 +45,7 @@
 #include "gromacs/math/vectypes.h"
 #include "gromacs/pbcutil/pbc.h"
 #include "gromacs/utility/basedefinitions.h"
+#include "gromacs/utility/classhelpers.h"
 #include "gromacs/utility/real.h"
 
 struct gmx_mtop_t;
@@ -215,6 +216,72 @@ PbcType read_tpx(const char* fn, t_inputrec* ir, matrix box, int* natoms, rvec*
 PbcType read_tpx_top(const char* fn, t_inputrec* ir, matrix box, int* natoms, rvec* x, rvec* v, t_topology* top);
 /* As read_tpx, but for the old t_topology struct */
 
+namespace gmx
+{
+
+/*! \libinternal
+ * \brief
+ * Reads sections of a TPR file on demand.
+ *
+ * The header is read on construction. The body is memory mapped,
+ * or read into memory on platforms without memory mapping, but
+ * a section is only decoded when it is requested. Thus a tool that
+ * only needs the topology does not pay for decoding the coordinates
+ * and velocities, which make up most of a large system.
+ *
+ * Since the topology is variable in size, requesting the coordinates,
+ * velocities or input record requires walking over the topology once,
+ * unless it was already read.
+ *
+ * Files written before the body size was stored in the header can only
+ * be read as a stream. For those files each request reads the file
+ * from the start.
+ */
+class TprFileReader
+{
+public:
+    /*! \brief Opens \p fileName and reads the header
+     *
+     * \param[in] fileName            The name of the TPR file.
+     * \param[in] canReadTopologyOnly If reading the inputrec can be skipped or not,
+     *                                see readTpxHeader().
+     */
+    TprFileReader(const char* fileName, bool canReadTopologyOnly);
+    ~TprFileReader();
+
+    //! Returns the file header
+    const TpxFileHeader& header() const;
+    //! Reads the box, or clears \p box when the file has no box
+    void readBox(matrix box);
+    //! Reads the global topology
+    void readTopology(gmx_mtop_t* mtop);
+    /*! \brief Reads the coordinates, \p x should have header().natoms elements
+     *
+     * \returns false, leaving \p x unchanged, when the file has no coordinates.
+     */
+    bool readCoordinates(rvec* x);
+    /*! \brief Reads the velocities, \p v should have header().natoms elements
+     *
+     * \returns false, leaving \p v unchanged, when the file has no velocities.
+     */
+    bool readVelocities(rvec* v);
+    //! Reads the box and, when present, the coordinates and velocities into \p state
+    void readState(t_state* state);
+    /*! \brief Reads the input record
+     *
+     * \param[out] ir  The input record to populate, can be nullptr.
+     * \returns The PBC type, also when \p ir is nullptr.
+     */
+    PbcType readInputrec(t_inputrec* ir);
+
+private:
+    class Impl;
+
+    PrivateImplPointer<Impl> impl_;
+};
+
+} // namespace gmx
+
 gmx_bool fn2bTPX(const char* file);
 /* return if *file is one of the TPX file types */
 
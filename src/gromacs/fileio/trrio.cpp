@@ -333,6 +333,36 @@ void gmx_trr_write_frame(t_fileio*   fio,
 }
 
 
+int64_t gmx_trr_write_frame_header(t_fileio*   fio,
+                                   int64_t     step,
+                                   real        t,
+                                   real        lambda,
+                                   const rvec* box,
+                                   int         natoms,
+                                   gmx_bool    bX,
+                                   gmx_bool    bV,
+                                   gmx_bool    bF)
+{
+    gmx_trr_header_t sh = {};
+    sh.box_size         = (box) ? sizeof(matrix) : 0;
+    sh.x_size           = (bX ? natoms * sizeof(rvec) : 0);
+    sh.v_size           = (bV ? natoms * sizeof(rvec) : 0);
+    sh.f_size           = (bF ? natoms * sizeof(rvec) : 0);
+    sh.natoms           = natoms;
+    sh.step             = step;
+    sh.t                = t;
+    sh.lambda           = lambda;
+
+    gmx_bool bOK;
+    if (!do_trr_frame_header(fio, false, &sh, &bOK)
+        || (box && !gmx_fio_ndo_rvec(fio, const_cast<rvec*>(box), DIM)))
+    {
+        gmx_file("Cannot write trajectory frame; maybe you are out of disk space?");
+    }
+
+    return gmx_fio_ftell(fio);
+}
+
 gmx_bool gmx_trr_read_frame(t_fileio* fio,
                             int64_t*  step,
                             real*     t,
@@ -136,6 +136,20 @@ void gmx_trr_write_frame(struct t_fileio* fio,
                          const rvec*      f);
 /* Write a trr frame to file fp, box, x, v, f may be NULL */
 
+int64_t gmx_trr_write_frame_header(struct t_fileio* fio,
+                                   int64_t          step,
+                                   real             t,
+                                   real             lambda,
+                                   const rvec*      box,
+                                   int              natoms,
+                                   gmx_bool         bX,
+                                   gmx_bool         bV,
+                                   gmx_bool         bF);
+/* Write the header and box of a trr frame to file fp, but not the vectors.
+ * Returns the file offset at which the x, v and f arrays, when present,
+ * should be stored consecutively, each as natoms rvecs in XDR format.
+ */
+
 void gmx_trr_read_single_header(const char* fn, gmx_trr_header_t* header);
 /* Read the header of a trr file from fn, and close the file afterwards.
  */
@@ -41,9 +41,11 @@
 
 #include <cassert>
 #include <cctype>
+#include <cstdlib>
 #include <cstring>
 
 #include <string>
+#include <vector>
 
 #include "gromacs/fileio/gmxfio.h"
 #include "gromacs/fileio/oenv.h"
@@ -55,6 +57,7 @@
 #include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/smalloc.h"
 #include "gromacs/utility/sysinfo.h"
 
@@ -446,61 +449,6 @@ void xvgr_box(FILE*                   out,
     }
 }
 
-/* reads a line into ptr, adjusting len and renewing ptr if neccesary */
-static char* fgets3(FILE* fp, char** ptr, int* len, int maxlen)
-{
-    int len_remaining = *len; /* remaining amount of allocated bytes in buf */
-    int curp          = 0;    /* current position in buf to read into */
-
-    do
-    {
-        if (len_remaining < 2)
-        {
-            if (*len + STRLEN < maxlen)
-            {
-                /* This line is longer than len characters, let's increase len! */
-                *len += STRLEN;
-                len_remaining += STRLEN;
-                srenew(*ptr, *len);
-            }
-            else
-            {
-                /*something is wrong, we'll just keep reading and return NULL*/
-                len_remaining = STRLEN;
-                curp          = 0;
-            }
-        }
-        if (fgets(*ptr + curp, len_remaining, fp) == nullptr)
-        {
-            /* if last line, skip */
-            return nullptr;
-        }
-        curp += len_remaining - 1; /* overwrite the nul char in next iteration */
-        len_remaining = 1;
-    } while ((std::strchr(*ptr, '\n') == nullptr) && (feof(fp) == 0));
-
-    if (*len + STRLEN >= maxlen)
-    {
-        return nullptr; /* this line was too long */
-    }
-
-    if (feof(fp))
-    {
-        /* We reached EOF before '\n', skip this last line. */
-        return nullptr;
-    }
-    {
-        /* now remove newline */
-        int slen = std::strlen(*ptr);
-        if ((*ptr)[slen - 1] == '\n')
-        {
-            (*ptr)[slen - 1] = '\0';
-        }
-    }
-
-    return *ptr;
-}
-
 static int wordcount(char* ptr)
 {
     int i, n = 0, is[2];
@@ -511,7 +459,7 @@ static int wordcount(char* ptr)
     {
         for (i = 0; (ptr[i] != '\0'); i++)
         {
-            is[cur] = std::isspace(ptr[i]);
+            is[cur] = std::isspace(static_cast<unsigned char>(ptr[i]));
             if (((0 == i) && !is[cur]) || ((i > 0) && (!is[cur] && is[prev])))
             {
                 n++;
@@ -550,24 +498,133 @@ static char* read_xvgr_string(const char* line)
     return str;
 }
 
+/*! \brief Lines of an xvg file, split in memory
+ *
+ * The file is read with a few large block reads, which is much faster than
+ * reading it line by line for the large dhdl.xvg files written by long
+ * free-energy simulations. The lines are nul-terminated in place.
+ */
+struct XvgFileLines
+{
+    //! The file contents, with the line ends replaced by nul characters
+    std::vector<char> contents;
+    //! The lines starting with '@', trimmed, in file order
+    std::vector<char*> headerLines;
+    //! The data lines, i.e. all lines not starting with '@' or '#'
+    std::vector<char*> dataLines;
+    //! The line number of each data line, counting from 1
+    std::vector<int> dataLineNumbers;
+};
+
+//! Reads \p fn and splits it into lines, stopping at the first line starting with '&'
+static XvgFileLines splitXvgFile(const char* fn)
+{
+    constexpr size_t c_blockSize = 1 << 24;
+    XvgFileLines     lines;
+    size_t           size = 0;
+
+    FILE* fp = gmx_fio_fopen(fn, "r");
+    size_t numRead;
+    do
+    {
+        lines.contents.resize(size + c_blockSize);
+        numRead = std::fread(lines.contents.data() + size, 1, c_blockSize, fp);
+        size += numRead;
+    } while (numRead == c_blockSize);
+    gmx_fio_fclose(fp);
+    lines.contents.resize(size + 1);
+    lines.contents[size] = '\0';
+
+    char* end = lines.contents.data() + size;
+    int   line = 0;
+    for (char* ptr = lines.contents.data(); ptr < end;)
+    {
+        char* lineEnd = static_cast<char*>(std::memchr(ptr, '\n', end - ptr));
+        if (lineEnd == nullptr)
+        {
+            /* As with reading line by line, skip a last line without newline */
+            break;
+        }
+        *lineEnd = '\0';
+        if (ptr[0] == '&')
+        {
+            break;
+        }
+        line++;
+        char* first = ptr;
+        while (*first != '\0' && std::isspace(static_cast<unsigned char>(*first)))
+        {
+            first++;
+        }
+        if (first[0] == '@')
+        {
+            trim(ptr);
+            lines.headerLines.push_back(ptr);
+        }
+        else if (first[0] != '#')
+        {
+            lines.dataLines.push_back(ptr);
+            lines.dataLineNumbers.push_back(line);
+        }
+        ptr = lineEnd + 1;
+    }
+
+    return lines;
+}
+
+/*! \brief Parses the data lines of an xvg file into \p numColumns columns
+ *
+ * Value \p k of data line \p row is stored in \p columns[k][row]. Missing
+ * values are set to zero. The lines are independent and are parsed in
+ * parallel, each value is parsed with a single strtod call instead of
+ * re-scanning the line for each column.
+ */
+static void parseXvgDataLines(const XvgFileLines& lines, int numColumns, double** columns, const char* fn)
+{
+    const int numRows = lines.dataLines.size();
+
+#pragma omp parallel for num_threads(gmx_omp_get_max_threads()) schedule(static)
+    for (int row = 0; row < numRows; row++)
+    {
+        const char* ptr = lines.dataLines[row];
+        int         k;
+        for (k = 0; k < numColumns; k++)
+        {
+            char*        valueEnd;
+            const double value = std::strtod(ptr, &valueEnd);
+            if (valueEnd == ptr)
+            {
+                break;
+            }
+            columns[k][row] = value;
+            /* Skip the rest of the word, as sscanf with %*s would */
+            ptr = valueEnd;
+            while (*ptr != '\0' && !std::isspace(static_cast<unsigned char>(*ptr)))
+            {
+                ptr++;
+            }
+        }
+        if (k != numColumns)
+        {
+#pragma omp critical
+            fprintf(stderr, "Only %d columns on line %d in file %s\n", k, lines.dataLineNumbers[row], fn);
+            for (; (k < numColumns); k++)
+            {
+                columns[k][row] = 0.0;
+            }
+        }
+    }
+}
+
 int read_xvg_legend(const char* fn, double*** y, int* ny, char** subtitle, char*** legend)
 {
-    FILE*    fp;
     char*    ptr;
-    char*    base = nullptr;
-    char*    fmt  = nullptr;
-    int      k, line = 0, nny, nx, maxx, rval, legend_nalloc, set, nchar;
-    double   lf;
+    int      k, nny, nx, legend_nalloc, set, nchar;
     double** yy = nullptr;
-    char*    tmpbuf;
-    int      len = STRLEN;
-    *ny          = 0;
-    nny          = 0;
-    nx           = 0;
-    maxx         = 0;
-    fp           = gmx_fio_fopen(fn, "r");
-
-    snew(tmpbuf, len);
+    *ny         = 0;
+
+    XvgFileLines lines = splitXvgFile(fn);
+
     if (subtitle != nullptr)
     {
         *subtitle = nullptr;
@@ -576,119 +633,69 @@ int read_xvg_legend(const char* fn, double*** y, int* ny, char** subtitle, char*
     if (legend != nullptr)
     {
         *legend = nullptr;
-    }
-
-    while ((ptr = fgets3(fp, &tmpbuf, &len, 10 * STRLEN)) != nullptr && ptr[0] != '&')
-    {
-        line++;
-        trim(ptr);
-        if (ptr[0] == '@')
+        for (char* headerLine : lines.headerLines)
         {
-            if (legend != nullptr)
+            ptr = headerLine + 1;
+            trim(ptr);
+            set = -1;
+            if (std::strncmp(ptr, "subtitle", 8) == 0)
             {
-                ptr++;
-                trim(ptr);
-                set = -1;
-                if (std::strncmp(ptr, "subtitle", 8) == 0)
-                {
-                    ptr += 8;
-                    if (subtitle != nullptr)
-                    {
-                        *subtitle = read_xvgr_string(ptr);
-                    }
-                }
-                else if (std::strncmp(ptr, "legend string", 13) == 0)
-                {
-                    ptr += 13;
-                    sscanf(ptr, "%d%n", &set, &nchar);
-                    ptr += nchar;
-                }
-                else if (ptr[0] == 's')
+                ptr += 8;
+                if (subtitle != nullptr)
                 {
-                    ptr++;
-                    sscanf(ptr, "%d%n", &set, &nchar);
-                    ptr += nchar;
-                    trim(ptr);
-                    if (std::strncmp(ptr, "legend", 6) == 0)
-                    {
-                        ptr += 6;
-                    }
-                    else
-                    {
-                        set = -1;
-                    }
-                }
-                if (set >= 0)
-                {
-                    if (set >= legend_nalloc)
-                    {
-                        legend_nalloc = set + 1;
-                        srenew(*legend, legend_nalloc);
-                        (*legend)[set] = read_xvgr_string(ptr);
-                    }
+                    *subtitle = read_xvgr_string(ptr);
                 }
             }
-        }
-        else if (ptr[0] != '#')
-        {
-            if (nny == 0)
+            else if (std::strncmp(ptr, "legend string", 13) == 0)
             {
-                (*ny) = nny = wordcount(ptr);
-                /* fprintf(stderr,"There are %d columns in your file\n",nny);*/
-                if (nny == 0)
-                {
-                    return 0;
-                }
-                snew(yy, nny);
-                snew(fmt, 3 * nny + 1);
-                snew(base, 3 * nny + 1);
+                ptr += 13;
+                sscanf(ptr, "%d%n", &set, &nchar);
+                ptr += nchar;
             }
-            /* Allocate column space */
-            if (nx >= maxx)
+            else if (ptr[0] == 's')
             {
-                maxx += 1024;
-                for (k = 0; (k < nny); k++)
+                ptr++;
+                sscanf(ptr, "%d%n", &set, &nchar);
+                ptr += nchar;
+                trim(ptr);
+                if (std::strncmp(ptr, "legend", 6) == 0)
                 {
-                    srenew(yy[k], maxx);
+                    ptr += 6;
                 }
-            }
-            /* Initiate format string */
-            fmt[0]  = '\0';
-            base[0] = '\0';
-
-            /* fprintf(stderr,"ptr='%s'\n",ptr);*/
-            for (k = 0; (k < nny); k++)
-            {
-                std::strcpy(fmt, base);
-                std::strcat(fmt, "%lf");
-                rval = sscanf(ptr, fmt, &lf);
-                /* fprintf(stderr,"rval = %d\n",rval);*/
-                if ((rval == EOF) || (rval == 0))
+                else
                 {
-                    break;
+                    set = -1;
                 }
-                yy[k][nx] = lf;
-                srenew(fmt, 3 * (nny + 1) + 1);
-                srenew(base, 3 * nny + 1);
-                std::strcat(base, "%*s");
             }
-            if (k != nny)
+            if (set >= 0)
             {
-                fprintf(stderr, "Only %d columns on line %d in file %s\n", k, line, fn);
-                for (; (k < nny); k++)
+                if (set >= legend_nalloc)
                 {
-                    yy[k][nx] = 0.0;
+                    legend_nalloc = set + 1;
+                    srenew(*legend, legend_nalloc);
+                    (*legend)[set] = read_xvgr_string(ptr);
                 }
             }
-            nx++;
         }
     }
-    gmx_fio_fclose(fp);
+
+    nx = lines.dataLines.size();
+    if (nx > 0)
+    {
+        (*ny) = nny = wordcount(lines.dataLines[0]);
+        if (nny == 0)
+        {
+            return 0;
+        }
+        snew(yy, nny);
+        for (k = 0; (k < nny); k++)
+        {
+            snew(yy[k], nx);
+        }
+        parseXvgDataLines(lines, nny, yy, fn);
+    }
 
     *y = yy;
-    sfree(tmpbuf);
-    sfree(base);
-    sfree(fmt);
 
     if (legend_nalloc > 0)
     {
@@ -733,84 +740,23 @@ int read_xvg(const char* fn, double*** y, int* ny)
 
 gmx::MultiDimArray<std::vector<double>, gmx::dynamicExtents2D> readXvgData(const std::string& fn)
 {
-    FILE* fp = gmx_fio_fopen(fn.c_str(), "r");
-    char* ptr;
-    char* base = nullptr;
-    char* fmt  = nullptr;
-    char* tmpbuf;
-    int   len = STRLEN;
-
-    //! This only gets properly set after the first line of data is read
-    int numColumns = 0;
-    int numRows    = 0;
-    snew(tmpbuf, len);
-    std::vector<double> xvgData;
-
-    for (int line = 0; (ptr = fgets3(fp, &tmpbuf, &len, 10 * STRLEN)) != nullptr && ptr[0] != '&'; ++line)
-    {
-        trim(ptr);
-        if (ptr[0] == '@' || ptr[0] == '#')
-        {
-            continue;
-        }
-        ++numRows;
-        if (numColumns == 0)
-        {
-            numColumns = wordcount(ptr);
-            if (numColumns == 0)
-            {
-                return {}; // There are no columns and hence no data to process
-            }
-            snew(fmt, 3 * numColumns + 1);
-            snew(base, 3 * numColumns + 1);
-        }
-        /* Initiate format string */
-        fmt[0]          = '\0';
-        base[0]         = '\0';
-        int columnCount = 0;
-        for (columnCount = 0; (columnCount < numColumns); columnCount++)
-        {
-            double lf;
-            std::strcpy(fmt, base);
-            std::strcat(fmt, "%lf");
-            int rval = sscanf(ptr, fmt, &lf);
-            if ((rval == EOF) || (rval == 0))
-            {
-                break;
-            }
-            xvgData.push_back(lf);
-            srenew(fmt, 3 * (numColumns + 1) + 1);
-            srenew(base, 3 * numColumns + 1);
-            std::strcat(base, "%*s");
-        }
+    XvgFileLines lines = splitXvgFile(fn.c_str());
 
-        if (columnCount != numColumns)
-        {
-            fprintf(stderr, "Only %d columns on line %d in file %s\n", columnCount, line, fn.c_str());
-            for (; (columnCount < numColumns); columnCount++)
-            {
-                xvgData.push_back(0.0);
-            }
-        }
+    const int numRows    = lines.dataLines.size();
+    const int numColumns = (numRows > 0) ? wordcount(lines.dataLines[0]) : 0;
+    if (numColumns == 0)
+    {
+        return {}; // There are no columns and hence no data to process
     }
-    gmx_fio_fclose(fp);
-
-    sfree(tmpbuf);
-    sfree(base);
-    sfree(fmt);
-
-    gmx::MultiDimArray<std::vector<double>, gmx::dynamicExtents2D> xvgDataAsArray(numRows, numColumns);
-    std::copy(std::begin(xvgData), std::end(xvgData), begin(xvgDataAsArray.asView()));
 
     gmx::MultiDimArray<std::vector<double>, gmx::dynamicExtents2D> xvgDataAsArrayTransposed(
             numColumns, numRows);
-    for (std::ptrdiff_t row = 0; row < numRows; ++row)
+    std::vector<double*> columns(numColumns);
+    for (int column = 0; column < numColumns; ++column)
     {
-        for (std::ptrdiff_t column = 0; column < numColumns; ++column)
-        {
-            xvgDataAsArrayTransposed(column, row) = xvgDataAsArray(row, column);
-        }
+        columns[column] = xvgDataAsArrayTransposed.asView()[column].data();
     }
+    parseXvgDataLines(lines, numColumns, columns.data(), fn.c_str());
 
     return xvgDataAsArrayTransposed;
 }
@@ -0,0 +1,202 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements Anderson mixing for accelerating fixed-point iterations.
+ *
+ * \ingroup module_gmxana
+ */
+#include "gmxpre.h"
+
+#include "andersonmixer.h"
+
+#include <cmath>
+
+#include <algorithm>
+
+namespace gmx
+{
+
+namespace
+{
+
+//! Solves a x = b with Gaussian elimination, returns false when a is (nearly) singular
+bool solveLinearSystem(int m, double* a, double* b)
+{
+    double trace = 0;
+    for (int j = 0; j < m; j++)
+    {
+        trace += a[j * m + j];
+    }
+    /* Regularize, since the residual differences become nearly linearly dependent */
+    for (int j = 0; j < m; j++)
+    {
+        a[j * m + j] += 1e-12 * trace;
+    }
+    for (int j = 0; j < m; j++)
+    {
+        int pivot = j;
+        for (int k = j + 1; k < m; k++)
+        {
+            if (std::abs(a[k * m + j]) > std::abs(a[pivot * m + j]))
+            {
+                pivot = k;
+            }
+        }
+        if (!(std::abs(a[pivot * m + j]) > 1e-14 * trace))
+        {
+            return false;
+        }
+        if (pivot != j)
+        {
+            for (int k = 0; k < m; k++)
+            {
+                std::swap(a[j * m + k], a[pivot * m + k]);
+            }
+            std::swap(b[j], b[pivot]);
+        }
+        for (int k = j + 1; k < m; k++)
+        {
+            const double factor = a[k * m + j] / a[j * m + j];
+            for (int l = j; l < m; l++)
+            {
+                a[k * m + l] -= factor * a[j * m + l];
+            }
+            b[k] -= factor * b[j];
+        }
+    }
+    for (int j = m - 1; j >= 0; j--)
+    {
+        for (int k = j + 1; k < m; k++)
+        {
+            b[j] -= a[j * m + k] * b[k];
+        }
+        b[j] /= a[j * m + j];
+    }
+    return true;
+}
+
+} // namespace
+
+void AndersonMixer::reset()
+{
+    dF_.clear();
+    dG_.clear();
+    fPrev_.clear();
+    gPrev_.clear();
+}
+
+void AndersonMixer::mix(const std::vector<double>& x, std::vector<double>* g)
+{
+    const size_t        n = x.size();
+    std::vector<double> f(n);
+    double              residual = 0;
+    for (size_t i = 0; i < n; i++)
+    {
+        f[i]     = (*g)[i] - x[i];
+        residual = std::max(residual, std::abs(f[i]));
+    }
+
+    if (!fPrev_.empty())
+    {
+        if (residual > residualPrev_)
+        {
+            /* Fall back to the plain iteration and start a new history */
+            reset();
+        }
+        else
+        {
+            std::vector<double> df(n), dg(n);
+            for (size_t i = 0; i < n; i++)
+            {
+                df[i] = f[i] - fPrev_[i];
+                dg[i] = (*g)[i] - gPrev_[i];
+            }
+            dF_.push_back(std::move(df));
+            dG_.push_back(std::move(dg));
+            if (static_cast<int>(dF_.size()) > depth_)
+            {
+                dF_.pop_front();
+                dG_.pop_front();
+            }
+        }
+    }
+    fPrev_        = f;
+    gPrev_        = *g;
+    residualPrev_ = residual;
+
+    const int m = dF_.size();
+    if (m == 0)
+    {
+        return;
+    }
+
+    /* Solve the least-squares problem min |f - dF gamma| with the normal
+     * equations, which is fine for the small history lengths used here.
+     */
+    std::vector<double> a(m * m), gamma(m);
+    for (int j = 0; j < m; j++)
+    {
+        for (int k = 0; k < m; k++)
+        {
+            double sum = 0;
+            for (size_t i = 0; i < n; i++)
+            {
+                sum += dF_[j][i] * dF_[k][i];
+            }
+            a[j * m + k] = sum;
+        }
+        double sum = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            sum += dF_[j][i] * f[i];
+        }
+        gamma[j] = sum;
+    }
+    if (!solveLinearSystem(m, a.data(), gamma.data()))
+    {
+        reset();
+        return;
+    }
+    for (int j = 0; j < m; j++)
+    {
+        for (size_t i = 0; i < n; i++)
+        {
+            (*g)[i] -= gamma[j] * dG_[j][i];
+        }
+    }
+}
+
+} // namespace gmx
@@ -0,0 +1,97 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Declares Anderson mixing for accelerating fixed-point iterations,
+ * used by the WHAM iteration in gmx wham.
+ *
+ * \ingroup module_gmxana
+ */
+#ifndef GMXANA_ANDERSONMIXER_H
+#define GMXANA_ANDERSONMIXER_H
+
+#include <deque>
+#include <vector>
+
+namespace gmx
+{
+
+/*! \internal \brief Anderson mixing to accelerate a fixed-point iteration x -> G(x)
+ *
+ * Plain fixed-point iterations, such as the WHAM iteration of the free energy
+ * offsets z (calc_profile() followed by calc_z()), converge slowly when
+ * the map G is only weakly contracting, as with many strongly overlapping
+ * umbrella windows. Anderson mixing, also known as DIIS, extrapolates the
+ * next x from the last few iterates and their residuals G(x) - x.
+ * When the residual grows, the history is discarded and the plain iterate
+ * is used, so the plain iteration is the fallback.
+ */
+class AndersonMixer
+{
+public:
+    //! Constructor, \p depth is the maximum number of stored previous iterations
+    explicit AndersonMixer(int depth) : depth_(depth) {}
+
+    //! Discard the history, required when the map G changes
+    void reset();
+
+    /*! \brief Replaces \p g = G(\p x) by the next iterate
+     *
+     * \param[in]     x  The current iterate
+     * \param[in,out] g  The image of \p x under one plain iteration, returns the mixed iterate
+     */
+    void mix(const std::vector<double>& x, std::vector<double>* g);
+
+    //! Returns the number of previous iterations currently used for mixing
+    int historySize() const { return dF_.size(); }
+
+private:
+    //! Maximum number of stored previous iterations
+    int depth_;
+    //! Differences between consecutive residuals
+    std::deque<std::vector<double>> dF_;
+    //! Differences between consecutive images G(x)
+    std::deque<std::vector<double>> dG_;
+    //! Residual of the previous iteration
+    std::vector<double> fPrev_;
+    //! Image of the previous iteration
+    std::vector<double> gPrev_;
+    //! Maximum norm of the residual of the previous iteration
+    double residualPrev_ = 0;
+};
+
+} // namespace gmx
+
+#endif
@@ -57,8 +57,10 @@
 #include "gromacs/utility/arraysize.h"
 #include "gromacs/utility/cstringutil.h"
 #include "gromacs/utility/dir_separator.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/smalloc.h"
 #include "gromacs/utility/snprintf.h"
 
@@ -2193,14 +2195,14 @@ static const char* find_value(const char* str)
         /* first find the end of the name */
         if (!name_end_found)
         {
-            if (std::isspace(*str) || (*str == '='))
+            if (std::isspace(static_cast<unsigned char>(*str)) || (*str == '='))
             {
                 name_end_found = TRUE;
             }
         }
         else
         {
-            if (!(std::isspace(*str) || (*str == '=')))
+            if (!(std::isspace(static_cast<unsigned char>(*str)) || (*str == '=')))
             {
                 return str;
             }
@@ -2261,7 +2263,7 @@ static gmx_bool read_lambda_compvec(const char*                str,
                 vector        = TRUE;
                 start_reached = TRUE;
             }
-            else if (!std::isspace(*str))
+            else if (!std::isspace(static_cast<unsigned char>(*str)))
             {
                 gmx_fatal(FARGS, "Error in lambda components in %s", fn);
             }
@@ -2270,7 +2272,8 @@ static gmx_bool read_lambda_compvec(const char*                str,
         {
             if (val_start)
             {
-                if (std::isspace(*str) || *str == ')' || *str == ',' || *str == '\0')
+                if (std::isspace(static_cast<unsigned char>(*str)) || *str == ')' || *str == ','
+                    || *str == '\0')
                 {
                     /* end of value */
                     if (lv == nullptr)
@@ -2463,7 +2466,7 @@ static gmx_bool legend2lambda(const char* fn, const char* legend, lambda_vec_t*
                 gmx_fatal(FARGS, "dhdl legend '%s' %s faulty", legend, fn);
             }
             /* now backtrack to the start of the identifier */
-            while (isspace(*ptr))
+            while (std::isspace(static_cast<unsigned char>(*ptr)))
             {
                 end = ptr;
                 ptr--;
@@ -2472,7 +2475,7 @@ static gmx_bool legend2lambda(const char* fn, const char* legend, lambda_vec_t*
                     gmx_fatal(FARGS, "dhdl legend '%s' %s faulty", legend, fn);
                 }
             }
-            while (!std::isspace(*ptr))
+            while (!std::isspace(static_cast<unsigned char>(*ptr)))
             {
                 ptr--;
                 if (ptr < legend)
@@ -3569,15 +3572,37 @@ int gmx_bar(int argc, char* argv[])
         nbmin = nbmax;
     }
 
-    /* first calculate results */
+    /* first calculate results, the lambda pairs are independent and are
+     * computed concurrently, each with its own partial sums for the error
+     * estimate, which are reduced in order afterwards.
+     */
+    const int           partsumSize = (nbmax + 1) * (nbmax + 1);
+    std::vector<double> partsumOfResult(nresults * partsumSize, 0.0);
+    gmx_bool*           bEEOfResult;
+    snew(bEEOfResult, nresults);
+#pragma omp parallel for num_threads(gmx_omp_get_max_threads()) schedule(dynamic)
+    for (f = 0; f < nresults; f++)
+    {
+        try
+        {
+            /* Determine the free energy difference with a factor of 10
+             * more accuracy than requested for printing.
+             */
+            calc_bar(&(results[f]), 0.1 * prec, nbmin, nbmax, &bEEOfResult[f],
+                     partsumOfResult.data() + f * partsumSize);
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+
     bEE      = TRUE;
     disc_err = FALSE;
     for (f = 0; f < nresults; f++)
     {
-        /* Determine the free energy difference with a factor of 10
-         * more accuracy than requested for printing.
-         */
-        calc_bar(&(results[f]), 0.1 * prec, nbmin, nbmax, &bEE, partsum);
+        for (int i = 0; i < partsumSize; i++)
+        {
+            partsum[i] += partsumOfResult[f * partsumSize + i];
+        }
+        bEE = bEE && bEEOfResult[f];
 
         if (results[f].dg_disc_err > prec / 10.)
         {
@@ -3588,6 +3613,7 @@ int gmx_bar(int argc, char* argv[])
             histrange_err = TRUE;
         }
     }
+    sfree(bEEOfResult);
 
     /* print results in kT */
     kT = BOLTZ * temp;
@@ -40,6 +40,10 @@
 #include <cmath>
 #include <cstring>
 
+#include <algorithm>
+#include <functional>
+#include <vector>
+
 #include "gromacs/commandline/pargs.h"
 #include "gromacs/fileio/confio.h"
 #include "gromacs/fileio/matio.h"
@@ -58,9 +62,108 @@
 #include "gromacs/utility/cstringutil.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/smalloc.h"
 #include "gromacs/utility/sysinfo.h"
 
+//! Number of frames that are buffered before they are added to the covariance matrix
+static constexpr int c_frameBlockSize = 32;
+//! Number of matrix elements in a row that are updated together, chosen to stay in L1 cache
+static constexpr int64_t c_columnBlockSize = 512;
+//! Relative residual of the eigenvectors from the iterative solver above which we warn
+static constexpr real c_maxRelativeResidual = 1e-3;
+
+/*! \brief Adds the outer products of a block of deviation vectors to the covariance matrix
+ *
+ * This is a symmetric rank-\p nblock update of the upper triangle of \p mat,
+ * \p dx contains \p nblock vectors of length \p ndim. Each row segment
+ * is updated with all frames in the block while it resides in cache, which
+ * cuts the memory traffic over the matrix by a factor of the block size
+ * compared to adding one frame at a time. Rows are distributed over threads.
+ */
+static void addFrameBlockToCovariance(real* mat, int64_t ndim, const real* dx, int nblock)
+{
+    const int64_t nrow = ndim;
+#pragma omp parallel for num_threads(gmx_omp_get_max_threads()) schedule(dynamic, 16)
+    for (int64_t row = 0; row < nrow; row++)
+    {
+        real* matRow = mat + ndim * row;
+        for (int64_t c0 = row; c0 < ndim; c0 += c_columnBlockSize)
+        {
+            const int64_t c1 = std::min(c0 + c_columnBlockSize, ndim);
+            for (int f = 0; f < nblock; f++)
+            {
+                const real* dxFrame = dx + ndim * f;
+                const real  dxRow   = dxFrame[row];
+                for (int64_t c = c0; c < c1; c++)
+                {
+                    matRow[c] += dxRow * dxFrame[c];
+                }
+            }
+        }
+    }
+}
+
+/*! \brief Computes y = C x for the covariance matrix C given by the stored deviations
+ *
+ * \p dx contains \p nframes scaled deviation vectors d_f of length \p ndim,
+ * such that C = sum_f d_f d_f^T. The product is computed as sum_f d_f (d_f . x)
+ * without constructing C, \p proj is a work array of length \p nframes.
+ */
+static void multiplyFrameCovariance(const real* dx,
+                                    int         nframes,
+                                    int64_t     ndim,
+                                    const real* x,
+                                    real*       y,
+                                    real*       proj)
+{
+#pragma omp parallel for num_threads(gmx_omp_get_max_threads()) schedule(static)
+    for (int f = 0; f < nframes; f++)
+    {
+        const real* dxFrame = dx + ndim * f;
+        real        sum     = 0;
+        for (int64_t c = 0; c < ndim; c++)
+        {
+            sum += dxFrame[c] * x[c];
+        }
+        proj[f] = sum;
+    }
+#pragma omp parallel for num_threads(gmx_omp_get_max_threads()) schedule(static)
+    for (int64_t c0 = 0; c0 < ndim; c0 += c_columnBlockSize)
+    {
+        const int64_t c1 = std::min(c0 + c_columnBlockSize, ndim);
+        for (int64_t c = c0; c < c1; c++)
+        {
+            y[c] = 0;
+        }
+        for (int f = 0; f < nframes; f++)
+        {
+            const real* dxFrame = dx + ndim * f;
+            for (int64_t c = c0; c < c1; c++)
+            {
+                y[c] += proj[f] * dxFrame[c];
+            }
+        }
+    }
+}
+
+//! Computes y = mat x for the symmetric covariance matrix, used by the iterative eigensolver
+static void multiplyCovariance(const real* mat, int64_t ndim, const real* x, real* y)
+{
+    const int64_t nrow = ndim;
+#pragma omp parallel for num_threads(gmx_omp_get_max_threads()) schedule(static)
+    for (int64_t row = 0; row < nrow; row++)
+    {
+        const real* matRow = mat + ndim * row;
+        real        sum    = 0;
+        for (int64_t c = 0; c < ndim; c++)
+        {
+            sum += matRow[c] * x[c];
+        }
+        y[row] = sum;
+    }
+}
+
 int gmx_covar(int argc, char* argv[])
 {
     const char* desc[] = {
@@ -95,10 +198,22 @@ int gmx_covar(int argc, char* argv[])
         "of atoms involved. It is easy to run out of memory, in which",
         "case this tool will probably exit with a 'Segmentation fault'. You",
         "should consider carefully whether a reduced set of atoms will meet",
-        "your needs for lower costs."
+        "your needs for lower costs.",
+        "[PAR]",
+        "With option [TT]-neig[tt] only the given number of eigenvectors with",
+        "the largest eigenvalues are determined, using an iterative Lanczos",
+        "solver instead of full diagonalization. This avoids a second matrix",
+        "of the full size and is much faster for large analysis groups",
+        "when only the first few eigenvectors are of interest.",
+        "When there are fewer frames than degrees of freedom and none of the",
+        "matrix output options are used, the covariance matrix is not",
+        "constructed at all, but applied directly from the stored frames.",
+        "The solver stops with an error when not all requested eigenvectors",
+        "have converged after [TT]-maxiter[tt] restarts.",
+        "The output files have the same format as with full diagonalization."
     };
     static gmx_bool bFit = TRUE, bRef = FALSE, bM = FALSE, bPBC = TRUE;
-    static int      end  = -1;
+    static int      end = -1, neig = 0, maxiter = 1000;
     t_pargs         pa[] = {
         { "-fit", FALSE, etBOOL, { &bFit }, "Fit to a reference structure" },
         { "-ref",
@@ -109,6 +224,17 @@ int gmx_covar(int argc, char* argv[])
           "average" },
         { "-mwa", FALSE, etBOOL, { &bM }, "Mass-weighted covariance analysis" },
         { "-last", FALSE, etINT, { &end }, "Last eigenvector to write away (-1 is till the last)" },
+        { "-neig",
+          FALSE,
+          etINT,
+          { &neig },
+          "Only compute this number of eigenvectors with the largest eigenvalues using an "
+          "iterative solver (0 is all, with full diagonalization)" },
+        { "-maxiter",
+          FALSE,
+          etINT,
+          { &maxiter },
+          "Maximum number of restarts of the iterative solver with -neig" },
         { "-pbc", FALSE, etBOOL, { &bPBC }, "Apply corrections for periodic boundary conditions" }
     };
     FILE*             out = nullptr; /* initialization makes all compilers happy */
@@ -118,12 +244,13 @@ int gmx_covar(int argc, char* argv[])
     t_atoms*          atoms;
     rvec *            x, *xread, *xref, *xav, *xproj;
     matrix            box, zerobox;
-    real *            sqrtm, *mat, *eigenvalues, sum, trace, inv_nframes;
+    real *            sqrtm, *mat, *eigenvalues, *eigvalOut, *dxBlock, sum, trace, inv_nframes;
+    real              maxResidual = 0;
     real              t, tstart, tend, **mat2;
-    real              xj, *w_rls = nullptr;
+    real*             w_rls = nullptr;
     real              min, max, *axis;
-    int               natoms, nat, nframes0, nframes, nlevels;
-    int64_t           ndim, i, j, k, l;
+    int               natoms, nat, nframes0, nframes, nlevels, nInBlock;
+    int64_t           ndim, i, j, k;
     int               WriteXref;
     const char *      fitfile, *trxfile, *ndxfile;
     const char *      eigvalfile, *eigvecfile, *averfile, *logfile;
@@ -254,7 +381,6 @@ int gmx_covar(int argc, char* argv[])
     {
         gmx_fatal(FARGS, "Number of degrees of freedoms to large for matrix.\n");
     }
-    snew(mat, ndim * ndim);
 
     fprintf(stderr, "Calculating the average structure ...\n");
     nframes0 = 0;
@@ -297,10 +423,34 @@ int gmx_covar(int argc, char* argv[])
                            PbcType::No, zerobox, natoms, index);
     sfree(xread);
 
-    fprintf(stderr, "Constructing covariance matrix (%dx%d) ...\n", static_cast<int>(ndim),
-            static_cast<int>(ndim));
-    nframes = 0;
-    nat     = read_first_x(oenv, &status, trxfile, &t, &xread, box);
+    if (neig >= ndim)
+    {
+        neig = 0;
+    }
+    /* The iterative solver only needs products of the covariance matrix with
+     * vectors. With fewer frames than degrees of freedom, storing the deviations
+     * of all frames takes less memory than the matrix, so we use those directly.
+     */
+    const bool bStoreFrames =
+            (neig > 0 && nframes0 < ndim && !asciifile && !xpmfile && !xpmafile);
+    std::vector<real> dxFrames;
+    if (bStoreFrames)
+    {
+        fprintf(stderr, "Storing the deviations of %d frames ...\n", nframes0);
+        dxFrames.reserve(ndim * nframes0);
+        mat     = nullptr;
+        dxBlock = nullptr;
+    }
+    else
+    {
+        fprintf(stderr, "Constructing covariance matrix (%dx%d) ...\n", static_cast<int>(ndim),
+                static_cast<int>(ndim));
+        snew(mat, ndim * ndim);
+        snew(dxBlock, ndim * c_frameBlockSize);
+    }
+    nframes  = 0;
+    nInBlock = 0;
+    nat      = read_first_x(oenv, &status, trxfile, &t, &xread, box);
     tstart  = t;
     do
     {
@@ -331,25 +481,26 @@ int gmx_covar(int argc, char* argv[])
             }
         }
 
-        for (j = 0; j < natoms; j++)
+        if (bStoreFrames)
         {
-            for (dj = 0; dj < DIM; dj++)
-            {
-                k  = ndim * (DIM * j + dj);
-                xj = x[j][dj];
-                for (i = j; i < natoms; i++)
-                {
-                    l = k + DIM * i;
-                    for (d = 0; d < DIM; d++)
-                    {
-                        mat[l + d] += x[i][d] * xj;
-                    }
-                }
-            }
+            dxFrames.insert(dxFrames.end(), x[0], x[0] + ndim);
+            continue;
+        }
+        std::memcpy(dxBlock + ndim * nInBlock, x[0], ndim * sizeof(real));
+        nInBlock++;
+        if (nInBlock == c_frameBlockSize)
+        {
+            addFrameBlockToCovariance(mat, ndim, dxBlock, nInBlock);
+            nInBlock = 0;
         }
     } while (read_next_x(oenv, status, &t, xread, box) && (bRef || nframes < nframes0));
     close_trx(status);
     gmx_rmpbc_done(gpbc);
+    if (nInBlock > 0)
+    {
+        addFrameBlockToCovariance(mat, ndim, dxBlock, nInBlock);
+    }
+    sfree(dxBlock);
 
     fprintf(stderr, "Read %d frames\n", nframes);
 
@@ -367,36 +518,57 @@ int gmx_covar(int argc, char* argv[])
         xproj = xav;
     }
 
-    /* correct the covariance matrix for the mass */
     inv_nframes = 1.0 / nframes;
-    for (j = 0; j < natoms; j++)
+    if (bStoreFrames)
     {
-        for (dj = 0; dj < DIM; dj++)
+        /* scale the deviations such that the covariance matrix is sum_f dx_f dx_f^T */
+        const real frameScale = std::sqrt(inv_nframes);
+        trace                 = 0;
+        for (int f = 0; f < nframes; f++)
         {
-            for (i = j; i < natoms; i++)
+            for (i = 0; i < natoms; i++)
             {
-                k = ndim * (DIM * j + dj) + DIM * i;
                 for (d = 0; d < DIM; d++)
                 {
-                    mat[k + d] = mat[k + d] * inv_nframes * sqrtm[i] * sqrtm[j];
+                    real& dx = dxFrames[ndim * f + DIM * i + d];
+                    dx *= frameScale * sqrtm[i];
+                    trace += dx * dx;
                 }
             }
         }
     }
-
-    /* symmetrize the matrix */
-    for (j = 0; j < ndim; j++)
+    else
     {
-        for (i = j; i < ndim; i++)
+        /* correct the covariance matrix for the mass */
+        for (j = 0; j < natoms; j++)
+        {
+            for (dj = 0; dj < DIM; dj++)
+            {
+                for (i = j; i < natoms; i++)
+                {
+                    k = ndim * (DIM * j + dj) + DIM * i;
+                    for (d = 0; d < DIM; d++)
+                    {
+                        mat[k + d] = mat[k + d] * inv_nframes * sqrtm[i] * sqrtm[j];
+                    }
+                }
+            }
+        }
+
+        /* symmetrize the matrix */
+        for (j = 0; j < ndim; j++)
         {
-            mat[ndim * i + j] = mat[ndim * j + i];
+            for (i = j; i < ndim; i++)
+            {
+                mat[ndim * i + j] = mat[ndim * j + i];
+            }
         }
-    }
 
-    trace = 0;
-    for (i = 0; i < ndim; i++)
-    {
-        trace += mat[i * ndim + i];
+        trace = 0;
+        for (i = 0; i < ndim; i++)
+        {
+            trace += mat[i * ndim + i];
+        }
     }
     fprintf(stderr, "\nTrace of the covariance matrix: %g (%snm^2)\n", trace, bM ? "u " : "");
 
@@ -517,13 +689,81 @@ int gmx_covar(int argc, char* argv[])
     /* call diagonalization routine */
 
     snew(eigenvalues, ndim);
-    snew(eigenvectors, ndim * ndim);
 
-    std::memcpy(eigenvectors, mat, ndim * ndim * sizeof(real));
-    fprintf(stderr, "\nDiagonalizing ...\n");
-    fflush(stderr);
-    eigensolver(eigenvectors, ndim, 0, ndim, eigenvalues, mat);
-    sfree(eigenvectors);
+    if (neig > 0)
+    {
+        /* Only determine the leading eigenvectors. The eigenvalues are stored
+         * at the end of eigenvalues in ascending order, as the full
+         * diagonalization does, the eigenvectors are reordered below.
+         */
+        std::vector<real>                 proj(nframes);
+        std::function<void(real*, real*)> multiply;
+        if (bStoreFrames)
+        {
+            multiply = [&dxFrames, &proj, nframes, ndim](real* xv, real* yv) {
+                multiplyFrameCovariance(dxFrames.data(), nframes, ndim, xv, yv, proj.data());
+            };
+        }
+        else
+        {
+            multiply = [mat, ndim](real* xv, real* yv) { multiplyCovariance(mat, ndim, xv, yv); };
+        }
+        snew(eigenvectors, ndim * neig);
+        fprintf(stderr, "\nDiagonalizing to find eigenvectors 1 through %d ...\n", neig);
+        fflush(stderr);
+        largest_eigensolver(static_cast<int>(ndim), neig, multiply, eigenvalues + ndim - neig,
+                            eigenvectors, maxiter);
+
+        /* Check the eigenpairs, since the solver only estimates the residuals */
+        std::vector<real> av(ndim);
+        maxResidual = 0;
+        for (j = 0; j < neig; j++)
+        {
+            real* v      = eigenvectors + ndim * j;
+            real  lambda = eigenvalues[ndim - neig + j];
+            multiply(v, av.data());
+            real norm2 = 0;
+            for (i = 0; i < ndim; i++)
+            {
+                norm2 += gmx::square(av[i] - lambda * v[i]);
+            }
+            maxResidual = std::max(maxResidual, std::sqrt(norm2));
+        }
+        maxResidual /= std::max(std::abs(eigenvalues[ndim - 1]), GMX_REAL_MIN);
+        fprintf(stderr, "Maximum relative residual of the eigenvectors: %g\n", maxResidual);
+        if (maxResidual > c_maxRelativeResidual)
+        {
+            fprintf(stderr,
+                    "\nWARNING: the eigenvectors have not converged to a relative residual "
+                    "of %g,\n         consider increasing -maxiter\n",
+                    c_maxRelativeResidual);
+        }
+
+        /* Store the eigenvectors and -values in descending order for writing */
+        for (j = 0; j < neig / 2; j++)
+        {
+            std::swap_ranges(eigenvectors + ndim * j, eigenvectors + ndim * (j + 1),
+                             eigenvectors + ndim * (neig - 1 - j));
+        }
+        snew(eigvalOut, neig);
+        for (j = 0; j < neig; j++)
+        {
+            eigvalOut[j] = eigenvalues[ndim - 1 - j];
+        }
+    }
+    else
+    {
+        snew(eigenvectors, ndim * ndim);
+
+        std::memcpy(eigenvectors, mat, ndim * ndim * sizeof(real));
+        fprintf(stderr, "\nDiagonalizing ...\n");
+        fflush(stderr);
+        eigensolver(eigenvectors, ndim, 0, ndim, eigenvalues, mat);
+        sfree(eigenvectors);
+        /* The eigenvectors are stored in mat in ascending order */
+        eigenvectors = mat;
+        eigvalOut    = eigenvalues;
+    }
 
     /* now write the output */
 
@@ -532,14 +772,19 @@ int gmx_covar(int argc, char* argv[])
     {
         sum += eigenvalues[i];
     }
-    fprintf(stderr, "\nSum of the eigenvalues: %g (%snm^2)\n", sum, bM ? "u " : "");
-    if (std::abs(trace - sum) > 0.01 * trace)
+    fprintf(stderr, "\nSum of the %seigenvalues: %g (%snm^2)\n", neig > 0 ? "computed " : "", sum,
+            bM ? "u " : "");
+    if (neig == 0 && std::abs(trace - sum) > 0.01 * trace)
     {
         fprintf(stderr,
                 "\nWARNING: eigenvalue sum deviates from the trace of the covariance matrix\n");
     }
 
     /* Set 'end', the maximum eigenvector and -value index used for output */
+    if (neig > 0 && (end == -1 || end > neig))
+    {
+        end = neig;
+    }
     if (end == -1)
     {
         if (nframes - 1 < ndim)
@@ -588,8 +833,8 @@ int gmx_covar(int argc, char* argv[])
         WriteXref = eWXR_NOFIT;
     }
 
-    write_eigenvectors(eigvecfile, natoms, mat, TRUE, 1, end, WriteXref, x, bDiffMass1, xproj, bM,
-                       eigenvalues);
+    write_eigenvectors(eigvecfile, natoms, eigenvectors, neig == 0, 1, end, WriteXref, x,
+                       bDiffMass1, xproj, bM, eigvalOut);
 
     out = gmx_ffopen(logfile, "w");
 
@@ -627,10 +872,21 @@ int gmx_covar(int argc, char* argv[])
     {
         fprintf(out, "Fit is %smass weighted\n", bDiffMass1 ? "" : "non-");
     }
-    fprintf(out, "Diagonalized the %dx%d covariance matrix\n", static_cast<int>(ndim),
-            static_cast<int>(ndim));
-    fprintf(out, "Trace of the covariance matrix before diagonalizing: %g\n", trace);
-    fprintf(out, "Trace of the covariance matrix after diagonalizing: %g\n\n", sum);
+    if (neig > 0)
+    {
+        fprintf(out, "Determined the %d largest eigenvalues of the %dx%d covariance matrix\n",
+                neig, static_cast<int>(ndim), static_cast<int>(ndim));
+        fprintf(out, "Trace of the covariance matrix: %g\n", trace);
+        fprintf(out, "Sum of the computed eigenvalues: %g\n", sum);
+        fprintf(out, "Maximum relative residual of the eigenvectors: %g\n\n", maxResidual);
+    }
+    else
+    {
+        fprintf(out, "Diagonalized the %dx%d covariance matrix\n", static_cast<int>(ndim),
+                static_cast<int>(ndim));
+        fprintf(out, "Trace of the covariance matrix before diagonalizing: %g\n", trace);
+        fprintf(out, "Trace of the covariance matrix after diagonalizing: %g\n\n", sum);
+    }
 
     fprintf(out, "Wrote %d eigenvalues to %s\n", static_cast<int>(end), eigvalfile);
     if (WriteXref == eWXR_YES)
@@ -42,11 +42,14 @@
 #include <cstdlib>
 #include <cstring>
 
+#include <vector>
+
 #include "gromacs/commandline/pargs.h"
 #include "gromacs/commandline/viewit.h"
 #include "gromacs/fileio/trxio.h"
 #include "gromacs/fileio/xvgr.h"
 #include "gromacs/gmxana/gmx_ana.h"
+#include "gromacs/gmxana/gridbinning.h"
 #include "gromacs/gmxana/gstat.h"
 #include "gromacs/math/units.h"
 #include "gromacs/math/vec.h"
@@ -168,6 +171,61 @@ static void center_coords(t_atoms* atoms, const int* index_center, int ncenter,
     }
 }
 
+/*! \brief Returns the slice along \p axis of coordinate \p z
+ *
+ * \p z is put in the box first, \p boxSz and \p slWidth are in relative
+ * units when \p bRelative is set.
+ */
+static int slice_of_coordinate(real         z,
+                               const matrix box,
+                               int          axis,
+                               int          nslices,
+                               real         slWidth,
+                               real         boxSz,
+                               gmx_bool     bCenter,
+                               gmx_bool     bRelative)
+{
+    while (z < 0)
+    {
+        z += box[axis][axis];
+    }
+    while (z > box[axis][axis])
+    {
+        z -= box[axis][axis];
+    }
+
+    if (bRelative)
+    {
+        z = z / box[axis][axis];
+    }
+
+    /* determine which slice atom is in */
+    int slice;
+    if (bCenter)
+    {
+        slice = static_cast<int>(std::floor((z - (boxSz / 2.0)) / slWidth) + nslices / 2.);
+    }
+    else
+    {
+        slice = static_cast<int>(std::floor(z / slWidth));
+    }
+
+    /* Slice should already be 0<=slice<nslices, but we just make
+     * sure we are not hit by IEEE rounding errors since we do
+     * math operations after applying PBC above.
+     */
+    if (slice < 0)
+    {
+        slice += nslices;
+    }
+    else if (slice >= nslices)
+    {
+        slice -= nslices;
+    }
+
+    return slice;
+}
+
 static void calc_electron_density(const char*             fn,
                                   int**                   index,
                                   const int               gnx[],
@@ -192,14 +250,13 @@ static void calc_electron_density(const char*             fn,
     int          natoms; /* nr. atoms in trj */
     t_trxstatus* status;
     int          i, n,     /* loop indices */
-            nr_frames = 0, /* number of frames */
-            slice;         /* current slice */
+            nr_frames = 0; /* number of frames */
     t_electron* found;     /* found by bsearch */
     t_electron  sought;    /* thingie thought by bsearch */
     real        boxSz, aveBox;
     gmx_rmpbc_t gpbc = nullptr;
 
-    real t, z;
+    real t;
 
     if (axis < 0 || axis >= DIM)
     {
@@ -225,6 +282,37 @@ static void calc_electron_density(const char*             fn,
         snew((*slDensity)[i], *nslices);
     }
 
+    /* Look up the number of electrons of all atoms once */
+    std::vector<real> electrons(top->atoms.nr, 0);
+    std::vector<bool> bHaveElectrons(top->atoms.nr, false);
+    for (n = 0; n < nr_grps; n++)
+    {
+        for (i = 0; i < gnx[n]; i++)
+        {
+            const int a     = index[n][i];
+            sought.nr_el    = 0;
+            sought.atomname = gmx_strdup(*(top->atoms.atomname[a]));
+
+            found = static_cast<t_electron*>(
+                    bsearch(&sought, eltab, nr, sizeof(t_electron),
+                            reinterpret_cast<int (*)(const void*, const void*)>(compare)));
+
+            if (found == nullptr)
+            {
+                fprintf(stderr, "Couldn't find %s. Add it to the .dat file\n",
+                        *(top->atoms.atomname[a]));
+            }
+            else
+            {
+                electrons[a]      = found->nr_el - top->atoms.atom[a].q;
+                bHaveElectrons[a] = true;
+            }
+            free(sought.atomname);
+        }
+    }
+
+    gmx::GridBinner binner({ nr_grps, *nslices, 1 });
+
     gpbc = gmx_rmpbc_init(&top->idef, pbcType, top->atoms.nr);
     /*********** Start processing trajectory ***********/
     do
@@ -256,51 +344,18 @@ static void calc_electron_density(const char*             fn,
 
         for (n = 0; n < nr_grps; n++)
         {
-            for (i = 0; i < gnx[n]; i++) /* loop over all atoms in index file */
-            {
-                z = x0[index[n][i]][axis];
-                while (z < 0)
-                {
-                    z += box[axis][axis];
-                }
-                while (z > box[axis][axis])
-                {
-                    z -= box[axis][axis];
-                }
-
-                if (bRelative)
-                {
-                    z = z / box[axis][axis];
-                }
-
-                /* determine which slice atom is in */
-                if (bCenter)
+            binner.addPoints(gnx[n], [&, n](int i, real* weight) {
+                const int a = index[n][i];
+                if (!bHaveElectrons[a])
                 {
-                    slice = static_cast<int>(std::floor((z - (boxSz / 2.0)) / (*slWidth)) + *nslices / 2.);
+                    return -1;
                 }
-                else
-                {
-                    slice = static_cast<int>(z / (*slWidth));
-                }
-                sought.nr_el    = 0;
-                sought.atomname = gmx_strdup(*(top->atoms.atomname[index[n][i]]));
-
-                /* now find the number of electrons. This is not efficient. */
-                found = static_cast<t_electron*>(
-                        bsearch(&sought, eltab, nr, sizeof(t_electron),
-                                reinterpret_cast<int (*)(const void*, const void*)>(compare)));
-
-                if (found == nullptr)
-                {
-                    fprintf(stderr, "Couldn't find %s. Add it to the .dat file\n",
-                            *(top->atoms.atomname[index[n][i]]));
-                }
-                else
-                {
-                    (*slDensity)[n][slice] += (found->nr_el - top->atoms.atom[index[n][i]].q) * invvol;
-                }
-                free(sought.atomname);
-            }
+                *weight = electrons[a] * invvol;
+                return binner.binIndex(n,
+                                       slice_of_coordinate(x0[a][axis], box, axis, *nslices,
+                                                           *slWidth, boxSz, bCenter, bRelative),
+                                       0);
+            });
         }
         nr_frames++;
     } while (read_next_x(oenv, status, &t, x0, box));
@@ -321,11 +376,12 @@ static void calc_electron_density(const char*             fn,
         *slWidth = aveBox / (*nslices);
     }
 
+    gmx::ArrayRef<const double> binSums = binner.reduce();
     for (n = 0; n < nr_grps; n++)
     {
         for (i = 0; i < *nslices; i++)
         {
-            (*slDensity)[n][i] /= nr_frames;
+            (*slDensity)[n][i] = binSums[binner.binIndex(n, i, 0)] / nr_frames;
         }
     }
 
@@ -355,9 +411,8 @@ static void calc_density(const char*             fn,
     int          natoms; /* nr. atoms in trj */
     t_trxstatus* status;
     int          i, n,     /* loop indices */
-            nr_frames = 0, /* number of frames */
-            slice;         /* current slice */
-    real        t, z;
+            nr_frames = 0; /* number of frames */
+    real        t;
     real        boxSz, aveBox;
     real*       den_val; /* values from which the density is calculated */
     gmx_rmpbc_t gpbc = nullptr;
@@ -386,6 +441,8 @@ static void calc_density(const char*             fn,
         snew((*slDensity)[i], *nslices);
     }
 
+    gmx::GridBinner binner({ nr_grps, *nslices, 1 });
+
     gpbc = gmx_rmpbc_init(&top->idef, pbcType, top->atoms.nr);
     /*********** Start processing trajectory ***********/
 
@@ -441,48 +498,14 @@ static void calc_density(const char*             fn,
 
         for (n = 0; n < nr_grps; n++)
         {
-            for (i = 0; i < gnx[n]; i++) /* loop over all atoms in index file */
-            {
-                z = x0[index[n][i]][axis];
-                while (z < 0)
-                {
-                    z += box[axis][axis];
-                }
-                while (z > box[axis][axis])
-                {
-                    z -= box[axis][axis];
-                }
-
-                if (bRelative)
-                {
-                    z = z / box[axis][axis];
-                }
-
-                /* determine which slice atom is in */
-                if (bCenter)
-                {
-                    slice = static_cast<int>(std::floor((z - (boxSz / 2.0)) / (*slWidth)) + *nslices / 2.);
-                }
-                else
-                {
-                    slice = static_cast<int>(std::floor(z / (*slWidth)));
-                }
-
-                /* Slice should already be 0<=slice<nslices, but we just make
-                 * sure we are not hit by IEEE rounding errors since we do
-                 * math operations after applying PBC above.
-                 */
-                if (slice < 0)
-                {
-                    slice += *nslices;
-                }
-                else if (slice >= *nslices)
-                {
-                    slice -= *nslices;
-                }
-
-                (*slDensity)[n][slice] += den_val[index[n][i]] * invvol;
-            }
+            binner.addPoints(gnx[n], [&, n](int i, real* weight) {
+                const int a = index[n][i];
+                *weight     = den_val[a] * invvol;
+                return binner.binIndex(n,
+                                       slice_of_coordinate(x0[a][axis], box, axis, *nslices,
+                                                           *slWidth, boxSz, bCenter, bRelative),
+                                       0);
+            });
         }
         nr_frames++;
     } while (read_next_x(oenv, status, &t, x0, box));
@@ -503,11 +526,12 @@ static void calc_density(const char*             fn,
         *slWidth = aveBox / (*nslices);
     }
 
+    gmx::ArrayRef<const double> binSums = binner.reduce();
     for (n = 0; n < nr_grps; n++)
     {
         for (i = 0; i < *nslices; i++)
         {
-            (*slDensity)[n][i] /= nr_frames;
+            (*slDensity)[n][i] = binSums[binner.binIndex(n, i, 0)] / nr_frames;
         }
     }
 
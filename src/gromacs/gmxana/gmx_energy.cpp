@@ -42,6 +42,7 @@
 #include <cstring>
 
 #include <algorithm>
+#include <vector>
 
 #include "gromacs/commandline/pargs.h"
 #include "gromacs/commandline/viewit.h"
@@ -64,6 +65,7 @@
 #include "gromacs/topology/mtop_util.h"
 #include "gromacs/topology/topology.h"
 #include "gromacs/trajectory/energyframe.h"
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/arraysize.h"
 #include "gromacs/utility/cstringutil.h"
 #include "gromacs/utility/fatalerror.h"
@@ -1894,23 +1896,80 @@ int gmx_energy(int argc, char* argv[])
     edat.bHaveSums = TRUE;
     snew(edat.s, nset);
 
+    /* Without dH/dl output we only need the selected terms, which we read
+     * as columns using a frame index. Old format files are read sequentially.
+     */
+    t_enxframeindex  frameIndex;
+    t_enxcolumns     columns;
+    std::vector<int> indexedFrames;
+    size_t           nextIndexedFrame = 0;
+    const gmx_bool   bIndexed         = !bDHDL && build_enx_frame_index(fp, &frameIndex);
+    if (bIndexed)
+    {
+        for (size_t f = 0; f < frameIndex.t.size(); f++)
+        {
+            timecheck = check_times(frameIndex.t[f]);
+            if (timecheck > 0)
+            {
+                break;
+            }
+            if (timecheck == 0 && frameIndex.nre[f] > 0)
+            {
+                indexedFrames.push_back(f);
+            }
+        }
+        read_enx_columns(fp, frameIndex, indexedFrames, gmx::arrayRefFromArray(set, nset), TRUE,
+                         &columns);
+    }
+
     /* Initiate counters */
     bFoundStart = FALSE;
     start_step  = 0;
     start_t     = 0;
     do
     {
-        /* This loop searches for the first frame (when -b option is given),
-         * or when this has been found it reads just one energy frame
-         */
-        do
+        if (bIndexed)
         {
-            bCont = do_enx(fp, &(frame[NEXT]));
+            /* Fill the frame with the header and the selected terms only */
+            bCont     = (nextIndexedFrame < indexedFrames.size());
+            timecheck = 0;
             if (bCont)
             {
-                timecheck = check_times(frame[NEXT].t);
+                const int   f  = indexedFrames[nextIndexedFrame];
+                t_enxframe* fnext = &(frame[NEXT]);
+                fnext->t          = frameIndex.t[f];
+                fnext->step       = frameIndex.step[f];
+                fnext->nsteps     = frameIndex.nsteps[f];
+                fnext->nsum       = frameIndex.nsum[f];
+                fnext->nre        = frameIndex.nre[f];
+                if (fnext->nre > fnext->e_alloc)
+                {
+                    srenew(fnext->ener, fnext->nre);
+                    fnext->e_alloc = fnext->nre;
+                }
+                for (i = 0; i < nset; i++)
+                {
+                    fnext->ener[set[i]].e    = columns.e[i][nextIndexedFrame];
+                    fnext->ener[set[i]].eav  = columns.eav[i][nextIndexedFrame];
+                    fnext->ener[set[i]].esum = columns.esum[i][nextIndexedFrame];
+                }
+                nextIndexedFrame++;
             }
-        } while (bCont && (timecheck < 0));
+        }
+        else
+        {
+            /* This loop searches for the first frame (when -b option is given),
+             * or when this has been found it reads just one energy frame
+             */
+            do
+            {
+                bCont = do_enx(fp, &(frame[NEXT]));
+                if (bCont)
+                {
+                    timecheck = check_times(frame[NEXT].t);
+                }
+            } while (bCont && (timecheck < 0));
+        }
 
         if ((timecheck == 0) && bCont)
         {
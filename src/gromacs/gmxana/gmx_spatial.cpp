@@ -39,10 +39,13 @@
 #include <cmath>
 #include <cstdlib>
 
+#include <algorithm>
+
 #include "gromacs/commandline/pargs.h"
 #include "gromacs/fileio/confio.h"
 #include "gromacs/fileio/trxio.h"
 #include "gromacs/gmxana/gmx_ana.h"
+#include "gromacs/gmxana/gridbinning.h"
 #include "gromacs/math/vec.h"
 #include "gromacs/pbcutil/pbc.h"
 #include "gromacs/pbcutil/rmpbc.h"
@@ -127,6 +130,7 @@ int gmx_spatial(int argc, char* argv[])
     static real     rBINWIDTH    = 0.05; /* nm */
     static gmx_bool bCALCDIV     = TRUE;
     static int      iNAB         = 4;
+    static real     rSIGMA       = 0; /* nm */
 
     t_pargs pa[] = { { "-pbc",
                        FALSE,
@@ -153,7 +157,13 @@ int gmx_spatial(int argc, char* argv[])
                        FALSE,
                        etINT,
                        { &iNAB },
-                       "Number of additional bins to ensure proper memory allocation" } };
+                       "Number of additional bins to ensure proper memory allocation" },
+                     { "-sigma",
+                       FALSE,
+                       etREAL,
+                       { &rSIGMA },
+                       "When > 0, spread each atom as a Gaussian with this width (nm) instead of "
+                       "binning it" } };
 
     double            MINBIN[3];
     double            MAXBIN[3];
@@ -172,12 +182,11 @@ int gmx_spatial(int argc, char* argv[])
     int               i, nidx, nidxp;
     int               v;
     int               j, k;
-    int***            bin = nullptr;
     int               nbin[3];
     FILE*             flp;
-    int               x, y, z, minx, miny, minz, maxx, maxy, maxz;
+    int               minx, miny, minz, maxx, maxy, maxz;
     int               numfr, numcu;
-    int               tot, maxval, minval;
+    double            tot, maxval, minval;
     double            norm;
     gmx_output_env_t* oenv;
     gmx_rmpbc_t       gpbc = nullptr;
@@ -246,19 +255,13 @@ int gmx_spatial(int argc, char* argv[])
         MINBIN[i] -= iNAB * rBINWIDTH;
         nbin[i] = static_cast<int>(std::ceil((MAXBIN[i] - MINBIN[i]) / rBINWIDTH));
     }
-    snew(bin, nbin[XX]);
-    for (i = 0; i < nbin[XX]; ++i)
+    gmx::GridBinner binner({ nbin[XX], nbin[YY], nbin[ZZ] });
+    if (rSIGMA > 0)
     {
-        snew(bin[i], nbin[YY]);
-        for (j = 0; j < nbin[YY]; ++j)
-        {
-            snew(bin[i][j], nbin[ZZ]);
-        }
+        binner.setGaussianSpreading(rSIGMA / rBINWIDTH, 4);
     }
     copy_mat(box, box_pbc);
     numfr = 0;
-    minx = miny = minz = 999;
-    maxx = maxy = maxz = 0;
 
     if (bPBC)
     {
@@ -276,48 +279,59 @@ int gmx_spatial(int argc, char* argv[])
             set_pbc(&pbc, pbcType, box_pbc);
         }
 
-        for (i = 0; i < nidx; i++)
+        auto isOutside = [&](int i) {
+            const rvec& x = fr.x[index[i]];
+            return (x[XX] < MINBIN[XX] || x[XX] > MAXBIN[XX] || x[YY] < MINBIN[YY]
+                    || x[YY] > MAXBIN[YY] || x[ZZ] < MINBIN[ZZ] || x[ZZ] > MAXBIN[ZZ]);
+        };
+        int numOutside;
+        if (rSIGMA > 0)
         {
-            if (fr.x[index[i]][XX] < MINBIN[XX] || fr.x[index[i]][XX] > MAXBIN[XX]
-                || fr.x[index[i]][YY] < MINBIN[YY] || fr.x[index[i]][YY] > MAXBIN[YY]
-                || fr.x[index[i]][ZZ] < MINBIN[ZZ] || fr.x[index[i]][ZZ] > MAXBIN[ZZ])
-            {
-                printf("There was an item outside of the allocated memory. Increase the value "
-                       "given with the -nab option.\n");
-                printf("Memory was allocated for [%f,%f,%f]\tto\t[%f,%f,%f]\n", MINBIN[XX],
-                       MINBIN[YY], MINBIN[ZZ], MAXBIN[XX], MAXBIN[YY], MAXBIN[ZZ]);
-                printf("Memory was required for [%f,%f,%f]\n", fr.x[index[i]][XX],
-                       fr.x[index[i]][YY], fr.x[index[i]][ZZ]);
-                exit(1);
-            }
-            x = static_cast<int>(std::ceil((fr.x[index[i]][XX] - MINBIN[XX]) / rBINWIDTH));
-            y = static_cast<int>(std::ceil((fr.x[index[i]][YY] - MINBIN[YY]) / rBINWIDTH));
-            z = static_cast<int>(std::ceil((fr.x[index[i]][ZZ] - MINBIN[ZZ]) / rBINWIDTH));
-            ++bin[x][y][z];
-            if (x < minx)
-            {
-                minx = x;
-            }
-            if (x > maxx)
-            {
-                maxx = x;
-            }
-            if (y < miny)
-            {
-                miny = y;
-            }
-            if (y > maxy)
-            {
-                maxy = y;
-            }
-            if (z < minz)
+            /* The center of bin k is at (k - 0.5)*rBINWIDTH from MINBIN */
+            auto positionOfAtom = [&](int i, gmx::RVec* position, real* amplitude) {
+                for (int d = 0; d < DIM; d++)
+                {
+                    (*position)[d] = (fr.x[index[i]][d] - MINBIN[d]) / rBINWIDTH + 0.5;
+                }
+                *amplitude = 1;
+                return !isOutside(i);
+            };
+            numOutside = binner.spreadPoints(nidx, positionOfAtom);
+        }
+        else
+        {
+            auto binOfAtom = [&](int i, real* weight) {
+                int b[DIM];
+                for (int d = 0; d < DIM; d++)
+                {
+                    b[d] = static_cast<int>(std::ceil((fr.x[index[i]][d] - MINBIN[d]) / rBINWIDTH));
+                }
+                if (isOutside(i) || b[XX] >= nbin[XX] || b[YY] >= nbin[YY] || b[ZZ] >= nbin[ZZ])
+                {
+                    return -1;
+                }
+                *weight = 1;
+                return binner.binIndex(b[XX], b[YY], b[ZZ]);
+            };
+            numOutside = binner.addPoints(nidx, binOfAtom);
+        }
+        if (numOutside > 0)
+        {
+            i = 0;
+            while (i < nidx && !isOutside(i))
             {
-                minz = z;
+                i++;
             }
-            if (z > maxz)
+            printf("There was an item outside of the allocated memory. Increase the value "
+                   "given with the -nab option.\n");
+            printf("Memory was allocated for [%f,%f,%f]\tto\t[%f,%f,%f]\n", MINBIN[XX],
+                   MINBIN[YY], MINBIN[ZZ], MAXBIN[XX], MAXBIN[YY], MAXBIN[ZZ]);
+            if (i < nidx)
             {
-                maxz = z;
+                printf("Memory was required for [%f,%f,%f]\n", fr.x[index[i]][XX],
+                       fr.x[index[i]][YY], fr.x[index[i]][ZZ]);
             }
+            exit(1);
         }
         numfr++;
         /* printf("%f\t%f\t%f\n",box[XX][XX],box[YY][YY],box[ZZ][ZZ]); */
@@ -329,6 +343,30 @@ int gmx_spatial(int argc, char* argv[])
         gmx_rmpbc_done(gpbc);
     }
 
+    gmx::ArrayRef<const double> bin = binner.reduce();
+
+    /* Determine the range of occupied bins */
+    minx = miny = minz = 999;
+    maxx = maxy = maxz = 0;
+    for (k = 0; k < nbin[XX]; k++)
+    {
+        for (j = 0; j < nbin[YY]; j++)
+        {
+            for (i = 0; i < nbin[ZZ]; i++)
+            {
+                if (bin[binner.binIndex(k, j, i)] != 0)
+                {
+                    minx = std::min(minx, k);
+                    maxx = std::max(maxx, k);
+                    miny = std::min(miny, j);
+                    maxy = std::max(maxy, j);
+                    minz = std::min(minz, i);
+                    maxz = std::max(maxz, i);
+                }
+            }
+        }
+    }
+
     if (!bCUTDOWN)
     {
         minx = miny = minz = 0;
@@ -397,11 +435,11 @@ int gmx_spatial(int argc, char* argv[])
                 {
                     continue;
                 }
-                if (bin[k][j][i] != 0)
+                if (bin[binner.binIndex(k, j, i)] != 0)
                 {
                     printf("A bin was not empty when it should have been empty. Programming "
                            "error.\n");
-                    printf("bin[%d][%d][%d] was = %d\n", k, j, i, bin[k][j][i]);
+                    printf("bin[%d][%d][%d] was = %g\n", k, j, i, bin[binner.binIndex(k, j, i)]);
                     exit(1);
                 }
             }
@@ -428,14 +466,14 @@ int gmx_spatial(int argc, char* argv[])
                 {
                     continue;
                 }
-                tot += bin[k][j][i];
-                if (bin[k][j][i] > maxval)
+                tot += bin[binner.binIndex(k, j, i)];
+                if (bin[binner.binIndex(k, j, i)] > maxval)
                 {
-                    maxval = bin[k][j][i];
+                    maxval = bin[binner.binIndex(k, j, i)];
                 }
-                if (bin[k][j][i] < minval)
+                if (bin[binner.binIndex(k, j, i)] < minval)
                 {
-                    minval = bin[k][j][i];
+                    minval = bin[binner.binIndex(k, j, i)];
                 }
             }
         }
@@ -445,7 +483,7 @@ int gmx_spatial(int argc, char* argv[])
             * (maxz - minz + 1 - (2 * iIGNOREOUTER));
     if (bCALCDIV)
     {
-        norm = static_cast<double>(numcu * numfr) / tot;
+        norm = numcu * numfr / tot;
     }
     else
     {
@@ -470,7 +508,7 @@ int gmx_spatial(int argc, char* argv[])
                 {
                     continue;
                 }
-                fprintf(flp, "%12.6f ", static_cast<double>(norm * bin[k][j][i]) / numfr);
+                fprintf(flp, "%12.6f ", norm * bin[binner.binIndex(k, j, i)] / numfr);
             }
             fprintf(flp, "\n");
         }
@@ -487,8 +525,8 @@ int gmx_spatial(int argc, char* argv[])
     else
     {
         printf("grid.cube contains counts per frame in all %d cubes\n", numcu);
-        printf("Raw data: average %le, min %le, max %le\n", 1.0 / norm,
-               static_cast<double>(minval) / numfr, static_cast<double>(maxval) / numfr);
+        printf("Raw data: average %le, min %le, max %le\n", 1.0 / norm, minval / numfr,
+               maxval / numfr);
     }
 
     return 0;
@@ -54,10 +54,12 @@
 
 #include <algorithm>
 #include <sstream>
+#include <vector>
 
 #include "gromacs/commandline/pargs.h"
 #include "gromacs/fileio/tpxio.h"
 #include "gromacs/fileio/xvgr.h"
+#include "gromacs/gmxana/andersonmixer.h"
 #include "gromacs/gmxana/gmx_ana.h"
 #include "gromacs/math/functions.h"
 #include "gromacs/math/units.h"
@@ -237,6 +239,7 @@ typedef struct UmbrellaOptions // NOLINT(clang-analyzer-optin.performance.Paddin
 
     gmx_bool bInitPotByIntegration; //!< before WHAM, guess potential by force integration. Yields 1.5 to 2 times faster convergence
     int stepUpdateContrib; //!< update contribution table every ... iterations. Accelerates WHAM.
+    int andersonDepth; //!< number of previous iterations used for Anderson mixing, 0 = plain iteration
     int nCoordsel;         //!< if >0: use only certain group in WHAM, if ==0: use all groups
     t_coordselection* coordsel; //!< for each tpr file: which pull coordinates to use in WHAM?
     /*!\}*/
@@ -333,10 +336,11 @@ typedef struct UmbrellaOptions // NOLINT(clang-analyzer-optin.performance.Paddin
     double * tabX, *tabY, tabMin, tabMax, tabDz;
     int      tabNbins;
     /*!\}*/
-    gmx::DefaultRandomEngine           rng;                //!< gromacs random number generator
-    gmx::TabulatedNormalDistribution<> normalDistribution; //!< Uses default: real output, 14-bit table
 } t_UmbrellaOptions;
 
+//! Random engine used for bootstrapping, each bootstrap uses its own stream
+typedef gmx::ThreeFry2x64<64> t_bsRandomEngine;
+
 //! Make an umbrella window (may contain several histograms)
 static t_UmbrellaWindow* initUmbrellaWindows(int nwin)
 {
@@ -859,20 +863,18 @@ static double tabulated_pot(double dist, t_UmbrellaOptions* opt)
  */
 static void setup_acc_wham(const double* profile, t_UmbrellaWindow* window, int nWindows, t_UmbrellaOptions* opt)
 {
-    int        i, j, k, nGrptot = 0, nContrib = 0, nTot = 0;
-    double     U, min = opt->min, dz = opt->dz, temp, ztot_half, distance, ztot, contrib1, contrib2;
-    gmx_bool   bAnyContrib;
+    int      i, j, k, nGrptot = 0, nContrib = 0, nTot = 0;
+    double   U, min = opt->min, dz = opt->dz, temp, ztot_half, distance, ztot, contrib1, contrib2;
+    double   wham_contrib_lim;
+    gmx_bool bAnyContrib;
+    /* Only changed in the first call, which is done before the concurrent bootstraps */
     static int bFirst = 1;
-    static double wham_contrib_lim;
 
-    if (bFirst)
+    for (i = 0; i < nWindows; ++i)
     {
-        for (i = 0; i < nWindows; ++i)
-        {
-            nGrptot += window[i].nPull;
-        }
-        wham_contrib_lim = opt->Tolerance / nGrptot;
+        nGrptot += window[i].nPull;
     }
+    wham_contrib_lim = opt->Tolerance / nGrptot;
 
     ztot      = opt->max - opt->min;
     ztot_half = ztot / 2;
@@ -947,13 +949,13 @@ static void setup_acc_wham(const double* profile, t_UmbrellaWindow* window, int
         printf("Initialized rapid wham stuff (contrib tolerance %g)\n"
                "Evaluating only %d of %d expressions.\n\n",
                wham_contrib_lim, nContrib, nTot);
+        bFirst = 0;
     }
 
     if (opt->verbose)
     {
         printf("Updated rapid wham stuff. (evaluating only %d of %d contributions)\n", nContrib, nTot);
     }
-    bFirst = 0;
 }
 
 //! Compute the PMF (one of the two main WHAM routines)
@@ -1116,6 +1118,87 @@ static double calc_z(const double* profile, t_UmbrellaWindow* window, int nWindo
     return maxglob;
 }
 
+//! Copy the free energy offsets z of all pull groups into one array
+static void getWindowZ(const t_UmbrellaWindow* window, int nWindows, std::vector<double>* z)
+{
+    z->clear();
+    for (int i = 0; i < nWindows; i++)
+    {
+        z->insert(z->end(), window[i].z, window[i].z + window[i].nPull);
+    }
+}
+
+//! Set the free energy offsets z of all pull groups from one array
+static void setWindowZ(t_UmbrellaWindow* window, int nWindows, const std::vector<double>& z)
+{
+    auto zIt = z.begin();
+    for (int i = 0; i < nWindows; i++)
+    {
+        std::copy(zIt, zIt + window[i].nPull, window[i].z);
+        zIt += window[i].nPull;
+    }
+}
+
+/*! \brief Iterate the WHAM equations until the profile has converged
+ *
+ * First iterate with only the significant contributions (rapid wham), then
+ * switch to the exact iteration. Returns the number of iterations and, in
+ * \p maxchangeOut, the final maximum change of z.
+ */
+static int iterateWham(double*            profile,
+                       t_UmbrellaWindow*  window,
+                       int                nWindows,
+                       t_UmbrellaOptions* opt,
+                       gmx_bool           bReportSwitch,
+                       double*            maxchangeOut)
+{
+    gmx::AndersonMixer  mixer(opt->andersonDepth);
+    std::vector<double> zOld, zNew;
+    gmx_bool            bExact    = FALSE;
+    double              maxchange = 1e20;
+    int                 i         = 0;
+
+    do
+    {
+        if ((i % opt->stepUpdateContrib) == 0)
+        {
+            setup_acc_wham(profile, window, nWindows, opt);
+            mixer.reset();
+        }
+        if (maxchange < opt->Tolerance)
+        {
+            bExact = TRUE;
+            mixer.reset();
+            if (bReportSwitch)
+            {
+                printf("Switched to exact iteration in iteration %d\n", i);
+            }
+        }
+        calc_profile(profile, window, nWindows, opt, bExact);
+        if (((i % opt->stepchange) == 0 || i == 1) && i != 0)
+        {
+            printf("\t%4d) Maximum change %e\n", i, maxchange);
+        }
+        i++;
+        if (opt->andersonDepth > 0)
+        {
+            getWindowZ(window, nWindows, &zOld);
+        }
+        maxchange = calc_z(profile, window, nWindows, opt, bExact);
+        /* Never mix the last iteration, so the final z are consistent with the profile */
+        if (opt->andersonDepth > 0 && maxchange > opt->Tolerance)
+        {
+            getWindowZ(window, nWindows, &zNew);
+            mixer.mix(zOld, &zNew);
+            setWindowZ(window, nWindows, zNew);
+        }
+    } while (maxchange > opt->Tolerance || !bExact);
+
+    *maxchangeOut = maxchange;
+
+    return i;
+}
+
 //! Make PMF symmetric around 0 (useful e.g. for membranes)
 static void symmetrizeProfile(double* profile, t_UmbrellaOptions* opt)
 {
@@ -1225,7 +1308,7 @@ static void prof_normalization_and_unit(double* profile, t_UmbrellaOptions* opt)
 }
 
 //! Make an array of random integers (used for bootstrapping)
-static void getRandomIntArray(int nPull, int blockLength, int* randomArray, gmx::DefaultRandomEngine* rng)
+static void getRandomIntArray(int nPull, int blockLength, int* randomArray, t_bsRandomEngine* rng)
 {
     gmx::UniformIntDistribution<int> dist(0, blockLength - 1);
 
@@ -1259,15 +1342,18 @@ static void getRandomIntArray(int nPull, int blockLength, int* randomArray, gmx:
  *
  * This is used when bootstapping new trajectories and thereby create new histogtrams,
  * but it is not required if we bootstrap complete histograms.
+ * The contribution table is copied, since it is updated independently by each
+ * concurrently running bootstrap.
  */
 static void copy_pullgrp_to_synthwindow(t_UmbrellaWindow* synthWindow, t_UmbrellaWindow* thisWindow, int pullid)
 {
-    synthWindow->N[0]        = thisWindow->N[pullid];
-    synthWindow->Histo[0]    = thisWindow->Histo[pullid];
-    synthWindow->pos[0]      = thisWindow->pos[pullid];
-    synthWindow->z[0]        = thisWindow->z[pullid];
-    synthWindow->k[0]        = thisWindow->k[pullid];
-    synthWindow->bContrib[0] = thisWindow->bContrib[pullid];
+    synthWindow->N[0]     = thisWindow->N[pullid];
+    synthWindow->Histo[0] = thisWindow->Histo[pullid];
+    synthWindow->pos[0]   = thisWindow->pos[pullid];
+    synthWindow->z[0]     = thisWindow->z[pullid];
+    synthWindow->k[0]     = thisWindow->k[pullid];
+    std::copy(thisWindow->bContrib[pullid], thisWindow->bContrib[pullid] + synthWindow->nBin,
+              synthWindow->bContrib[0]);
     synthWindow->g[0]        = thisWindow->g[pullid];
     synthWindow->bsWeight[0] = thisWindow->bsWeight[pullid];
 }
@@ -1375,10 +1461,12 @@ static void searchCumulative(const double xx[], int n, double x, int* j)
 }
 
 //! Bootstrap new trajectories and thereby generate new (bootstrapped) histograms
-static void create_synthetic_histo(t_UmbrellaWindow*  synthWindow,
-                                   t_UmbrellaWindow*  thisWindow,
-                                   int                pullid,
-                                   t_UmbrellaOptions* opt)
+static void create_synthetic_histo(t_UmbrellaWindow*                   synthWindow,
+                                   t_UmbrellaWindow*                   thisWindow,
+                                   int                                 pullid,
+                                   t_UmbrellaOptions*                  opt,
+                                   t_bsRandomEngine*                   rng,
+                                   gmx::TabulatedNormalDistribution<>* normalDistribution)
 {
     int    N, i, nbins, r_index, ibin;
     double r, tausteps = 0.0, a, ap, dt, x, invsqrt2, g, y, sig = 0., z, mu = 0.;
@@ -1415,11 +1503,12 @@ static void create_synthetic_histo(t_UmbrellaWindow*  synthWindow,
         gmx_fatal(FARGS, "%s", errstr);
     }
 
-    synthWindow->N[0]        = N;
-    synthWindow->pos[0]      = thisWindow->pos[pullid];
-    synthWindow->z[0]        = thisWindow->z[pullid];
-    synthWindow->k[0]        = thisWindow->k[pullid];
-    synthWindow->bContrib[0] = thisWindow->bContrib[pullid];
+    synthWindow->N[0]   = N;
+    synthWindow->pos[0] = thisWindow->pos[pullid];
+    synthWindow->z[0]   = thisWindow->z[pullid];
+    synthWindow->k[0]   = thisWindow->k[pullid];
+    std::copy(thisWindow->bContrib[pullid], thisWindow->bContrib[pullid] + synthWindow->nBin,
+              synthWindow->bContrib[0]);
     synthWindow->g[0]        = thisWindow->g[pullid];
     synthWindow->bsWeight[0] = thisWindow->bsWeight[pullid];
 
@@ -1455,14 +1544,14 @@ static void create_synthetic_histo(t_UmbrellaWindow*  synthWindow,
     invsqrt2 = 1.0 / std::sqrt(2.0);
 
     /* init random sequence */
-    x = opt->normalDistribution(opt->rng);
+    x = (*normalDistribution)(*rng);
 
     if (opt->bsMethod == bsMethod_traj)
     {
         /* bootstrap points from the umbrella histograms */
         for (i = 0; i < N; i++)
         {
-            y = opt->normalDistribution(opt->rng);
+            y = (*normalDistribution)(*rng);
             x = a * x + ap * y;
             /* get flat distribution in [0,1] using cumulative distribution function of Gauusian
                Note: CDF(Gaussian) = 0.5*{1+erf[x/sqrt(2)]}
@@ -1482,7 +1571,7 @@ static void create_synthetic_histo(t_UmbrellaWindow*  synthWindow,
         i = 0;
         while (i < N)
         {
-            y    = opt->normalDistribution(opt->rng);
+            y    = (*normalDistribution)(*rng);
             x    = a * x + ap * y;
             z    = x * sig + mu;
             ibin = static_cast<int>(std::floor((z - opt->min) / opt->dz));
@@ -1560,7 +1649,7 @@ static void print_histograms(const char*        fnhist,
 }
 
 //! Make random weights for histograms for the Bayesian bootstrap of complete histograms)
-static void setRandomBsWeights(t_UmbrellaWindow* synthwin, int nAllPull, t_UmbrellaOptions* opt)
+static void setRandomBsWeights(t_UmbrellaWindow* synthwin, int nAllPull, t_bsRandomEngine* rng)
 {
     int                                i;
     double*                            r;
@@ -1571,7 +1660,7 @@ static void setRandomBsWeights(t_UmbrellaWindow* synthwin, int nAllPull, t_Umbre
     /* generate ordered random numbers between 0 and nAllPull  */
     for (i = 0; i < nAllPull - 1; i++)
     {
-        r[i] = dist(opt->rng);
+        r[i] = dist(*rng);
     }
     std::sort(r, r + nAllPull - 1);
     r[nAllPull - 1] = 1.0 * nAllPull;
@@ -1594,7 +1683,58 @@ static void setRandomBsWeights(t_UmbrellaWindow* synthwin, int nAllPull, t_Umbre
     sfree(r);
 }
 
-//! The main bootstrapping routine
+/*! \brief Allocate synthetic windows with one pull group each
+ *
+ * Each bootstrap thread uses its own set, since the windows are modified
+ * during the bootstrap.
+ */
+static t_UmbrellaWindow* initSynthWindows(t_UmbrellaWindow*  window,
+                                          const int*         allPull_winId,
+                                          const int*         allPull_pullId,
+                                          int                nAllPull,
+                                          t_UmbrellaOptions* opt)
+{
+    t_UmbrellaWindow* synthWindow;
+    int               i;
+
+    snew(synthWindow, nAllPull);
+    for (i = 0; i < nAllPull; i++)
+    {
+        synthWindow[i].nPull = 1;
+        synthWindow[i].nBin  = opt->bins;
+        snew(synthWindow[i].Histo, 1);
+        if (opt->bsMethod == bsMethod_traj || opt->bsMethod == bsMethod_trajGauss)
+        {
+            snew(synthWindow[i].Histo[0], opt->bins);
+        }
+        snew(synthWindow[i].N, 1);
+        snew(synthWindow[i].pos, 1);
+        snew(synthWindow[i].z, 1);
+        snew(synthWindow[i].k, 1);
+        snew(synthWindow[i].bContrib, 1);
+        snew(synthWindow[i].bContrib[0], opt->bins);
+        snew(synthWindow[i].g, 1);
+        snew(synthWindow[i].bsWeight, 1);
+    }
+
+    if (opt->bsMethod == bsMethod_BayesianHist)
+    {
+        /* just copy all histogams into synthWindow array */
+        for (i = 0; i < nAllPull; i++)
+        {
+            copy_pullgrp_to_synthwindow(synthWindow + i, window + allPull_winId[i], allPull_pullId[i]);
+        }
+    }
+
+    return synthWindow;
+}
+
+/*! \brief The main bootstrapping routine
+ *
+ * The bootstraps are independent and run concurrently on OpenMP threads.
+ * Bootstrap ib draws its random numbers from stream ib of the random engine,
+ * so the results do not depend on the number of threads.
+ */
 static void do_bootstrapping(const char*        fnres,
                              const char*        fnprof,
                              const char*        fnhist,
@@ -1605,21 +1745,18 @@ static void do_bootstrapping(const char*        fnres,
                              int                nWindows,
                              t_UmbrellaOptions* opt)
 {
-    t_UmbrellaWindow* synthWindow;
-    double *          bsProfile, *bsProfiles_av, *bsProfiles_av2, maxchange = 1e20, tmp, stddev;
-    int               i, j, *randomArray = nullptr, winid, pullid, ib;
-    int               iAllPull, nAllPull, *allPull_winId, *allPull_pullId;
-    FILE*             fp;
-    gmx_bool          bExact = FALSE;
+    double *bsProfiles, *bsProfiles_av, *bsProfiles_av2, tmp, stddev;
+    int     i, j, ib, nThreads;
+    int     iAllPull, nAllPull, *allPull_winId, *allPull_pullId;
+    FILE*   fp;
 
     /* init random generator */
     if (opt->bsSeed == 0)
     {
         opt->bsSeed = static_cast<int>(gmx::makeRandomSeed());
     }
-    opt->rng.seed(opt->bsSeed);
 
-    snew(bsProfile, opt->bins);
+    snew(bsProfiles, opt->nBootStrap * opt->bins);
     snew(bsProfiles_av, opt->bins);
     snew(bsProfiles_av2, opt->bins);
 
@@ -1645,131 +1782,123 @@ static void do_bootstrapping(const char*        fnres,
         }
     }
 
-    /* setup stuff for synthetic windows */
-    snew(synthWindow, nAllPull);
-    for (i = 0; i < nAllPull; i++)
-    {
-        synthWindow[i].nPull = 1;
-        synthWindow[i].nBin  = opt->bins;
-        snew(synthWindow[i].Histo, 1);
-        if (opt->bsMethod == bsMethod_traj || opt->bsMethod == bsMethod_trajGauss)
-        {
-            snew(synthWindow[i].Histo[0], opt->bins);
-        }
-        snew(synthWindow[i].N, 1);
-        snew(synthWindow[i].pos, 1);
-        snew(synthWindow[i].z, 1);
-        snew(synthWindow[i].k, 1);
-        snew(synthWindow[i].bContrib, 1);
-        snew(synthWindow[i].g, 1);
-        snew(synthWindow[i].bsWeight, 1);
-    }
-
     switch (opt->bsMethod)
     {
         case bsMethod_hist:
             printf("\n\nWhen computing statistical errors by bootstrapping entire histograms:\n");
             please_cite(stdout, "Hub2006");
             break;
-        case bsMethod_BayesianHist:
-            /* just copy all histogams into synthWindow array */
-            for (i = 0; i < nAllPull; i++)
-            {
-                winid  = allPull_winId[i];
-                pullid = allPull_pullId[i];
-                copy_pullgrp_to_synthwindow(synthWindow + i, window + winid, pullid);
-            }
-            break;
+        case bsMethod_BayesianHist: break;
         case bsMethod_traj:
         case bsMethod_trajGauss: calc_cumulatives(window, nWindows, opt, fnhist, xlabel); break;
         default: gmx_fatal(FARGS, "Unknown bootstrap method. That should not have happened.\n");
     }
 
+    /* setup stuff for synthetic windows, one set per thread */
+    nThreads = std::min(opt->nBootStrap, gmx_omp_get_max_threads());
+    std::vector<t_UmbrellaWindow*> synthWindows(nThreads);
+    for (i = 0; i < nThreads; i++)
+    {
+        synthWindows[i] = initSynthWindows(window, allPull_winId, allPull_pullId, nAllPull, opt);
+    }
+
     /* do bootstrapping */
-    fp = xvgropen(fnprof, "Bootstrap profiles", xlabel, ylabel, opt->oenv);
+#pragma omp parallel for num_threads(nThreads) schedule(dynamic)
     for (ib = 0; ib < opt->nBootStrap; ib++)
     {
-        printf("  *******************************************\n"
-               "  ******** Start bootstrap nr %d ************\n"
-               "  *******************************************\n",
-               ib + 1);
-
-        switch (opt->bsMethod)
-        {
-            case bsMethod_hist:
-                /* bootstrap complete histograms from given histograms */
-                srenew(randomArray, nAllPull);
-                getRandomIntArray(nAllPull, opt->histBootStrapBlockLength, randomArray, &opt->rng);
-                for (i = 0; i < nAllPull; i++)
-                {
-                    winid  = allPull_winId[randomArray[i]];
-                    pullid = allPull_pullId[randomArray[i]];
-                    copy_pullgrp_to_synthwindow(synthWindow + i, window + winid, pullid);
-                }
-                break;
-            case bsMethod_BayesianHist:
-                /* keep histos, but assign random weights ("Bayesian bootstrap") */
-                setRandomBsWeights(synthWindow, nAllPull, opt);
-                break;
-            case bsMethod_traj:
-            case bsMethod_trajGauss:
-                /* create new histos from given histos, that is generate new hypothetical
-                   trajectories */
-                for (i = 0; i < nAllPull; i++)
-                {
-                    winid  = allPull_winId[i];
-                    pullid = allPull_pullId[i];
-                    create_synthetic_histo(synthWindow + i, window + winid, pullid, opt);
-                }
-                break;
-        }
-
-        /* write histos in case of verbose output */
-        if (opt->bs_verbose)
+        try
         {
-            print_histograms(fnhist, synthWindow, nAllPull, ib, opt, xlabel);
-        }
+            t_UmbrellaWindow*                  synthWindow = synthWindows[gmx_omp_get_thread_num()];
+            double*                            bsProfile   = bsProfiles + ib * opt->bins;
+            std::vector<int>                   randomArray;
+            t_bsRandomEngine                   rng(opt->bsSeed, gmx::RandomDomain::Other);
+            gmx::TabulatedNormalDistribution<> normalDistribution;
+            double                             maxchange;
+            int                                k, winid, pullid, nIter;
 
-        /* do wham */
-        i         = 0;
-        bExact    = FALSE;
-        maxchange = 1e20;
-        std::memcpy(bsProfile, profile, opt->bins * sizeof(double)); /* use profile as guess */
-        do
-        {
-            if ((i % opt->stepUpdateContrib) == 0)
+            if (nThreads > 1)
             {
-                setup_acc_wham(bsProfile, synthWindow, nAllPull, opt);
+                /* The WHAM iterations of concurrent bootstraps should not spawn threads */
+                gmx_omp_set_num_threads(1);
             }
-            if (maxchange < opt->Tolerance)
+            rng.restart(ib, 0);
+
+            printf("  *******************************************\n"
+                   "  ******** Start bootstrap nr %d ************\n"
+                   "  *******************************************\n",
+                   ib + 1);
+
+            switch (opt->bsMethod)
             {
-                bExact = TRUE;
+                case bsMethod_hist:
+                    /* bootstrap complete histograms from given histograms */
+                    randomArray.resize(nAllPull);
+                    getRandomIntArray(nAllPull, opt->histBootStrapBlockLength, randomArray.data(), &rng);
+                    for (k = 0; k < nAllPull; k++)
+                    {
+                        winid  = allPull_winId[randomArray[k]];
+                        pullid = allPull_pullId[randomArray[k]];
+                        copy_pullgrp_to_synthwindow(synthWindow + k, window + winid, pullid);
+                    }
+                    break;
+                case bsMethod_BayesianHist:
+                    /* keep histos, but assign random weights ("Bayesian bootstrap").
+                       Restart from the original z, since the previous bootstrap on this
+                       thread left its converged z values in synthWindow. */
+                    for (k = 0; k < nAllPull; k++)
+                    {
+                        synthWindow[k].z[0] = window[allPull_winId[k]].z[allPull_pullId[k]];
+                    }
+                    setRandomBsWeights(synthWindow, nAllPull, &rng);
+                    break;
+                case bsMethod_traj:
+                case bsMethod_trajGauss:
+                    /* create new histos from given histos, that is generate new hypothetical
+                       trajectories */
+                    for (k = 0; k < nAllPull; k++)
+                    {
+                        winid  = allPull_winId[k];
+                        pullid = allPull_pullId[k];
+                        create_synthetic_histo(synthWindow + k, window + winid, pullid, opt, &rng,
+                                               &normalDistribution);
+                    }
+                    break;
             }
-            if (((i % opt->stepchange) == 0 || i == 1) && i != 0)
+
+            /* write histos in case of verbose output */
+            if (opt->bs_verbose)
             {
-                printf("\t%4d) Maximum change %e\n", i, maxchange);
+#pragma omp critical
+                print_histograms(fnhist, synthWindow, nAllPull, ib, opt, xlabel);
             }
-            calc_profile(bsProfile, synthWindow, nAllPull, opt, bExact);
-            i++;
-        } while ((maxchange = calc_z(bsProfile, synthWindow, nAllPull, opt, bExact)) > opt->Tolerance
-                 || !bExact);
-        printf("\tConverged in %d iterations. Final maximum change %g\n", i, maxchange);
 
-        if (opt->bLog)
-        {
-            prof_normalization_and_unit(bsProfile, opt);
-        }
+            /* do wham */
+            std::memcpy(bsProfile, profile, opt->bins * sizeof(double)); /* use profile as guess */
+            nIter = iterateWham(bsProfile, synthWindow, nAllPull, opt, FALSE, &maxchange);
+            printf("\tBootstrap nr %d converged in %d iterations. Final maximum change %g\n",
+                   ib + 1, nIter, maxchange);
 
-        /* symmetrize profile around z=0 */
-        if (opt->bSym)
-        {
-            symmetrizeProfile(bsProfile, opt);
+            if (opt->bLog)
+            {
+                prof_normalization_and_unit(bsProfile, opt);
+            }
+
+            /* symmetrize profile around z=0 */
+            if (opt->bSym)
+            {
+                symmetrizeProfile(bsProfile, opt);
+            }
         }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
 
-        /* save stuff to get average and stddev */
+    /* save stuff to get average and stddev */
+    fp = xvgropen(fnprof, "Bootstrap profiles", xlabel, ylabel, opt->oenv);
+    for (ib = 0; ib < opt->nBootStrap; ib++)
+    {
         for (i = 0; i < opt->bins; i++)
         {
-            tmp = bsProfile[i];
+            tmp = bsProfiles[ib * opt->bins + i];
             bsProfiles_av[i] += tmp;
             bsProfiles_av2[i] += tmp * tmp;
             fprintf(fp, "%e\t%e\n", (i + 0.5) * opt->dz + opt->min, tmp);
@@ -1794,6 +1923,7 @@ static void do_bootstrapping(const char*        fnres,
     }
     xvgrclose(fp);
     printf("Wrote boot strap result to %s\n", fnres);
+    sfree(bsProfiles);
 }
 
 //! Return type of input file based on file extension (xvg, pdo, or tpr)
@@ -3449,7 +3579,11 @@ int gmx_wham(int argc, char* argv[])
         "",
         "With [TT]-vbs[tt] (verbose bootstrapping), the histograms of each bootstrap are written, ",
         "and, with bootstrap method [TT]traj[tt], the cumulative distribution functions of ",
-        "the histograms."
+        "the histograms.",
+        "",
+        "The bootstraps are computed concurrently on the available OpenMP threads.",
+        "Each bootstrap uses its own random number stream, so the results do not",
+        "depend on the number of threads."
     };
 
     const char* en_unit[]       = { nullptr, "kJ", "kCal", "kT", nullptr };
@@ -3547,6 +3681,12 @@ int gmx_wham(int argc, char* argv[])
           etINT,
           { &opt.stepUpdateContrib },
           "HIDDENUpdate table with significan contributions to WHAM every ... iterations" },
+        { "-anderson",
+          FALSE,
+          etINT,
+          { &opt.andersonDepth },
+          "Number of previous iterations used to accelerate the WHAM iteration with Anderson "
+          "mixing (0: plain iteration)" },
     };
 
     t_filenm fnm[] = {
@@ -3568,7 +3708,7 @@ int gmx_wham(int argc, char* argv[])
     t_UmbrellaHeader  header;
     t_UmbrellaWindow* window = nullptr;
     double *          profile, maxchange = 1e20;
-    gmx_bool          bMinSet, bMaxSet, bAutoSet, bExact = FALSE;
+    gmx_bool          bMinSet, bMaxSet, bAutoSet;
     char **           fninTpr, **fninPull, **fninPdo;
     const char*       fnPull;
     FILE *            histout, *profout;
@@ -3609,6 +3749,7 @@ int gmx_wham(int argc, char* argv[])
     opt.acTrestart            = 1.0;
     opt.stepchange            = 100;
     opt.stepUpdateContrib     = 100;
+    opt.andersonDepth         = 0;
 
     if (!parse_common_args(&argc, argv, 0, NFILE, fnm, asize(pa), pa, asize(desc), desc, 0, nullptr,
                            &opt.oenv))
@@ -3729,8 +3870,9 @@ int gmx_wham(int argc, char* argv[])
     }
 
     /* It is currently assumed that all pull coordinates have the same geometry, so they also have the same coordinate units.
-       We can therefore get the units for the xlabel from the first coordinate. */
-    sprintf(xlabel, "\\xx\\f{} (%s)", header.pcrd[0].coord_unit);
+       We can therefore get the units for the xlabel from the first coordinate.
+       The pull coordinates are only read from tpr files, pdo files contain distances. */
+    sprintf(xlabel, "\\xx\\f{} (%s)", opt.bPdo ? "nm" : header.pcrd[0].coord_unit);
 
     nwins = nfiles;
 
@@ -3802,26 +3944,7 @@ int gmx_wham(int argc, char* argv[])
     {
         opt.stepchange = 1;
     }
-    i = 0;
-    do
-    {
-        if ((i % opt.stepUpdateContrib) == 0)
-        {
-            setup_acc_wham(profile, window, nwins, &opt);
-        }
-        if (maxchange < opt.Tolerance)
-        {
-            bExact = TRUE;
-            /* if (opt.verbose) */
-            printf("Switched to exact iteration in iteration %d\n", i);
-        }
-        calc_profile(profile, window, nwins, &opt, bExact);
-        if (((i % opt.stepchange) == 0 || i == 1) && i != 0)
-        {
-            printf("\t%4d) Maximum change %e\n", i, maxchange);
-        }
-        i++;
-    } while ((maxchange = calc_z(profile, window, nwins, &opt, bExact)) > opt.Tolerance || !bExact);
+    i = iterateWham(profile, window, nwins, &opt, TRUE, &maxchange);
     printf("Converged in %d iterations. Final maximum change %g\n", i, maxchange);
 
     /* calc error from Kumar's formula */
@@ -0,0 +1,114 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements multi-threaded accumulation of points on regular grids.
+ *
+ * \ingroup module_gmxana
+ */
+#include "gmxpre.h"
+
+#include "gridbinning.h"
+
+#include <algorithm>
+
+#include "gromacs/math/multidimarray.h"
+
+namespace gmx
+{
+
+namespace
+{
+
+//! The memory all thread copies of a grid may use together, larger grids use fewer threads
+constexpr std::size_t c_maxThreadGridMemory = std::size_t(512) * 1024 * 1024;
+
+//! Returns the number of threads to use for accumulating on a grid with \p numBins bins
+int numThreadsForGrid(int numBins)
+{
+    const std::size_t gridMemory  = std::max<std::size_t>(numBins * sizeof(double), 1);
+    const std::size_t maxNumGrids = std::max<std::size_t>(c_maxThreadGridMemory / gridMemory, 1);
+    return static_cast<int>(std::min<std::size_t>(gmx_omp_get_max_threads(), maxNumGrids));
+}
+
+} // namespace
+
+GridBinner::GridBinner(const IVec& extents) :
+    extents_(extents),
+    numThreads_(numThreadsForGrid(numBins()))
+{
+}
+
+void GridBinner::setGaussianSpreading(real sigma, real spreadWidthMultiplesOfSigma)
+{
+    const GaussianSpreadKernelParameters::Shape shape = { DVec(sigma, sigma, sigma),
+                                                         spreadWidthMultiplesOfSigma };
+    const dynamicExtents3D extents(extents_[XX], extents_[YY], extents_[ZZ]);
+
+    threadTransforms_.clear();
+    for (int thread = 0; thread < numThreads_; thread++)
+    {
+        threadTransforms_.push_back(std::make_unique<GaussTransform3D>(extents, shape));
+    }
+}
+
+ArrayRef<const double> GridBinner::reduce()
+{
+    const int numBins = this->numBins();
+    grid_.resize(numBins);
+    std::vector<const float*> spreadGrids;
+    for (const auto& transform : threadTransforms_)
+    {
+        spreadGrids.push_back(transform->constView().data());
+    }
+#pragma omp parallel for num_threads(gmx_omp_get_max_threads()) schedule(static)
+    for (int bin = 0; bin < numBins; bin++)
+    {
+        double sum = 0;
+        for (const auto& threadGrid : threadGrids_)
+        {
+            sum += threadGrid[bin];
+        }
+        for (const float* spreadGrid : spreadGrids)
+        {
+            sum += spreadGrid[bin];
+        }
+        grid_[bin] = sum;
+    }
+
+    return grid_;
+}
+
+} // namespace gmx
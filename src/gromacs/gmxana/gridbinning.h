@@ -0,0 +1,204 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Declares multi-threaded accumulation of points on regular grids,
+ * used by the density and spatial distribution tools.
+ *
+ * \ingroup module_gmxana
+ */
+#ifndef GMXANA_GRIDBINNING_H
+#define GMXANA_GRIDBINNING_H
+
+#include <cstdint>
+
+#include <memory>
+#include <vector>
+
+#include "gromacs/math/gausstransform.h"
+#include "gromacs/math/vectypes.h"
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/exceptions.h"
+#include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/gmxomp.h"
+#include "gromacs/utility/real.h"
+
+namespace gmx
+{
+
+/*! \internal \brief Accumulates weighted points on a regular grid of up to three dimensions
+ *
+ * Every thread accumulates into its own copy of the grid, so points can be
+ * binned in parallel without atomics. The copies are summed by reduce(),
+ * which only needs to be called once at the end of a trajectory.
+ * To bound the memory use, fewer threads are used for grids so large that
+ * the copies would exceed a fixed memory budget, and the copies are only
+ * allocated for the kind of accumulation that is used.
+ * Grids are stored with the last dimension running fastest, unused
+ * dimensions should have extent 1.
+ *
+ * Instead of binning, 3D grids can spread each point as a Gaussian using
+ * GaussTransform3D, see spreadPoints().
+ */
+class GridBinner
+{
+public:
+    //! Constructs a zeroed grid with \p extents bins
+    explicit GridBinner(const IVec& extents);
+
+    //! Return the extents of the grid
+    const IVec& extents() const { return extents_; }
+    //! Return the total number of bins
+    int numBins() const { return extents_[XX] * extents_[YY] * extents_[ZZ]; }
+    //! Return the index in the flat grid of bin (\p i, \p j, \p k)
+    int binIndex(int i, int j, int k) const { return (i * extents_[YY] + j) * extents_[ZZ] + k; }
+    //! Return the number of threads, and thus grid copies, used for accumulation
+    int numThreads() const { return numThreads_; }
+
+    /*! \brief Adds \p numPoints points to the grid in parallel
+     *
+     * \p binOfPoint(i, &weight) should return the index of the bin of point \p i,
+     * as given by binIndex(), and set its weight. It should return -1 to skip
+     * the point. It is called concurrently, so it should not modify shared state.
+     *
+     * \returns the number of skipped points.
+     */
+    template<typename BinFunction>
+    int addPoints(int numPoints, BinFunction binOfPoint)
+    {
+        if (threadGrids_.empty())
+        {
+            threadGrids_.resize(numThreads_, std::vector<double>(numBins(), 0.0));
+        }
+        const int numThreads = numThreads_;
+        int       numSkipped = 0;
+#pragma omp parallel for num_threads(numThreads) schedule(static) reduction(+ : numSkipped)
+        for (int thread = 0; thread < numThreads; thread++)
+        {
+            try
+            {
+                std::vector<double>& grid  = threadGrids_[thread];
+                const int            start = (numPoints * static_cast<int64_t>(thread)) / numThreads;
+                const int end = (numPoints * static_cast<int64_t>(thread + 1)) / numThreads;
+                for (int i = start; i < end; i++)
+                {
+                    real      weight = 0;
+                    const int bin    = binOfPoint(i, &weight);
+                    if (bin >= 0)
+                    {
+                        grid[bin] += weight;
+                    }
+                    else
+                    {
+                        numSkipped++;
+                    }
+                }
+            }
+            GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+        }
+        return numSkipped;
+    }
+
+    /*! \brief Sets up spreading of points with Gaussians of width \p sigma bins
+     *
+     * The Gaussians are truncated at \p spreadWidthMultiplesOfSigma times \p sigma.
+     */
+    void setGaussianSpreading(real sigma, real spreadWidthMultiplesOfSigma);
+
+    /*! \brief Spreads \p numPoints points as Gaussians on the grid in parallel
+     *
+     * \p positionOfPoint(i, &position, &amplitude) should set the position of point
+     * \p i in lattice coordinates, i.e. in units of bins, and its amplitude,
+     * and return false to skip the point. It is called concurrently.
+     * Requires setGaussianSpreading() to have been called.
+     *
+     * \returns the number of skipped points.
+     */
+    template<typename PositionFunction>
+    int spreadPoints(int numPoints, PositionFunction positionOfPoint)
+    {
+        GMX_RELEASE_ASSERT(!threadTransforms_.empty(), "Spreading needs to be set up first");
+        const int numThreads = numThreads_;
+        int       numSkipped = 0;
+#pragma omp parallel for num_threads(numThreads) schedule(static) reduction(+ : numSkipped)
+        for (int thread = 0; thread < numThreads; thread++)
+        {
+            try
+            {
+                GaussTransform3D& transform = *threadTransforms_[thread];
+                const int         start = (numPoints * static_cast<int64_t>(thread)) / numThreads;
+                const int end = (numPoints * static_cast<int64_t>(thread + 1)) / numThreads;
+                for (int i = start; i < end; i++)
+                {
+                    RVec position;
+                    real amplitude = 0;
+                    if (positionOfPoint(i, &position, &amplitude))
+                    {
+                        transform.add({ position, amplitude });
+                    }
+                    else
+                    {
+                        numSkipped++;
+                    }
+                }
+            }
+            GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+        }
+        return numSkipped;
+    }
+
+    /*! \brief Sums the contributions of all threads and returns the grid
+     *
+     * Accumulation can continue after this call, the next call returns
+     * the sum over all points added before it.
+     */
+    ArrayRef<const double> reduce();
+
+private:
+    //! The number of bins along each dimension
+    IVec extents_;
+    //! The number of threads used for accumulation
+    int numThreads_;
+    //! The grid of each thread, empty until points are added
+    std::vector<std::vector<double>> threadGrids_;
+    //! The Gaussian spreading lattice of each thread, empty without spreading
+    std::vector<std::unique_ptr<GaussTransform3D>> threadTransforms_;
+    //! The sum over all thread grids, allocated by reduce()
+    std::vector<double> grid_;
+};
+
+} // namespace gmx
+
+#endif
@@ -0,0 +1,151 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for Anderson mixing of fixed-point iterations.
+ *
+ * \ingroup module_gmxana
+ */
+#include "gmxpre.h"
+
+#include "gromacs/gmxana/andersonmixer.h"
+
+#include <cmath>
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "testutils/testasserts.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! A weakly contracting linear map G(x) = M x + b
+std::vector<double> linearMap(const std::vector<double>& x)
+{
+    return { 0.99 * x[0] + 0.005 * x[1] + 1.0, 0.95 * x[1] - 0.01 * x[2] + 2.0,
+             0.002 * x[0] + 0.9 * x[2] - 1.0 };
+}
+
+//! Iterates linearMap with mixing depth \p depth until the residual is below \p tolerance
+int iterateLinearMap(int depth, double tolerance, std::vector<double>* x)
+{
+    AndersonMixer mixer(depth);
+    *x = { 0, 0, 0 };
+    for (int iteration = 1; iteration < 100000; iteration++)
+    {
+        std::vector<double> g        = linearMap(*x);
+        double              residual = 0;
+        for (size_t i = 0; i < x->size(); i++)
+        {
+            residual = std::max(residual, std::abs(g[i] - (*x)[i]));
+        }
+        if (residual < tolerance)
+        {
+            return iteration;
+        }
+        if (depth > 0)
+        {
+            mixer.mix(*x, &g);
+        }
+        *x = g;
+    }
+    return -1;
+}
+
+TEST(AndersonMixerTest, AcceleratesToSameFixedPoint)
+{
+    const double        tolerance = 1e-10;
+    std::vector<double> xPlain, xMixed;
+
+    const int numIterationsPlain = iterateLinearMap(0, tolerance, &xPlain);
+    const int numIterationsMixed = iterateLinearMap(5, tolerance, &xMixed);
+
+    ASSERT_GT(numIterationsPlain, 0);
+    ASSERT_GT(numIterationsMixed, 0);
+    EXPECT_LT(10 * numIterationsMixed, numIterationsPlain);
+
+    const FloatingPointTolerance fixedPointTolerance = absoluteTolerance(1e-6);
+    for (size_t i = 0; i < xPlain.size(); i++)
+    {
+        EXPECT_REAL_EQ_TOL(xPlain[i], xMixed[i], fixedPointTolerance);
+    }
+}
+
+TEST(AndersonMixerTest, FallsBackToPlainIterateWhenResidualGrows)
+{
+    AndersonMixer mixer(5);
+
+    std::vector<double> g = { 1.0, 1.0 };
+    mixer.mix({ 0.0, 0.0 }, &g);
+    EXPECT_EQ(0, mixer.historySize());
+
+    /* A smaller residual adds to the history and changes the iterate */
+    g = { 1.5, 1.4 };
+    mixer.mix({ 1.0, 1.0 }, &g);
+    EXPECT_EQ(1, mixer.historySize());
+    EXPECT_NE(1.5, g[0]);
+
+    /* A growing residual resets the history and returns the plain iterate */
+    const std::vector<double> gPlain = { 0.0, 5.0 };
+    g                                = gPlain;
+    mixer.mix({ 2.0, 2.0 }, &g);
+    EXPECT_EQ(0, mixer.historySize());
+    EXPECT_EQ(gPlain, g);
+}
+
+TEST(AndersonMixerTest, LimitsHistoryToDepth)
+{
+    const int     depth = 3;
+    AndersonMixer mixer(depth);
+
+    std::vector<double> x = { 0, 0, 0 };
+    for (int iteration = 0; iteration < 10; iteration++)
+    {
+        std::vector<double> g = linearMap(x);
+        mixer.mix(x, &g);
+        EXPECT_LE(mixer.historySize(), depth);
+        x = g;
+    }
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -0,0 +1,255 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for gmx covar.
+ *
+ * \ingroup module_gmxana
+ */
+#include "gmxpre.h"
+
+#include <cmath>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gromacs/fileio/xvgr.h"
+#include "gromacs/gmxana/eigio.h"
+#include "gromacs/gmxana/gmx_ana.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/utility/smalloc.h"
+#include "gromacs/utility/stringutil.h"
+#include "gromacs/utility/textwriter.h"
+
+#include "testutils/cmdlinetest.h"
+#include "testutils/stdiohelper.h"
+#include "testutils/testasserts.h"
+#include "testutils/testfilemanager.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Eigenvalues and eigenvectors written by gmx covar
+struct CovarianceEigenSystem
+{
+    //! The eigenvalues in descending order
+    std::vector<real> eigenvalues;
+    //! The eigenvectors, in the same order
+    std::vector<std::vector<RVec>> eigenvectors;
+};
+
+class GmxCovarTest : public CommandLineTestBase
+{
+public:
+    //! Writes a structure and a trajectory of \p numFrames frames with a few dominant motions
+    void writeTrajectory(int numFrames)
+    {
+        const int numAtoms = 6;
+
+        std::mt19937                     rng(4321);
+        std::normal_distribution<double> normalDist;
+
+        /* Three random collective directions with clearly separated amplitudes */
+        const std::vector<double>        amplitudes = { 0.5, 0.3, 0.15 };
+        std::vector<std::vector<double>> directions(amplitudes.size());
+        for (auto& direction : directions)
+        {
+            for (int c = 0; c < numAtoms * DIM; c++)
+            {
+                direction.push_back(normalDist(rng) / std::sqrt(numAtoms * DIM));
+            }
+        }
+
+        structureFile_  = fileManager().getTemporaryFilePath("conf.gro");
+        trajectoryFile_ = fileManager().getTemporaryFilePath("traj.gro");
+        TextWriter trajectoryWriter(trajectoryFile_);
+        for (int f = -1; f < numFrames; f++)
+        {
+            std::vector<double> x(numAtoms * DIM);
+            for (int c = 0; c < numAtoms * DIM; c++)
+            {
+                x[c] = 1.0 + 0.2 * c;
+            }
+            if (f >= 0)
+            {
+                for (size_t k = 0; k < amplitudes.size(); k++)
+                {
+                    const double displacement = amplitudes[k] * normalDist(rng);
+                    for (int c = 0; c < numAtoms * DIM; c++)
+                    {
+                        x[c] += displacement * directions[k][c];
+                    }
+                }
+                for (int c = 0; c < numAtoms * DIM; c++)
+                {
+                    x[c] += 0.01 * normalDist(rng);
+                }
+            }
+            std::string frame = formatString("Generated t= %d.0\n%5d\n", std::max(f, 0), numAtoms);
+            for (int a = 0; a < numAtoms; a++)
+            {
+                frame += formatString("%5d%-5s%5s%5d%8.3f%8.3f%8.3f\n", a + 1, "RES", "C", a + 1,
+                                      x[DIM * a], x[DIM * a + 1], x[DIM * a + 2]);
+            }
+            frame += "   5.00000   5.00000   5.00000\n";
+            if (f < 0)
+            {
+                TextWriter::writeFileFromString(structureFile_, frame);
+            }
+            else
+            {
+                trajectoryWriter.writeString(frame);
+            }
+        }
+        trajectoryWriter.close();
+    }
+
+    //! Runs gmx covar with \p args and returns the eigenvalues and eigenvectors
+    CovarianceEigenSystem runCovar(const CommandLine& args, const std::string& name)
+    {
+        const std::string eigenvalueFile  = fileManager().getTemporaryFilePath(name + ".xvg");
+        const std::string eigenvectorFile = fileManager().getTemporaryFilePath(name + ".trr");
+
+        CommandLine cmdline;
+        cmdline.append("covar");
+        cmdline.addOption("-s", structureFile_);
+        cmdline.addOption("-f", trajectoryFile_);
+        cmdline.addOption("-o", eigenvalueFile);
+        cmdline.addOption("-v", eigenvectorFile);
+        cmdline.addOption("-av", fileManager().getTemporaryFilePath(name + "-average.gro"));
+        cmdline.addOption("-l", fileManager().getTemporaryFilePath(name + ".log"));
+        cmdline.append("-nofit");
+        cmdline.append("-nopbc");
+        cmdline.addOption("-xvg", "none");
+        cmdline.merge(args);
+
+        StdioTestHelper stdioHelper(&fileManager());
+        stdioHelper.redirectStringToStdin("0\n");
+        EXPECT_EQ(0, gmx_covar(cmdline.argc(), cmdline.argv()));
+
+        CovarianceEigenSystem result;
+        const auto            eigenvalues = readXvgData(eigenvalueFile);
+        for (int i = 0; i < eigenvalues.extent(1); i++)
+        {
+            result.eigenvalues.push_back(eigenvalues(1, i));
+        }
+
+        int      natoms, nvec;
+        gmx_bool bFit, bDMR, bDMA;
+        rvec *   xref, *xav;
+        int*     eignr;
+        rvec**   eigvec;
+        real*    eigval;
+        read_eigenvectors(eigenvectorFile.c_str(), &natoms, &bFit, &xref, &bDMR, &xav, &bDMA, &nvec,
+                          &eignr, &eigvec, &eigval);
+        for (int v = 0; v < nvec; v++)
+        {
+            result.eigenvectors.emplace_back(eigvec[v], eigvec[v] + natoms);
+            sfree(eigvec[v]);
+        }
+        sfree(eigvec);
+        sfree(eigval);
+        sfree(eignr);
+        sfree(xav);
+        sfree(xref);
+
+        return result;
+    }
+
+    //! Checks that the -neig solution matches the leading part of the full diagonalization
+    void compareWithFullDiagonalization(const CommandLine& extraArgs)
+    {
+        const int numEigenvectors = 3;
+
+        const CovarianceEigenSystem full = runCovar(extraArgs, "full");
+        CommandLine                 args(extraArgs);
+        args.addOption("-neig", numEigenvectors);
+        const CovarianceEigenSystem partial = runCovar(args, "partial");
+
+        ASSERT_EQ(numEigenvectors, static_cast<int>(partial.eigenvalues.size()));
+        ASSERT_EQ(numEigenvectors, static_cast<int>(partial.eigenvectors.size()));
+        ASSERT_LE(numEigenvectors, static_cast<int>(full.eigenvectors.size()));
+        const FloatingPointTolerance tolerance = relativeToleranceAsFloatingPoint(1, 1e-4);
+        for (int v = 0; v < numEigenvectors; v++)
+        {
+            EXPECT_REAL_EQ_TOL(full.eigenvalues[v], partial.eigenvalues[v], tolerance)
+                    << "for eigenvalue " << v + 1;
+            /* Eigenvectors are normalized and only determined up to their sign */
+            real overlap = 0;
+            for (size_t a = 0; a < full.eigenvectors[v].size(); a++)
+            {
+                overlap += iprod(full.eigenvectors[v][a], partial.eigenvectors[v][a]);
+            }
+            EXPECT_REAL_EQ_TOL(1.0, std::abs(overlap), tolerance) << "for eigenvector " << v + 1;
+        }
+    }
+
+private:
+    //! The reference structure
+    std::string structureFile_;
+    //! The trajectory with the fluctuations
+    std::string trajectoryFile_;
+};
+
+TEST_F(GmxCovarTest, PartialDiagonalizationFromFramesMatchesFull)
+{
+    /* Fewer frames than degrees of freedom, so the matrix is not constructed */
+    writeTrajectory(12);
+    compareWithFullDiagonalization(CommandLine());
+}
+
+TEST_F(GmxCovarTest, PartialDiagonalizationFromMatrixMatchesFull)
+{
+    writeTrajectory(40);
+    compareWithFullDiagonalization(CommandLine());
+}
+
+TEST_F(GmxCovarTest, PartialDiagonalizationWithMatrixOutputMatchesFull)
+{
+    /* Writing the matrix requires constructing it, also with few frames */
+    writeTrajectory(12);
+    CommandLine args;
+    args.addOption("-ascii", fileManager().getTemporaryFilePath("covar.dat"));
+    compareWithFullDiagonalization(args);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -0,0 +1,195 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for gmx wham.
+ *
+ * \ingroup module_gmxana
+ */
+#include "gmxpre.h"
+
+#include <cmath>
+
+#include <random>
+#include <string>
+
+#include "gromacs/fileio/xvgr.h"
+#include "gromacs/gmxana/gmx_ana.h"
+#include "gromacs/utility/gmxomp.h"
+#include "gromacs/utility/stringutil.h"
+#include "gromacs/utility/textreader.h"
+#include "gromacs/utility/textwriter.h"
+
+#include "testutils/cmdlinetest.h"
+#include "testutils/testasserts.h"
+#include "testutils/testfilemanager.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+class GmxWhamTest : public CommandLineTestBase
+{
+public:
+    GmxWhamTest()
+    {
+        /* Umbrella windows along a double-well free-energy landscape in the
+         * (gmx 3 style) pdo format, which needs no tpr files.
+         */
+        const int    numWindows      = 8;
+        const int    numSamples      = 2000;
+        const double forceConstant   = 1000;
+        const double windowSpacing   = 0.1;
+        const double kTAt298K        = 2.478;
+        const double landscapeHeight = 5;
+
+        std::mt19937                     rng(1234);
+        std::normal_distribution<double> normalDist;
+
+        std::string fileList;
+        for (int w = 0; w < numWindows; w++)
+        {
+            const double umbrellaPosition = w * windowSpacing;
+            const double forceOnCoord =
+                    landscapeHeight * 2 * M_PI * std::sin(2 * M_PI * umbrellaPosition / 0.7) / 0.7;
+            const std::string fileName =
+                    fileManager().getTemporaryFilePath(formatString("window%d.pdo", w));
+            TextWriter writer(fileName);
+            writer.writeLine("# UMBRELLA      3.0");
+            writer.writeLine("# Component selection: 0 0 1");
+            writer.writeLine("# nSkip 1");
+            writer.writeLine("# Ref. Group 'Reference'");
+            writer.writeLine("# Nr. of pull groups 1");
+            writer.writeLine(formatString("# Group 1 'Pulled'  Umb. Pos. %g Umb. Cons. %g",
+                                          umbrellaPosition, forceConstant));
+            writer.writeLine("#####");
+            for (int s = 0; s < numSamples; s++)
+            {
+                /* The displacement from the umbrella position */
+                const double displacement = forceOnCoord / forceConstant
+                                            + std::sqrt(kTAt298K / forceConstant) * normalDist(rng);
+                writer.writeLine(formatString("%.3f\t%.5f", s * 0.1, displacement));
+            }
+            writer.close();
+            fileList += fileName + "\n";
+        }
+        pdoFileList_ = fileManager().getTemporaryFilePath("pdo-files.dat");
+        TextWriter::writeFileFromString(pdoFileList_, fileList);
+    }
+
+    //! Runs gmx wham with \p args, writing its output files with prefix \p name
+    void runWham(const CommandLine& args, const std::string& name)
+    {
+        CommandLine cmdline;
+        cmdline.append("wham");
+        cmdline.addOption("-ip", pdoFileList_);
+        cmdline.addOption("-o", fileManager().getTemporaryFilePath(name + "-profile.xvg"));
+        cmdline.addOption("-hist", fileManager().getTemporaryFilePath(name + "-histo.xvg"));
+        cmdline.addOption("-bsres", fileManager().getTemporaryFilePath(name + "-bsres.xvg"));
+        cmdline.addOption("-bsprof", fileManager().getTemporaryFilePath(name + "-bsprof.xvg"));
+        cmdline.addOption("-xvg", "none");
+        cmdline.merge(args);
+
+        EXPECT_EQ(0, gmx_wham(cmdline.argc(), cmdline.argv()));
+    }
+
+    //! Returns the contents of output file \p suffix of the run with prefix \p name
+    std::string readOutput(const std::string& name, const std::string& suffix)
+    {
+        return TextReader::readFileToString(fileManager().getTemporaryFilePath(name + suffix));
+    }
+
+    //! Returns the profile of a gmx wham run with \p andersonDepth
+    std::vector<double> runWhamProfile(int andersonDepth)
+    {
+        CommandLine args;
+        args.addOption("-anderson", andersonDepth);
+        args.addOption("-bins", 50);
+        const std::string name = formatString("anderson%d", andersonDepth);
+        runWham(args, name);
+        const auto          data = readXvgData(fileManager().getTemporaryFilePath(name + "-profile.xvg"));
+        std::vector<double> profile;
+        for (int row = 0; row < data.extent(1); row++)
+        {
+            profile.push_back(data(1, row));
+        }
+        return profile;
+    }
+
+private:
+    //! The file with the list of pdo files
+    std::string pdoFileList_;
+};
+
+TEST_F(GmxWhamTest, AndersonMixingGivesSameProfile)
+{
+    const std::vector<double> plainProfile = runWhamProfile(0);
+    const std::vector<double> mixedProfile = runWhamProfile(5);
+
+    ASSERT_EQ(plainProfile.size(), mixedProfile.size());
+    ASSERT_FALSE(plainProfile.empty());
+    /* Both iterations converge the offsets to the same tolerance */
+    const FloatingPointTolerance tolerance = absoluteTolerance(1e-3);
+    for (size_t i = 0; i < plainProfile.size(); i++)
+    {
+        EXPECT_REAL_EQ_TOL(plainProfile[i], mixedProfile[i], tolerance) << "for bin " << i;
+    }
+}
+
+TEST_F(GmxWhamTest, BootstrapsAreIndependentOfThreadCount)
+{
+    CommandLine args;
+    args.addOption("-nBootstrap", 4);
+    args.addOption("-bs-method", "b-hist");
+    args.addOption("-bins", 50);
+
+    const int maxNumThreads = gmx_omp_get_max_threads();
+
+    gmx_omp_set_num_threads(1);
+    runWham(args, "threads1");
+    gmx_omp_set_num_threads(3);
+    runWham(args, "threads3");
+    gmx_omp_set_num_threads(maxNumThreads);
+
+    EXPECT_EQ(readOutput("threads1", "-profile.xvg"), readOutput("threads3", "-profile.xvg"));
+    EXPECT_EQ(readOutput("threads1", "-bsprof.xvg"), readOutput("threads3", "-bsprof.xvg"));
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
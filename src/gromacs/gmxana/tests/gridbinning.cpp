@@ -0,0 +1,129 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for multi-threaded grid binning.
+ *
+ * \ingroup module_gmxana
+ */
+#include "gmxpre.h"
+
+#include "gromacs/gmxana/gridbinning.h"
+
+#include <numeric>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/utility/gmxomp.h"
+
+#include "testutils/testasserts.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+TEST(GridBinnerTest, AddPointsMatchesSerialBinning)
+{
+    const IVec       extents = { 3, 4, 5 };
+    GridBinner       binner(extents);
+    std::vector<int> bins;
+    for (int i = 0; i < 1000; i++)
+    {
+        bins.push_back((i * 7919) % (binner.numBins() + 3) - 3);
+    }
+    std::vector<double> reference(binner.numBins(), 0);
+    int                 referenceSkipped = 0;
+    for (size_t i = 0; i < bins.size(); i++)
+    {
+        if (bins[i] >= 0)
+        {
+            reference[bins[i]] += 0.5 * i;
+        }
+        else
+        {
+            referenceSkipped++;
+        }
+    }
+
+    const int numSkipped = binner.addPoints(bins.size(), [&bins](int i, real* weight) {
+        *weight = 0.5 * i;
+        return bins[i];
+    });
+    EXPECT_EQ(referenceSkipped, numSkipped);
+
+    ArrayRef<const double> grid = binner.reduce();
+    ASSERT_EQ(reference.size(), grid.size());
+    for (size_t b = 0; b < reference.size(); b++)
+    {
+        EXPECT_DOUBLE_EQ_TOL(reference[b], grid[b], defaultRealTolerance());
+    }
+    EXPECT_EQ(binner.binIndex(1, 2, 3), (1 * 4 + 2) * 5 + 3);
+}
+
+TEST(GridBinnerTest, GaussianSpreadingConservesAmplitude)
+{
+    GridBinner binner({ 20, 20, 20 });
+    binner.setGaussianSpreading(1.5, 5);
+    const std::vector<RVec> positions = { { 9.5, 10, 10.2 }, { 8, 11, 9 } };
+    auto                    positionOfPoint = [&positions](int i, RVec* x, real* amplitude) {
+        *x         = positions[i];
+        *amplitude = 2;
+        return true;
+    };
+    const int numSkipped = binner.spreadPoints(positions.size(), positionOfPoint);
+    EXPECT_EQ(0, numSkipped);
+
+    ArrayRef<const double> grid = binner.reduce();
+    const double           sum  = std::accumulate(grid.begin(), grid.end(), 0.0);
+    EXPECT_REAL_EQ_TOL(4, sum, relativeToleranceAsFloatingPoint(4, 1e-3));
+    EXPECT_GT(grid[binner.binIndex(9, 10, 10)], grid[binner.binIndex(2, 10, 10)]);
+}
+
+TEST(GridBinnerTest, LimitsThreadsForLargeGrids)
+{
+    // No grid memory is allocated before points are added
+    GridBinner smallBinner({ 10, 10, 10 });
+    EXPECT_EQ(gmx_omp_get_max_threads(), smallBinner.numThreads());
+    GridBinner largeBinner({ 1024, 1024, 128 });
+    EXPECT_EQ(1, largeBinner.numThreads());
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -44,11 +44,13 @@
 #include <cstdlib>
 #include <cstring>
 
+#include <algorithm>
 #include <numeric>
 #include <vector>
 
 #include "gromacs/commandline/pargs.h"
 #include "gromacs/fileio/confio.h"
+#include "gromacs/gmxpreprocess/occupancygrid.h"
 #include "gromacs/math/units.h"
 #include "gromacs/math/utilities.h"
 #include "gromacs/math/vec.h"
@@ -62,44 +64,13 @@
 #include "gromacs/utility/arraysize.h"
 #include "gromacs/utility/basedefinitions.h"
 #include "gromacs/utility/cstringutil.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/smalloc.h"
 
 
-/*! \brief Return whether any atoms of two groups are below minimum distance.
- *
- * \param[in] pbc the periodic boundary conditions
- * \param[in] x the coordinates
- * \param[in] smallerGroupIndices the atom indices of the first group to check
- * \param[in] largerGroupIndices the atom indices of the second group to check
- * \param[in] minimumDistance the minimum required distance betwenn any atom in
- *                            the first and second group
- * \returns true if any distance between an atom from group A and group B is
- *               smaller than a minimum distance.
- */
-static bool groupsCloserThanCutoffWithPbc(t_pbc*                   pbc,
-                                          rvec                     x[],
-                                          gmx::ArrayRef<const int> smallerGroupIndices,
-                                          gmx::ArrayRef<const int> largerGroupIndices,
-                                          real                     minimumDistance)
-{
-    const real minimumDistance2 = minimumDistance * minimumDistance;
-    for (int aIndex : largerGroupIndices)
-    {
-        for (int bIndex : smallerGroupIndices)
-        {
-            rvec dx;
-            pbc_dx(pbc, x[aIndex], x[bIndex], dx);
-            if (norm2(dx) < minimumDistance2)
-            {
-                return true;
-            }
-        }
-    }
-    return false;
-}
-
 /*! \brief Calculate the solvent molecule atom indices from molecule number.
  *
  * \note the solvent group index has to be continuous
@@ -123,45 +94,158 @@ static std::vector<int> solventMoleculeIndices(int solventMoleculeNumber,
     return indices;
 }
 
-static void insert_ion(int                      nsa,
-                       std::vector<int>*        solventMoleculesForReplacement,
-                       int                      repl[],
-                       gmx::ArrayRef<const int> index,
-                       rvec                     x[],
-                       t_pbc*                   pbc,
-                       int                      sign,
-                       int                      q,
-                       const char*              ionname,
-                       t_atoms*                 atoms,
-                       real                     rmin,
-                       std::vector<int>*        notSolventGroup)
+/*! \brief Return whether any atom of a solvent molecule is closer than the grid cut-off
+ * to a position in the grid.
+ *
+ * \param[in] grid                  grid with the positions ions should stay away from
+ * \param[in] firstPositionToCheck  only grid positions with this index or higher are checked
+ * \param[in] x                     the coordinates
+ * \param[in] solventMoleculeAtoms  the atom indices of the solvent molecule
+ */
+static bool solventMoleculeIsCloserThanCutoff(const gmx::OccupancyGrid& grid,
+                                              int                       firstPositionToCheck,
+                                              const rvec                x[],
+                                              gmx::ArrayRef<const int>  solventMoleculeAtoms)
 {
-    std::vector<int> solventMoleculeAtomsToBeReplaced =
-            solventMoleculeIndices(solventMoleculesForReplacement->back(), nsa, index);
+    for (int atomIndex : solventMoleculeAtoms)
+    {
+        const bool searchCompleted = grid.forEachPositionWithinCutoff(
+                x[atomIndex], [firstPositionToCheck](int index, real /* distance2 */) {
+                    return index < firstPositionToCheck;
+                });
+        if (!searchCompleted)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*! \brief Select the solvent molecules to replace by ions.
+ *
+ * Candidates are taken from the back of \p candidates.
+ * A candidate is rejected when any of its atoms is within \p rmin of
+ * a non-solvent atom or of an ion placed before it. The candidates are checked
+ * in parallel in batches against a grid that is updated with each placed ion,
+ * followed by an in-order check against the ions placed in the same batch.
+ * This gives the same selection as checking one candidate at a time.
+ *
+ * \param[in]     numIons            the number of ions to place
+ * \param[in]     nsa                the number of atoms per solvent molecule
+ * \param[in]     solventGroupIndex  continuous index of solvent atoms
+ * \param[in,out] candidates         the solvent molecule candidates, checked ones are removed
+ * \param[in]     x                  the coordinates
+ * \param[in]     numAtoms           the number of atoms
+ * \param[in]     pbc                the periodic boundary conditions
+ * \param[in]     box                the box
+ * \param[in]     rmin               the minimum distance of ions to non-solvent and other ions
+ * \param[in]     notSolventGroup    the non-solvent atoms
+ *
+ * \returns the selected solvent molecules, in order of selection
+ */
+static std::vector<int> selectSolventMoleculesForReplacement(int                      numIons,
+                                                             int                      nsa,
+                                                             gmx::ArrayRef<const int> solventGroupIndex,
+                                                             std::vector<int>*        candidates,
+                                                             const rvec               x[],
+                                                             int                      numAtoms,
+                                                             const t_pbc&             pbc,
+                                                             const matrix             box,
+                                                             real                     rmin,
+                                                             gmx::ArrayRef<const int> notSolventGroup)
+{
+    std::vector<int> selectedMolecules;
+    if (rmin <= 0)
+    {
+        while (gmx::ssize(selectedMolecules) < numIons && !candidates->empty())
+        {
+            selectedMolecules.push_back(candidates->back());
+            candidates->pop_back();
+        }
+        return selectedMolecules;
+    }
 
-    if (rmin > 0.0)
+    /* Without PBC the grid only needs a box for setting up the cells,
+     * positions outside of it are still handled correctly.
+     */
+    matrix gridBox;
+    copy_mat(box, gridBox);
+    if (pbc.pbcType == PbcType::No || det(box) <= 0)
     {
-        // check for proximity to non-solvent
-        while (groupsCloserThanCutoffWithPbc(pbc, x, solventMoleculeAtomsToBeReplaced, *notSolventGroup, rmin)
-               && !solventMoleculesForReplacement->empty())
+        clear_mat(gridBox);
+        for (int d = 0; d < DIM; d++)
         {
-            solventMoleculesForReplacement->pop_back();
-            solventMoleculeAtomsToBeReplaced =
-                    solventMoleculeIndices(solventMoleculesForReplacement->back(), nsa, index);
+            gridBox[d][d] = rmin;
+            for (int i = 0; i < numAtoms; i++)
+            {
+                gridBox[d][d] = std::max(gridBox[d][d], x[i][d]);
+            }
         }
     }
+    gmx::OccupancyGrid grid(pbc, gridBox, rmin);
+    for (int atomIndex : notSolventGroup)
+    {
+        grid.addPosition(x[atomIndex]);
+    }
 
-    if (solventMoleculesForReplacement->empty())
+    const int         numThreads   = gmx_omp_get_max_threads();
+    const int         maxBatchSize = 16 * numThreads;
+    std::vector<char> isCloseToFixedAtoms(maxBatchSize);
+    while (gmx::ssize(selectedMolecules) < numIons && !candidates->empty())
     {
-        gmx_fatal(FARGS, "No more replaceable solvent!");
+        const int batchSize          = std::min(maxBatchSize, static_cast<int>(candidates->size()));
+        const int batchStartPosition = grid.numPositions();
+        // Candidates are taken from the back, so candidate i in the batch is at back - i
+        const int* batchCandidates = candidates->data() + candidates->size() - 1;
+#pragma omp parallel for num_threads(numThreads) schedule(static)
+        for (int i = 0; i < batchSize; i++)
+        {
+            try
+            {
+                const std::vector<int> moleculeAtoms =
+                        solventMoleculeIndices(*(batchCandidates - i), nsa, solventGroupIndex);
+                isCloseToFixedAtoms[i] = solventMoleculeIsCloserThanCutoff(grid, 0, x, moleculeAtoms);
+            }
+            GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+        }
+
+        for (int i = 0; i < batchSize && gmx::ssize(selectedMolecules) < numIons; i++)
+        {
+            const int              candidate = candidates->back();
+            const std::vector<int> moleculeAtoms =
+                    solventMoleculeIndices(candidate, nsa, solventGroupIndex);
+            candidates->pop_back();
+            if (isCloseToFixedAtoms[i]
+                || solventMoleculeIsCloserThanCutoff(grid, batchStartPosition, x, moleculeAtoms))
+            {
+                continue;
+            }
+            selectedMolecules.push_back(candidate);
+            // The ion is placed at the position of the first atom of the molecule
+            grid.addPosition(x[moleculeAtoms[0]]);
+        }
     }
 
-    fprintf(stderr, "Replacing solvent molecule %d (atom %d) with %s\n",
-            solventMoleculesForReplacement->back(), solventMoleculeAtomsToBeReplaced[0], ionname);
+    return selectedMolecules;
+}
+
+static void insert_ion(int                      nsa,
+                       int                      solventMolecule,
+                       int                      repl[],
+                       gmx::ArrayRef<const int> index,
+                       int                      sign,
+                       int                      q,
+                       const char*              ionname,
+                       t_atoms*                 atoms)
+{
+    std::vector<int> solventMoleculeAtomsToBeReplaced =
+            solventMoleculeIndices(solventMolecule, nsa, index);
+
+    fprintf(stderr, "Replacing solvent molecule %d (atom %d) with %s\n", solventMolecule,
+            solventMoleculeAtomsToBeReplaced[0], ionname);
 
     /* Replace solvent molecule charges with ion charge */
-    notSolventGroup->push_back(solventMoleculeAtomsToBeReplaced[0]);
-    repl[solventMoleculesForReplacement->back()] = sign;
+    repl[solventMolecule] = sign;
 
     // The first solvent molecule atom is replaced with an ion and the respective
     // charge while the rest of the solvent molecule atoms is set to 0 charge.
@@ -171,7 +255,6 @@ static void insert_ion(int                      nsa,
     {
         atoms->atom[*replacedMoleculeAtom].q = 0;
     }
-    solventMoleculesForReplacement->pop_back();
 }
 
 
@@ -644,16 +727,25 @@ int gmx_genion(int argc, char* argv[])
         std::shuffle(std::begin(solventMoleculesForReplacement),
                      std::end(solventMoleculesForReplacement), rng);
 
+        const std::vector<int> moleculesToReplace = selectSolventMoleculesForReplacement(
+                p_num + n_num, nsa, solventGroup, &solventMoleculesForReplacement, x, atoms.nr,
+                pbc, box, rmin, notSolventGroup);
+
         /* Now loop over the ions that have to be placed */
-        while (p_num-- > 0)
+        for (gmx::index i = 0; i < gmx::ssize(moleculesToReplace); i++)
         {
-            insert_ion(nsa, &solventMoleculesForReplacement, repl, solventGroup, x, &pbc, 1, p_q,
-                       p_name, &atoms, rmin, &notSolventGroup);
+            if (i < p_num)
+            {
+                insert_ion(nsa, moleculesToReplace[i], repl, solventGroup, 1, p_q, p_name, &atoms);
+            }
+            else
+            {
+                insert_ion(nsa, moleculesToReplace[i], repl, solventGroup, -1, n_q, n_name, &atoms);
+            }
         }
-        while (n_num-- > 0)
+        if (gmx::ssize(moleculesToReplace) < p_num + n_num)
         {
-            insert_ion(nsa, &solventMoleculesForReplacement, repl, solventGroup, x, &pbc, -1, n_q,
-                       n_name, &atoms, rmin, &notSolventGroup);
+            gmx_fatal(FARGS, "No more replaceable solvent!");
         }
         fprintf(stderr, "\n");
 
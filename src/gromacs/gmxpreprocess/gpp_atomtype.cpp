@@ -367,6 +367,7 @@ void PreprocessingAtomTypes::renumberTypes(gmx::ArrayRef<InteractionsOfType> pli
 
     impl_->types                  = new_types;
     plist[ftype].interactionTypes = nbsnew;
+    plist[ftype].generation++;
 }
 
 void PreprocessingAtomTypes::copyTot_atomtypes(t_atomtypes* atomtypes) const
@@ -102,6 +102,7 @@
 #include "gromacs/utility/filestream.h"
 #include "gromacs/utility/futil.h"
 #include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/keyvaluetreebuilder.h"
 #include "gromacs/utility/listoflists.h"
 #include "gromacs/utility/logger.h"
@@ -339,10 +340,8 @@ static void check_bonds_timestep(const gmx_mtop_t* mtop, double dt, warninp* wi)
      */
     int  min_steps_warn = 5;
     int  min_steps_note = 10;
-    int  ftype;
-    int  i, a1, a2, w_a1, w_a2, j;
-    real twopi2, limit2, fc, re, m1, m2, period2, w_period2;
-    bool bFound, bWater, bWarn;
+    real twopi2, limit2;
+    bool bWater, bWarn;
 
     /* Get the interaction parameters */
     gmx::ArrayRef<const t_iparams> ip = mtop->ffparams.iparams;
@@ -351,79 +350,109 @@ static void check_bonds_timestep(const gmx_mtop_t* mtop, double dt, warninp* wi)
 
     limit2 = gmx::square(min_steps_note * dt);
 
-    w_a1 = w_a2 = -1;
-    w_period2   = -1.0;
+    /* The shortest unconstrained period, with atom pair, per moleculetype */
+    struct ShortestPeriod
+    {
+        int  a1      = -1;
+        int  a2      = -1;
+        real period2 = -1.0;
+    };
+    std::vector<ShortestPeriod> shortestPeriod(mtop->moltype.size());
 
-    const gmx_moltype_t* w_moltype = nullptr;
-    for (const gmx_moltype_t& moltype : mtop->moltype)
+#pragma omp parallel for num_threads(gmx_omp_get_max_threads()) schedule(dynamic)
+    for (gmx::index mt = 0; mt < gmx::ssize(mtop->moltype); mt++)
     {
-        const t_atom*           atom  = moltype.atoms.atom;
-        const InteractionLists& ilist = moltype.ilist;
-        const InteractionList&  ilc   = ilist[F_CONSTR];
-        const InteractionList&  ils   = ilist[F_SETTLE];
-        for (ftype = 0; ftype < F_NRE; ftype++)
+        try
         {
-            if (!(ftype == F_BONDS || ftype == F_G96BONDS || ftype == F_HARMONIC))
-            {
-                continue;
-            }
-
-            const InteractionList& ilb = ilist[ftype];
-            for (i = 0; i < ilb.size(); i += 3)
+            const gmx_moltype_t&    moltype = mtop->moltype[mt];
+            const t_atom*           atom    = moltype.atoms.atom;
+            const InteractionLists& ilist   = moltype.ilist;
+            const InteractionList&  ilc     = ilist[F_CONSTR];
+            const InteractionList&  ils     = ilist[F_SETTLE];
+            ShortestPeriod&         w       = shortestPeriod[mt];
+            for (int ftype = 0; ftype < F_NRE; ftype++)
             {
-                fc = ip[ilb.iatoms[i]].harmonic.krA;
-                re = ip[ilb.iatoms[i]].harmonic.rA;
-                if (ftype == F_G96BONDS)
-                {
-                    /* Convert squared sqaure fc to harmonic fc */
-                    fc = 2 * fc * re;
-                }
-                a1 = ilb.iatoms[i + 1];
-                a2 = ilb.iatoms[i + 2];
-                m1 = atom[a1].m;
-                m2 = atom[a2].m;
-                if (fc > 0 && m1 > 0 && m2 > 0)
+                if (!(ftype == F_BONDS || ftype == F_G96BONDS || ftype == F_HARMONIC))
                 {
-                    period2 = twopi2 * m1 * m2 / ((m1 + m2) * fc);
+                    continue;
                 }
-                else
-                {
-                    period2 = GMX_FLOAT_MAX;
-                }
-                if (debug)
-                {
-                    fprintf(debug, "fc %g m1 %g m2 %g period %g\n", fc, m1, m2, std::sqrt(period2));
-                }
-                if (period2 < limit2)
+
+                const InteractionList& ilb = ilist[ftype];
+                for (int i = 0; i < ilb.size(); i += 3)
                 {
-                    bFound = false;
-                    for (j = 0; j < ilc.size(); j += 3)
+                    real fc = ip[ilb.iatoms[i]].harmonic.krA;
+                    real re = ip[ilb.iatoms[i]].harmonic.rA;
+                    if (ftype == F_G96BONDS)
                     {
-                        if ((ilc.iatoms[j + 1] == a1 && ilc.iatoms[j + 2] == a2)
-                            || (ilc.iatoms[j + 1] == a2 && ilc.iatoms[j + 2] == a1))
-                        {
-                            bFound = true;
-                        }
+                        /* Convert squared sqaure fc to harmonic fc */
+                        fc = 2 * fc * re;
                     }
-                    for (j = 0; j < ils.size(); j += 4)
+                    int  a1 = ilb.iatoms[i + 1];
+                    int  a2 = ilb.iatoms[i + 2];
+                    real m1 = atom[a1].m;
+                    real m2 = atom[a2].m;
+                    real period2;
+                    if (fc > 0 && m1 > 0 && m2 > 0)
                     {
-                        if ((a1 == ils.iatoms[j + 1] || a1 == ils.iatoms[j + 2] || a1 == ils.iatoms[j + 3])
-                            && (a2 == ils.iatoms[j + 1] || a2 == ils.iatoms[j + 2]
-                                || a2 == ils.iatoms[j + 3]))
-                        {
-                            bFound = true;
-                        }
+                        period2 = twopi2 * m1 * m2 / ((m1 + m2) * fc);
+                    }
+                    else
+                    {
+                        period2 = GMX_FLOAT_MAX;
                     }
-                    if (!bFound && (w_moltype == nullptr || period2 < w_period2))
+                    if (debug)
                     {
-                        w_moltype = &moltype;
-                        w_a1      = a1;
-                        w_a2      = a2;
-                        w_period2 = period2;
+                        fprintf(debug, "fc %g m1 %g m2 %g period %g\n", fc, m1, m2,
+                                std::sqrt(period2));
+                    }
+                    if (period2 < limit2)
+                    {
+                        bool bFound = false;
+                        for (int j = 0; j < ilc.size(); j += 3)
+                        {
+                            if ((ilc.iatoms[j + 1] == a1 && ilc.iatoms[j + 2] == a2)
+                                || (ilc.iatoms[j + 1] == a2 && ilc.iatoms[j + 2] == a1))
+                            {
+                                bFound = true;
+                            }
+                        }
+                        for (int j = 0; j < ils.size(); j += 4)
+                        {
+                            if ((a1 == ils.iatoms[j + 1] || a1 == ils.iatoms[j + 2]
+                                 || a1 == ils.iatoms[j + 3])
+                                && (a2 == ils.iatoms[j + 1] || a2 == ils.iatoms[j + 2]
+                                    || a2 == ils.iatoms[j + 3]))
+                            {
+                                bFound = true;
+                            }
+                        }
+                        if (!bFound && (w.a1 < 0 || period2 < w.period2))
+                        {
+                            w.a1      = a1;
+                            w.a2      = a2;
+                            w.period2 = period2;
+                        }
                     }
                 }
             }
         }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR;
+    }
+
+    /* Reduce in moleculetype order, so we report the same bond as a serial search */
+    int                  w_a1 = -1, w_a2 = -1;
+    real                 w_period2 = -1.0;
+    const gmx_moltype_t* w_moltype = nullptr;
+    for (size_t mt = 0; mt < mtop->moltype.size(); mt++)
+    {
+        const ShortestPeriod& w = shortestPeriod[mt];
+        if (w.a1 >= 0 && (w_moltype == nullptr || w.period2 < w_period2))
+        {
+            w_moltype = &mtop->moltype[mt];
+            w_a1      = w.a1;
+            w_a2      = w.a2;
+            w_period2 = w.period2;
+        }
     }
 
     if (w_moltype != nullptr)
@@ -1361,17 +1390,15 @@ static real get_max_reference_temp(const t_inputrec* ir, warninp* wi)
     return ref_t;
 }
 
-/* Checks if there are unbound atoms in moleculetype molt.
- * Prints a note for each unbound atoms and a warning if any is present.
- */
-static void checkForUnboundAtoms(const gmx_moltype_t* molt, gmx_bool bVerbose, warninp* wi, const gmx::MDLogger& logger)
+/* Returns the indices of the unbound atoms in moleculetype molt */
+static std::vector<int> findUnboundAtoms(const gmx_moltype_t& molt)
 {
-    const t_atoms* atoms = &molt->atoms;
+    const t_atoms* atoms = &molt.atoms;
 
     if (atoms->nr == 1)
     {
         /* Only one atom, there can't be unbound atoms */
-        return;
+        return {};
     }
 
     std::vector<int> count(atoms->nr, 0);
@@ -1381,7 +1408,7 @@ static void checkForUnboundAtoms(const gmx_moltype_t* molt, gmx_bool bVerbose, w
         if (((interaction_function[ftype].flags & IF_BOND) && NRAL(ftype) == 2 && ftype != F_CONNBONDS)
             || (interaction_function[ftype].flags & IF_CONSTRAINT) || ftype == F_SETTLE)
         {
-            const InteractionList& il   = molt->ilist[ftype];
+            const InteractionList& il   = molt.ilist[ftype];
             const int              nral = NRAL(ftype);
 
             for (int i = 0; i < il.size(); i += 1 + nral)
@@ -1394,43 +1421,63 @@ static void checkForUnboundAtoms(const gmx_moltype_t* molt, gmx_bool bVerbose, w
         }
     }
 
-    int numDanglingAtoms = 0;
+    std::vector<int> unboundAtoms;
     for (int a = 0; a < atoms->nr; a++)
     {
         if (atoms->atom[a].ptype != eptVSite && count[a] == 0)
         {
-            if (bVerbose)
+            unboundAtoms.push_back(a);
+        }
+    }
+
+    return unboundAtoms;
+}
+
+/* Checks all moleculetypes for unbound atoms.
+ * Prints a note for each unbound atoms and a warning for each moleculetype
+ * with unbound atoms. The moleculetypes are searched concurrently,
+ * the output is given in moleculetype order.
+ */
+static void checkForUnboundAtoms(const gmx_mtop_t* mtop, gmx_bool bVerbose, warninp* wi, const gmx::MDLogger& logger)
+{
+    std::vector<std::vector<int>> unboundAtoms(mtop->moltype.size());
+#pragma omp parallel for num_threads(gmx_omp_get_max_threads()) schedule(dynamic)
+    for (gmx::index mt = 0; mt < gmx::ssize(mtop->moltype); mt++)
+    {
+        try
+        {
+            unboundAtoms[mt] = findUnboundAtoms(mtop->moltype[mt]);
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR;
+    }
+
+    for (size_t mt = 0; mt < mtop->moltype.size(); mt++)
+    {
+        const gmx_moltype_t& molt = mtop->moltype[mt];
+        if (bVerbose)
+        {
+            for (int a : unboundAtoms[mt])
             {
                 GMX_LOG(logger.warning)
                         .asParagraph()
                         .appendTextFormatted(
                                 "Atom %d '%s' in moleculetype '%s' is not bound by a potential or "
                                 "constraint to any other atom in the same moleculetype.",
-                                a + 1, *atoms->atomname[a], *molt->name);
+                                a + 1, *molt.atoms.atomname[a], *molt.name);
             }
-            numDanglingAtoms++;
         }
-    }
 
-    if (numDanglingAtoms > 0)
-    {
-        std::string warningMessage = gmx::formatString(
-                "In moleculetype '%s' %d atoms are not bound by a potential or constraint to any "
-                "other atom in the same moleculetype. Although technically this might not cause "
-                "issues in a simulation, this often means that the user forgot to add a "
-                "bond/potential/constraint or put multiple molecules in the same moleculetype "
-                "definition by mistake. Run with -v to get information for each atom.",
-                *molt->name, numDanglingAtoms);
-        warning_note(wi, warningMessage.c_str());
-    }
-}
-
-/* Checks all moleculetypes for unbound atoms */
-static void checkForUnboundAtoms(const gmx_mtop_t* mtop, gmx_bool bVerbose, warninp* wi, const gmx::MDLogger& logger)
-{
-    for (const gmx_moltype_t& molt : mtop->moltype)
-    {
-        checkForUnboundAtoms(&molt, bVerbose, wi, logger);
+        if (!unboundAtoms[mt].empty())
+        {
+            std::string warningMessage = gmx::formatString(
+                    "In moleculetype '%s' %zu atoms are not bound by a potential or constraint to "
+                    "any other atom in the same moleculetype. Although technically this might not "
+                    "cause issues in a simulation, this often means that the user forgot to add a "
+                    "bond/potential/constraint or put multiple molecules in the same moleculetype "
+                    "definition by mistake. Run with -v to get information for each atom.",
+                    *molt.name, unboundAtoms[mt].size());
+            warning_note(wi, warningMessage.c_str());
+        }
     }
 }
 
@@ -1611,17 +1658,26 @@ static void set_verlet_buffer(const gmx_mtop_t*    mtop,
                     "Determining Verlet buffer for a tolerance of %g kJ/mol/ps at %g K",
                     ir->verletbuf_tol, buffer_temp);
 
-    /* Calculate the buffer size for simple atom vs atoms list */
+    /* The molecule types and the list setups are processed concurrently */
+    const VerletBufferEstimator verletBufferEstimator(*mtop, *ir, gmx_omp_get_max_threads());
+
+    /* Calculate the buffer size for simple atom vs atoms list
+     * and for the 4x4 list that we use to set the pair-list buffer in ir.
+     */
     VerletbufListSetup listSetup1x1;
-    listSetup1x1.cluster_size_i = 1;
-    listSetup1x1.cluster_size_j = 1;
-    const real rlist_1x1 = calcVerletBufferSize(*mtop, det(box), *ir, ir->nstlist, ir->nstlist - 1,
-                                                buffer_temp, listSetup1x1);
+    listSetup1x1.cluster_size_i           = 1;
+    listSetup1x1.cluster_size_j           = 1;
+    const VerletbufListSetup listSetup4x4 = verletbufGetSafeListSetup(ListSetupType::CpuNoSimd);
+
+    const VerletbufCandidate candidates[] = {
+        { ir->nstlist, ir->nstlist - 1, buffer_temp, listSetup1x1 },
+        { ir->nstlist, ir->nstlist - 1, buffer_temp, listSetup4x4 }
+    };
+    const std::vector<real> rlists = verletBufferEstimator.calcBufferSizes(det(box), *ir, candidates);
+    const real              rlist_1x1 = rlists[0];
 
     /* Set the pair-list buffer size in ir */
-    VerletbufListSetup listSetup4x4 = verletbufGetSafeListSetup(ListSetupType::CpuNoSimd);
-    ir->rlist = calcVerletBufferSize(*mtop, det(box), *ir, ir->nstlist, ir->nstlist - 1,
-                                     buffer_temp, listSetup4x4);
+    ir->rlist = rlists[1];
 
     const int n_nonlin_vsite = gmx::countNonlinearVsites(*mtop);
     if (n_nonlin_vsite > 0)
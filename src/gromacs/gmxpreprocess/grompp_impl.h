@@ -39,6 +39,8 @@
 #ifndef GMX_GMXPREPROCESS_GROMPP_IMPL_H
 #define GMX_GMXPREPROCESS_GROMPP_IMPL_H
 
+#include <cstdint>
+
 #include <string>
 
 #include "gromacs/gmxpreprocess/notset.h"
@@ -149,6 +151,12 @@ struct InteractionsOfType
     std::vector<real> cmap;
     //! The five atomtypes followed by a number that identifies the type.
     std::vector<int> cmapAtomTypes;
+    /*! \brief Counter of modifications of the types other than appending
+     *
+     * Should be incremented when types are removed, replaced or reordered,
+     * so indices on the types, such as BondedTypeIndex, rebuild themselves.
+     */
+    int64_t generation = 0;
 
     //! Number of parameters.
     size_t size() const { return interactionTypes.size(); }
@@ -51,6 +51,7 @@
 #include "gromacs/fileio/xvgr.h"
 #include "gromacs/gmxlib/conformation_utilities.h"
 #include "gromacs/gmxpreprocess/makeexclusiondistances.h"
+#include "gromacs/gmxpreprocess/occupancygrid.h"
 #include "gromacs/math/functions.h"
 #include "gromacs/math/utilities.h"
 #include "gromacs/math/vec.h"
@@ -60,7 +61,6 @@
 #include "gromacs/pbcutil/pbc.h"
 #include "gromacs/random/threefry.h"
 #include "gromacs/random/uniformrealdistribution.h"
-#include "gromacs/selection/nbsearch.h"
 #include "gromacs/selection/selection.h"
 #include "gromacs/selection/selectioncollection.h"
 #include "gromacs/selection/selectionoption.h"
@@ -76,6 +76,7 @@
 #include "gromacs/utility/enumerationhelpers.h"
 #include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/smalloc.h"
 
 using gmx::RVec;
@@ -139,30 +140,40 @@ static void generate_trial_conf(gmx::ArrayRef<RVec>       xin,
     }
 }
 
-static bool isInsertionAllowed(gmx::AnalysisNeighborhoodSearch* search,
-                               const std::vector<real>&         exclusionDistances,
-                               const std::vector<RVec>&         x,
-                               const std::vector<real>&         exclusionDistances_insrt,
-                               const t_atoms&                   atoms,
-                               const std::set<int>&             removableAtoms,
-                               gmx::AtomsRemover*               remover)
+/*! \brief Checks whether the molecule at \p x can be inserted
+ *
+ * Only positions in \p grid with index \p firstPositionToCheck or higher
+ * are checked. Removable positions that overlap are added to \p positionsToReplace.
+ */
+static bool isInsertionAllowed(const gmx::OccupancyGrid& grid,
+                               int                       firstPositionToCheck,
+                               const std::vector<real>&  exclusionDistances,
+                               const std::vector<RVec>&  x,
+                               const std::vector<real>&  exclusionDistances_insrt,
+                               const std::vector<bool>&  isRemovable,
+                               std::vector<int>*         positionsToReplace)
 {
-    gmx::AnalysisNeighborhoodPositions  pos(x);
-    gmx::AnalysisNeighborhoodPairSearch pairSearch = search->startPairSearch(pos);
-    gmx::AnalysisNeighborhoodPair       pair;
-    while (pairSearch.findNextPair(&pair))
+    for (gmx::index i = 0; i < gmx::ssize(x); i++)
     {
-        const real r1 = exclusionDistances[pair.refIndex()];
-        const real r2 = exclusionDistances_insrt[pair.testIndex()];
-        if (pair.distance2() < gmx::square(r1 + r2))
-        {
-            if (removableAtoms.count(pair.refIndex()) == 0)
+        const real r2            = exclusionDistances_insrt[i];
+        const auto checkPosition = [&](int refIndex, real distance2) {
+            if (refIndex < firstPositionToCheck
+                || distance2 >= gmx::square(exclusionDistances[refIndex] + r2))
+            {
+                return true;
+            }
+            if (refIndex >= gmx::ssize(isRemovable) || !isRemovable[refIndex])
             {
                 return false;
             }
             // TODO: If molecule information is available, this should ideally
             // use it to remove whole molecules.
-            remover->markResidue(atoms, pair.refIndex(), true);
+            positionsToReplace->push_back(refIndex);
+            return true;
+        };
+        if (!grid.forEachPositionWithinCutoff(x[i], checkPosition))
+        {
+            return false;
         }
     }
     return true;
@@ -201,11 +212,6 @@ static void insert_mols(int                  nmol_insrt,
         maxRadius = std::max(maxInsertRadius, maxExistingRadius);
     }
 
-    // TODO: Make all of this exception-safe.
-    gmx::AnalysisNeighborhood nb;
-    nb.setCutoff(maxInsertRadius + maxRadius);
-
-
     if (seed == 0)
     {
         seed = static_cast<int>(gmx::makeRandomSeed());
@@ -241,7 +247,29 @@ static void insert_mols(int                  nmol_insrt,
         exclusionDistances.reserve(finalAtomCount);
     }
 
-    std::vector<RVec> x_n(x_insrt.size());
+    std::vector<bool> isRemovable(atoms->nr, false);
+    for (int index : removableAtoms)
+    {
+        isRemovable[index] = true;
+    }
+
+    // The grid is updated with each inserted molecule, so the search does
+    // not need to be rebuilt for every trial.
+    gmx::OccupancyGrid grid(pbc, box, maxInsertRadius + maxRadius);
+    grid.addPositions(*x);
+
+    /* Trial configurations are generated serially in batches and checked
+     * in parallel. They are accepted in order, checking against molecules
+     * accepted earlier in the same batch, so the result is identical
+     * to inserting one trial at a time, independently of the number of threads.
+     * With -ip the position of the next trial depends on the acceptance of
+     * the previous trial, so then trials are checked one at a time.
+     */
+    const int                      numThreads   = gmx_omp_get_max_threads();
+    const int                      maxBatchSize = (insertAtPositions ? 1 : 4 * numThreads);
+    std::vector<std::vector<RVec>> trialX(maxBatchSize);
+    std::vector<std::vector<int>>  positionsToReplace(maxBatchSize);
+    std::vector<char>              trialAllowed(maxBatchSize);
 
     int                                mol        = 0;
     int                                trial      = 0;
@@ -251,15 +279,8 @@ static void insert_mols(int                  nmol_insrt,
 
     while (mol < nmol_insrt && trial < ntry * nmol_insrt)
     {
-        rvec offset_x;
-        if (!insertAtPositions)
-        {
-            // Insert at random positions.
-            offset_x[XX] = box[XX][XX] * dist(rng);
-            offset_x[YY] = box[YY][YY] * dist(rng);
-            offset_x[ZZ] = box[ZZ][ZZ] * dist(rng);
-        }
-        else
+        int batchSize = std::min(maxBatchSize, ntry * nmol_insrt - trial);
+        if (insertAtPositions)
         {
             // Skip a position if ntry trials were not successful.
             if (trial >= firstTrial + ntry)
@@ -271,27 +292,75 @@ static void insert_mols(int                  nmol_insrt,
                 firstTrial = trial;
                 continue;
             }
-            // Insert at positions taken from option -ip file.
-            offset_x[XX] = rpos[XX][mol] + deltaR[XX] * (2 * dist(rng) - 1);
-            offset_x[YY] = rpos[YY][mol] + deltaR[YY] * (2 * dist(rng) - 1);
-            offset_x[ZZ] = rpos[ZZ][mol] + deltaR[ZZ] * (2 * dist(rng) - 1);
         }
-        fprintf(stderr, "\rTry %d", ++trial);
-        fflush(stderr);
-
-        generate_trial_conf(x_insrt, offset_x, enum_rot, &rng, &x_n);
-        gmx::AnalysisNeighborhoodPositions pos(*x);
-        gmx::AnalysisNeighborhoodSearch    search = nb.initSearch(&pbc, pos);
-        if (isInsertionAllowed(&search, exclusionDistances, x_n, exclusionDistances_insrt, *atoms,
-                               removableAtoms, &remover))
+
+        for (int t = 0; t < batchSize; t++)
         {
-            x->insert(x->end(), x_n.begin(), x_n.end());
-            exclusionDistances.insert(exclusionDistances.end(), exclusionDistances_insrt.begin(),
-                                      exclusionDistances_insrt.end());
-            builder.mergeAtoms(atoms_insrt);
-            ++mol;
-            firstTrial = trial;
-            fprintf(stderr, " success (now %d atoms)!\n", builder.currentAtomCount());
+            rvec offset_x;
+            if (!insertAtPositions)
+            {
+                // Insert at random positions.
+                offset_x[XX] = box[XX][XX] * dist(rng);
+                offset_x[YY] = box[YY][YY] * dist(rng);
+                offset_x[ZZ] = box[ZZ][ZZ] * dist(rng);
+            }
+            else
+            {
+                // Insert at positions taken from option -ip file.
+                offset_x[XX] = rpos[XX][mol] + deltaR[XX] * (2 * dist(rng) - 1);
+                offset_x[YY] = rpos[YY][mol] + deltaR[YY] * (2 * dist(rng) - 1);
+                offset_x[ZZ] = rpos[ZZ][mol] + deltaR[ZZ] * (2 * dist(rng) - 1);
+            }
+            generate_trial_conf(x_insrt, offset_x, enum_rot, &rng, &trialX[t]);
+        }
+
+        const int batchStartAtomCount = grid.numPositions();
+#pragma omp parallel for num_threads(numThreads) schedule(dynamic)
+        for (int t = 0; t < batchSize; t++)
+        {
+            try
+            {
+                positionsToReplace[t].clear();
+                trialAllowed[t] = isInsertionAllowed(grid, 0, exclusionDistances, trialX[t],
+                                                     exclusionDistances_insrt, isRemovable,
+                                                     &positionsToReplace[t]);
+            }
+            GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+        }
+
+        for (int t = 0; t < batchSize; t++)
+        {
+            fprintf(stderr, "\rTry %d", ++trial);
+            fflush(stderr);
+
+            bool allowed = trialAllowed[t];
+            if (allowed && grid.numPositions() > batchStartAtomCount)
+            {
+                // Check for overlap with molecules inserted earlier in this batch
+                allowed = isInsertionAllowed(grid, batchStartAtomCount, exclusionDistances,
+                                             trialX[t], exclusionDistances_insrt, isRemovable,
+                                             &positionsToReplace[t]);
+            }
+            if (allowed)
+            {
+                for (int index : positionsToReplace[t])
+                {
+                    remover.markResidue(*atoms, index, true);
+                }
+                grid.addPositions(trialX[t]);
+                x->insert(x->end(), trialX[t].begin(), trialX[t].end());
+                exclusionDistances.insert(exclusionDistances.end(),
+                                          exclusionDistances_insrt.begin(),
+                                          exclusionDistances_insrt.end());
+                builder.mergeAtoms(atoms_insrt);
+                ++mol;
+                firstTrial = trial;
+                fprintf(stderr, " success (now %d atoms)!\n", builder.currentAtomCount());
+                if (mol == nmol_insrt)
+                {
+                    break;
+                }
+            }
         }
     }
 
@@ -0,0 +1,136 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Implements gmx::OccupancyGrid.
+ *
+ * \ingroup module_gmxpreprocess
+ */
+#include "gmxpre.h"
+
+#include "occupancygrid.h"
+
+#include <cmath>
+
+#include "gromacs/math/invertmatrix.h"
+#include "gromacs/utility/gmxassert.h"
+
+namespace gmx
+{
+
+//! The maximum number of grid cells, limits the memory usage with sparse positions
+static constexpr int c_maxNumCells = 1 << 24;
+
+OccupancyGrid::OccupancyGrid(const t_pbc& pbc, const matrix box, const real cutoff) :
+    pbc_(pbc),
+    cutoff2_(cutoff * cutoff)
+{
+    GMX_RELEASE_ASSERT(cutoff > 0, "The cut-off should be positive");
+    GMX_RELEASE_ASSERT(det(box) > 0, "The grid needs a box with non-zero volume");
+
+    copy_mat(box, box_);
+    invertBoxMatrix(box_, invBox_);
+
+    const int numPbcDims    = numPbcDimensions(pbc.pbcType);
+    double    numCellsTotal = 1;
+    for (int d = 0; d < DIM; d++)
+    {
+        periodic_[d] = (d < numPbcDims);
+        /* The distance between the planes of constant fractional coordinate d
+         * is one over the norm of the gradient of that coordinate.
+         */
+        const real height = 1 / std::sqrt(gmx::square(invBox_[XX][d]) + gmx::square(invBox_[YY][d])
+                                          + gmx::square(invBox_[ZZ][d]));
+        numCells_[d]      = std::max(static_cast<int>(height / cutoff), 1);
+        numCellsTotal *= numCells_[d];
+    }
+    if (numCellsTotal > c_maxNumCells)
+    {
+        // Use larger cells, this keeps the cells at least as large as the cut-off
+        const double scale = std::cbrt(c_maxNumCells / numCellsTotal);
+        for (int d = 0; d < DIM; d++)
+        {
+            numCells_[d] = std::max(static_cast<int>(numCells_[d] * scale), 1);
+        }
+    }
+
+    cellFirst_.resize(numCells_[XX] * numCells_[YY] * numCells_[ZZ], -1);
+}
+
+void OccupancyGrid::putInCell(const RVec& x, RVec* xInBox, IVec* cell) const
+{
+    RVec fractional;
+    for (int d = 0; d < DIM; d++)
+    {
+        fractional[d] = x[XX] * invBox_[XX][d] + x[YY] * invBox_[YY][d] + x[ZZ] * invBox_[ZZ][d];
+        if (periodic_[d])
+        {
+            fractional[d] -= std::floor(fractional[d]);
+            (*cell)[d] = std::min(static_cast<int>(fractional[d] * numCells_[d]), numCells_[d] - 1);
+        }
+        else
+        {
+            const real cellCoordinate = fractional[d] * numCells_[d];
+            (*cell)[d] = std::clamp(static_cast<int>(std::floor(cellCoordinate)), 0, numCells_[d] - 1);
+        }
+    }
+    for (int d = 0; d < DIM; d++)
+    {
+        (*xInBox)[d] = fractional[XX] * box_[XX][d] + fractional[YY] * box_[YY][d]
+                       + fractional[ZZ] * box_[ZZ][d];
+    }
+}
+
+void OccupancyGrid::addPosition(const RVec& x)
+{
+    RVec xInBox;
+    IVec cell;
+    putInCell(x, &xInBox, &cell);
+
+    const int cellIndex = (cell[XX] * numCells_[YY] + cell[YY]) * numCells_[ZZ] + cell[ZZ];
+    next_.push_back(cellFirst_[cellIndex]);
+    cellFirst_[cellIndex] = numPositions();
+    positions_.push_back(xInBox);
+}
+
+void OccupancyGrid::addPositions(ArrayRef<const RVec> x)
+{
+    for (const RVec& xi : x)
+    {
+        addPosition(xi);
+    }
+}
+
+} // namespace gmx
@@ -0,0 +1,190 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Declares a cell grid of positions for fast overlap checks in
+ * solvate and insert-molecules.
+ *
+ * \ingroup module_gmxpreprocess
+ */
+#ifndef GMX_GMXPREPROCESS_OCCUPANCYGRID_H
+#define GMX_GMXPREPROCESS_OCCUPANCYGRID_H
+
+#include <algorithm>
+#include <vector>
+
+#include "gromacs/math/vec.h"
+#include "gromacs/math/vectypes.h"
+#include "gromacs/pbcutil/pbc.h"
+#include "gromacs/utility/arrayref.h"
+#include "gromacs/utility/real.h"
+
+namespace gmx
+{
+
+/*! \internal
+ * \brief
+ * Cell grid of positions that can be extended one position at a time.
+ *
+ * Positions are stored in cells of at least the cut-off size in a
+ * linked-list per cell, so adding a position and looking up all stored
+ * positions within the cut-off of a query position both take constant
+ * time for a homogeneous density. This is used instead of
+ * AnalysisNeighborhood when positions are added between searches,
+ * which would otherwise require rebuilding the search from scratch.
+ *
+ * Triclinic boxes are supported by using cells in the box vector basis.
+ * Along non-periodic dimensions positions outside the box are placed
+ * in the first or last cell.
+ *
+ * Lookups are thread-safe as long as no positions are added concurrently.
+ */
+class OccupancyGrid
+{
+public:
+    /*! \brief Constructs an empty grid
+     *
+     * \param[in] pbc     PBC information
+     * \param[in] box     The box, needs to have non-zero volume also without PBC
+     * \param[in] cutoff  The largest distance for which pairs are returned
+     */
+    OccupancyGrid(const t_pbc& pbc, const matrix box, real cutoff);
+
+    //! Adds a position, the index of the position is numPositions() before the call
+    void addPosition(const RVec& x);
+
+    //! Adds a list of positions
+    void addPositions(ArrayRef<const RVec> x);
+
+    //! Returns the number of positions stored
+    int numPositions() const { return gmx::ssize(positions_); }
+
+    /*! \brief Calls \p pairFunction for all stored positions within the cut-off of \p x
+     *
+     * \p pairFunction is called as pairFunction(index, distance2), where
+     * index is the index of the stored position and distance2 the squared
+     * distance. It should return true to continue the search and false
+     * to stop it. The order of the calls is not defined.
+     *
+     * \returns false when the search was stopped by \p pairFunction, true otherwise.
+     */
+    template<typename PairFunction>
+    bool forEachPositionWithinCutoff(const RVec& x, PairFunction&& pairFunction) const
+    {
+        RVec xInBox;
+        IVec cell;
+        putInCell(x, &xInBox, &cell);
+
+        IVec cellRangeBegin;
+        IVec cellRangeEnd;
+        for (int d = 0; d < DIM; d++)
+        {
+            if (periodic_[d] && numCells_[d] < 3)
+            {
+                // Search all cells once, wrapping would visit cells twice
+                cellRangeBegin[d] = 0;
+                cellRangeEnd[d]   = numCells_[d];
+            }
+            else if (periodic_[d])
+            {
+                cellRangeBegin[d] = cell[d] - 1;
+                cellRangeEnd[d]   = cell[d] + 2;
+            }
+            else
+            {
+                cellRangeBegin[d] = std::max(cell[d] - 1, 0);
+                cellRangeEnd[d]   = std::min(cell[d] + 2, numCells_[d]);
+            }
+        }
+
+        for (int cx = cellRangeBegin[XX]; cx < cellRangeEnd[XX]; cx++)
+        {
+            const int cellX = (cx + numCells_[XX]) % numCells_[XX];
+            for (int cy = cellRangeBegin[YY]; cy < cellRangeEnd[YY]; cy++)
+            {
+                const int cellY = (cy + numCells_[YY]) % numCells_[YY];
+                for (int cz = cellRangeBegin[ZZ]; cz < cellRangeEnd[ZZ]; cz++)
+                {
+                    const int cellZ     = (cz + numCells_[ZZ]) % numCells_[ZZ];
+                    const int cellIndex = (cellX * numCells_[YY] + cellY) * numCells_[ZZ] + cellZ;
+                    for (int i = cellFirst_[cellIndex]; i >= 0; i = next_[i])
+                    {
+                        rvec dx;
+                        pbc_dx_aiuc(&pbc_, xInBox, positions_[i], dx);
+                        const real distance2 = norm2(dx);
+                        if (distance2 < cutoff2_ && !pairFunction(i, distance2))
+                        {
+                            return false;
+                        }
+                    }
+                }
+            }
+        }
+
+        return true;
+    }
+
+private:
+    /*! \brief Returns the position put in the unit-cell along periodic dimensions and its cell
+     *
+     * \param[in]  x       The position
+     * \param[out] xInBox  The position, put in the unit cell along periodic dimensions
+     * \param[out] cell    The cell index along each dimension
+     */
+    void putInCell(const RVec& x, RVec* xInBox, IVec* cell) const;
+
+    //! PBC information
+    t_pbc pbc_;
+    //! The inverse of the box, for computing fractional coordinates
+    matrix invBox_;
+    //! The box
+    matrix box_;
+    //! Whether each dimension is periodic
+    bool periodic_[DIM];
+    //! The number of cells along each dimension
+    IVec numCells_;
+    //! The squared cut-off distance
+    real cutoff2_;
+    //! The first position in each cell, -1 when empty
+    std::vector<int> cellFirst_;
+    //! The next position in the same cell, -1 for the last one
+    std::vector<int> next_;
+    //! The positions, put in the unit cell along periodic dimensions
+    std::vector<RVec> positions_;
+};
+
+} // namespace gmx
+
+#endif
@@ -539,6 +539,21 @@ void check_ir(const char*                   mdparin,
             }
         }
 
+        if (ir->useMts && ir->eI == eiMD && ir->mtsFactor > 1)
+        {
+            /* The PME mesh forces are only computed every mtsFactor steps with MTS.
+             * Steps that need energies, the virial or the total force would require
+             * an extra PME mesh evaluation, so their intervals should be multiples.
+             */
+            check_nst("mts-factor", ir->mtsFactor, "nstcalcenergy", &ir->nstcalcenergy, wi);
+            check_nst("mts-factor", ir->mtsFactor, "nstlog", &ir->nstlog, wi);
+            check_nst("mts-factor", ir->mtsFactor, "nstfout", &ir->nstfout, wi);
+            if (ir->epc != epcNO)
+            {
+                check_nst("mts-factor", ir->mtsFactor, "nstpcouple", &ir->nstpcouple, wi);
+            }
+        }
+
         if (ir->nstcalcenergy > 0)
         {
             if (ir->efep != efepNO)
@@ -578,6 +593,20 @@ void check_ir(const char*                   mdparin,
                      "continuation = yes to avoid constraining the input coordinates.");
     }
 
+    /* MULTIPLE TIME STEPPING */
+    if (ir->useMts)
+    {
+        sprintf(err_buf, "Multiple time stepping is only supported with integrator %s", ei_names[eiMD]);
+        CHECK(ir->eI != eiMD);
+        sprintf(err_buf, "With multiple time stepping, mts-factor should be larger than 1");
+        CHECK(ir->mtsFactor < 2);
+        sprintf(err_buf,
+                "Multiple time stepping only applies to the PME mesh forces and therefore "
+                "requires coulombtype or vdwtype = %s",
+                eel_names[eelPME]);
+        CHECK(!EEL_PME(ir->coulombtype) && !EVDW_PME(ir->vdwtype));
+    }
+
     /* LD STUFF */
     if ((EI_SD(ir->eI) || ir->eI == eiBD) && ir->bContinuation && ir->ld_seed != -1)
     {
@@ -1883,6 +1912,9 @@ void get_ir(const char*     mdparin,
     printStringNoNewline(
             &inp, "Part index is updated automatically on checkpointing (keeps files separate)");
     ir->simulation_part = get_eint(&inp, "simulation-part", 1, wi);
+    printStringNoNewline(&inp, "Multiple time-stepping: compute the PME mesh forces every mts-factor steps");
+    ir->useMts    = (get_eeenum(&inp, "mts", yesno_names, wi) != 0);
+    ir->mtsFactor = get_eint(&inp, "mts-factor", 2, wi);
     printStringNoNewline(&inp, "mode for center of mass motion removal");
     ir->comm_mode = get_eeenum(&inp, "comm-mode", ecm_names, wi);
     printStringNoNewline(&inp, "number of steps for center of mass motion removal");
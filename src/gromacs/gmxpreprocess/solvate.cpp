@@ -50,12 +50,12 @@
 #include "gromacs/fileio/pdbio.h"
 #include "gromacs/gmxlib/conformation_utilities.h"
 #include "gromacs/gmxpreprocess/makeexclusiondistances.h"
+#include "gromacs/gmxpreprocess/occupancygrid.h"
 #include "gromacs/math/functions.h"
 #include "gromacs/math/units.h"
 #include "gromacs/math/vec.h"
 #include "gromacs/pbcutil/boxutilities.h"
 #include "gromacs/pbcutil/pbc.h"
-#include "gromacs/selection/nbsearch.h"
 #include "gromacs/topology/atomprop.h"
 #include "gromacs/topology/atoms.h"
 #include "gromacs/topology/atomsbuilder.h"
@@ -63,9 +63,11 @@
 #include "gromacs/topology/topology.h"
 #include "gromacs/utility/arraysize.h"
 #include "gromacs/utility/cstringutil.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
 #include "gromacs/utility/gmxassert.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/smalloc.h"
 
 using gmx::RVec;
@@ -374,6 +376,7 @@ static void replicateSolventBox(t_atoms*           atoms,
  * \param[in,out] v          Solvent velocities (can be empty).
  * \param[in,out] r          Solvent exclusion radii.
  * \param[in]     pbc        PBC information.
+ * \param[in]     box        The box.
  *
  * Solvent residues that lay on the edges that do not touch the origin are
  * removed if they overlap with other solvent atoms across the PBC.
@@ -389,35 +392,35 @@ static void removeSolventBoxOverlap(t_atoms*           atoms,
                                     std::vector<RVec>* x,
                                     std::vector<RVec>* v,
                                     std::vector<real>* r,
-                                    const t_pbc&       pbc)
+                                    const t_pbc&       pbc,
+                                    const matrix       box)
 {
     gmx::AtomsRemover remover(*atoms);
 
     // TODO: We could limit the amount of pairs searched significantly,
     // since we are only interested in pairs where the positions are on
     // opposite edges.
-    const real                maxRadius = *std::max_element(r->begin(), r->end());
-    gmx::AnalysisNeighborhood nb;
-    nb.setCutoff(2 * maxRadius);
-    gmx::AnalysisNeighborhoodPositions  pos(*x);
-    gmx::AnalysisNeighborhoodSearch     search     = nb.initSearch(&pbc, pos);
-    gmx::AnalysisNeighborhoodPairSearch pairSearch = search.startPairSearch(pos);
-    gmx::AnalysisNeighborhoodPair       pair;
-    while (pairSearch.findNextPair(&pair))
+    const real         maxRadius = *std::max_element(r->begin(), r->end());
+    gmx::OccupancyGrid grid(pbc, box, 2 * maxRadius);
+    grid.addPositions(*x);
+
+    // Overlap is resolved greedily, so the pairs are processed serially
+    for (int i2 = 0; i2 < atoms->nr; i2++)
     {
-        const int i1 = pair.refIndex();
-        const int i2 = pair.testIndex();
         if (remover.isMarked(i2))
-        {
-            pairSearch.skipRemainingPairsForTestPosition();
-            continue;
-        }
-        if (remover.isMarked(i1) || atoms->atom[i1].resind == atoms->atom[i2].resind)
         {
             continue;
         }
-        if (pair.distance2() < gmx::square((*r)[i1] + (*r)[i2]))
-        {
+        const auto checkPair = [&](int i1, real distance2) {
+            if (remover.isMarked(i1) || atoms->atom[i1].resind == atoms->atom[i2].resind)
+            {
+                return true;
+            }
+            if (distance2 >= gmx::square((*r)[i1] + (*r)[i2]))
+            {
+                return true;
+            }
+
             rvec dx;
             rvec_sub((*x)[i2], (*x)[i1], dx);
             bool bCandidate1 = false, bCandidate2 = false;
@@ -443,13 +446,16 @@ static void removeSolventBoxOverlap(t_atoms*           atoms,
             if (bCandidate2 && (!bCandidate1 || i2 > i1))
             {
                 remover.markResidue(*atoms, i2, true);
-                pairSearch.skipRemainingPairsForTestPosition();
+                // Skip the remaining pairs for i2
+                return false;
             }
             else if (bCandidate1)
             {
                 remover.markResidue(*atoms, i1, true);
             }
-        }
+            return true;
+        };
+        grid.forEachPositionWithinCutoff((*x)[i2], checkPair);
     }
 
     remover.removeMarkedElements(x);
@@ -472,6 +478,7 @@ static void removeSolventBoxOverlap(t_atoms*           atoms,
  * \param[in,out] v_solvent Solvent velocities.
  * \param[in,out] r         Atomic exclusion radii.
  * \param[in]     pbc       PBC information.
+ * \param[in]     box       The box.
  * \param[in]     x_solute  Solute positions.
  * \param[in]     rshell    The radius outside the solute molecule.
  */
@@ -480,25 +487,38 @@ static void removeSolventOutsideShell(t_atoms*                 atoms,
                                       std::vector<RVec>*       v_solvent,
                                       std::vector<real>*       r,
                                       const t_pbc&             pbc,
+                                      const matrix             box,
                                       const std::vector<RVec>& x_solute,
                                       real                     rshell)
 {
-    gmx::AtomsRemover         remover(*atoms);
-    gmx::AnalysisNeighborhood nb;
-    nb.setCutoff(rshell);
-    gmx::AnalysisNeighborhoodPositions  posSolute(x_solute);
-    gmx::AnalysisNeighborhoodSearch     search = nb.initSearch(&pbc, posSolute);
-    gmx::AnalysisNeighborhoodPositions  pos(*x_solvent);
-    gmx::AnalysisNeighborhoodPairSearch pairSearch = search.startPairSearch(pos);
-    gmx::AnalysisNeighborhoodPair       pair;
+    gmx::AtomsRemover  remover(*atoms);
+    gmx::OccupancyGrid grid(pbc, box, rshell);
+    grid.addPositions(x_solute);
+
+    std::vector<char> isInShell(atoms->nr);
+#pragma omp parallel for num_threads(gmx_omp_get_max_threads()) schedule(static)
+    for (int i = 0; i < atoms->nr; i++)
+    {
+        try
+        {
+            // The search stops at, and only at, the first solute position within rshell
+            isInShell[i] = !grid.forEachPositionWithinCutoff((*x_solvent)[i],
+                                                             [](int /*index*/, real /*distance2*/) {
+                                                                 return false;
+                                                             });
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
 
     // Remove everything
     remover.markAll();
     // Now put back those within the shell without checking for overlap
-    while (pairSearch.findNextPair(&pair))
+    for (int i = 0; i < atoms->nr; i++)
     {
-        remover.markResidue(*atoms, pair.testIndex(), false);
-        pairSearch.skipRemainingPairsForTestPosition();
+        if (isInShell[i])
+        {
+            remover.markResidue(*atoms, i, false);
+        }
     }
     remover.removeMarkedElements(x_solvent);
     if (!v_solvent->empty())
@@ -520,6 +540,7 @@ static void removeSolventOutsideShell(t_atoms*                 atoms,
  * \param[in,out] v        Solvent velocities (can be empty).
  * \param[in,out] r        Solvent exclusion radii.
  * \param[in]     pbc      PBC information.
+ * \param[in]     box      The box.
  * \param[in]     x_solute Solute positions.
  * \param[in]     r_solute Solute exclusion radii.
  */
@@ -528,6 +549,7 @@ static void removeSolventOverlappingWithSolute(t_atoms*                 atoms,
                                                std::vector<RVec>*       v,
                                                std::vector<real>*       r,
                                                const t_pbc&             pbc,
+                                               const matrix             box,
                                                const std::vector<RVec>& x_solute,
                                                const std::vector<real>& r_solute)
 {
@@ -535,25 +557,29 @@ static void removeSolventOverlappingWithSolute(t_atoms*                 atoms,
     const real        maxRadius1 = *std::max_element(r->begin(), r->end());
     const real        maxRadius2 = *std::max_element(r_solute.begin(), r_solute.end());
 
-    // Now check for overlap.
-    gmx::AnalysisNeighborhood     nb;
-    gmx::AnalysisNeighborhoodPair pair;
-    nb.setCutoff(maxRadius1 + maxRadius2);
-    gmx::AnalysisNeighborhoodPositions  posSolute(x_solute);
-    gmx::AnalysisNeighborhoodSearch     search = nb.initSearch(&pbc, posSolute);
-    gmx::AnalysisNeighborhoodPositions  pos(*x);
-    gmx::AnalysisNeighborhoodPairSearch pairSearch = search.startPairSearch(pos);
-    while (pairSearch.findNextPair(&pair))
+    gmx::OccupancyGrid grid(pbc, box, maxRadius1 + maxRadius2);
+    grid.addPositions(x_solute);
+
+    // Now check for overlap, a residue is removed when any of its atoms overlaps
+    std::vector<char> overlaps(atoms->nr);
+#pragma omp parallel for num_threads(gmx_omp_get_max_threads()) schedule(static)
+    for (int i = 0; i < atoms->nr; i++)
     {
-        if (remover.isMarked(pair.testIndex()))
+        try
         {
-            pairSearch.skipRemainingPairsForTestPosition();
-            continue;
+            const real r2 = (*r)[i];
+            overlaps[i]   = !grid.forEachPositionWithinCutoff((*x)[i], [&](int j, real distance2) {
+                return distance2 >= gmx::square(r_solute[j] + r2);
+            });
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
+    }
+    for (int i = 0; i < atoms->nr; i++)
+    {
+        if (overlaps[i])
+        {
+            remover.markResidue(*atoms, i, true);
         }
-        const real r1      = r_solute[pair.refIndex()];
-        const real r2      = (*r)[pair.testIndex()];
-        const bool bRemove = (pair.distance2() < gmx::square(r1 + r2));
-        remover.markResidue(*atoms, pair.testIndex(), bRemove);
     }
 
     remover.removeMarkedElements(x);
@@ -669,7 +695,8 @@ static void add_solv(const char*        filename,
         replicateSolventBox(atomsSolvent, &xSolvent, &vSolvent, &exclusionDistances_solvt, boxSolvent, box);
         if (pbcType != PbcType::No)
         {
-            removeSolventBoxOverlap(atomsSolvent, &xSolvent, &vSolvent, &exclusionDistances_solvt, pbc);
+            removeSolventBoxOverlap(atomsSolvent, &xSolvent, &vSolvent, &exclusionDistances_solvt,
+                                    pbc, box);
         }
     }
     if (atoms->nr > 0)
@@ -677,10 +704,10 @@ static void add_solv(const char*        filename,
         if (rshell > 0.0)
         {
             removeSolventOutsideShell(atomsSolvent, &xSolvent, &vSolvent, &exclusionDistances_solvt,
-                                      pbc, *x, rshell);
+                                      pbc, box, *x, rshell);
         }
         removeSolventOverlappingWithSolute(atomsSolvent, &xSolvent, &vSolvent,
-                                           &exclusionDistances_solvt, pbc, *x, exclusionDistances);
+                                           &exclusionDistances_solvt, pbc, box, *x, exclusionDistances);
     }
 
     if (max_sol > 0 && atomsSolvent->nres > max_sol)
@@ -0,0 +1,185 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the hash index on bonded interaction types used by grompp.
+ *
+ * \ingroup module_gmxpreprocess
+ */
+#include "gmxpre.h"
+
+#include <array>
+#include <random>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/gmxpreprocess/grompp_impl.h"
+#include "gromacs/gmxpreprocess/toppush.h"
+#include "gromacs/topology/ifunc.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Adds a type with bond atom types \p atoms to \p types
+void addType(InteractionsOfType* types, gmx::ArrayRef<const int> atoms)
+{
+    std::array<real, MAXFORCEPARAM> forceParam = { 0 };
+    types->interactionTypes.emplace_back(atoms, forceParam);
+}
+
+/*! \brief Linear search reference for the best matching dihedral type
+ *
+ * Returns the first type with the most non-wildcard matches.
+ */
+int referenceBestDihedralMatch(const InteractionsOfType& types, const std::array<int, 4>& atomTypes)
+{
+    int bestIndex      = -1;
+    int bestNumMatches = -1;
+    for (size_t i = 0; i < types.size(); i++)
+    {
+        gmx::ArrayRef<const int> atoms      = types.interactionTypes[i].atoms();
+        int                      numMatches = 0;
+        bool                     isMatch    = true;
+        for (int j = 0; j < 4; j++)
+        {
+            if (atoms[j] != -1)
+            {
+                isMatch = isMatch && (atoms[j] == atomTypes[j]);
+                numMatches++;
+            }
+        }
+        if (isMatch && numMatches > bestNumMatches)
+        {
+            bestIndex      = i;
+            bestNumMatches = numMatches;
+        }
+    }
+    return bestIndex;
+}
+
+//! Adds \p numTypes random dihedral types with wildcards to \p types
+void addRandomDihedralTypes(InteractionsOfType* types, int numTypes, int numAtomTypes, std::mt19937* rng)
+{
+    std::uniform_int_distribution<int> atomTypeDist(-1, numAtomTypes - 1);
+    for (int i = 0; i < numTypes; i++)
+    {
+        const std::array<int, 4> atoms = {
+            atomTypeDist(*rng), atomTypeDist(*rng), atomTypeDist(*rng), atomTypeDist(*rng)
+        };
+        addType(types, atoms);
+    }
+}
+
+TEST(BondedTypeIndexTest, DihedralMatchesLinearSearch)
+{
+    const int          numAtomTypes = 4;
+    std::mt19937       rng(1234);
+    InteractionsOfType types;
+    addRandomDihedralTypes(&types, 60, numAtomTypes, &rng);
+
+    BondedTypeIndex index;
+    for (int pass = 0; pass < 2; pass++)
+    {
+        // Check all combinations of atom types
+        for (int combination = 0; combination < 256; combination++)
+        {
+            const std::array<int, 4> atomTypes = { combination % numAtomTypes,
+                                                   (combination / 4) % numAtomTypes,
+                                                   (combination / 16) % numAtomTypes,
+                                                   (combination / 64) % numAtomTypes };
+            EXPECT_EQ(referenceBestDihedralMatch(types, atomTypes),
+                      index.findBestDihedralMatch(F_PDIHS, types, atomTypes));
+        }
+        // Types added after a lookup should be found as well
+        addRandomDihedralTypes(&types, 60, numAtomTypes, &rng);
+    }
+}
+
+TEST(BondedTypeIndexTest, ExactMatchReturnsFirstType)
+{
+    InteractionsOfType types;
+    addType(&types, std::array<int, 2>{ 0, 1 });
+    addType(&types, std::array<int, 2>{ 1, 0 });
+    addType(&types, std::array<int, 2>{ 2, 1 });
+    addType(&types, std::array<int, 2>{ 0, 1 });
+
+    BondedTypeIndex index;
+    EXPECT_EQ(0, index.findFirstExactMatch(F_BONDS, types, std::array<int, 2>{ 0, 1 }));
+    EXPECT_EQ(1, index.findFirstExactMatch(F_BONDS, types, std::array<int, 2>{ 1, 0 }));
+    EXPECT_EQ(2, index.findFirstExactMatch(F_BONDS, types, std::array<int, 2>{ 2, 1 }));
+    EXPECT_EQ(-1, index.findFirstExactMatch(F_BONDS, types, std::array<int, 2>{ 1, 2 }));
+    // Types with a different number of atoms do not match
+    EXPECT_EQ(-1, index.findFirstExactMatch(F_BONDS, types, std::array<int, 3>{ 0, 1, 0 }));
+
+    addType(&types, std::array<int, 2>{ 1, 2 });
+    EXPECT_EQ(4, index.findFirstExactMatch(F_BONDS, types, std::array<int, 2>{ 1, 2 }));
+}
+
+TEST(BondedTypeIndexTest, RebuildsAfterTypesAreReplaced)
+{
+    InteractionsOfType types;
+    addType(&types, std::array<int, 2>{ 0, 1 });
+    addType(&types, std::array<int, 2>{ 1, 2 });
+
+    BondedTypeIndex index;
+    EXPECT_EQ(1, index.findFirstExactMatch(F_BONDS, types, std::array<int, 2>{ 1, 2 }));
+
+    // Replace the types by a list of the same size with other atom types
+    types.interactionTypes.clear();
+    addType(&types, std::array<int, 2>{ 1, 2 });
+    addType(&types, std::array<int, 2>{ 2, 3 });
+    types.generation++;
+    EXPECT_EQ(0, index.findFirstExactMatch(F_BONDS, types, std::array<int, 2>{ 1, 2 }));
+    EXPECT_EQ(1, index.findFirstExactMatch(F_BONDS, types, std::array<int, 2>{ 2, 3 }));
+    EXPECT_EQ(-1, index.findFirstExactMatch(F_BONDS, types, std::array<int, 2>{ 0, 1 }));
+
+    // And by a longer list
+    types.interactionTypes.clear();
+    addType(&types, std::array<int, 2>{ 3, 4 });
+    addType(&types, std::array<int, 2>{ 4, 5 });
+    addType(&types, std::array<int, 2>{ 2, 3 });
+    types.generation++;
+    EXPECT_EQ(2, index.findFirstExactMatch(F_BONDS, types, std::array<int, 2>{ 2, 3 }));
+    EXPECT_EQ(-1, index.findFirstExactMatch(F_BONDS, types, std::array<int, 2>{ 1, 2 }));
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -0,0 +1,151 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the cell grid used for overlap checks in solvate and insert-molecules.
+ *
+ * \ingroup module_gmxpreprocess
+ */
+#include "gmxpre.h"
+
+#include "gromacs/gmxpreprocess/occupancygrid.h"
+
+#include <algorithm>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/math/vec.h"
+#include "gromacs/pbcutil/pbc.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Parameters for the grid tests: PBC type and whether the box is triclinic
+using OccupancyGridTestParameters = std::tuple<PbcType, bool>;
+
+class OccupancyGridTest : public ::testing::TestWithParam<OccupancyGridTestParameters>
+{
+};
+
+TEST_P(OccupancyGridTest, FindsSamePairsAsAllToAllSearch)
+{
+    const PbcType pbcType    = std::get<0>(GetParam());
+    const bool    triclinic  = std::get<1>(GetParam());
+    matrix        box        = { { 3.0, 0, 0 }, { 0, 2.2, 0 }, { 0, 0, 2.6 } };
+    const real    cutoff     = 0.7;
+    const int     numRef     = 300;
+    const int     numQueries = 100;
+    if (triclinic)
+    {
+        box[YY][XX] = 1.1;
+        box[ZZ][XX] = -0.9;
+        box[ZZ][YY] = 0.8;
+    }
+    t_pbc pbc;
+    set_pbc(&pbc, pbcType, box);
+
+    // Include positions outside the box to check the placement in cells
+    std::default_random_engine           rng(1234);
+    std::uniform_real_distribution<real> dist(-0.5, 1.5);
+    const auto                           randomPosition = [&]() {
+        RVec x = { 0, 0, 0 };
+        for (int d = 0; d < DIM; d++)
+        {
+            const real fraction = dist(rng);
+            for (int e = 0; e < DIM; e++)
+            {
+                x[e] += fraction * box[d][e];
+            }
+        }
+        return x;
+    };
+
+    OccupancyGrid     grid(pbc, box, cutoff);
+    std::vector<RVec> ref;
+    for (int i = 0; i < numRef; i++)
+    {
+        ref.push_back(randomPosition());
+        grid.addPosition(ref.back());
+    }
+    ASSERT_EQ(numRef, grid.numPositions());
+
+    for (int q = 0; q < numQueries; q++)
+    {
+        const RVec x = randomPosition();
+
+        std::vector<int> expected;
+        for (int i = 0; i < numRef; i++)
+        {
+            rvec dx;
+            pbc_dx(&pbc, x, ref[i], dx);
+            if (norm2(dx) < cutoff * cutoff)
+            {
+                expected.push_back(i);
+            }
+        }
+
+        std::vector<int> found;
+        EXPECT_TRUE(grid.forEachPositionWithinCutoff(x, [&](int index, real distance2) {
+            rvec dx;
+            pbc_dx(&pbc, x, ref[index], dx);
+            EXPECT_NEAR(norm2(dx), distance2, 1e-4);
+            found.push_back(index);
+            return true;
+        }));
+        std::sort(found.begin(), found.end());
+        EXPECT_EQ(expected, found);
+
+        // Stopping the search should return false, when there is something to find
+        const bool completed = grid.forEachPositionWithinCutoff(
+                x, [](int /*index*/, real /*distance2*/) { return false; });
+        EXPECT_EQ(expected.empty(), completed);
+    }
+}
+
+INSTANTIATE_TEST_CASE_P(WithDifferentBoxes,
+                        OccupancyGridTest,
+                        ::testing::Combine(::testing::Values(PbcType::Xyz, PbcType::XY, PbcType::No),
+                                           ::testing::Bool()));
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -110,6 +110,30 @@ public:
         checker.checkString(outputMdpContents, "OutputMdpFile");
     }
 
+    /*! \brief Reads and checks mdp contents without comparing to reference data
+     *
+     * \returns whether check_ir() reported errors
+     */
+    bool readAndCheckMdp(const std::string& inputMdpFileContents)
+    {
+        // Allows reading several mdp files in one test
+        done_inputrec_strings();
+
+        auto inputMdpFilename  = fileManager_.getTemporaryFilePath("input.mdp");
+        auto outputMdpFilename = fileManager_.getTemporaryFilePath("output.mdp");
+
+        TextWriter::writeFileFromString(inputMdpFilename, inputMdpFileContents);
+
+        get_ir(inputMdpFilename.c_str(), outputMdpFilename.c_str(), &mdModules_, &ir_, &opts_,
+               WriteMdpHeader::no, wi_);
+
+        check_ir(inputMdpFilename.c_str(), mdModules_.notifier(), &ir_, &opts_, wi_);
+        bool failure = warning_errors_exist(wi_);
+        warning_reset(wi_);
+
+        return failure;
+    }
+
     TestFileManager                    fileManager_;
     t_inputrec                         ir_;
     MDModules                          mdModules_;
@@ -221,5 +245,80 @@ TEST_F(GetIrTest, AcceptsMimic)
     runTest(joinStrings(inputMdpFile, "\n"));
 }
 
+TEST_F(GetIrTest, AcceptsMultipleTimeStepping)
+{
+    const char* inputMdpFile[] = { "mts = yes", "mts-factor = 2", "coulombtype = PME" };
+    runTest(joinStrings(inputMdpFile, "\n"));
+}
+
+TEST_F(GetIrTest, RoundsIntervalsToMultiplesOfMtsFactor)
+{
+    const char* inputMdpFile[] = { "mts = yes",
+                                   "mts-factor = 3",
+                                   "coulombtype = PME",
+                                   "nstcalcenergy = 100",
+                                   "nstenergy = 1020",
+                                   "nstlog = 1000",
+                                   "nstfout = 50",
+                                   "pcoupl = berendsen",
+                                   "tau-p = 5",
+                                   "ref-p = 1",
+                                   "compressibility = 4.5e-5",
+                                   "nstpcouple = 10" };
+    // The test fixture does not allow warnings, so rounding gives errors
+    readAndCheckMdp(joinStrings(inputMdpFile, "\n"));
+    EXPECT_EQ(102, ir_.nstcalcenergy);
+    EXPECT_EQ(1002, ir_.nstlog);
+    EXPECT_EQ(51, ir_.nstfout);
+    EXPECT_EQ(12, ir_.nstpcouple);
+}
+
+TEST_F(GetIrTest, KeepsIntervalsThatAreMultiplesOfMtsFactor)
+{
+    const char* inputMdpFile[] = { "mts = yes",     "mts-factor = 2", "coulombtype = PME",
+                                   "nstlog = 1000", "nstfout = 50",   "nstcalcenergy = 100" };
+    EXPECT_FALSE(readAndCheckMdp(joinStrings(inputMdpFile, "\n")));
+    EXPECT_EQ(100, ir_.nstcalcenergy);
+    EXPECT_EQ(1000, ir_.nstlog);
+    EXPECT_EQ(50, ir_.nstfout);
+}
+
+TEST_F(GetIrTest, AcceptsMultipleTimeSteppingWithLJPme)
+{
+    const char* inputMdpFile[] = { "mts = yes", "vdwtype = PME" };
+    EXPECT_FALSE(readAndCheckMdp(joinStrings(inputMdpFile, "\n")));
+}
+
+TEST_F(GetIrTest, RejectsMultipleTimeSteppingWithOtherIntegrators)
+{
+    for (const char* integrator : { "md-vv", "sd", "bd", "steep" })
+    {
+        SCOPED_TRACE(formatString("with integrator %s", integrator));
+        const std::string inputMdpFile =
+                formatString("coulombtype = PME\nintegrator = %s\ntau-t = 1\n", integrator);
+        // Check that only MTS makes this input invalid
+        EXPECT_FALSE(readAndCheckMdp(inputMdpFile + "mts = no\n"));
+        EXPECT_TRUE(readAndCheckMdp(inputMdpFile + "mts = yes\n"));
+    }
+}
+
+TEST_F(GetIrTest, RejectsMultipleTimeSteppingWithoutPme)
+{
+    for (const char* coulombtype : { "Cut-off", "Reaction-Field", "Ewald" })
+    {
+        SCOPED_TRACE(formatString("with coulombtype %s", coulombtype));
+        const std::string inputMdpFile = formatString("coulombtype = %s\n", coulombtype);
+        // Check that only MTS makes this input invalid
+        EXPECT_FALSE(readAndCheckMdp(inputMdpFile + "mts = no\n"));
+        EXPECT_TRUE(readAndCheckMdp(inputMdpFile + "mts = yes\n"));
+    }
+}
+
+TEST_F(GetIrTest, RejectsMtsFactorOfOne)
+{
+    const char* inputMdpFile[] = { "mts = yes", "mts-factor = 1", "coulombtype = PME" };
+    EXPECT_TRUE(readAndCheckMdp(joinStrings(inputMdpFile, "\n")));
+}
+
 } // namespace test
 } // namespace gmx
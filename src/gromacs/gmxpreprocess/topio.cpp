@@ -77,8 +77,10 @@
 #include "gromacs/topology/symtab.h"
 #include "gromacs/topology/topology.h"
 #include "gromacs/utility/cstringutil.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/futil.h"
+#include "gromacs/utility/gmxomp.h"
 #include "gromacs/utility/gmxassert.h"
 #include "gromacs/utility/logger.h"
 #include "gromacs/utility/pleasecite.h"
@@ -105,6 +107,7 @@ static void gen_pairs(const InteractionsOfType& nbs, InteractionsOfType* pairs,
 
     fprintf(stderr, "Generating 1-4 interactions: fudge = %g\n", fudge);
     pairs->interactionTypes.clear();
+    pairs->generation++;
     int                             i = 0;
     std::array<int, 2>              atomNumbers;
     std::array<real, MAXFORCEPARAM> forceParam = { NOTSET };
@@ -438,6 +441,8 @@ static char** read_topol(const char*                           infile,
     nbparam = nullptr;              /* The temporary non-bonded matrix */
     pair    = nullptr;              /* The temporary pair interaction matrix */
     std::vector<std::vector<gmx::ExclusionBlock>> exclusionBlocks;
+    std::vector<int>                              moltypesToProcess;
+    std::vector<bool>                             moltypeIsCoupled;
     nb_funct = F_LJ;
 
     *reppow = 12.0; /* Default value for repulsion power     */
@@ -449,6 +454,7 @@ static char** read_topol(const char*                           infile,
     bWarn_copy_A_B = bFEP;
 
     PreprocessingBondAtomType bondAtomType;
+    BondedTypeIndex           bondTypeIndex;
     /* parse the actual file */
     bReadDefaults = FALSE;
     bGenPairs     = FALSE;
@@ -737,15 +743,17 @@ static char** read_topol(const char*                           infile,
                             GMX_RELEASE_ASSERT(
                                     mi0,
                                     "Need to have a valid MoleculeInformation object to work on");
-                            push_bond(d, interactions, mi0->interactions, &(mi0->atoms), atypes,
-                                      pline, FALSE, bGenPairs, *fudgeQQ, bZero, &bWarn_copy_A_B, wi);
+                            push_bond(d, interactions, &bondTypeIndex, mi0->interactions,
+                                      &(mi0->atoms), atypes, pline, FALSE, bGenPairs, *fudgeQQ,
+                                      bZero, &bWarn_copy_A_B, wi);
                             break;
                         case Directive::d_pairs_nb:
                             GMX_RELEASE_ASSERT(
                                     mi0,
                                     "Need to have a valid MoleculeInformation object to work on");
-                            push_bond(d, interactions, mi0->interactions, &(mi0->atoms), atypes,
-                                      pline, FALSE, FALSE, 1.0, bZero, &bWarn_copy_A_B, wi);
+                            push_bond(d, interactions, &bondTypeIndex, mi0->interactions,
+                                      &(mi0->atoms), atypes, pline, FALSE, FALSE, 1.0, bZero,
+                                      &bWarn_copy_A_B, wi);
                             break;
 
                         case Directive::d_vsites2:
@@ -768,8 +776,9 @@ static char** read_topol(const char*                           infile,
                             GMX_RELEASE_ASSERT(
                                     mi0,
                                     "Need to have a valid MoleculeInformation object to work on");
-                            push_bond(d, interactions, mi0->interactions, &(mi0->atoms), atypes,
-                                      pline, TRUE, bGenPairs, *fudgeQQ, bZero, &bWarn_copy_A_B, wi);
+                            push_bond(d, interactions, &bondTypeIndex, mi0->interactions,
+                                      &(mi0->atoms), atypes, pline, TRUE, bGenPairs, *fudgeQQ,
+                                      bZero, &bWarn_copy_A_B, wi);
                             break;
                         case Directive::d_cmap:
                             GMX_RELEASE_ASSERT(
@@ -832,17 +841,9 @@ static char** read_topol(const char*                           infile,
                             sum_q(&mi0->atoms, nrcopies, &qt, &qBt);
                             if (!mi0->bProcessed)
                             {
-                                generate_excl(mi0->nrexcl, mi0->atoms.nr, mi0->interactions, &(mi0->excls));
-                                gmx::mergeExclusions(&(mi0->excls), exclusionBlocks[whichmol]);
-                                make_shake(mi0->interactions, &mi0->atoms, opts->nshake, logger);
-
-                                if (bCouple)
-                                {
-                                    convert_moltype_couple(mi0, dcatt, *fudgeQQ, opts->couple_lam0,
-                                                           opts->couple_lam1, opts->bCoupleIntra,
-                                                           nb_funct, &(interactions[nb_funct]), wi);
-                                }
-                                stupid_fill_block(&mi0->mols, mi0->atoms.nr, TRUE);
+                                /* The actual processing is done after reading the whole file */
+                                moltypesToProcess.push_back(whichmol);
+                                moltypeIsCoupled.push_back(bCouple);
                                 mi0->bProcessed = TRUE;
                             }
                             break;
@@ -860,6 +861,36 @@ static char** read_topol(const char*                           infile,
         }
     } while (!done);
 
+    /* Generating the exclusions is independent between molecule types
+     * and dominates the processing time for large molecules, so we do
+     * this concurrently. The remaining steps print output and can modify
+     * the shared non-bonded parameters, so these are done in order.
+     */
+#pragma omp parallel for num_threads(gmx_omp_get_max_threads()) schedule(dynamic)
+    for (gmx::index m = 0; m < gmx::ssize(moltypesToProcess); m++)
+    {
+        try
+        {
+            const int            whichmol = moltypesToProcess[m];
+            MoleculeInformation* mi       = &(*molinfo)[whichmol];
+            generate_excl(mi->nrexcl, mi->atoms.nr, mi->interactions, &(mi->excls));
+            gmx::mergeExclusions(&(mi->excls), exclusionBlocks[whichmol]);
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR;
+    }
+    for (gmx::index m = 0; m < gmx::ssize(moltypesToProcess); m++)
+    {
+        MoleculeInformation* mi = &(*molinfo)[moltypesToProcess[m]];
+        make_shake(mi->interactions, &mi->atoms, opts->nshake, logger);
+
+        if (moltypeIsCoupled[m])
+        {
+            convert_moltype_couple(mi, dcatt, *fudgeQQ, opts->couple_lam0, opts->couple_lam1,
+                                   opts->bCoupleIntra, nb_funct, &(interactions[nb_funct]), wi);
+        }
+        stupid_fill_block(&mi->mols, mi->atoms.nr, TRUE);
+    }
+
     // Check that all strings defined with -D were used when processing topology
     std::string unusedDefineWarning = checkAndWarnForUnusedDefines(*handle);
     if (!unusedDefineWarning.empty())
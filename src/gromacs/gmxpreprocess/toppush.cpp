@@ -45,7 +45,9 @@
 #include <cstring>
 
 #include <algorithm>
+#include <array>
 #include <string>
+#include <unordered_map>
 
 #include "gromacs/fileio/warninp.h"
 #include "gromacs/gmxpreprocess/gpp_atomtype.h"
@@ -80,6 +82,7 @@ void generate_nbparams(int                     comb,
     nr   = atypes->size();
     nrfp = NRFP(ftype);
     interactions->interactionTypes.clear();
+    interactions->generation++;
 
     std::array<real, MAXFORCEPARAM> forceParam = { NOTSET };
     /* Fill the matrix with force parameters */
@@ -1672,88 +1675,133 @@ static bool default_cmap_params(gmx::ArrayRef<InteractionsOfType> bondtype,
     return bFound;
 }
 
-/* Returns the number of exact atom type matches, i.e. non wild-card matches,
- * returns -1 when there are no matches at all.
- */
-static int natom_match(const InteractionOfType&      pi,
-                       int                           type_i,
-                       int                           type_j,
-                       int                           type_k,
-                       int                           type_l,
-                       const PreprocessingAtomTypes* atypes)
+namespace
 {
-    if ((pi.ai() == -1 || atypes->bondAtomTypeFromAtomType(type_i) == pi.ai())
-        && (pi.aj() == -1 || atypes->bondAtomTypeFromAtomType(type_j) == pi.aj())
-        && (pi.ak() == -1 || atypes->bondAtomTypeFromAtomType(type_k) == pi.ak())
-        && (pi.al() == -1 || atypes->bondAtomTypeFromAtomType(type_l) == pi.al()))
-    {
-        return (pi.ai() == -1 ? 0 : 1) + (pi.aj() == -1 ? 0 : 1) + (pi.ak() == -1 ? 0 : 1)
-               + (pi.al() == -1 ? 0 : 1);
-    }
-    else
+
+//! Bond atom types of an interaction type, padded with c_unusedKeyEntry
+using BondedTypeKey = std::array<int, MAXATOMLIST>;
+
+//! Value for the unused entries in BondedTypeKey
+constexpr int c_unusedKeyEntry = -2;
+
+//! Hash function for BondedTypeKey
+struct BondedTypeKeyHash
+{
+    //! Combines the hashes of all entries
+    size_t operator()(const BondedTypeKey& key) const
     {
-        return -1;
+        size_t hash = 0;
+        for (int type : key)
+        {
+            hash ^= std::hash<int>()(type) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+        }
+        return hash;
     }
+};
+
+//! Returns the key for the bond atom types \p atomTypes
+BondedTypeKey makeBondedTypeKey(gmx::ArrayRef<const int> atomTypes)
+{
+    GMX_ASSERT(atomTypes.size() <= MAXATOMLIST, "Interactions have at most MAXATOMLIST atoms");
+    BondedTypeKey key;
+    key.fill(c_unusedKeyEntry);
+    std::copy(atomTypes.begin(), atomTypes.end(), key.begin());
+    return key;
 }
 
-static int findNumberOfDihedralAtomMatches(const InteractionOfType& currentParamFromParameterArray,
-                                           const InteractionOfType& parameterToAdd,
-                                           const t_atoms*           at,
-                                           const PreprocessingAtomTypes* atypes,
-                                           bool                          bB)
+} // namespace
+
+class BondedTypeIndex::Impl
 {
-    if (bB)
+public:
+    //! Map from bond atom types, including wildcards, to the first type with those atom types
+    using TypeMap = std::unordered_map<BondedTypeKey, int, BondedTypeKeyHash>;
+
+    //! Returns the map for \p ftype, after adding the types added since the previous call
+    const TypeMap& update(int ftype, const InteractionsOfType& types);
+
+private:
+    //! The map for each interaction type
+    std::array<TypeMap, F_NRE> firstTypeIndex_;
+    //! The number of types that have been added to each map
+    std::array<size_t, F_NRE> numIndexed_ = { 0 };
+    //! The generation of the types that each map was built for
+    std::array<int64_t, F_NRE> indexedGeneration_ = { 0 };
+};
+
+const BondedTypeIndex::Impl::TypeMap& BondedTypeIndex::Impl::update(int ftype, const InteractionsOfType& types)
+{
+    TypeMap& map = firstTypeIndex_[ftype];
+    if (types.generation != indexedGeneration_[ftype] || types.size() < numIndexed_[ftype])
     {
-        return natom_match(currentParamFromParameterArray, at->atom[parameterToAdd.ai()].typeB,
-                           at->atom[parameterToAdd.aj()].typeB, at->atom[parameterToAdd.ak()].typeB,
-                           at->atom[parameterToAdd.al()].typeB, atypes);
+        /* Types were removed or replaced, rebuild the map */
+        map.clear();
+        numIndexed_[ftype]        = 0;
+        indexedGeneration_[ftype] = types.generation;
     }
-    else
+    for (size_t i = numIndexed_[ftype]; i < types.size(); i++)
     {
-        return natom_match(currentParamFromParameterArray, at->atom[parameterToAdd.ai()].type,
-                           at->atom[parameterToAdd.aj()].type, at->atom[parameterToAdd.ak()].type,
-                           at->atom[parameterToAdd.al()].type, atypes);
+        /* Does not replace existing entries, so the first type is kept */
+        map.emplace(makeBondedTypeKey(types.interactionTypes[i].atoms()), i);
     }
+    numIndexed_[ftype] = types.size();
+
+    return map;
 }
 
-static bool findIfAllParameterAtomsMatch(gmx::ArrayRef<const int>      atomsFromParameterArray,
-                                         gmx::ArrayRef<const int>      atomsFromCurrentParameter,
-                                         const t_atoms*                at,
-                                         const PreprocessingAtomTypes* atypes,
-                                         bool                          bB)
+BondedTypeIndex::BondedTypeIndex() : impl_(new Impl) {}
+
+BondedTypeIndex::~BondedTypeIndex() = default;
+
+int BondedTypeIndex::findFirstExactMatch(int                       ftype,
+                                         const InteractionsOfType& types,
+                                         gmx::ArrayRef<const int>  atomTypes)
 {
-    if (atomsFromParameterArray.size() != atomsFromCurrentParameter.size())
-    {
-        return false;
-    }
-    else if (bB)
+    const Impl::TypeMap& map   = impl_->update(ftype, types);
+    const auto           found = map.find(makeBondedTypeKey(atomTypes));
+
+    return (found != map.end() ? found->second : -1);
+}
+
+int BondedTypeIndex::findBestDihedralMatch(int                       ftype,
+                                           const InteractionsOfType& types,
+                                           const std::array<int, 4>& atomTypes)
+{
+    const Impl::TypeMap& map = impl_->update(ftype, types);
+
+    /* Look up all 16 combinations of wildcards (-1) and atom types,
+     * out of the types with the most non-wildcard matches we choose the first.
+     */
+    int bestIndex      = -1;
+    int bestNumMatches = -1;
+    for (int wildcardMask = 0; wildcardMask < 16; wildcardMask++)
     {
-        for (gmx::index i = 0; i < atomsFromCurrentParameter.ssize(); i++)
+        std::array<int, 4> pattern;
+        int                numMatches = 0;
+        for (int j = 0; j < 4; j++)
         {
-            if (atypes->bondAtomTypeFromAtomType(at->atom[atomsFromCurrentParameter[i]].typeB)
-                != atomsFromParameterArray[i])
-            {
-                return false;
-            }
+            const bool isWildcard = ((wildcardMask >> j) & 1) != 0;
+            pattern[j]            = isWildcard ? -1 : atomTypes[j];
+            numMatches += isWildcard ? 0 : 1;
         }
-        return true;
-    }
-    else
-    {
-        for (gmx::index i = 0; i < atomsFromCurrentParameter.ssize(); i++)
+        const auto found = map.find(makeBondedTypeKey(pattern));
+        if (found == map.end())
         {
-            if (atypes->bondAtomTypeFromAtomType(at->atom[atomsFromCurrentParameter[i]].type)
-                != atomsFromParameterArray[i])
-            {
-                return false;
-            }
+            continue;
+        }
+        if (numMatches > bestNumMatches || (numMatches == bestNumMatches && found->second < bestIndex))
+        {
+            bestIndex      = found->second;
+            bestNumMatches = numMatches;
         }
-        return true;
     }
+
+    return bestIndex;
 }
 
 static std::vector<InteractionOfType>::iterator defaultInteractionsOfType(int ftype,
                                                                           gmx::ArrayRef<InteractionsOfType> bt,
+                                                                          BondedTypeIndex* btIndex,
                                                                           t_atoms* at,
                                                                           PreprocessingAtomTypes* atypes,
                                                                           const InteractionOfType& p,
@@ -1769,30 +1817,25 @@ static std::vector<InteractionOfType>::iterator defaultInteractionsOfType(int ft
         return bt[ftype].interactionTypes.end();
     }
 
+    /* The bond atom types of the atoms of this interaction */
+    gmx::ArrayRef<const int>     atomParam = p.atoms();
+    std::array<int, MAXATOMLIST> atomTypes;
+    for (gmx::index i = 0; i < atomParam.ssize(); i++)
+    {
+        atomTypes[i] = atypes->bondAtomTypeFromAtomType(bB ? at->atom[atomParam[i]].typeB
+                                                           : at->atom[atomParam[i]].type);
+    }
 
     nparam_found = 0;
     if (ftype == F_PDIHS || ftype == F_RBDIHS || ftype == F_IDIHS || ftype == F_PIDIHS)
     {
-        int nmatch_max = -1;
-
         /* For dihedrals we allow wildcards. We choose the first type
          * that has the most real matches, i.e. non-wildcard matches.
          */
-        auto prevPos = bt[ftype].interactionTypes.end();
-        auto pos     = bt[ftype].interactionTypes.begin();
-        while (pos != bt[ftype].interactionTypes.end() && nmatch_max < 4)
-        {
-            pos = std::find_if(bt[ftype].interactionTypes.begin(), bt[ftype].interactionTypes.end(),
-                               [&p, &at, &atypes, &bB, &nmatch_max](const auto& param) {
-                                   return (findNumberOfDihedralAtomMatches(param, p, at, atypes, bB)
-                                           > nmatch_max);
-                               });
-            if (pos != bt[ftype].interactionTypes.end())
-            {
-                prevPos    = pos;
-                nmatch_max = findNumberOfDihedralAtomMatches(*pos, p, at, atypes, bB);
-            }
-        }
+        const int bestIndex = btIndex->findBestDihedralMatch(
+                ftype, bt[ftype], { atomTypes[0], atomTypes[1], atomTypes[2], atomTypes[3] });
+        auto prevPos = (bestIndex >= 0 ? bt[ftype].interactionTypes.begin() + bestIndex
+                                       : bt[ftype].interactionTypes.end());
 
         if (prevPos != bt[ftype].interactionTypes.end())
         {
@@ -1828,12 +1871,10 @@ static std::vector<InteractionOfType>::iterator defaultInteractionsOfType(int ft
     }
     else /* Not a dihedral */
     {
-        gmx::ArrayRef<const int> atomParam = p.atoms();
-        auto                     found     = std::find_if(
-                bt[ftype].interactionTypes.begin(), bt[ftype].interactionTypes.end(),
-                [&atomParam, &at, &atypes, &bB](const auto& param) {
-                    return findIfAllParameterAtomsMatch(param.atoms(), atomParam, at, atypes, bB);
-                });
+        const int firstIndex = btIndex->findFirstExactMatch(
+                ftype, bt[ftype], gmx::arrayRefFromArray(atomTypes.data(), atomParam.size()));
+        auto found = (firstIndex >= 0 ? bt[ftype].interactionTypes.begin() + firstIndex
+                                      : bt[ftype].interactionTypes.end());
         if (found != bt[ftype].interactionTypes.end())
         {
             nparam_found = 1;
@@ -1846,6 +1887,7 @@ static std::vector<InteractionOfType>::iterator defaultInteractionsOfType(int ft
 
 void push_bond(Directive                         d,
                gmx::ArrayRef<InteractionsOfType> bondtype,
+               BondedTypeIndex*                  bondtypeIndex,
                gmx::ArrayRef<InteractionsOfType> bond,
                t_atoms*                          at,
                PreprocessingAtomTypes*           atypes,
@@ -1989,7 +2031,8 @@ void push_bond(Directive                         d,
     if (bBonded)
     {
         foundAParameter =
-                defaultInteractionsOfType(ftype, bondtype, at, atypes, param, FALSE, &nparam_defA);
+                defaultInteractionsOfType(ftype, bondtype, bondtypeIndex, at, atypes, param,
+                                          FALSE, &nparam_defA);
         if (foundAParameter != bondtype[ftype].interactionTypes.end())
         {
             /* Copy the A-state and B-state default parameters. */
@@ -2007,7 +2050,8 @@ void push_bond(Directive                         d,
             bFoundA = true;
         }
         foundBParameter =
-                defaultInteractionsOfType(ftype, bondtype, at, atypes, param, TRUE, &nparam_defB);
+                defaultInteractionsOfType(ftype, bondtype, bondtypeIndex, at, atypes, param,
+                                          TRUE, &nparam_defB);
         if (foundBParameter != bondtype[ftype].interactionTypes.end())
         {
             /* Copy only the B-state default parameters */
@@ -39,8 +39,10 @@
 #ifndef GMX_GMXPREPROCESS_TOPPUSH_H
 #define GMX_GMXPREPROCESS_TOPPUSH_H
 
+#include <array>
 #include <vector>
 
+#include "gromacs/utility/classhelpers.h"
 #include "gromacs/utility/real.h"
 
 enum class Directive : int;
@@ -62,6 +64,42 @@ class ArrayRef;
 struct ExclusionBlock;
 } // namespace gmx
 
+/*! \libinternal \brief Hash index on the bond atom types of bonded interaction types
+ *
+ * Used by push_bond() to find the default parameters of an interaction
+ * in constant average time instead of by a linear search over all types.
+ * The index of an interaction type is extended lazily with the types that
+ * were added since the previous lookup, so it can be used while
+ * the parameter sections are being read. Any other modification of the
+ * types should increment InteractionsOfType::generation, which makes
+ * the index rebuild itself on the next lookup.
+ */
+class BondedTypeIndex
+{
+public:
+    BondedTypeIndex();
+    ~BondedTypeIndex();
+
+    /*! \brief Returns the first type in \p types with bond atom types \p atomTypes, -1 if none
+     *
+     * Wildcards are not considered, i.e. they have to match exactly.
+     */
+    int findFirstExactMatch(int ftype, const InteractionsOfType& types, gmx::ArrayRef<const int> atomTypes);
+
+    /*! \brief Returns the dihedral type in \p types that best matches \p atomTypes, -1 if none
+     *
+     * Types can contain wildcards, which match any bond atom type.
+     * Out of all matching types, the first type with the highest number
+     * of non-wildcard matches is returned.
+     */
+    int findBestDihedralMatch(int ftype, const InteractionsOfType& types, const std::array<int, 4>& atomTypes);
+
+private:
+    class Impl;
+    //! Pimpl that holds the index data
+    gmx::PrivateImplPointer<Impl> impl_;
+};
+
 void generate_nbparams(int comb, int funct, InteractionsOfType* plist, PreprocessingAtomTypes* atype, warninp* wi);
 
 void push_at(struct t_symtab*           symtab,
@@ -101,6 +139,7 @@ void push_atom(struct t_symtab* symtab, t_atoms* at, PreprocessingAtomTypes* aty
 
 void push_bond(Directive                         d,
                gmx::ArrayRef<InteractionsOfType> bondtype,
+               BondedTypeIndex*                  bondtypeIndex,
                gmx::ArrayRef<InteractionsOfType> bond,
                t_atoms*                          at,
                PreprocessingAtomTypes*           atype,
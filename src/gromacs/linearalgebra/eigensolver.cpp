@@ -39,6 +39,8 @@
 
 #include "eigensolver.h"
 
+#include <functional>
+
 #include "gromacs/linearalgebra/sparsematrix.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/real.h"
@@ -250,7 +252,18 @@ void sparse_parallel_eigensolver(gmx_sparsematrix_t* A, int neig, real* eigenval
 #endif
 
 
-void sparse_eigensolver(gmx_sparsematrix_t* A, int neig, real* eigenvalues, real* eigenvectors, int maxiter)
+/*! \brief Reverse-communication ARPACK driver shared by the iterative eigensolvers.
+ *
+ * \p which is passed on to ARPACK and selects which end of the spectrum
+ * is determined, \p multiply computes y = A x for the operator.
+ */
+static void arpack_eigensolver(int                                          n,
+                               int                                          neig,
+                               const char*                                  which,
+                               const std::function<void(real* x, real* y)>& multiply,
+                               real*                                        eigenvalues,
+                               real*                                        eigenvectors,
+                               int                                          maxiter)
 {
     int   iwork[80];
     int   iparam[11];
@@ -259,21 +272,11 @@ void sparse_eigensolver(gmx_sparsematrix_t* A, int neig, real* eigenvalues, real
     real* workd;
     real* workl;
     real* v;
-    int   n;
     int   ido, info, lworkl, i, ncv, dovec;
     real  abstol;
     int*  select;
     int   iter;
 
-#ifdef GMX_MPI_NOT
-    MPI_Comm_size(MPI_COMM_WORLD, &n);
-    if (n > 1)
-    {
-        sparse_parallel_eigensolver(A, neig, eigenvalues, eigenvectors, maxiter);
-        return;
-    }
-#endif
-
     if (eigenvectors != nullptr)
     {
         dovec = 1;
@@ -283,7 +286,6 @@ void sparse_eigensolver(gmx_sparsematrix_t* A, int neig, real* eigenvalues, real
         dovec = 0;
     }
 
-    n   = A->nrow;
     ncv = 2 * neig;
 
     if (ncv > n)
@@ -318,16 +320,16 @@ void sparse_eigensolver(gmx_sparsematrix_t* A, int neig, real* eigenvalues, real
     {
 #if GMX_DOUBLE
         F77_FUNC(dsaupd, DSAUPD)
-        (&ido, "I", &n, "SA", &neig, &abstol, resid, &ncv, v, &n, iparam, ipntr, workd, iwork,
+        (&ido, "I", &n, which, &neig, &abstol, resid, &ncv, v, &n, iparam, ipntr, workd, iwork,
          workl, &lworkl, &info);
 #else
         F77_FUNC(ssaupd, SSAUPD)
-        (&ido, "I", &n, "SA", &neig, &abstol, resid, &ncv, v, &n, iparam, ipntr, workd, iwork,
+        (&ido, "I", &n, which, &neig, &abstol, resid, &ncv, v, &n, iparam, ipntr, workd, iwork,
          workl, &lworkl, &info);
 #endif
         if (ido == -1 || ido == 1)
         {
-            gmx_sparsematrix_vector_multiply(A, workd + ipntr[0] - 1, workd + ipntr[1] - 1);
+            multiply(workd + ipntr[0] - 1, workd + ipntr[1] - 1);
         }
 
         fprintf(stderr, "\rIteration %4d: %3d out of %3d Ritz values converged.", iter++, iparam[4], neig);
@@ -353,13 +355,17 @@ void sparse_eigensolver(gmx_sparsematrix_t* A, int neig, real* eigenvalues, real
 
 #if GMX_DOUBLE
     F77_FUNC(dseupd, DSEUPD)
-    (&dovec, "A", select, eigenvalues, eigenvectors, &n, nullptr, "I", &n, "SA", &neig, &abstol,
+    (&dovec, "A", select, eigenvalues, eigenvectors, &n, nullptr, "I", &n, which, &neig, &abstol,
      resid, &ncv, v, &n, iparam, ipntr, workd, workl, &lworkl, &info);
 #else
     F77_FUNC(sseupd, SSEUPD)
-    (&dovec, "A", select, eigenvalues, eigenvectors, &n, nullptr, "I", &n, "SA", &neig, &abstol,
+    (&dovec, "A", select, eigenvalues, eigenvectors, &n, nullptr, "I", &n, which, &neig, &abstol,
      resid, &ncv, v, &n, iparam, ipntr, workd, workl, &lworkl, &info);
 #endif
+    if (info != 0)
+    {
+        gmx_fatal(FARGS, "Error extracting the eigenvectors from Arnoldi diagonalization:%d\n", info);
+    }
 
     sfree(v);
     sfree(resid);
@@ -367,3 +373,32 @@ void sparse_eigensolver(gmx_sparsematrix_t* A, int neig, real* eigenvalues, real
     sfree(workl);
     sfree(select);
 }
+
+
+void sparse_eigensolver(gmx_sparsematrix_t* A, int neig, real* eigenvalues, real* eigenvectors, int maxiter)
+{
+#ifdef GMX_MPI_NOT
+    int nnodes;
+    MPI_Comm_size(MPI_COMM_WORLD, &nnodes);
+    if (nnodes > 1)
+    {
+        sparse_parallel_eigensolver(A, neig, eigenvalues, eigenvectors, maxiter);
+        return;
+    }
+#endif
+
+    arpack_eigensolver(A->nrow, neig, "SA",
+                       [A](real* x, real* y) { gmx_sparsematrix_vector_multiply(A, x, y); },
+                       eigenvalues, eigenvectors, maxiter);
+}
+
+
+void largest_eigensolver(int                                          n,
+                         int                                          neig,
+                         const std::function<void(real* x, real* y)>& multiply,
+                         real*                                        eigenvalues,
+                         real*                                        eigenvectors,
+                         int                                          maxiter)
+{
+    arpack_eigensolver(n, neig, "LA", multiply, eigenvalues, eigenvectors, maxiter);
+}
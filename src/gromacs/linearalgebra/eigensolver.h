@@ -37,6 +37,8 @@
 #ifndef GMX_LINEARALGEBRA_EIGENSOLVER_H
 #define GMX_LINEARALGEBRA_EIGENSOLVER_H
 
+#include <functional>
+
 #include "gromacs/linearalgebra/sparsematrix.h"
 #include "gromacs/utility/real.h"
 
@@ -75,4 +77,22 @@ void eigensolver(real* a, int n, int index_lower, int index_upper, real* eigenva
  */
 void sparse_eigensolver(gmx_sparsematrix_t* A, int neig, real* eigenvalues, real* eigenvectors, int maxiter);
 
+/*! \brief Iterative eigensolver for the largest eigenvalues of a symmetric operator.
+ *
+ *  This routine uses the ARPACK Lanczos solver and only accesses the matrix
+ *  through \p multiply, which should compute y = A x for vectors of length n.
+ *  This is useful when only a few leading eigenvectors of a large dense
+ *  matrix are needed, since full diagonalization costs O(n^3) time and
+ *  a second n*n work array.
+ *
+ *  The neig largest eigenvalues are returned in ascending order, and
+ *  if the eigenvectors pointer is non-NULL eigenvector j starts at offset j*n.
+ */
+void largest_eigensolver(int                                          n,
+                         int                                          neig,
+                         const std::function<void(real* x, real* y)>& multiply,
+                         real*                                        eigenvalues,
+                         real*                                        eigenvectors,
+                         int                                          maxiter);
+
 #endif
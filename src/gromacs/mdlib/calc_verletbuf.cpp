@@ -41,6 +41,7 @@
 #include <cstdlib>
 
 #include <algorithm>
+#include <vector>
 
 #include "gromacs/ewald/ewald_utils.h"
 #include "gromacs/math/functions.h"
@@ -54,6 +55,7 @@
 #include "gromacs/topology/block.h"
 #include "gromacs/topology/ifunc.h"
 #include "gromacs/topology/topology.h"
+#include "gromacs/utility/exceptions.h"
 #include "gromacs/utility/fatalerror.h"
 #include "gromacs/utility/real.h"
 #include "gromacs/utility/strconvert.h"
@@ -323,97 +325,128 @@ static void get_vsite_masses(const gmx_moltype_t&  moltype,
     }
 }
 
-static std::vector<VerletbufAtomtype> getVerletBufferAtomtypes(const gmx_mtop_t& mtop, const bool setMassesToOne)
+/* Returns the atom types of one molecule of type moltype, counts are per molecule */
+static std::vector<VerletbufAtomtype> getMoltypeVerletBufferAtomtypes(const gmx_moltype_t&  moltype,
+                                                                      const gmx_ffparams_t& ffparams,
+                                                                      const bool setMassesToOne)
 {
     std::vector<VerletbufAtomtype> att;
     int                            ft, i, a1, a2, a3, a;
     const t_iparams*               ip;
 
-    for (const gmx_molblock_t& molblock : mtop.molblock)
-    {
-        int                  nmol    = molblock.nmol;
-        const gmx_moltype_t& moltype = mtop.moltype[molblock.type];
-        const t_atoms*       atoms   = &moltype.atoms;
+    const t_atoms* atoms = &moltype.atoms;
 
-        /* Check for constraints, as they affect the kinetic energy.
-         * For virtual sites we need the masses and geometry of
-         * the constructing atoms to determine their velocity distribution.
-         * Thus we need a list of properties for all atoms which
-         * we partially fill when looping over constraints.
-         */
-        std::vector<atom_nonbonded_kinetic_prop_t> prop(atoms->nr);
+    /* Check for constraints, as they affect the kinetic energy.
+     * For virtual sites we need the masses and geometry of
+     * the constructing atoms to determine their velocity distribution.
+     * Thus we need a list of properties for all atoms which
+     * we partially fill when looping over constraints.
+     */
+    std::vector<atom_nonbonded_kinetic_prop_t> prop(atoms->nr);
 
-        for (ft = F_CONSTR; ft <= F_CONSTRNC; ft++)
-        {
-            const InteractionList& il = moltype.ilist[ft];
+    for (ft = F_CONSTR; ft <= F_CONSTRNC; ft++)
+    {
+        const InteractionList& il = moltype.ilist[ft];
 
-            for (i = 0; i < il.size(); i += 1 + NRAL(ft))
+        for (i = 0; i < il.size(); i += 1 + NRAL(ft))
+        {
+            ip         = &ffparams.iparams[il.iatoms[i]];
+            a1         = il.iatoms[i + 1];
+            a2         = il.iatoms[i + 2];
+            real mass1 = getMass(*atoms, a1, setMassesToOne);
+            real mass2 = getMass(*atoms, a2, setMassesToOne);
+            if (mass2 > prop[a1].con_mass)
             {
-                ip         = &mtop.ffparams.iparams[il.iatoms[i]];
-                a1         = il.iatoms[i + 1];
-                a2         = il.iatoms[i + 2];
-                real mass1 = getMass(*atoms, a1, setMassesToOne);
-                real mass2 = getMass(*atoms, a2, setMassesToOne);
-                if (mass2 > prop[a1].con_mass)
-                {
-                    prop[a1].con_mass = mass2;
-                    prop[a1].con_len  = ip->constr.dA;
-                }
-                if (mass1 > prop[a2].con_mass)
-                {
-                    prop[a2].con_mass = mass1;
-                    prop[a2].con_len  = ip->constr.dA;
-                }
+                prop[a1].con_mass = mass2;
+                prop[a1].con_len  = ip->constr.dA;
+            }
+            if (mass1 > prop[a2].con_mass)
+            {
+                prop[a2].con_mass = mass1;
+                prop[a2].con_len  = ip->constr.dA;
             }
         }
+    }
 
-        const InteractionList& il = moltype.ilist[F_SETTLE];
+    const InteractionList& il = moltype.ilist[F_SETTLE];
 
-        for (i = 0; i < il.size(); i += 1 + NRAL(F_SETTLE))
-        {
-            ip = &mtop.ffparams.iparams[il.iatoms[i]];
-            a1 = il.iatoms[i + 1];
-            a2 = il.iatoms[i + 2];
-            a3 = il.iatoms[i + 3];
-            /* Usually the mass of a1 (usually oxygen) is larger than a2/a3.
-             * If this is not the case, we overestimate the displacement,
-             * which leads to a larger buffer (ok since this is an exotic case).
-             */
-            prop[a1].con_mass = getMass(*atoms, a2, setMassesToOne);
-            prop[a1].con_len  = ip->settle.doh;
+    for (i = 0; i < il.size(); i += 1 + NRAL(F_SETTLE))
+    {
+        ip = &ffparams.iparams[il.iatoms[i]];
+        a1 = il.iatoms[i + 1];
+        a2 = il.iatoms[i + 2];
+        a3 = il.iatoms[i + 3];
+        /* Usually the mass of a1 (usually oxygen) is larger than a2/a3.
+         * If this is not the case, we overestimate the displacement,
+         * which leads to a larger buffer (ok since this is an exotic case).
+         */
+        prop[a1].con_mass = getMass(*atoms, a2, setMassesToOne);
+        prop[a1].con_len  = ip->settle.doh;
+
+        prop[a2].con_mass = getMass(*atoms, a1, setMassesToOne);
+        prop[a2].con_len  = ip->settle.doh;
 
-            prop[a2].con_mass = getMass(*atoms, a1, setMassesToOne);
-            prop[a2].con_len  = ip->settle.doh;
+        prop[a3].con_mass = getMass(*atoms, a1, setMassesToOne);
+        prop[a3].con_len  = ip->settle.doh;
+    }
+
+    std::vector<real> vsite_m(atoms->nr);
+    get_vsite_masses(moltype, ffparams, setMassesToOne, vsite_m);
 
-            prop[a3].con_mass = getMass(*atoms, a1, setMassesToOne);
-            prop[a3].con_len  = ip->settle.doh;
+    for (a = 0; a < atoms->nr; a++)
+    {
+        if (atoms->atom[a].ptype == eptVSite)
+        {
+            prop[a].mass = vsite_m[a];
         }
+        else
+        {
+            prop[a].mass = getMass(*atoms, a, setMassesToOne);
+        }
+        prop[a].type = atoms->atom[a].type;
+        prop[a].q    = atoms->atom[a].q;
+        /* We consider an atom constrained, #DOF=2, when it is
+         * connected with constraints to (at least one) atom with
+         * a mass of more than 0.4x its own mass. This is not a critical
+         * parameter, since with roughly equal masses the unconstrained
+         * and constrained displacement will not differ much (and both
+         * overestimate the displacement).
+         */
+        prop[a].bConstr = (prop[a].con_mass > 0.4 * prop[a].mass);
 
-        std::vector<real> vsite_m(atoms->nr);
-        get_vsite_masses(moltype, mtop.ffparams, setMassesToOne, vsite_m);
+        addAtomtype(&att, prop[a], 1);
+    }
 
-        for (a = 0; a < atoms->nr; a++)
+    return att;
+}
+
+static std::vector<VerletbufAtomtype> getVerletBufferAtomtypes(const gmx_mtop_t& mtop,
+                                                               const bool        setMassesToOne,
+                                                               const int         numThreads)
+{
+    /* The molecule types are independent, so we process them concurrently.
+     * The merge below goes over the blocks and types in the same order
+     * as a sequential loop over all atoms would, so the resulting list
+     * and thus the buffer estimate does not depend on the thread count.
+     */
+    std::vector<std::vector<VerletbufAtomtype>> attPerMoltype(mtop.moltype.size());
+#pragma omp parallel for num_threads(numThreads) schedule(dynamic)
+    for (gmx::index mt = 0; mt < gmx::ssize(mtop.moltype); mt++)
+    {
+        try
         {
-            if (atoms->atom[a].ptype == eptVSite)
-            {
-                prop[a].mass = vsite_m[a];
-            }
-            else
-            {
-                prop[a].mass = getMass(*atoms, a, setMassesToOne);
-            }
-            prop[a].type = atoms->atom[a].type;
-            prop[a].q    = atoms->atom[a].q;
-            /* We consider an atom constrained, #DOF=2, when it is
-             * connected with constraints to (at least one) atom with
-             * a mass of more than 0.4x its own mass. This is not a critical
-             * parameter, since with roughly equal masses the unconstrained
-             * and constrained displacement will not differ much (and both
-             * overestimate the displacement).
-             */
-            prop[a].bConstr = (prop[a].con_mass > 0.4 * prop[a].mass);
+            attPerMoltype[mt] =
+                    getMoltypeVerletBufferAtomtypes(mtop.moltype[mt], mtop.ffparams, setMassesToOne);
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR;
+    }
 
-            addAtomtype(&att, prop[a], nmol);
+    std::vector<VerletbufAtomtype> att;
+    for (const gmx_molblock_t& molblock : mtop.molblock)
+    {
+        for (const VerletbufAtomtype& moltypeAtomtype : attPerMoltype[molblock.type])
+        {
+            addAtomtype(&att, moltypeAtomtype.prop, moltypeAtomtype.n * molblock.nmol);
         }
     }
 
@@ -610,9 +643,24 @@ static real energyDriftAtomPair(bool                     isConstrained_i,
     return pot1 + pot2 + pot3;
 }
 
+// Struct for the displacement variance of an atom type, see get_atom_sigma2()
+struct AtomtypeSigma2
+{
+    real s2_2d; // variance due to rotation around a constraint
+    real s2_3d; // variance of the (constrained pair) COM displacement
+};
+
+// Struct for the LJ parameters of a pair of Verlet buffer atom types
+struct LJPairParameters
+{
+    real c6;
+    real c12;
+};
+
 // Computes and returns an estimate of the energy drift for the whole system
 static real energyDrift(gmx::ArrayRef<const VerletbufAtomtype> att,
-                        const gmx_ffparams_t*                  ffp,
+                        gmx::ArrayRef<const AtomtypeSigma2>    sigma2,
+                        gmx::ArrayRef<const LJPairParameters>  ljParams,
                         real                                   kT_fac,
                         const pot_derivatives_t*               ljDisp,
                         const pot_derivatives_t*               ljRep,
@@ -636,22 +684,22 @@ static real energyDrift(gmx::ArrayRef<const VerletbufAtomtype> att,
     {
         // Get the thermal displacement variance for the i-atom type
         const atom_nonbonded_kinetic_prop_t* prop_i = &att[i].prop;
-        real                                 s2i_2d, s2i_3d;
-        get_atom_sigma2(kT_fac, prop_i, &s2i_2d, &s2i_3d);
+        const real                           s2i_2d = sigma2[i].s2_2d;
+        const real                           s2i_3d = sigma2[i].s2_3d;
 
         for (gmx::index j = i; j < att.ssize(); j++)
         {
             // Get the thermal displacement variance for the j-atom type
             const atom_nonbonded_kinetic_prop_t* prop_j = &att[j].prop;
-            real                                 s2j_2d, s2j_3d;
-            get_atom_sigma2(kT_fac, prop_j, &s2j_2d, &s2j_3d);
+            const real                           s2j_2d = sigma2[j].s2_2d;
+            const real                           s2j_3d = sigma2[j].s2_3d;
 
             /* Add up the up to four independent variances */
             real s2 = s2i_2d + s2i_3d + s2j_2d + s2j_3d;
 
             // Set -V', V'' and -V''' at the cut-off for LJ */
-            real              c6  = ffp->iparams[prop_i->type * ffp->atnr + prop_j->type].lj.c6;
-            real              c12 = ffp->iparams[prop_i->type * ffp->atnr + prop_j->type].lj.c12;
+            real              c6  = ljParams[i * att.ssize() + j].c6;
+            real              c12 = ljParams[i * att.ssize() + j].c12;
             pot_derivatives_t lj;
             lj.md1 = c6 * ljDisp->md1 + c12 * ljRep->md1;
             lj.d2  = c6 * ljDisp->d2 + c12 * ljRep->d2;
@@ -825,99 +873,18 @@ static real maxSigma(real kT_fac, gmx::ArrayRef<const VerletbufAtomtype> att)
     return 2 * std::sqrt(kT_fac / smallestMass);
 }
 
-real calcVerletBufferSize(const gmx_mtop_t&         mtop,
-                          const real                boxVolume,
-                          const t_inputrec&         ir,
-                          const int                 nstlist,
-                          const int                 listLifetime,
-                          real                      referenceTemperature,
-                          const VerletbufListSetup& listSetup)
+/* Computes the derivatives at the cut-off of the LJ dispersion and repulsion
+ * potentials, without the C6/C12 factors, and of the electrostatic potential,
+ * without the charge factors, for the interaction settings in \p ir.
+ */
+static void getPotentialDerivatives(const t_inputrec&  ir,
+                                    real               repPow,
+                                    pot_derivatives_t* ljDisp,
+                                    pot_derivatives_t* ljRep,
+                                    pot_derivatives_t* elec)
 {
-    double resolution;
-    char*  env;
-
-    real particle_distance;
-    real nb_clust_frac_pairs_not_in_list_at_cutoff;
-
-    real elfac;
-    int  ib0, ib1, ib;
-    real rb, rl;
-    real drift;
-
-    if (!EI_DYNAMICS(ir.eI))
-    {
-        gmx_incons(
-                "Can only determine the Verlet buffer size for integrators that perform dynamics");
-    }
-    if (ir.verletbuf_tol <= 0)
-    {
-        gmx_incons("The Verlet buffer tolerance needs to be larger than zero");
-    }
-
-    if (referenceTemperature < 0)
-    {
-        /* We use the maximum temperature with multiple T-coupl groups.
-         * We could use a per particle temperature, but since particles
-         * interact, this might underestimate the buffer size.
-         */
-        referenceTemperature = maxReferenceTemperature(ir);
-
-        GMX_RELEASE_ASSERT(referenceTemperature >= 0,
-                           "Without T-coupling we should not end up here");
-    }
-
-    /* Resolution of the buffer size */
-    resolution = 0.001;
-
-    env = getenv("GMX_VERLET_BUFFER_RES");
-    if (env != nullptr)
-    {
-        sscanf(env, "%lf", &resolution);
-    }
-
-    /* In an atom wise pair-list there would be no pairs in the list
-     * beyond the pair-list cut-off.
-     * However, we use a pair-list of groups vs groups of atoms.
-     * For groups of 4 atoms, the parallelism of SSE instructions, only
-     * 10% of the atoms pairs are not in the list just beyond the cut-off.
-     * As this percentage increases slowly compared to the decrease of the
-     * Gaussian displacement distribution over this range, we can simply
-     * reduce the drift by this fraction.
-     * For larger groups, e.g. of 8 atoms, this fraction will be lower,
-     * so then buffer size will be on the conservative (large) side.
-     *
-     * Note that the formulas used here do not take into account
-     * cancellation of errors which could occur by missing both
-     * attractive and repulsive interactions.
-     *
-     * The only major assumption is homogeneous particle distribution.
-     * For an inhomogeneous system, such as a liquid-vapor system,
-     * the buffer will be underestimated. The actual energy drift
-     * will be higher by the factor: local/homogeneous particle density.
-     *
-     * The results of this estimate have been checked againt simulations.
-     * In most cases the real drift differs by less than a factor 2.
-     */
-
-    /* Worst case assumption: HCP packing of particles gives largest distance */
-    particle_distance = std::cbrt(boxVolume * std::sqrt(2) / mtop.natoms);
-
-    /* TODO: Obtain masses through (future) integrator functionality
-     *       to avoid scattering the code with (or forgetting) checks.
-     */
-    const bool setMassesToOne = (ir.eI == eiBD && ir.bd_fric > 0);
-    const auto att            = getVerletBufferAtomtypes(mtop, setMassesToOne);
-    GMX_ASSERT(!att.empty(), "We expect at least one type");
-
-    if (debug)
-    {
-        fprintf(debug, "particle distance assuming HCP packing: %f nm\n", particle_distance);
-        fprintf(debug, "energy drift atom types: %zu\n", att.size());
-    }
-
-    pot_derivatives_t ljDisp = { 0, 0, 0 };
-    pot_derivatives_t ljRep  = { 0, 0, 0 };
-    real              repPow = mtop.ffparams.reppow;
+    *ljDisp = { 0, 0, 0 };
+    *ljRep  = { 0, 0, 0 };
 
     if (ir.vdwtype == evdwCUT)
     {
@@ -928,14 +895,14 @@ real calcVerletBufferSize(const gmx_mtop_t&         mtop,
             case eintmodNONE:
             case eintmodPOTSHIFT:
                 /* -dV/dr of -r^-6 and r^-reppow */
-                ljDisp.md1 = -6 * std::pow(ir.rvdw, -7.0);
-                ljRep.md1  = repPow * std::pow(ir.rvdw, -(repPow + 1));
+                ljDisp->md1 = -6 * std::pow(ir.rvdw, -7.0);
+                ljRep->md1  = repPow * std::pow(ir.rvdw, -(repPow + 1));
                 /* The contribution of the higher derivatives is negligible */
                 break;
             case eintmodFORCESWITCH:
                 /* At the cut-off: V=V'=V''=0, so we use only V''' */
-                ljDisp.md3 = -md3_force_switch(6.0, ir.rvdw_switch, ir.rvdw);
-                ljRep.md3  = md3_force_switch(repPow, ir.rvdw_switch, ir.rvdw);
+                ljDisp->md3 = -md3_force_switch(6.0, ir.rvdw_switch, ir.rvdw);
+                ljRep->md3  = md3_force_switch(repPow, ir.rvdw_switch, ir.rvdw);
                 break;
             case eintmodPOTSWITCH:
                 /* At the cut-off: V=V'=V''=0.
@@ -945,8 +912,8 @@ real calcVerletBufferSize(const gmx_mtop_t&         mtop,
                 sw_range = ir.rvdw - ir.rvdw_switch;
                 md3_pswf = 60.0 / gmx::power3(sw_range);
 
-                ljDisp.md3 = -std::pow(ir.rvdw, -6.0) * md3_pswf;
-                ljRep.md3  = std::pow(ir.rvdw, -repPow) * md3_pswf;
+                ljDisp->md3 = -std::pow(ir.rvdw, -6.0) * md3_pswf;
+                ljRep->md3  = std::pow(ir.rvdw, -repPow) * md3_pswf;
                 break;
             default: gmx_incons("Unimplemented VdW modifier");
         }
@@ -961,8 +928,8 @@ real calcVerletBufferSize(const gmx_mtop_t&         mtop,
         real br6 = br4 * br2;
         // -dV/dr of g(br)*r^-6 [where g(x) = exp(-x^2)(1+x^2+x^4/2),
         // see LJ-PME equations in manual] and r^-reppow
-        ljDisp.md1 = -std::exp(-br2) * (br6 + 3.0 * br4 + 6.0 * br2 + 6.0) * std::pow(r, -7.0);
-        ljRep.md1  = repPow * pow(r, -(repPow + 1));
+        ljDisp->md1 = -std::exp(-br2) * (br6 + 3.0 * br4 + 6.0 * br2 + 6.0) * std::pow(r, -7.0);
+        ljRep->md1  = repPow * pow(r, -(repPow + 1));
         // The contribution of the higher derivatives is negligible
     }
     else
@@ -972,10 +939,10 @@ real calcVerletBufferSize(const gmx_mtop_t&         mtop,
                   "interactions");
     }
 
-    elfac = ONE_4PI_EPS0 / ir.epsilon_r;
+    const real elfac = ONE_4PI_EPS0 / ir.epsilon_r;
 
     // Determine the 1st and 2nd derivative for the electostatics
-    pot_derivatives_t elec = { 0, 0, 0 };
+    *elec = { 0, 0, 0 };
 
     if (ir.coulombtype == eelCUT || EEL_RF(ir.coulombtype))
     {
@@ -1002,20 +969,20 @@ real calcVerletBufferSize(const gmx_mtop_t&         mtop,
 
         if (eps_rf > 0)
         {
-            elec.md1 = elfac * (1.0 / gmx::square(ir.rcoulomb) - 2 * k_rf * ir.rcoulomb);
+            elec->md1 = elfac * (1.0 / gmx::square(ir.rcoulomb) - 2 * k_rf * ir.rcoulomb);
         }
-        elec.d2 = elfac * (2.0 / gmx::power3(ir.rcoulomb) + 2 * k_rf);
+        elec->d2 = elfac * (2.0 / gmx::power3(ir.rcoulomb) + 2 * k_rf);
     }
     else if (EEL_PME(ir.coulombtype) || ir.coulombtype == eelEWALD)
     {
         real b, rc, br;
 
-        b        = calc_ewaldcoeff_q(ir.rcoulomb, ir.ewald_rtol);
-        rc       = ir.rcoulomb;
-        br       = b * rc;
-        elec.md1 = elfac * (b * std::exp(-br * br) * M_2_SQRTPI / rc + std::erfc(br) / (rc * rc));
-        elec.d2  = elfac / (rc * rc)
-                  * (2 * b * (1 + br * br) * std::exp(-br * br) * M_2_SQRTPI + 2 * std::erfc(br) / rc);
+        b         = calc_ewaldcoeff_q(ir.rcoulomb, ir.ewald_rtol);
+        rc        = ir.rcoulomb;
+        br        = b * rc;
+        elec->md1 = elfac * (b * std::exp(-br * br) * M_2_SQRTPI / rc + std::erfc(br) / (rc * rc));
+        elec->d2  = elfac / (rc * rc)
+                   * (2 * b * (1 + br * br) * std::exp(-br * br) * M_2_SQRTPI + 2 * std::erfc(br) / rc);
     }
     else
     {
@@ -1023,13 +990,154 @@ real calcVerletBufferSize(const gmx_mtop_t&         mtop,
                   "Energy drift calculation is only implemented for Reaction-Field and Ewald "
                   "electrostatics");
     }
+}
+
+/* The topology dependent data for the Verlet buffer estimate */
+class VerletBufferEstimator::Impl
+{
+public:
+    Impl(const gmx_mtop_t& mtop, const t_inputrec& ir, int numThreads);
+
+    //! The unique atom types with their counts
+    std::vector<VerletbufAtomtype> att;
+    //! The LJ parameters for all pairs of entries in att
+    std::vector<LJPairParameters> ljParams;
+    //! The repulsion power of the LJ potential
+    real repPow;
+    //! The number of atoms in the system
+    int numAtoms;
+    //! Whether all masses are set to one, as for BD with bd_fric > 0
+    bool setMassesToOne;
+    //! The number of OpenMP threads for evaluating multiple candidates
+    int numThreads;
+    //! The resolution of the buffer size
+    double resolution;
+};
+
+VerletBufferEstimator::Impl::Impl(const gmx_mtop_t& mtop,
+                                  const t_inputrec& ir,
+                                  const int         numThreads) :
+    repPow(mtop.ffparams.reppow),
+    numAtoms(mtop.natoms),
+    /* TODO: Obtain masses through (future) integrator functionality
+     *       to avoid scattering the code with (or forgetting) checks.
+     */
+    setMassesToOne(ir.eI == eiBD && ir.bd_fric > 0),
+    numThreads(numThreads),
+    resolution(0.001)
+{
+    const char* env = getenv("GMX_VERLET_BUFFER_RES");
+    if (env != nullptr)
+    {
+        sscanf(env, "%lf", &resolution);
+    }
+
+    att = getVerletBufferAtomtypes(mtop, setMassesToOne, numThreads);
+    GMX_ASSERT(!att.empty(), "We expect at least one type");
+
+    if (debug)
+    {
+        fprintf(debug, "energy drift atom types: %zu\n", att.size());
+    }
+
+    /* Store the LJ parameters per atom type pair, so we no longer need the topology */
+    const gmx_ffparams_t& ffp = mtop.ffparams;
+    ljParams.resize(att.size() * att.size());
+    for (size_t i = 0; i < att.size(); i++)
+    {
+        for (size_t j = 0; j < att.size(); j++)
+        {
+            const t_iparams& iparams = ffp.iparams[att[i].prop.type * ffp.atnr + att[j].prop.type];
+
+            ljParams[i * att.size() + j] = { iparams.lj.c6, iparams.lj.c12 };
+        }
+    }
+}
+
+VerletBufferEstimator::VerletBufferEstimator(const gmx_mtop_t& mtop,
+                                             const t_inputrec& ir,
+                                             const int         numThreads) :
+    impl_(new Impl(mtop, ir, numThreads))
+{
+}
+
+VerletBufferEstimator::~VerletBufferEstimator() = default;
+
+real VerletBufferEstimator::calcBufferSize(const real                boxVolume,
+                                           const t_inputrec&         ir,
+                                           const VerletbufCandidate& candidate) const
+{
+    const VerletbufListSetup& listSetup = candidate.listSetup;
+
+    if (!EI_DYNAMICS(ir.eI))
+    {
+        gmx_incons(
+                "Can only determine the Verlet buffer size for integrators that perform dynamics");
+    }
+    if (ir.verletbuf_tol <= 0)
+    {
+        gmx_incons("The Verlet buffer tolerance needs to be larger than zero");
+    }
+    GMX_RELEASE_ASSERT((ir.eI == eiBD && ir.bd_fric > 0) == impl_->setMassesToOne,
+                       "The integrator mass treatment should match that at construction");
+
+    real referenceTemperature = candidate.referenceTemperature;
+    if (referenceTemperature < 0)
+    {
+        /* We use the maximum temperature with multiple T-coupl groups.
+         * We could use a per particle temperature, but since particles
+         * interact, this might underestimate the buffer size.
+         */
+        referenceTemperature = maxReferenceTemperature(ir);
+
+        GMX_RELEASE_ASSERT(referenceTemperature >= 0,
+                           "Without T-coupling we should not end up here");
+    }
+
+    /* In an atom wise pair-list there would be no pairs in the list
+     * beyond the pair-list cut-off.
+     * However, we use a pair-list of groups vs groups of atoms.
+     * For groups of 4 atoms, the parallelism of SSE instructions, only
+     * 10% of the atoms pairs are not in the list just beyond the cut-off.
+     * As this percentage increases slowly compared to the decrease of the
+     * Gaussian displacement distribution over this range, we can simply
+     * reduce the drift by this fraction.
+     * For larger groups, e.g. of 8 atoms, this fraction will be lower,
+     * so then buffer size will be on the conservative (large) side.
+     *
+     * Note that the formulas used here do not take into account
+     * cancellation of errors which could occur by missing both
+     * attractive and repulsive interactions.
+     *
+     * The only major assumption is homogeneous particle distribution.
+     * For an inhomogeneous system, such as a liquid-vapor system,
+     * the buffer will be underestimated. The actual energy drift
+     * will be higher by the factor: local/homogeneous particle density.
+     *
+     * The results of this estimate have been checked againt simulations.
+     * In most cases the real drift differs by less than a factor 2.
+     */
+
+    /* Worst case assumption: HCP packing of particles gives largest distance */
+    const real particle_distance = std::cbrt(boxVolume * std::sqrt(2) / impl_->numAtoms);
+
+    if (debug)
+    {
+        fprintf(debug, "particle distance assuming HCP packing: %f nm\n", particle_distance);
+    }
+
+    pot_derivatives_t ljDisp;
+    pot_derivatives_t ljRep;
+    pot_derivatives_t elec;
+    getPotentialDerivatives(ir, impl_->repPow, &ljDisp, &ljRep, &elec);
 
     /* Determine the variance of the atomic displacement
      * over list_lifetime steps: kT_fac
      * For inertial dynamics (not Brownian dynamics) the mass factor
      * is not included in kT_fac, it is added later.
      */
-    const real kT_fac = displacementVariance(ir, referenceTemperature, listLifetime * ir.delta_t);
+    const real kT_fac =
+            displacementVariance(ir, referenceTemperature, candidate.listLifetime * ir.delta_t);
 
     if (debug)
     {
@@ -1040,33 +1148,49 @@ real calcVerletBufferSize(const gmx_mtop_t&         mtop,
         fprintf(debug, "sqrt(kT_fac) %f\n", std::sqrt(kT_fac));
     }
 
+    gmx::ArrayRef<const VerletbufAtomtype> att = impl_->att;
+
+    /* The displacement variances do not depend on the buffer size,
+     * so we compute them once outside the bisection.
+     */
+    std::vector<AtomtypeSigma2> sigma2(att.size(), { 0, 0 });
+    if (kT_fac != 0)
+    {
+        for (size_t i = 0; i < att.size(); i++)
+        {
+            get_atom_sigma2(kT_fac, &att[i].prop, &sigma2[i].s2_2d, &sigma2[i].s2_3d);
+        }
+    }
+
+    const double resolution = impl_->resolution;
+
     /* Search using bisection */
-    ib0 = -1;
+    int ib0 = -1;
     /* The drift will be neglible at 5 times the max sigma */
-    ib1 = static_cast<int>(5 * maxSigma(kT_fac, att) / resolution) + 1;
+    int ib1 = static_cast<int>(5 * maxSigma(kT_fac, att) / resolution) + 1;
     while (ib1 - ib0 > 1)
     {
-        ib = (ib0 + ib1) / 2;
-        rb = ib * resolution;
-        rl = std::max(ir.rvdw, ir.rcoulomb) + rb;
+        const int  ib = (ib0 + ib1) / 2;
+        const real rb = ib * resolution;
+        const real rl = std::max(ir.rvdw, ir.rcoulomb) + rb;
 
         /* Calculate the average energy drift at the last step
          * of the nstlist steps at which the pair-list is used.
          */
-        drift = energyDrift(att, &mtop.ffparams, kT_fac, &ljDisp, &ljRep, &elec, ir.rvdw,
-                            ir.rcoulomb, rl, boxVolume);
+        real drift = energyDrift(att, sigma2, impl_->ljParams, kT_fac, &ljDisp, &ljRep, &elec,
+                                 ir.rvdw, ir.rcoulomb, rl, boxVolume);
 
         /* Correct for the fact that we are using a Ni x Nj particle pair list
          * and not a 1 x 1 particle pair list. This reduces the drift.
          */
         /* We don't have a formula for 8 (yet), use 4 which is conservative */
-        nb_clust_frac_pairs_not_in_list_at_cutoff =
+        const real nb_clust_frac_pairs_not_in_list_at_cutoff =
                 surface_frac(std::min(listSetup.cluster_size_i, 4), particle_distance, rl)
                 * surface_frac(std::min(listSetup.cluster_size_j, 4), particle_distance, rl);
         drift *= nb_clust_frac_pairs_not_in_list_at_cutoff;
 
         /* Convert the drift to drift per unit time per atom */
-        drift /= nstlist * ir.delta_t * mtop.natoms;
+        drift /= candidate.nstlist * ir.delta_t * impl_->numAtoms;
 
         if (debug)
         {
@@ -1088,6 +1212,41 @@ real calcVerletBufferSize(const gmx_mtop_t&         mtop,
     return std::max(ir.rvdw, ir.rcoulomb) + ib1 * resolution;
 }
 
+std::vector<real>
+VerletBufferEstimator::calcBufferSizes(const real                              boxVolume,
+                                       const t_inputrec&                       ir,
+                                       gmx::ArrayRef<const VerletbufCandidate> candidates) const
+{
+    /* The candidates are independent and only read the cached type data */
+    std::vector<real> rlists(candidates.size());
+#pragma omp parallel for num_threads(impl_->numThreads) schedule(dynamic)
+    for (gmx::index c = 0; c < candidates.ssize(); c++)
+    {
+        try
+        {
+            rlists[c] = calcBufferSize(boxVolume, ir, candidates[c]);
+        }
+        GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR;
+    }
+
+    return rlists;
+}
+
+real calcVerletBufferSize(const gmx_mtop_t&         mtop,
+                          const real                boxVolume,
+                          const t_inputrec&         ir,
+                          const int                 nstlist,
+                          const int                 listLifetime,
+                          const real                referenceTemperature,
+                          const VerletbufListSetup& listSetup,
+                          const int                 numThreads)
+{
+    const VerletBufferEstimator estimator(mtop, ir, numThreads);
+
+    return estimator.calcBufferSize(boxVolume, ir,
+                                    { nstlist, listLifetime, referenceTemperature, listSetup });
+}
+
 /* Returns the pairlist buffer size for use as a minimum buffer size
  *
  * Note that this is a rather crude estimate. It is ok for a buffer
@@ -1319,7 +1478,7 @@ real minCellSizeForAtomDisplacement(const gmx_mtop_t&      mtop,
 
     const bool setMassesToOne = (ir.eI == eiBD && ir.bd_fric > 0);
 
-    const auto atomtypes = getVerletBufferAtomtypes(mtop, setMassesToOne);
+    const auto atomtypes = getVerletBufferAtomtypes(mtop, setMassesToOne, 1);
 
     const real kT_fac = displacementVariance(ir, temperature, ir.nstlist * ir.delta_t);
 
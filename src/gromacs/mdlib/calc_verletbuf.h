@@ -37,7 +37,11 @@
 #ifndef GMX_MDLIB_CALC_VERLETBUF_H
 #define GMX_MDLIB_CALC_VERLETBUF_H
 
+#include <vector>
+
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/basedefinitions.h"
+#include "gromacs/utility/classhelpers.h"
 #include "gromacs/utility/real.h"
 
 struct gmx_mtop_t;
@@ -45,8 +49,6 @@ struct t_inputrec;
 
 namespace gmx
 {
-template<typename>
-class ArrayRef;
 class RangePartitioning;
 } // namespace gmx
 
@@ -92,6 +94,58 @@ enum class ListSetupType
  */
 VerletbufListSetup verletbufGetSafeListSetup(ListSetupType listType);
 
+/* The pair-list settings for which to estimate a buffer size */
+struct VerletbufCandidate
+{
+    int                nstlist;              /* The pair list update frequency in steps */
+    int                listLifetime;         /* The lifetime of the pair-list, usually nstlist-1 */
+    real               referenceTemperature; /* The reference temperature, <0: use the maximum */
+    VerletbufListSetup listSetup;            /* The pair-list setup */
+};
+
+/* Estimates Verlet buffer sizes for many pair-list settings of one system
+ *
+ * Extracting the atom type statistics from the topology is the only part
+ * of the buffer estimate that scales with the system size. This is done
+ * once at construction. Buffer sizes for different pair-list update
+ * frequencies, list lifetimes, temperatures, list setups and cut-off
+ * settings can then be computed cheaply, also concurrently.
+ * The results are identical to those of calcVerletBufferSize().
+ */
+class VerletBufferEstimator
+{
+public:
+    /* Extracts the atom type statistics from the system
+     *
+     * \param[in] mtop        The system topology
+     * \param[in] inputrec    The input record, only the integrator and bd_fric are used here
+     * \param[in] numThreads  The number of OpenMP threads to use for processing molecule types
+     *                        and for evaluating multiple candidates
+     */
+    VerletBufferEstimator(const gmx_mtop_t& mtop, const t_inputrec& inputrec, int numThreads = 1);
+    ~VerletBufferEstimator();
+
+    /* Returns the non-bonded pair-list radius including computed buffer
+     *
+     * See calcVerletBufferSize() for details. The cut-off, tolerance and
+     * integrator settings are taken from \p inputrec, which should use
+     * the same mass treatment as the input record passed at construction.
+     */
+    real calcBufferSize(real                      boxVolume,
+                        const t_inputrec&         inputrec,
+                        const VerletbufCandidate& candidate) const;
+
+    /* Returns the pair-list radius for each of \p candidates, computed concurrently */
+    std::vector<real> calcBufferSizes(real                                    boxVolume,
+                                      const t_inputrec&                       inputrec,
+                                      gmx::ArrayRef<const VerletbufCandidate> candidates) const;
+
+private:
+    class Impl;
+
+    gmx::PrivateImplPointer<Impl> impl_;
+};
+
 /* Returns the non-bonded pair-list radius including computed buffer
  *
  * Calculate the non-bonded pair-list buffer size for the Verlet list
@@ -114,7 +168,11 @@ VerletbufListSetup verletbufGetSafeListSetup(ListSetupType listType);
  * \param[in] listLifetime  The lifetime of the pair-list, usually nstlist-1, but could be different
  * for dynamic pruning \param[in] referenceTemperature  The reference temperature for the ensemble
  * \param[in] listSetup     The pair-list setup
+ * \param[in] numThreads    The number of OpenMP threads to use for processing molecule types
  * \returns The computed pair-list radius including buffer
+ *
+ * When estimating for multiple settings, use VerletBufferEstimator directly
+ * to avoid repeatedly extracting the atom type statistics from \p mtop.
  */
 real calcVerletBufferSize(const gmx_mtop_t&         mtop,
                           real                      boxVolume,
@@ -122,7 +180,8 @@ real calcVerletBufferSize(const gmx_mtop_t&         mtop,
                           int                       nstlist,
                           int                       listLifetime,
                           real                      referenceTemperature,
-                          const VerletbufListSetup& listSetup);
+                          const VerletbufListSetup& listSetup,
+                          int                       numThreads = 1);
 
 /* Convenience type */
 using PartitioningPerMoltype = gmx::ArrayRef<const gmx::RangePartitioning>;
@@ -229,7 +229,7 @@ void do_force_lowlevel(t_forcerec*                          fr,
             {
                 /* Do reciprocal PME for Coulomb and/or LJ. */
                 assert(fr->n_tpi >= 0);
-                if (fr->n_tpi == 0 || stepWork.stateChanged)
+                if ((fr->n_tpi == 0 || stepWork.stateChanged) && stepWork.computeSlowForces)
                 {
                     /* With domain decomposition we close the CPU side load
                      * balancing region here, because PME does global
@@ -237,13 +237,18 @@ void do_force_lowlevel(t_forcerec*                          fr,
                      */
                     ddBalanceRegionHandler.closeAfterForceComputationCpu();
 
+                    /* With multiple time stepping the mesh forces are the slow forces */
+                    ArrayRef<RVec> pmeForce = forceOutputs->haveForceMtsSlow()
+                                                      ? forceOutputs->forceMtsSlow()
+                                                      : forceWithVirial.force_;
+
                     wallcycle_start(wcycle, ewcPMEMESH);
                     status = gmx_pme_do(
                             fr->pmedata,
                             gmx::constArrayRefFromArray(coordinates.unpaddedConstArrayRef().data(),
                                                         md->homenr - fr->n_tpi),
-                            forceWithVirial.force_, md->chargeA, md->chargeB, md->sqrt_c6A,
-                            md->sqrt_c6B, md->sigmaA, md->sigmaB, box, cr,
+                            pmeForce, md->chargeA, md->chargeB, md->sqrt_c6A, md->sqrt_c6B,
+                            md->sigmaA, md->sigmaB, box, cr,
                             DOMAINDECOMP(cr) ? dd_pme_maxshift_x(cr->dd) : 0,
                             DOMAINDECOMP(cr) ? dd_pme_maxshift_y(cr->dd) : 0, nrnb, wcycle,
                             ewaldOutput.vir_q, ewaldOutput.vir_lj, &Vlr_q, &Vlr_lj,
@@ -39,13 +39,16 @@
 
 #include "gromacs/commandline/filenm.h"
 #include "gromacs/domdec/collect.h"
+#include "gromacs/domdec/domdec_network.h"
 #include "gromacs/domdec/domdec_struct.h"
 #include "gromacs/fileio/checkpoint.h"
 #include "gromacs/fileio/gmxfio.h"
+#include "gromacs/fileio/positionedrvecwriter.h"
 #include "gromacs/fileio/tngio.h"
 #include "gromacs/fileio/trrio.h"
 #include "gromacs/fileio/xtcio.h"
 #include "gromacs/fileio/xvgr.h"
+#include "gromacs/gmxlib/network.h"
 #include "gromacs/math/vec.h"
 #include "gromacs/mdlib/trajectory_writing.h"
 #include "gromacs/mdrunutility/handlerestart.h"
@@ -65,6 +68,10 @@
 struct gmx_mdoutf
 {
     t_fileio*                     fp_trn;
+    const char*                   fn_trn;
+    /* With DD, whether all PP ranks write their home atoms to the trr file */
+    gmx_bool                      bParallelTrrWrites;
+    gmx::PositionedRvecWriter*    trrWriter;
     t_fileio*                     fp_xtc;
     gmx_tng_trajectory_t          tng;
     gmx_tng_trajectory_t          tng_low_prec;
@@ -113,6 +120,8 @@ gmx_mdoutf_t init_mdoutf(FILE*                         fplog,
     snew(of, 1);
 
     of->fp_trn       = nullptr;
+    of->fn_trn       = nullptr;
+    of->trrWriter    = nullptr;
     of->fp_ene       = nullptr;
     of->fp_xtc       = nullptr;
     of->tng          = nullptr;
@@ -232,6 +241,27 @@ gmx_mdoutf_t init_mdoutf(FILE*                         fplog,
         }
     }
 
+    /* With domain decomposition, the ranks can write their home atoms
+     * directly to the trr file, which avoids collecting the coordinates,
+     * velocities and forces of frames that are not written to other files.
+     */
+    of->bParallelTrrWrites = FALSE;
+    if (DOMAINDECOMP(cr) && EI_DYNAMICS(ir->eI) && getenv("GMX_TRR_PARALLEL_WRITE") != nullptr
+        && gmx::PositionedRvecWriter::isSupported())
+    {
+        /* Only the master knows whether a trr file is opened */
+        of->bParallelTrrWrites = (of->fp_trn != nullptr);
+        gmx_bcast(sizeof(of->bParallelTrrWrites), &of->bParallelTrrWrites, cr->mpi_comm_mygroup);
+        if (of->bParallelTrrWrites)
+        {
+            of->fn_trn = ftp2fn(efTRN, nfile, fnm);
+            if (fplog)
+            {
+                fprintf(fplog, "All PP ranks will write their atoms to the trr file\n");
+            }
+        }
+    }
+
     if (bCiteTng)
     {
         please_cite(fplog, "Lundborg2014");
@@ -255,6 +285,76 @@ gmx_wallcycle_t mdoutf_get_wcycle(gmx_mdoutf_t of)
     return of->wcycle;
 }
 
+/*! \brief Writes a trr frame with each PP rank writing the vectors of its home atoms
+ *
+ * The master rank writes the frame header and box. After that each rank
+ * writes its part of the coordinate, velocity and force arrays at the
+ * file positions of its atoms. Must be called on all PP ranks.
+ */
+static void writeTrrFrameInParallel(const t_commrec*               cr,
+                                    gmx_mdoutf_t                   of,
+                                    int                            mdof_flags,
+                                    int                            natoms,
+                                    int64_t                        step,
+                                    double                         t,
+                                    const t_state*                 state_local,
+                                    gmx::ArrayRef<const gmx::RVec> f_local)
+{
+    const bool bX = (mdof_flags & MDOF_X) != 0;
+    const bool bV = (mdof_flags & MDOF_V) != 0;
+    const bool bF = (mdof_flags & MDOF_F) != 0;
+
+    gmx_off_t frameDataOffset = 0;
+    if (MASTER(cr))
+    {
+        frameDataOffset = gmx_trr_write_frame_header(of->fp_trn, step, t,
+                                                     state_local->lambda[efptFEP],
+                                                     state_local->box, natoms, bX, bV, bF);
+        if (gmx_fio_flush(of->fp_trn) != 0)
+        {
+            gmx_file("Cannot write trajectory; maybe you are out of disk space?");
+        }
+    }
+    dd_bcast(cr->dd, sizeof(frameDataOffset), &frameDataOffset);
+
+    if (of->trrWriter == nullptr)
+    {
+        of->trrWriter = new gmx::PositionedRvecWriter(of->fn_trn);
+    }
+
+    gmx::ArrayRef<const int> globalIndices = dd_home_atom_global_indices(*cr->dd, *state_local);
+    const int                numHomeAtoms  = globalIndices.size();
+    const gmx_off_t          arraySize     = static_cast<gmx_off_t>(natoms) * sizeof(rvec);
+
+    gmx_off_t offset = frameDataOffset;
+    if (bX)
+    {
+        of->trrWriter->write(offset, globalIndices,
+                             gmx::constArrayRefFromArray(state_local->x.data(), numHomeAtoms));
+        offset += arraySize;
+    }
+    if (bV)
+    {
+        of->trrWriter->write(offset, globalIndices,
+                             gmx::constArrayRefFromArray(state_local->v.data(), numHomeAtoms));
+        offset += arraySize;
+    }
+    if (bF)
+    {
+        of->trrWriter->write(offset, globalIndices,
+                             gmx::constArrayRefFromArray(f_local.data(), numHomeAtoms));
+        offset += arraySize;
+    }
+
+    /* The master should only continue writing after all data has been written */
+    gmx_barrier(cr->mpi_comm_mygroup);
+
+    if (MASTER(cr) && gmx_fio_seek(of->fp_trn, offset) != 0)
+    {
+        gmx_file("Cannot write trajectory; maybe you are out of disk space?");
+    }
+}
+
 void mdoutf_write_to_trajectory_files(FILE*                    fplog,
                                       const t_commrec*         cr,
                                       gmx_mdoutf_t             of,
@@ -269,6 +369,11 @@ void mdoutf_write_to_trajectory_files(FILE*                    fplog,
 {
     rvec* f_global;
 
+    /* Checkpointing collects the whole state, so then we write the trr frame from the master */
+    const bool writeTrrInParallel = (of->bParallelTrrWrites
+                                     && (mdof_flags & (MDOF_X | MDOF_V | MDOF_F))
+                                     && !(mdof_flags & MDOF_CPT));
+
     if (DOMAINDECOMP(cr))
     {
         if (mdof_flags & MDOF_CPT)
@@ -277,19 +382,23 @@ void mdoutf_write_to_trajectory_files(FILE*                    fplog,
         }
         else
         {
-            if (mdof_flags & (MDOF_X | MDOF_X_COMPRESSED))
+            if ((mdof_flags & MDOF_X_COMPRESSED) || ((mdof_flags & MDOF_X) && !writeTrrInParallel))
             {
                 auto globalXRef = MASTER(cr) ? state_global->x : gmx::ArrayRef<gmx::RVec>();
                 dd_collect_vec(cr->dd, state_local, state_local->x, globalXRef);
             }
-            if (mdof_flags & MDOF_V)
+            if ((mdof_flags & MDOF_V) && !writeTrrInParallel)
             {
                 auto globalVRef = MASTER(cr) ? state_global->v : gmx::ArrayRef<gmx::RVec>();
                 dd_collect_vec(cr->dd, state_local, state_local->v, globalVRef);
             }
         }
+        if (writeTrrInParallel)
+        {
+            writeTrrFrameInParallel(cr, of, mdof_flags, natoms, step, t, state_local, f_local);
+        }
         f_global = of->f_global;
-        if (mdof_flags & MDOF_F)
+        if ((mdof_flags & MDOF_F) && !writeTrrInParallel)
         {
             dd_collect_vec(cr->dd, state_local, f_local,
                            gmx::arrayRefFromArray(reinterpret_cast<gmx::RVec*>(f_global), f_local.size()));
@@ -331,11 +440,14 @@ void mdoutf_write_to_trajectory_files(FILE*                    fplog,
 
             if (of->fp_trn)
             {
-                gmx_trr_write_frame(of->fp_trn, step, t, state_local->lambda[efptFEP],
-                                    state_local->box, natoms, x, v, f);
-                if (gmx_fio_flush(of->fp_trn) != 0)
+                if (!writeTrrInParallel)
                 {
-                    gmx_file("Cannot write trajectory; maybe you are out of disk space?");
+                    gmx_trr_write_frame(of->fp_trn, step, t, state_local->lambda[efptFEP],
+                                        state_local->box, natoms, x, v, f);
+                    if (gmx_fio_flush(of->fp_trn) != 0)
+                    {
+                        gmx_file("Cannot write trajectory; maybe you are out of disk space?");
+                    }
                 }
             }
 
@@ -461,6 +573,7 @@ void done_mdoutf(gmx_mdoutf_t of)
     {
         gmx_trr_close(of->fp_trn);
     }
+    delete of->trrWriter;
     if (of->fp_dhdl != nullptr)
     {
         gmx_fio_fclose(of->fp_dhdl);
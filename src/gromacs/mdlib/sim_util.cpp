@@ -148,6 +148,30 @@ static void sum_forces(ArrayRef<RVec> f, ArrayRef<const RVec> forceToAdd)
     }
 }
 
+/*! \brief Combines the fast and slow forces for multiple time stepping
+ *
+ * Sets \p forceMtsCombined to \p force plus \p mtsFactor times
+ * \p forceMtsSlow and adds \p forceMtsSlow to \p force.
+ * Pass \p mtsFactor = 0 when the slow forces should not be integrated.
+ */
+static void combineMtsForces(const int            numAtoms,
+                             ArrayRef<RVec>       force,
+                             ArrayRef<const RVec> forceMtsSlow,
+                             ArrayRef<RVec>       forceMtsCombined,
+                             const int            mtsFactor)
+{
+    const real factor = mtsFactor;
+
+    int gmx_unused nt = gmx_omp_nthreads_get(emntDefault);
+#pragma omp parallel for num_threads(nt) schedule(static)
+    for (int i = 0; i < numAtoms; i++)
+    {
+        const RVec forceFast = force[i];
+        force[i] += forceMtsSlow[i];
+        forceMtsCombined[i] = forceFast + factor * forceMtsSlow[i];
+    }
+}
+
 static void calc_virial(int                              start,
                         int                              homenr,
                         const rvec                       x[],
@@ -331,7 +355,8 @@ static void postProcessForces(const t_commrec*          cr,
                               const t_mdatoms*          mdatoms,
                               const t_forcerec*         fr,
                               gmx::VirtualSitesHandler* vsite,
-                              const StepWorkload&       stepWork)
+                              const StepWorkload&       stepWork,
+                              const int                 mtsFactor)
 {
     // Extract the final output force buffer, which is also the buffer for forces with shift forces
     ArrayRef<RVec> f = forceOutputs->forceWithShiftForces().force();
@@ -384,6 +409,32 @@ static void postProcessForces(const t_commrec*          cr,
                    "We should have spread the vsite forces (earlier)");
     }
 
+    if (forceOutputs->haveForceMtsSlow())
+    {
+        ArrayRef<RVec> forceMtsSlow = forceOutputs->forceMtsSlow();
+
+        if (vsite)
+        {
+            /* Spread the slow forces on virtual sites, as for forceWithVirial above */
+            const gmx::VirtualSitesHandler::VirialHandling virialHandling =
+                    (stepWork.computeVirial ? gmx::VirtualSitesHandler::VirialHandling::NonLinear
+                                            : gmx::VirtualSitesHandler::VirialHandling::None);
+            matrix virial = { { 0 } };
+            vsite->spreadForces(x, forceMtsSlow, virialHandling, {}, virial, nrnb, box, wcycle);
+            if (stepWork.computeVirial)
+            {
+                m_add(vir_force, virial, vir_force);
+            }
+        }
+
+        /* The energies, virial and output forces contain the full slow forces,
+         * for integration the slow forces are scaled by the MTS factor on MTS steps.
+         */
+        combineMtsForces(mdatoms->homenr, f, forceMtsSlow,
+                         fr->forceHelperBuffers->forceMtsCombinedWithPadding().unpaddedArrayRef(),
+                         stepWork.isMtsStep ? mtsFactor : 0);
+    }
+
     if (fr->print_force >= 0)
     {
         print_large_forces(stderr, mdatoms, cr, step, fr->print_force, x, f);
@@ -816,6 +867,14 @@ static ForceOutputs setupForceOutputs(ForceHelperBuffers*                 forceH
         clearRVecs(forceWithVirial.force_, true);
     }
 
+    /* With multiple time stepping the slow forces are stored separately */
+    const bool haveForceMtsSlow = (stepWork.computeForces && forceHelperBuffers->haveMtsForces()
+                                   && stepWork.computeSlowForces);
+    if (haveForceMtsSlow)
+    {
+        clearRVecs(forceHelperBuffers->forceMtsSlow(), true);
+    }
+
     if (inputrec.bPull && pull_have_constraint(pull_work))
     {
         clear_pull_forces(pull_work);
@@ -824,7 +883,8 @@ static ForceOutputs setupForceOutputs(ForceHelperBuffers*                 forceH
     wallcycle_sub_stop(wcycle, ewcsCLEAR_FORCE_BUFFER);
 
     return ForceOutputs(forceWithShiftForces, forceHelperBuffers->haveDirectVirialContributions(),
-                        forceWithVirial);
+                        forceWithVirial, haveForceMtsSlow,
+                        haveForceMtsSlow ? forceHelperBuffers->forceMtsSlow() : ArrayRef<RVec>());
 }
 
 
@@ -864,13 +924,15 @@ static DomainLifetimeWorkload setupDomainLifetimeWorkload(const t_inputrec&
  * \param[in]      isNonbondedOn        Global override, if false forces to turn off all nonbonded calculation.
  * \param[in]      simulationWork       Simulation workload description.
  * \param[in]      rankHasPmeDuty       If this rank computes PME.
+ * \param[in]      step                 The current MD step.
  *
  * \returns New Stepworkload description.
  */
 static StepWorkload setupStepWorkload(const int                 legacyFlags,
                                       const bool                isNonbondedOn,
                                       const SimulationWorkload& simulationWork,
-                                      const bool                rankHasPmeDuty)
+                                      const bool                rankHasPmeDuty,
+                                      const int64_t             step)
 {
     StepWorkload flags;
     flags.stateChanged           = ((legacyFlags & GMX_FORCE_STATECHANGED) != 0);
@@ -883,6 +945,16 @@ static StepWorkload setupStepWorkload(const int                 legacyFlags,
     flags.computeNonbondedForces = ((legacyFlags & GMX_FORCE_NONBONDED) != 0) && isNonbondedOn;
     flags.computeDhdl            = ((legacyFlags & GMX_FORCE_DHDL) != 0);
 
+    if (simulationWork.useMts)
+    {
+        /* The slow forces are applied as an impulse every mtsFactor steps.
+         * Energies and the virial always include all forces, so we then
+         * also need the slow forces, but do not apply them.
+         */
+        flags.isMtsStep         = (step % simulationWork.mtsFactor == 0);
+        flags.computeSlowForces = (flags.isMtsStep || flags.computeEnergy || flags.computeVirial);
+    }
+
     if (simulationWork.useGpuBufferOps)
     {
         GMX_ASSERT(simulationWork.useGpuNonbonded,
@@ -1033,7 +1105,7 @@ void do_force(FILE*                               fplog,
 
 
     runScheduleWork->stepWork    = setupStepWorkload(legacyFlags, fr->bNonbonded, simulationWork,
-                                                  thisRankHasDuty(cr, DUTY_PME));
+                                                  thisRankHasDuty(cr, DUTY_PME), step);
     const StepWorkload& stepWork = runScheduleWork->stepWork;
 
 
@@ -1877,7 +1949,7 @@ void do_force(FILE*                               fplog,
     if (stepWork.computeForces)
     {
         postProcessForces(cr, step, nrnb, wcycle, box, x.unpaddedArrayRef(), &forceOut, vir_force,
-                          mdatoms, fr, vsite, stepWork);
+                          mdatoms, fr, vsite, stepWork, simulationWork.mtsFactor);
     }
 
     if (stepWork.computeEnergy)
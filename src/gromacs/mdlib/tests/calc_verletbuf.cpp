@@ -42,10 +42,17 @@
 #include "gromacs/mdlib/calc_verletbuf.h"
 
 #include <algorithm>
+#include <vector>
 
 #include <gtest/gtest.h>
 
 #include "gromacs/math/functions.h"
+#include "gromacs/mdtypes/inputrec.h"
+#include "gromacs/mdtypes/md_enums.h"
+#include "gromacs/topology/ifunc.h"
+#include "gromacs/topology/mtop_util.h"
+#include "gromacs/topology/topology.h"
+#include "gromacs/utility/smalloc.h"
 
 #include "testutils/testasserts.h"
 
@@ -139,6 +146,136 @@ TEST_F(VerletBufferConstraintTest, EqualMasses)
             "before and after the location of the maximum value for the exact formula.");
 }
 
+
+//! Fills \p mtop with a system of charged and neutral molecules with two LJ types
+void createTestTopology(gmx_mtop_t* mtop)
+{
+    gmx_ffparams_t& ffparams = mtop->ffparams;
+    ffparams.atnr            = 2;
+    ffparams.reppow          = 12;
+    const real c6[2][2]      = { { 2.6e-3, 1.0e-3 }, { 1.0e-3, 0 } };
+    const real c12[2][2]     = { { 2.6e-6, 1.0e-7 }, { 1.0e-7, 0 } };
+    for (int i = 0; i < ffparams.atnr; i++)
+    {
+        for (int j = 0; j < ffparams.atnr; j++)
+        {
+            t_iparams iparams;
+            iparams.lj.c6  = c6[i][j];
+            iparams.lj.c12 = c12[i][j];
+            ffparams.iparams.push_back(iparams);
+            ffparams.functype.push_back(F_LJ);
+        }
+    }
+
+    // A water-like molecule and a neutral LJ particle
+    mtop->moltype.resize(2);
+    gmx_moltype_t& water = mtop->moltype[0];
+    water.atoms.nr       = 3;
+    snew(water.atoms.atom, water.atoms.nr);
+    water.atoms.atom[0].m = 15.9994;
+    water.atoms.atom[0].q = -0.82;
+    for (int a = 1; a < 3; a++)
+    {
+        water.atoms.atom[a].m    = 1.008;
+        water.atoms.atom[a].q    = 0.41;
+        water.atoms.atom[a].type = 1;
+    }
+    gmx_moltype_t& particle = mtop->moltype[1];
+    particle.atoms.nr       = 1;
+    snew(particle.atoms.atom, particle.atoms.nr);
+    particle.atoms.atom[0].m = 39.948;
+
+    mtop->molblock.resize(2);
+    mtop->molblock[0].type = 0;
+    mtop->molblock[0].nmol = 1000;
+    mtop->molblock[1].type = 1;
+    mtop->molblock[1].nmol = 100;
+    mtop->natoms           = 3 * 1000 + 100;
+    gmx_mtop_finalize(mtop);
+}
+
+//! Sets up \p ir for MD with PME and the given buffer tolerance
+void setTestInputrec(t_inputrec* ir)
+{
+    ir->eI            = eiMD;
+    ir->delta_t       = 0.002;
+    ir->verletbuf_tol = 0.005;
+    ir->vdwtype       = evdwCUT;
+    ir->vdw_modifier  = eintmodPOTSHIFT;
+    ir->rvdw          = 0.9;
+    ir->coulombtype   = eelPME;
+    ir->rcoulomb      = 0.9;
+    ir->ewald_rtol    = 1e-5;
+    ir->epsilon_r     = 1;
+}
+
+/* The estimator should give exactly the same results as the single estimate
+ * function, for single and batched evaluations and independently
+ * of the number of threads.
+ */
+TEST(VerletBufferEstimatorTest, MatchesSingleEstimates)
+{
+    gmx_mtop_t mtop;
+    createTestTopology(&mtop);
+    t_inputrec ir;
+    setTestInputrec(&ir);
+    const real boxVolume = 3.3 * 3.3 * 3.3;
+
+    const VerletbufListSetup        listSetups[] = { { 1, 1 }, { 4, 4 } };
+    std::vector<VerletbufCandidate> candidates;
+    for (int nstlist : { 10, 20, 40, 80 })
+    {
+        for (real temperature : { 100.0, 300.0 })
+        {
+            for (const VerletbufListSetup& listSetup : listSetups)
+            {
+                candidates.push_back({ nstlist, nstlist - 1, temperature, listSetup });
+            }
+        }
+    }
+
+    const VerletBufferEstimator estimator(mtop, ir, 1);
+    const VerletBufferEstimator threadedEstimator(mtop, ir, 4);
+    const std::vector<real> rlists = threadedEstimator.calcBufferSizes(boxVolume, ir, candidates);
+    ASSERT_EQ(candidates.size(), rlists.size());
+    for (size_t c = 0; c < candidates.size(); c++)
+    {
+        const VerletbufCandidate& candidate = candidates[c];
+        const real                rlistReference =
+                calcVerletBufferSize(mtop, boxVolume, ir, candidate.nstlist, candidate.listLifetime,
+                                     candidate.referenceTemperature, candidate.listSetup);
+        EXPECT_EQ(rlistReference, estimator.calcBufferSize(boxVolume, ir, candidate));
+        EXPECT_EQ(rlistReference, rlists[c]);
+        EXPECT_GE(rlists[c], std::max(ir.rvdw, ir.rcoulomb));
+    }
+}
+
+/* Changing the cut-off settings after construction is allowed
+ * and should match a fresh estimate with the modified settings.
+ */
+TEST(VerletBufferEstimatorTest, HandlesModifiedCutoffs)
+{
+    gmx_mtop_t mtop;
+    createTestTopology(&mtop);
+    t_inputrec ir;
+    setTestInputrec(&ir);
+    const real boxVolume = 3.3 * 3.3 * 3.3;
+
+    const VerletBufferEstimator estimator(mtop, ir);
+    const VerletbufCandidate    candidate = { 20, 19, 300, { 4, 4 } };
+    const real                  rlist     = estimator.calcBufferSize(boxVolume, ir, candidate);
+
+    ir.rcoulomb = 1.2;
+    ir.rvdw     = 1.2;
+    const real rlistLongCutoff = estimator.calcBufferSize(boxVolume, ir, candidate);
+    EXPECT_EQ(calcVerletBufferSize(mtop, boxVolume, ir, 20, 19, 300, { 4, 4 }), rlistLongCutoff);
+    EXPECT_GT(rlistLongCutoff, 1.2);
+
+    ir.rcoulomb = 0.9;
+    ir.rvdw     = 0.9;
+    EXPECT_EQ(rlist, estimator.calcBufferSize(boxVolume, ir, candidate));
+}
+
 } // namespace
 
 } // namespace gmx
@@ -124,6 +124,7 @@
 #include "gromacs/mdtypes/state_propagator_data_gpu.h"
 #include "gromacs/modularsimulator/energyelement.h"
 #include "gromacs/nbnxm/gpu_data_mgmt.h"
+#include "gromacs/nbnxm/kernel_tuning.h"
 #include "gromacs/nbnxm/nbnxm.h"
 #include "gromacs/pbcutil/pbc.h"
 #include "gromacs/pulling/output.h"
@@ -302,6 +303,11 @@ void gmx::LegacySimulator::do_md()
     /* Check for polarizable models and flexible constraints */
     shellfc = init_shell_flexcon(fplog, top_global, constr ? constr->numFlexibleConstraints() : 0,
                                  ir->nstcalcenergy, DOMAINDECOMP(cr));
+    if (shellfc && ir->useMts)
+    {
+        gmx_fatal(FARGS,
+                  "Shells and flexible constraints are not supported with multiple time stepping");
+    }
 
     {
         double io = compute_io(ir, top_global->natoms, *groups, energyOutput.numEnergyTerms(), 1);
@@ -475,6 +481,13 @@ void gmx::LegacySimulator::do_md()
                          fr->nbv->useGpu());
     }
 
+    std::unique_ptr<Nbnxm::KernelTuning> nbnxmKernelTuning;
+    if (mdrunOptions.tuneNonbonded && !mdrunOptions.reproducible)
+    {
+        nbnxmKernelTuning = std::make_unique<Nbnxm::KernelTuning>(
+                mdlog, cr, *ir, *fr, *top_global, bPMETune && pme_loadbal_is_active(pme_loadbal));
+    }
+
     if (!ir->bContinuation)
     {
         if (state->flags & (1U << estV))
@@ -775,6 +788,14 @@ void gmx::LegacySimulator::do_md()
                            &bPMETunePrinting, simulationWork.useGpuPmePpCommunication);
         }
 
+        if (nbnxmKernelTuning && nbnxmKernelTuning->isActive() && bNStList)
+        {
+            /* Time and switch CPU non-bonded kernel setups, can replace fr->nbv */
+            nbnxmKernelTuning->tune(cr, (mdrunOptions.verbose && MASTER(cr)) ? stderr : nullptr,
+                                    fplog, mdlog, *ir, fr, *top_global, state->box, wcycle, step,
+                                    step_rel);
+        }
+
         wallcycle_start(wcycle, ewcSTEP);
 
         bLastStep = (step_rel == ir->nsteps);
@@ -1322,8 +1343,15 @@ void gmx::LegacySimulator::do_md()
         }
         else
         {
-            upd.update_coords(*ir, step, mdatoms, state, f.arrayRefWithPadding(), fcdata, ekind, M,
-                              etrtPOSITION, cr, constr != nullptr);
+            /* With multiple time stepping we integrate with the combined forces,
+             * which contain the slow forces scaled by the MTS factor on MTS steps.
+             */
+            const bool useMtsCombinedForce = (runScheduleWork->simulationWork.useMts
+                                              && runScheduleWork->stepWork.computeSlowForces);
+            upd.update_coords(*ir, step, mdatoms, state,
+                              useMtsCombinedForce ? fr->forceHelperBuffers->forceMtsCombinedWithPadding()
+                                                  : f.arrayRefWithPadding(),
+                              fcdata, ekind, M, etrtPOSITION, cr, constr != nullptr);
 
             wallcycle_stop(wcycle, ewcUPDATE);
 
@@ -1687,6 +1715,11 @@ void gmx::LegacySimulator::do_md()
         pme_loadbal_done(pme_loadbal, fplog, mdlog, fr->nbv->useGpu());
     }
 
+    if (nbnxmKernelTuning)
+    {
+        nbnxmKernelTuning->done(mdlog);
+    }
+
     done_shellfc(fplog, shellfc, step_rel);
 
     if (useReplicaExchange && MASTER(cr))
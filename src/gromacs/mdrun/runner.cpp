@@ -776,17 +776,35 @@ int Mdrunner::mdrunner()
 
     auto partialDeserializedTpr = std::make_unique<PartialDeserializedTprFile>();
 
+    /* With many ranks, letting each rank read the topology and inputrec
+     * sections of the tpr file can be faster than broadcasting them.
+     * The file is memory mapped, so the coordinates are not read by
+     * the non-master ranks.
+     */
+    const bool  readTprOnAllRanks = (getenv("GMX_TPR_READ_ON_ALL_RANKS") != nullptr);
+    const char* tprFileName       = ftp2fn(efTPR, filenames.size(), filenames.data());
+
     if (isSimulationMasterRank)
     {
         /* Only the master rank has the global state */
         globalState = std::make_unique<t_state>();
 
-        /* Read (nearly) all data required for the simulation
-         * and keep the partly serialized tpr contents to send to other ranks later
-         */
-        *partialDeserializedTpr = read_tpx_state(ftp2fn(efTPR, filenames.size(), filenames.data()),
-                                                 &inputrecInstance, globalState.get(), &mtop);
-        inputrec                = &inputrecInstance;
+        if (readTprOnAllRanks)
+        {
+            gmx::TprFileReader tprReader(tprFileName, false);
+            tprReader.readTopology(&mtop);
+            tprReader.readState(globalState.get());
+            tprReader.readInputrec(&inputrecInstance);
+        }
+        else
+        {
+            /* Read (nearly) all data required for the simulation
+             * and keep the partly serialized tpr contents to send to other ranks later
+             */
+            *partialDeserializedTpr =
+                    read_tpx_state(tprFileName, &inputrecInstance, globalState.get(), &mtop);
+        }
+        inputrec = &inputrecInstance;
     }
 
     /* Check and update the hardware options for internal consistency */
@@ -839,12 +857,25 @@ int Mdrunner::mdrunner()
 
     if (PAR(cr))
     {
-        /* now broadcast everything to the non-master nodes/threads: */
         if (!isSimulationMasterRank)
         {
             inputrec = &inputrecInstance;
         }
-        init_parallel(cr->mpi_comm_mygroup, MASTER(cr), inputrec, &mtop, partialDeserializedTpr.get());
+        if (readTprOnAllRanks)
+        {
+            if (!isSimulationMasterRank)
+            {
+                gmx::TprFileReader tprReader(tprFileName, false);
+                tprReader.readTopology(&mtop);
+                tprReader.readInputrec(inputrec);
+            }
+        }
+        else
+        {
+            /* now broadcast everything to the non-master nodes/threads: */
+            init_parallel(cr->mpi_comm_mygroup, MASTER(cr), inputrec, &mtop,
+                          partialDeserializedTpr.get());
+        }
     }
     GMX_RELEASE_ASSERT(inputrec != nullptr, "All ranks should have a valid inputrec now");
     partialDeserializedTpr.reset(nullptr);
@@ -1000,6 +1031,18 @@ int Mdrunner::mdrunner()
         domdecOptions.numPmeRanks = 0;
     }
 
+    if (inputrec->useMts)
+    {
+        if (domdecOptions.numPmeRanks > 0)
+        {
+            gmx_fatal_collective(FARGS, cr->mpi_comm_mysim, MASTER(cr),
+                                 "PME-only ranks are requested, but multiple time stepping "
+                                 "requires the PME mesh to be computed on the PP ranks");
+        }
+
+        domdecOptions.numPmeRanks = 0;
+    }
+
     if (useGpuForNonbonded && domdecOptions.numPmeRanks < 0)
     {
         /* With NB GPUs we don't automatically use PME-only CPU ranks. PME ranks can
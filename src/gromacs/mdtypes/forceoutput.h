@@ -199,13 +199,22 @@ private:
 class ForceOutputs
 {
 public:
-    //! Constructor
+    /*! \brief Constructor
+     *
+     * With multiple time stepping, when the slow forces are computed
+     * this step, set \p haveForceMtsSlow and pass the buffer for
+     * the slow forces in \p forceMtsSlow.
+     */
     ForceOutputs(const ForceWithShiftForces& forceWithShiftForces,
                  bool                        haveForceWithVirial,
-                 const ForceWithVirial&      forceWithVirial) :
+                 const ForceWithVirial&      forceWithVirial,
+                 bool                        haveForceMtsSlow = false,
+                 ArrayRef<RVec>              forceMtsSlow     = {}) :
         forceWithShiftForces_(forceWithShiftForces),
         haveForceWithVirial_(haveForceWithVirial),
-        forceWithVirial_(forceWithVirial)
+        forceWithVirial_(forceWithVirial),
+        haveForceMtsSlow_(haveForceMtsSlow),
+        forceMtsSlow_(forceMtsSlow)
     {
     }
 
@@ -218,6 +227,12 @@ public:
     //! Returns a reference to the force with virial object
     ForceWithVirial& forceWithVirial() { return forceWithVirial_; }
 
+    //! Returns whether the slow forces are stored separately for multiple time stepping
+    bool haveForceMtsSlow() const { return haveForceMtsSlow_; }
+
+    //! Returns the buffer for the slow forces with multiple time stepping
+    ArrayRef<RVec> forceMtsSlow() { return forceMtsSlow_; }
+
 private:
     //! Force output buffer used by legacy modules (without SIMD padding)
     ForceWithShiftForces forceWithShiftForces_;
@@ -225,6 +240,10 @@ private:
     bool haveForceWithVirial_;
     //! Force with direct virial contribution (if there are any; without SIMD padding)
     ForceWithVirial forceWithVirial_;
+    //! Whether the slow forces are stored separately this step
+    bool haveForceMtsSlow_;
+    //! Slow forces with multiple time stepping (without SIMD padding)
+    ArrayRef<RVec> forceMtsSlow_;
 };
 
 } // namespace gmx
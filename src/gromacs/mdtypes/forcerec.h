@@ -42,6 +42,7 @@
 #include <memory>
 #include <vector>
 
+#include "gromacs/math/paddedvector.h"
 #include "gromacs/math/vectypes.h"
 #include "gromacs/mdtypes/md_enums.h"
 #include "gromacs/pbcutil/pbc.h"
@@ -141,9 +142,11 @@ public:
      * When the forces that will be accumulated with help of these buffers
      * have direct virial contributions, set the parameter to true, so
      * an extra force buffer is available for these forces to enable
-     * correct virial computation.
+     * correct virial computation. With multiple time stepping, set
+     * \p useMts to true to get buffers for the slow forces and for
+     * the combined forces used in the integration.
      */
-    ForceHelperBuffers(bool haveDirectVirialContributions);
+    ForceHelperBuffers(bool haveDirectVirialContributions, bool useMts);
 
     //! Returns whether we have a direct virial contribution force buffer
     bool haveDirectVirialContributions() const { return haveDirectVirialContributions_; }
@@ -158,7 +161,24 @@ public:
     //! Returns the buffer for shift forces, size SHIFTS
     gmx::ArrayRef<gmx::RVec> shiftForces() { return shiftForces_; }
 
-    //! Resizes the direct virial contribution buffer, when present
+    //! Returns whether we have buffers for multiple time stepping
+    bool haveMtsForces() const { return useMts_; }
+
+    //! Returns the buffer for the slow forces with MTS
+    gmx::ArrayRef<gmx::RVec> forceMtsSlow()
+    {
+        GMX_ASSERT(useMts_, "Buffer can only be requested with MTS");
+        return forceMtsSlow_;
+    }
+
+    //! Returns the buffer for the combined fast and scaled slow forces with MTS
+    gmx::ArrayRefWithPadding<gmx::RVec> forceMtsCombinedWithPadding()
+    {
+        GMX_ASSERT(useMts_, "Buffer can only be requested with MTS");
+        return forceMtsCombined_.arrayRefWithPadding();
+    }
+
+    //! Resizes the direct virial contribution and MTS buffers, when present
     void resize(int numAtoms);
 
 private:
@@ -168,6 +188,12 @@ private:
     std::vector<gmx::RVec> forceBufferForDirectVirialContributions_;
     //! Shift force array for computing the virial, size SHIFTS
     std::vector<gmx::RVec> shiftForces_;
+    //! True when we use multiple time stepping
+    bool useMts_ = false;
+    //! Force buffer for the slow forces with MTS
+    std::vector<gmx::RVec> forceMtsSlow_;
+    //! Force buffer for the fast plus scaled slow forces with MTS, used for integration
+    gmx::PaddedVector<gmx::RVec> forceMtsCombined_;
 };
 
 struct t_forcerec
@@ -322,6 +322,10 @@ struct t_inputrec // NOLINT (clang-analyzer-optin.performance.Padding)
     int simulation_part;
     //! Start at a stepcount >0 (used w. convert-tpr)
     int64_t init_step;
+    //! Whether to use multiple time stepping with the PME mesh forces as slow forces
+    gmx_bool useMts;
+    //! The interval in steps between PME mesh force evaluations with MTS
+    int mtsFactor;
     //! Frequency of energy calc. and T/P coupl. upd.
     int nstcalcenergy;
     //! Group or verlet cutoffs
@@ -120,6 +120,8 @@ struct MdrunOptions
     TimingOptions timingOptions;
     //! If true and supported, will tune the PP-PME load balance
     gmx_bool tunePme = TRUE;
+    //! If true and supported, will tune the CPU non-bonded kernel setup at the start of the run
+    gmx_bool tuneNonbonded = FALSE;
     //! True if the user explicitly set the -ntomp command line option
     gmx_bool ntompOptionIsSet = FALSE;
     //! Options for IMD
@@ -81,6 +81,15 @@ public:
     bool computeListedForces = false;
     //! Whether this step DHDL needs to be computed
     bool computeDhdl = false;
+    /*! \brief Whether the slow forces need to be computed this step
+     *
+     * Without multiple time stepping this is always true. With MTS the slow,
+     * PME mesh, forces are computed on MTS steps and when energies or
+     * the virial are needed.
+     */
+    bool computeSlowForces = true;
+    //! Whether this is an MTS step, i.e. the slow forces are applied as an impulse
+    bool isMtsStep = false;
     /*! \brief Whether coordinate buffer ops are done on the GPU this step
      * \note This technically belongs to DomainLifetimeWorkload but due
      * to needing the flag before DomainLifetimeWorkload is built we keep
@@ -168,6 +177,10 @@ public:
     bool useGpuDirectCommunication = false;
     //! If there is an Ewald surface (dipole) term to compute
     bool haveEwaldSurfaceContribution = false;
+    //! If multiple time stepping is used, with the PME mesh forces as slow forces
+    bool useMts = false;
+    //! The interval in steps between PME mesh force evaluations with MTS
+    int mtsFactor = 1;
 };
 
 class MdrunScheduleWorkload
@@ -1175,19 +1175,23 @@ gmx_unused static void nbnxn_atomdata_reduce_reals_simd(real gmx_unused* gmx_res
 }
 
 /* Add part of the force array(s) from nbnxn_atomdata_t to f
+ *
+ * With \p useBlockBuffers the forces for each flag block are read from
+ * the buffer given by nbat.reducedForceBuffer, otherwise from buffer 0.
  *
  * Note: Adding restrict to f makes this function 50% slower with gcc 7.3
  */
-static void nbnxn_atomdata_add_nbat_f_to_f_part(const Nbnxm::GridSet&          gridSet,
-                                                const nbnxn_atomdata_t&        nbat,
-                                                const nbnxn_atomdata_output_t& out,
-                                                const int                      a0,
-                                                const int                      a1,
-                                                rvec*                          f)
+template<bool useBlockBuffers>
+static void nbnxn_atomdata_add_nbat_f_to_f_part(const Nbnxm::GridSet&   gridSet,
+                                                const nbnxn_atomdata_t& nbat,
+                                                const int               a0,
+                                                const int               a1,
+                                                rvec*                   f)
 {
     gmx::ArrayRef<const int> cell = gridSet.cells();
     // Note: Using ArrayRef instead makes this code 25% slower with gcc 7.3
-    const real* fnb = out.f.data();
+    const real*        fnb         = nbat.out[0].f.data();
+    const real* const* blockBuffer = nbat.reducedForceBuffer.data();
 
     /* Loop over all columns and copy and fill */
     switch (nbat.FFormat)
@@ -1198,6 +1202,11 @@ static void nbnxn_atomdata_add_nbat_f_to_f_part(const Nbnxm::GridSet&          g
             {
                 int i = cell[a] * nbat.fstride;
 
+                if (useBlockBuffers)
+                {
+                    fnb = blockBuffer[cell[a] / NBNXN_BUFFERFLAG_SIZE];
+                }
+
                 f[a][XX] += fnb[i];
                 f[a][YY] += fnb[i + 1];
                 f[a][ZZ] += fnb[i + 2];
@@ -1208,6 +1217,11 @@ static void nbnxn_atomdata_add_nbat_f_to_f_part(const Nbnxm::GridSet&          g
             {
                 int i = atom_to_x_index<c_packX4>(cell[a]);
 
+                if (useBlockBuffers)
+                {
+                    fnb = blockBuffer[cell[a] / NBNXN_BUFFERFLAG_SIZE];
+                }
+
                 f[a][XX] += fnb[i + XX * c_packX4];
                 f[a][YY] += fnb[i + YY * c_packX4];
                 f[a][ZZ] += fnb[i + ZZ * c_packX4];
@@ -1218,6 +1232,11 @@ static void nbnxn_atomdata_add_nbat_f_to_f_part(const Nbnxm::GridSet&          g
             {
                 int i = atom_to_x_index<c_packX8>(cell[a]);
 
+                if (useBlockBuffers)
+                {
+                    fnb = blockBuffer[cell[a] / NBNXN_BUFFERFLAG_SIZE];
+                }
+
                 f[a][XX] += fnb[i + XX * c_packX8];
                 f[a][YY] += fnb[i + YY * c_packX8];
                 f[a][ZZ] += fnb[i + ZZ * c_packX8];
@@ -1372,8 +1391,21 @@ static void nbnxn_atomdata_add_nbat_f_to_f_treereduce(nbnxn_atomdata_t* nbat, in
 }
 
 
+/* Reduce the force output buffers in place
+ *
+ * The reduced forces of each flag block are stored in the buffer
+ * of the first output that contributes to the block. As each thread
+ * gets the i-clusters of a contiguous range of grid columns, most blocks
+ * only have contributions from the thread that owns them. Those blocks
+ * are not copied at all, only the blocks that receive j-forces from
+ * multiple threads are summed. Blocks without contributions are cleared
+ * in buffer 0. The buffer to use for each block is stored
+ * in nbat->reducedForceBuffer.
+ */
 static void nbnxn_atomdata_add_nbat_f_to_f_stdreduce(nbnxn_atomdata_t* nbat, int nth)
 {
+    nbat->reducedForceBuffer.resize(nbat->buffer_flags.size());
+
 #pragma omp parallel for num_threads(nth) schedule(static)
     for (int th = 0; th < nth; th++)
     {
@@ -1393,27 +1425,37 @@ static void nbnxn_atomdata_add_nbat_f_to_f_stdreduce(nbnxn_atomdata_t* nbat, int
                 int i0 = b * NBNXN_BUFFERFLAG_SIZE * nbat->fstride;
                 int i1 = (b + 1) * NBNXN_BUFFERFLAG_SIZE * nbat->fstride;
 
-                nfptr = 0;
-                for (gmx::index out = 1; out < gmx::ssize(nbat->out); out++)
+                int dest = -1;
+                nfptr    = 0;
+                for (gmx::index out = 0; out < gmx::ssize(nbat->out); out++)
                 {
                     if (bitmask_is_set(flags[b], out))
                     {
-                        fptr[nfptr++] = nbat->out[out].f.data();
+                        if (dest < 0)
+                        {
+                            dest = out;
+                        }
+                        else
+                        {
+                            fptr[nfptr++] = nbat->out[out].f.data();
+                        }
                     }
                 }
-                if (nfptr > 0)
+                if (dest < 0)
+                {
+                    dest = 0;
+                    nbnxn_atomdata_clear_reals(nbat->out[dest].f, i0, i1);
+                }
+                else if (nfptr > 0)
                 {
 #if GMX_SIMD
                     nbnxn_atomdata_reduce_reals_simd
 #else
                     nbnxn_atomdata_reduce_reals
 #endif
-                            (nbat->out[0].f.data(), bitmask_is_set(flags[b], 0), fptr, nfptr, i0, i1);
-                }
-                else if (!bitmask_is_set(flags[b], 0))
-                {
-                    nbnxn_atomdata_clear_reals(nbat->out[0].f, i0, i1);
+                            (nbat->out[dest].f.data(), TRUE, fptr, nfptr, i0, i1);
                 }
+                nbat->reducedForceBuffer[b] = nbat->out[dest].f.data();
             }
         }
         GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
@@ -1444,8 +1486,10 @@ void reduceForces(nbnxn_atomdata_t* nbat, const gmx::AtomLocality locality, cons
             gmx_incons("add_f_to_f called with nout>1 and locality!=eatAll");
         }
 
-        /* Reduce the force thread output buffers into buffer 0, before adding
+        /* Reduce the force thread output buffers, before adding
          * them to the, differently ordered, "real" force buffer.
+         * The tree reduction reduces into buffer 0, the standard reduction
+         * leaves the result for each block in one of the buffers.
          */
         if (nbat->bUseTreeReduce)
         {
@@ -1456,13 +1500,23 @@ void reduceForces(nbnxn_atomdata_t* nbat, const gmx::AtomLocality locality, cons
             nbnxn_atomdata_add_nbat_f_to_f_stdreduce(nbat, nth);
         }
     }
+    const bool useBlockBuffers = (nbat->out.size() > 1 && !nbat->bUseTreeReduce);
+
 #pragma omp parallel for num_threads(nth) schedule(static)
     for (int th = 0; th < nth; th++)
     {
         try
         {
-            nbnxn_atomdata_add_nbat_f_to_f_part(gridSet, *nbat, nbat->out[0], a0 + ((th + 0) * na) / nth,
-                                                a0 + ((th + 1) * na) / nth, f);
+            const int atomStart = a0 + ((th + 0) * na) / nth;
+            const int atomEnd   = a0 + ((th + 1) * na) / nth;
+            if (useBlockBuffers)
+            {
+                nbnxn_atomdata_add_nbat_f_to_f_part<true>(gridSet, *nbat, atomStart, atomEnd, f);
+            }
+            else
+            {
+                nbnxn_atomdata_add_nbat_f_to_f_part<false>(gridSet, *nbat, atomStart, atomEnd, f);
+            }
         }
         GMX_CATCH_ALL_AND_EXIT_WITH_FATAL_ERROR
     }
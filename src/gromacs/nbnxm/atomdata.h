@@ -294,6 +294,8 @@ public:
     gmx_bool bUseTreeReduce;
     //! Synchronization step for tree reduce
     tMPI_Atomic* syncStep;
+    //! The output buffer holding the reduced forces, per flag block, set by the standard reduction
+    std::vector<const real*> reducedForceBuffer;
     //! \}
 };
 
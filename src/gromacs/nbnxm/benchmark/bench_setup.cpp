@@ -166,6 +166,38 @@ static interaction_const_t setupInteractionConst(const KernelBenchOptions& optio
     return ic;
 }
 
+//! Returns the atom info for the given benchmark options and system
+static gmx::ArrayRef<const int> getAtomInfo(const KernelBenchOptions&   options,
+                                            const gmx::BenchmarkSystem& system)
+{
+    if (options.useHalfLJOptimization)
+    {
+        return system.atomInfoOxygenVdw;
+    }
+    else
+    {
+        return system.atomInfoAllVdw;
+    }
+}
+
+//! Puts the atoms of \p system on the grid and constructs the local pairlist
+static void putOnGridAndConstructPairlist(nonbonded_verlet_t*         nbv,
+                                          const gmx::BenchmarkSystem& system,
+                                          gmx::ArrayRef<const int>    atomInfo,
+                                          t_nrnb*                     nrnb)
+{
+    const rvec lowerCorner = { 0, 0, 0 };
+    const rvec upperCorner = { system.box[XX][XX], system.box[YY][YY], system.box[ZZ][ZZ] };
+
+    const real atomDensity = system.coordinates.size() / det(system.box);
+
+    nbnxn_put_on_grid(nbv, system.box, 0, lowerCorner, upperCorner, nullptr,
+                      { 0, int(system.coordinates.size()) }, atomDensity, atomInfo,
+                      system.coordinates, 0, nullptr);
+
+    nbv->constructPairlist(gmx::InteractionLocality::Local, system.excls, 0, nrnb);
+}
+
 //! Sets up and returns a Nbnxm object for the given benchmark options and system
 static std::unique_ptr<nonbonded_verlet_t> setupNbnxmForBenchInstance(const KernelBenchOptions& options,
                                                                       const gmx::BenchmarkSystem& system)
@@ -206,26 +238,10 @@ static std::unique_ptr<nonbonded_verlet_t> setupNbnxmForBenchInstance(const Kern
     t_nrnb nrnb;
 
     GMX_RELEASE_ASSERT(!TRICLINIC(system.box), "Only rectangular unit-cells are supported here");
-    const rvec lowerCorner = { 0, 0, 0 };
-    const rvec upperCorner = { system.box[XX][XX], system.box[YY][YY], system.box[ZZ][ZZ] };
-
-    gmx::ArrayRef<const int> atomInfo;
-    if (options.useHalfLJOptimization)
-    {
-        atomInfo = system.atomInfoOxygenVdw;
-    }
-    else
-    {
-        atomInfo = system.atomInfoAllVdw;
-    }
-
-    const real atomDensity = system.coordinates.size() / det(system.box);
 
-    nbnxn_put_on_grid(nbv.get(), system.box, 0, lowerCorner, upperCorner, nullptr,
-                      { 0, int(system.coordinates.size()) }, atomDensity, atomInfo,
-                      system.coordinates, 0, nullptr);
+    gmx::ArrayRef<const int> atomInfo = getAtomInfo(options, system);
 
-    nbv->constructPairlist(gmx::InteractionLocality::Local, system.excls, 0, &nrnb);
+    putOnGridAndConstructPairlist(nbv.get(), system, atomInfo, &nrnb);
 
     nbv->setAtomProperties(system.atomTypes, system.charges, atomInfo);
 
@@ -261,6 +277,55 @@ static void expandSimdOptionAndPushBack(const KernelBenchOptions&        options
     }
 }
 
+/*! \brief Runs the pair search for the requested benchmark instance and prints the results
+ *
+ * Each iteration puts all atoms on the grid and constructs the local pairlist.
+ * When \p doWarmup is true runs the warmup iterations instead
+ * of the normal ones and does not print any results.
+ */
+static void runPairSearchInstance(const gmx::BenchmarkSystem& system,
+                                  const KernelBenchOptions&   options,
+                                  const bool                  doWarmup)
+{
+    std::unique_ptr<nonbonded_verlet_t> nbv = setupNbnxmForBenchInstance(options, system);
+
+    gmx::ArrayRef<const int> atomInfo = getAtomInfo(options, system);
+
+    t_nrnb nrnb = { 0 };
+
+    const gmx::EnumerationArray<BenchMarkKernels, std::string> kernelNames = { "auto", "no", "4xM",
+                                                                               "2xMM" };
+
+    if (!doWarmup)
+    {
+        fprintf(stdout, "%-4s %-4s ", options.useHalfLJOptimization ? "half" : "all",
+                kernelNames[options.nbnxmSimd].c_str());
+    }
+
+    const int    numIterations = (doWarmup ? options.numWarmupIterations : options.numIterations);
+    gmx_cycles_t cycles        = gmx_cycles_read();
+    for (int iter = 0; iter < numIterations; iter++)
+    {
+        putOnGridAndConstructPairlist(nbv.get(), system, atomInfo, &nrnb);
+    }
+    cycles = gmx_cycles_read() - cycles;
+
+    if (!doWarmup)
+    {
+        const PairlistSet& pairlistSet =
+                nbv->pairlistSets().pairlistSet(gmx::InteractionLocality::Local);
+        gmx::index numClusterPairs = 0;
+        for (const auto& pairlist : pairlistSet.cpuLists())
+        {
+            numClusterPairs += pairlist.cj.size();
+        }
+        const double dCycles = static_cast<double>(cycles);
+        fprintf(stdout, "%10.3f %10.4f %10zd %8.2f\n", dCycles * 1e-6,
+                dCycles / options.numIterations * 1e-6, numClusterPairs,
+                options.numIterations * numClusterPairs / dCycles * 1e3);
+    }
+}
+
 //! Sets up and runs the requested benchmark instance and prints the results
 //
 // When \p doWarmup is true runs the warmup iterations instead
@@ -361,7 +426,18 @@ void bench(const int sizeFactor, const KernelBenchOptions& options)
     }
 
     std::vector<KernelBenchOptions> optionsList;
-    if (options.doAll)
+    if (options.doAll && options.benchmarkPairSearch)
+    {
+        // The pair search only depends on the SIMD layout and the LJ atom info
+        KernelBenchOptions opt = options;
+        for (int halfLJ = 0; halfLJ <= 1; halfLJ++)
+        {
+            opt.useHalfLJOptimization = (halfLJ == 1);
+
+            expandSimdOptionAndPushBack(opt, &optionsList);
+        }
+    }
+    else if (options.doAll)
     {
         KernelBenchOptions                        opt = options;
         gmx::EnumerationWrapper<BenchMarkCoulomb> coulombIter;
@@ -398,8 +474,16 @@ void bench(const int sizeFactor, const KernelBenchOptions& options)
     fprintf(stdout, "Cut-off radius:       %g nm\n", options.pairlistCutoff);
     fprintf(stdout, "Number of threads:    %d\n", options.numThreads);
     fprintf(stdout, "Number of iterations: %d\n", options.numIterations);
-    fprintf(stdout, "Compute energies:     %s\n", options.computeVirialAndEnergy ? "yes" : "no");
-    if (options.coulombType != BenchMarkCoulomb::ReactionField)
+    if (options.benchmarkPairSearch)
+    {
+        fprintf(stdout, "Benchmarking:         pair search\n");
+    }
+    else
+    {
+        fprintf(stdout, "Compute energies:     %s\n",
+                options.computeVirialAndEnergy ? "yes" : "no");
+    }
+    if (!options.benchmarkPairSearch && options.coulombType != BenchMarkCoulomb::ReactionField)
     {
         fprintf(stdout, "Ewald excl. corr.:    %s\n",
                 options.nbnxmSimd == BenchMarkKernels::SimdNo || options.useTabulatedEwaldCorr
@@ -408,6 +492,24 @@ void bench(const int sizeFactor, const KernelBenchOptions& options)
     }
     printf("\n");
 
+    if (options.benchmarkPairSearch)
+    {
+        if (options.numWarmupIterations > 0)
+        {
+            runPairSearchInstance(system, optionsList[0], true);
+        }
+
+        fprintf(stdout, "LJ   SIMD    Mcycles  Mcycles/it.  cluster   pairs/\n");
+        fprintf(stdout, "                                   pairs    kcycle\n");
+
+        for (const auto& optionsInstance : optionsList)
+        {
+            runPairSearchInstance(system, optionsInstance, false);
+        }
+
+        return;
+    }
+
     if (options.numWarmupIterations > 0)
     {
         setupAndRunInstance(system, optionsList[0], true);
@@ -113,6 +113,8 @@ struct KernelBenchOptions
     int numWarmupIterations = 0;
     //! Print cycles/pair instead of pairs/cycle
     bool cyclesPerPair = false;
+    //! Benchmark the pair search, i.e. gridding and pairlist construction, instead of the kernels
+    bool benchmarkPairSearch = false;
 };
 
 /*! \brief
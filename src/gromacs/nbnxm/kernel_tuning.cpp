@@ -0,0 +1,660 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ *
+ * \brief Implements the run-time tuning of the CPU non-bonded kernel setup
+ *
+ * \ingroup module_nbnxm
+ */
+
+#include "gmxpre.h"
+
+#include "kernel_tuning.h"
+
+#include <cstdlib>
+
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gromacs/gmxlib/network.h"
+#include "gromacs/math/vec.h"
+#include "gromacs/mdlib/calc_verletbuf.h"
+#include "gromacs/mdlib/gmx_omp_nthreads.h"
+#include "gromacs/mdtypes/commrec.h"
+#include "gromacs/mdtypes/forcerec.h"
+#include "gromacs/mdtypes/inputrec.h"
+#include "gromacs/mdtypes/interaction_const.h"
+#include "gromacs/nbnxm/nbnxm.h"
+#include "gromacs/timing/wallcycle.h"
+#include "gromacs/utility/basedefinitions.h"
+#include "gromacs/utility/logger.h"
+#include "gromacs/utility/strconvert.h"
+#include "gromacs/utility/stringutil.h"
+
+#include "nbnxm_geometry.h"
+#include "nbnxm_simd.h"
+#include "pairlistsets.h"
+
+namespace Nbnxm
+{
+
+//! The number of nstlist intervals to skip after switching setup, this covers (re)allocation
+static constexpr int c_numIntervalsSkipAfterSwitch = 1;
+
+//! The number of nstlist intervals to time for each setup, the fastest one is used
+static constexpr int c_numTimedIntervalsPerSetup = 2;
+
+/*! \brief The dynamic pruning intervals to consider
+ *
+ * Only values smaller than the list lifetime are used. The default
+ * chosen by setupDynamicPairlistPruning() is added when not present.
+ */
+static constexpr int c_nstlistPruneCandidates[] = { 2,  3,  4,  5,  6,  8,  10, 12,
+                                                    15, 20, 25, 30, 40, 50, 60, 80 };
+
+//! Value for nstlistPrune that indicates no dynamic pruning
+static constexpr int c_noDynamicPruning = -1;
+
+//! Value for nstlistPrune that indicates that the pruning setup chosen at initialization is used
+static constexpr int c_pruningFromInit = 0;
+
+namespace
+{
+
+//! The tuning stages, each stage tunes one parameter
+enum class Stage
+{
+    KernelLayout,
+    EwaldExclusion,
+    DynamicPruning,
+    Done
+};
+
+//! A non-bonded setup with its timing
+struct TimedSetup
+{
+    //! The kernel layout and Ewald exclusion handling
+    KernelSetup kernelSetup;
+    //! The dynamic pruning interval, can be c_noDynamicPruning or c_pruningFromInit
+    int nstlistPrune;
+    //! The inner pair-list radius
+    real rlistInner;
+    //! The number of intervals timed
+    int numTimedIntervals = 0;
+    //! The lowest number of cycles per step over the timed intervals
+    double cyclesPerStep = 0;
+};
+
+//! Returns a short description of the SIMD kernel layout
+std::string kernelLayoutName(const KernelType kernelType)
+{
+    const int jClusterSize = JClusterSizePerKernelType[kernelType];
+
+    switch (kernelType)
+    {
+        case KernelType::Cpu4xN_Simd_4xN:
+            return gmx::formatString("SIMD %dx%d", IClusterSizePerKernelType[kernelType],
+                                     jClusterSize);
+        case KernelType::Cpu4xN_Simd_2xNN:
+            return gmx::formatString("SIMD 2x(%d+%d)", jClusterSize, jClusterSize);
+        default: return lookup_kernel_name(kernelType);
+    }
+}
+
+//! Returns the Ewald exclusion correction name, or "-" when there is no choice
+const char* ewaldExclusionName(const EwaldExclusionType ewaldExclusionType, const bool haveChoice)
+{
+    if (!haveChoice)
+    {
+        return "-";
+    }
+    return (ewaldExclusionType == EwaldExclusionType::Analytical ? "analytical" : "tabulated");
+}
+
+//! Returns whether the kernel type is one of the SIMD kernel layouts
+bool isSimdKernelType(const KernelType kernelType)
+{
+    return (kernelType == KernelType::Cpu4xN_Simd_4xN
+            || kernelType == KernelType::Cpu4xN_Simd_2xNN);
+}
+
+} // namespace
+
+/*! \internal
+ * \brief Private implementation class for KernelTuning
+ */
+class KernelTuning::Impl
+{
+public:
+    //! Constructor
+    Impl(const gmx::MDLogger& mdlog,
+         const t_commrec*     cr,
+         const t_inputrec&    ir,
+         const t_forcerec&    fr,
+         const gmx_mtop_t&    mtop,
+         bool                 pmeTuningIsActive);
+
+    //! Returns a description of the setup
+    std::string setupDescription(const TimedSetup& setup) const;
+
+    //! Returns the next setup to time, or nothing when all stages are done
+    std::optional<TimedSetup> nextSetup(const t_inputrec&         ir,
+                                        const nonbonded_verlet_t& nbv,
+                                        const matrix              box);
+
+    //! Returns the next index in pruneCandidates_ to time, or -1 when done
+    int nextPruneCandidateIndex();
+
+    //! Switches the non-bonded setup in \p fr to \p setup
+    void applySetup(TimedSetup*       setup,
+                    const t_commrec*  cr,
+                    const t_inputrec& ir,
+                    t_forcerec*       fr,
+                    const gmx_mtop_t& mtop,
+                    matrix            box,
+                    gmx_wallcycle*    wcycle) const;
+
+    //! Logs all timings and the selected setup
+    void logResults(const gmx::MDLogger& mdlog) const;
+
+    //! Whether we have Ewald electrostatics
+    bool haveEwald_;
+    //! Whether we tune the kernel layout
+    bool tuneKernelLayout_ = false;
+    //! Whether we tune the Ewald exclusion handling
+    bool tuneEwaldExclusion_ = false;
+    //! Whether we tune the dynamic pruning interval
+    bool tuneDynamicPruning_ = false;
+    //! For computing the inner list buffer for each pruning interval
+    std::optional<VerletBufferEstimator> verletBufferEstimator_;
+    //! The current stage
+    Stage stage_ = Stage::Done;
+    //! Whether the candidate of the current stage has been tried, for the first two stages
+    bool stageCandidateTried_ = false;
+    //! All timed setups, in order of timing
+    std::vector<TimedSetup> setups_;
+    //! The index of the setup currently in use
+    int current_ = 0;
+    //! The index of the fastest setup
+    int best_ = 0;
+    //! The number of intervals done with the current setup
+    int numIntervalsWithCurrent_ = 0;
+    //! The wallcycle step count at the previous call
+    int prevStepCount_ = 0;
+    //! The wallcycle step cycles at the previous call
+    double prevStepCycles_ = 0;
+    //! The dynamic pruning intervals to walk through
+    std::vector<int> pruneCandidates_;
+    //! The index of the starting point of the walk through pruneCandidates_
+    int pruneStartIndex_ = -1;
+    //! The index of the last pruning interval tried, -1 when not started
+    int pruneIndex_ = -1;
+    //! The direction of the walk through pruneCandidates_
+    int pruneDirection_ = 1;
+};
+
+KernelTuning::Impl::Impl(const gmx::MDLogger& mdlog,
+                         const t_commrec*     cr,
+                         const t_inputrec&    ir,
+                         const t_forcerec&    fr,
+                         const gmx_mtop_t&    mtop,
+                         const bool           pmeTuningIsActive) :
+    haveEwald_(EEL_PME_EWALD(fr.ic->eeltype))
+{
+    const nonbonded_verlet_t& nbv    = *fr.nbv;
+    const PairlistParams&     params = nbv.pairlistSets().params();
+
+    const char* reasonNotTuning = nullptr;
+    if (!wallcycle_have_counter())
+    {
+        reasonNotTuning = "there is no cycle counter";
+    }
+    else if (pmeTuningIsActive)
+    {
+        reasonNotTuning = "PP-PME load balancing changes the cut-off, use -notunepme";
+    }
+    else if (!nbv.pairlistIsSimple() || !fr.bNonbonded)
+    {
+        reasonNotTuning = "the non-bonded interactions are not computed on the CPU";
+    }
+
+    if (reasonNotTuning == nullptr)
+    {
+        const bool haveSimdKernels = isSimdKernelType(nbv.kernelSetup().kernelType);
+
+#if defined GMX_NBNXN_SIMD_4XN && defined GMX_NBNXN_SIMD_2XNN
+        /* With DD the state is sorted using the grid order of the search
+         * object, so we can not replace the search object.
+         */
+        tuneKernelLayout_ = (haveSimdKernels && !DOMAINDECOMP(cr)
+                             && getenv("GMX_NBNXN_SIMD_4XN") == nullptr
+                             && getenv("GMX_NBNXN_SIMD_2XNN") == nullptr);
+#else
+        GMX_UNUSED_VALUE(cr);
+#endif
+        tuneEwaldExclusion_ = (haveSimdKernels && haveEwald_
+                               && getenv("GMX_NBNXN_EWALD_TABLE") == nullptr
+                               && getenv("GMX_NBNXN_EWALD_ANALYTICAL") == nullptr);
+        tuneDynamicPruning_ =
+                (params.useDynamicPruning && getenv("GMX_NSTLIST_DYNAMICPRUNING") == nullptr);
+
+        if (!(tuneKernelLayout_ || tuneEwaldExclusion_ || tuneDynamicPruning_))
+        {
+            reasonNotTuning = "there are no kernel setup choices for this system";
+        }
+    }
+
+    if (reasonNotTuning != nullptr)
+    {
+        GMX_LOG(mdlog.warning)
+                .asParagraph()
+                .appendTextFormatted("NOTE: Not tuning the non-bonded kernel setup, since %s",
+                                     reasonNotTuning);
+        return;
+    }
+
+    if (tuneDynamicPruning_)
+    {
+        verletBufferEstimator_.emplace(mtop, ir, gmx_omp_nthreads_get(emntDefault));
+    }
+
+    setups_.push_back({ nbv.kernelSetup(),
+                        params.useDynamicPruning ? params.nstlistPrune : c_noDynamicPruning,
+                        params.rlistInner });
+    stage_ = Stage::KernelLayout;
+
+    std::string tuned;
+    if (tuneKernelLayout_)
+    {
+        tuned += "\n  the SIMD kernel layout";
+    }
+    if (tuneEwaldExclusion_)
+    {
+        tuned += "\n  the Ewald exclusion correction";
+    }
+    if (tuneDynamicPruning_)
+    {
+        tuned += "\n  the dynamic pair-list pruning interval";
+    }
+    GMX_LOG(mdlog.info)
+            .asParagraph()
+            .appendTextFormatted(
+                    "Will tune the non-bonded kernel setup during the first part of the run:%s",
+                    tuned.c_str());
+}
+
+std::string KernelTuning::Impl::setupDescription(const TimedSetup& setup) const
+{
+    std::string description =
+            gmx::formatString("%s kernels", kernelLayoutName(setup.kernelSetup.kernelType).c_str());
+    if (haveEwald_ && isSimdKernelType(setup.kernelSetup.kernelType))
+    {
+        description += gmx::formatString(
+                ", %s Ewald correction",
+                ewaldExclusionName(setup.kernelSetup.ewaldExclusionType, true));
+    }
+    if (setup.nstlistPrune > 0)
+    {
+        description += gmx::formatString(", pruning every %d steps with rlist %.3f nm",
+                                         setup.nstlistPrune, setup.rlistInner);
+    }
+    else
+    {
+        description += ", no dynamic pruning";
+    }
+
+    return description;
+}
+
+int KernelTuning::Impl::nextPruneCandidateIndex()
+{
+    const bool lastWasFaster = (current_ == best_);
+
+    /* Walk upwards from the starting point while the timings improve.
+     * When the first step upwards is slower, walk downwards instead.
+     */
+    if (pruneIndex_ < 0)
+    {
+        pruneDirection_ = 1;
+        pruneIndex_     = pruneStartIndex_ + 1;
+        if (pruneIndex_ >= gmx::ssize(pruneCandidates_))
+        {
+            pruneDirection_ = -1;
+            pruneIndex_     = pruneStartIndex_ - 1;
+        }
+    }
+    else if (lastWasFaster)
+    {
+        pruneIndex_ += pruneDirection_;
+    }
+    else if (pruneDirection_ == 1 && pruneIndex_ == pruneStartIndex_ + 1)
+    {
+        pruneDirection_ = -1;
+        pruneIndex_     = pruneStartIndex_ - 1;
+    }
+    else
+    {
+        return -1;
+    }
+
+    if (pruneIndex_ < 0 || pruneIndex_ >= gmx::ssize(pruneCandidates_))
+    {
+        return -1;
+    }
+
+    return pruneIndex_;
+}
+
+std::optional<TimedSetup> KernelTuning::Impl::nextSetup(const t_inputrec&         ir,
+                                                        const nonbonded_verlet_t& nbv,
+                                                        const matrix              box)
+{
+    const TimedSetup& best = setups_[best_];
+
+    while (stage_ != Stage::Done)
+    {
+        switch (stage_)
+        {
+            case Stage::KernelLayout:
+                if (tuneKernelLayout_ && !stageCandidateTried_)
+                {
+                    stageCandidateTried_ = true;
+
+                    /* Time the other layout with the pruning setup that
+                     * would be chosen for that layout at initialization.
+                     */
+                    TimedSetup setup = { best.kernelSetup, c_pruningFromInit, 0 };
+                    setup.kernelSetup.kernelType =
+                            (best.kernelSetup.kernelType == KernelType::Cpu4xN_Simd_4xN)
+                                    ? KernelType::Cpu4xN_Simd_2xNN
+                                    : KernelType::Cpu4xN_Simd_4xN;
+                    return setup;
+                }
+                stage_               = Stage::EwaldExclusion;
+                stageCandidateTried_ = false;
+                break;
+            case Stage::EwaldExclusion:
+                if (tuneEwaldExclusion_ && !stageCandidateTried_)
+                {
+                    stageCandidateTried_ = true;
+
+                    TimedSetup setup = { best.kernelSetup, best.nstlistPrune, best.rlistInner };
+                    setup.kernelSetup.ewaldExclusionType =
+                            (best.kernelSetup.ewaldExclusionType == EwaldExclusionType::Analytical)
+                                    ? EwaldExclusionType::Table
+                                    : EwaldExclusionType::Analytical;
+                    return setup;
+                }
+                stage_ = Stage::DynamicPruning;
+                if (tuneDynamicPruning_ && best.nstlistPrune > 0)
+                {
+                    const int listLifetime = ir.nstlist - 1;
+                    for (int nstlistPrune : c_nstlistPruneCandidates)
+                    {
+                        if (nstlistPrune < listLifetime)
+                        {
+                            pruneCandidates_.push_back(nstlistPrune);
+                        }
+                    }
+                    if (std::find(pruneCandidates_.begin(), pruneCandidates_.end(),
+                                  best.nstlistPrune)
+                        == pruneCandidates_.end())
+                    {
+                        pruneCandidates_.insert(std::upper_bound(pruneCandidates_.begin(),
+                                                                 pruneCandidates_.end(),
+                                                                 best.nstlistPrune),
+                                                best.nstlistPrune);
+                    }
+                    pruneStartIndex_ = std::find(pruneCandidates_.begin(), pruneCandidates_.end(),
+                                                 best.nstlistPrune)
+                                       - pruneCandidates_.begin();
+                    // Not pruning at all is the limit of long pruning intervals
+                    pruneCandidates_.push_back(c_noDynamicPruning);
+                }
+                break;
+            case Stage::DynamicPruning:
+                if (!pruneCandidates_.empty())
+                {
+                    const int index = nextPruneCandidateIndex();
+                    if (index >= 0)
+                    {
+                        const int  nstlistPrune = pruneCandidates_[index];
+                        const real rlistOuter   = nbv.pairlistOuterRadius();
+                        real       rlistInner   = rlistOuter;
+                        if (nstlistPrune > 0)
+                        {
+                            /* The CPU list is pruned after the update, so the
+                             * lifetime of the pruned list is nstlistPrune-1.
+                             */
+                            const VerletbufCandidate candidate = {
+                                nstlistPrune, nstlistPrune - 1, -1,
+                                verletbufGetListSetup(best.kernelSetup.kernelType)
+                            };
+                            rlistInner = std::min(rlistOuter,
+                                                  verletBufferEstimator_->calcBufferSize(
+                                                          det(box), ir, candidate));
+                        }
+                        return TimedSetup{ best.kernelSetup, nstlistPrune, rlistInner };
+                    }
+                }
+                stage_ = Stage::Done;
+                break;
+            case Stage::Done: break;
+        }
+    }
+
+    return std::nullopt;
+}
+
+void KernelTuning::Impl::applySetup(TimedSetup*       setup,
+                                    const t_commrec*  cr,
+                                    const t_inputrec& ir,
+                                    t_forcerec*       fr,
+                                    const gmx_mtop_t& mtop,
+                                    matrix            box,
+                                    gmx_wallcycle*    wcycle) const
+{
+    if (setup->kernelSetup.kernelType != fr->nbv->kernelSetup().kernelType)
+    {
+        /* A different layout needs a different search grid, atom data and
+         * pair-list layout. The atoms are put on the new grid at this search
+         * step. We do not log the setup again.
+         */
+        fr->nbv = init_nb_verlet(gmx::MDLogger(), setup->kernelSetup, &ir, fr, cr, &mtop, box,
+                                 wcycle);
+    }
+    else
+    {
+        fr->nbv->changeEwaldExclusionType(setup->kernelSetup.ewaldExclusionType);
+    }
+
+    if (setup->nstlistPrune == c_pruningFromInit)
+    {
+        const PairlistParams& params = fr->nbv->pairlistSets().params();
+
+        setup->nstlistPrune = params.useDynamicPruning ? params.nstlistPrune : c_noDynamicPruning;
+        setup->rlistInner   = params.rlistInner;
+    }
+    else
+    {
+        fr->nbv->changeDynamicPruning(setup->nstlistPrune, setup->rlistInner);
+    }
+}
+
+void KernelTuning::Impl::logResults(const gmx::MDLogger& mdlog) const
+{
+    std::string mesg = "Non-bonded kernel tuning, M-cycles per step of the fastest interval:\n";
+    mesg += "   kernel          Ewald corr.  prune  rlistInner  M-cycles\n";
+    for (const TimedSetup& setup : setups_)
+    {
+        mesg += gmx::formatString(
+                "   %-14s  %-11s  %5s  %6.3f nm  %9.3f%s\n",
+                kernelLayoutName(setup.kernelSetup.kernelType).c_str(),
+                ewaldExclusionName(setup.kernelSetup.ewaldExclusionType,
+                                   haveEwald_ && isSimdKernelType(setup.kernelSetup.kernelType)),
+                setup.nstlistPrune > 0 ? gmx::toString(setup.nstlistPrune).c_str() : "-",
+                setup.rlistInner, setup.cyclesPerStep * 1e-6,
+                &setup == &setups_[best_] ? "  *" : "");
+    }
+    mesg += gmx::formatString("Using %s", setupDescription(setups_[best_]).c_str());
+
+    GMX_LOG(mdlog.info).asParagraph().appendText(mesg);
+}
+
+KernelTuning::KernelTuning(const gmx::MDLogger& mdlog,
+                           const t_commrec*     cr,
+                           const t_inputrec&    ir,
+                           const t_forcerec&    fr,
+                           const gmx_mtop_t&    mtop,
+                           const bool           pmeTuningIsActive) :
+    impl_(new Impl(mdlog, cr, ir, fr, mtop, pmeTuningIsActive))
+{
+}
+
+KernelTuning::~KernelTuning() = default;
+
+bool KernelTuning::isActive() const
+{
+    return impl_->stage_ != Stage::Done;
+}
+
+void KernelTuning::tune(const t_commrec*     cr,
+                        FILE*                fp_err,
+                        FILE*                fp_log,
+                        const gmx::MDLogger& mdlog,
+                        const t_inputrec&    ir,
+                        t_forcerec*          fr,
+                        const gmx_mtop_t&    mtop,
+                        matrix               box,
+                        gmx_wallcycle*       wcycle,
+                        const int64_t        step,
+                        const int64_t        step_rel)
+{
+    Impl& impl = *impl_;
+
+    if (impl.stage_ == Stage::Done)
+    {
+        return;
+    }
+
+    int    stepCount;
+    double stepCycles;
+    wallcycle_get(wcycle, ewcSTEP, &stepCount, &stepCycles);
+    const int numSteps   = stepCount - impl.prevStepCount_;
+    double    numCycles  = stepCycles - impl.prevStepCycles_;
+    impl.prevStepCount_  = stepCount;
+    impl.prevStepCycles_ = stepCycles;
+
+    /* Before the first step we have no timing. The counters can also
+     * have been reset, then we can not use this interval.
+     */
+    if (step_rel == 0 || numSteps <= 0)
+    {
+        return;
+    }
+
+    impl.numIntervalsWithCurrent_++;
+    if (impl.numIntervalsWithCurrent_ <= c_numIntervalsSkipAfterSwitch)
+    {
+        return;
+    }
+
+    if (havePPDomainDecomposition(cr))
+    {
+        /* Sum over the PP ranks, so all ranks take the same decisions */
+        gmx_sumd(1, &numCycles, cr);
+    }
+
+    TimedSetup&  current       = impl.setups_[impl.current_];
+    const double cyclesPerStep = numCycles / numSteps;
+    if (current.numTimedIntervals == 0 || cyclesPerStep < current.cyclesPerStep)
+    {
+        current.cyclesPerStep = cyclesPerStep;
+    }
+    current.numTimedIntervals++;
+    if (current.numTimedIntervals < c_numTimedIntervalsPerSetup)
+    {
+        return;
+    }
+
+    for (FILE* fp : { fp_err, fp_log })
+    {
+        if (fp != nullptr)
+        {
+            fprintf(fp, "step %4s: timed with %s: %.3f M-cycles per step\n",
+                    gmx::int64ToString(step).c_str(), impl.setupDescription(current).c_str(),
+                    current.cyclesPerStep * 1e-6);
+        }
+    }
+
+    if (current.cyclesPerStep < impl.setups_[impl.best_].cyclesPerStep)
+    {
+        impl.best_ = impl.current_;
+    }
+
+    std::optional<TimedSetup> next = impl.nextSetup(ir, *fr->nbv, box);
+    if (next)
+    {
+        impl.applySetup(&next.value(), cr, ir, fr, mtop, box, wcycle);
+        impl.setups_.push_back(next.value());
+        impl.current_ = static_cast<int>(impl.setups_.size()) - 1;
+    }
+    else
+    {
+        if (impl.current_ != impl.best_)
+        {
+            impl.applySetup(&impl.setups_[impl.best_], cr, ir, fr, mtop, box, wcycle);
+            impl.current_ = impl.best_;
+        }
+        impl.logResults(mdlog);
+    }
+    impl.numIntervalsWithCurrent_ = 0;
+}
+
+void KernelTuning::done(const gmx::MDLogger& mdlog) const
+{
+    if (isActive())
+    {
+        GMX_LOG(mdlog.warning)
+                .asParagraph()
+                .appendText(
+                        "NOTE: The run ended before the non-bonded kernel tuning finished, "
+                        "the non-bonded setup of the run might not be optimal");
+    }
+}
+
+} // namespace Nbnxm
@@ -0,0 +1,152 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \libinternal \file
+ *
+ * \brief Declares the run-time tuning of the CPU non-bonded kernel setup
+ *
+ * The static heuristics in init_nb_verlet() and setupDynamicPairlistPruning()
+ * choose the SIMD kernel layout, the Ewald exclusion correction and
+ * the dynamic pruning interval without knowledge of the actual system
+ * and hardware performance. With this tuning the available choices are
+ * timed during the first part of a run and the fastest setup is kept.
+ *
+ * \inlibraryapi
+ * \ingroup module_nbnxm
+ */
+
+#ifndef GMX_NBNXM_KERNEL_TUNING_H
+#define GMX_NBNXM_KERNEL_TUNING_H
+
+#include <cstdint>
+#include <cstdio>
+
+#include "gromacs/math/vectypes.h"
+#include "gromacs/utility/classhelpers.h"
+
+struct gmx_mtop_t;
+struct gmx_wallcycle;
+struct t_commrec;
+struct t_forcerec;
+struct t_inputrec;
+
+namespace gmx
+{
+class MDLogger;
+} // namespace gmx
+
+namespace Nbnxm
+{
+
+/*! \libinternal
+ * \brief Tunes the CPU non-bonded kernel setup by timing the MD steps
+ *
+ * The setups are tuned one parameter at a time: first the SIMD kernel
+ * layout (4xM or 2xMM), then the Ewald exclusion correction (analytical
+ * or tabulated) and finally the dynamic pruning interval, for which
+ * the inner list buffer is recomputed for each candidate value.
+ * Each setup is timed over a few pair-list lifetimes. Parameters fixed
+ * by the user through environment variables are not tuned.
+ *
+ * All choices are changed at search steps only and PP ranks take
+ * identical decisions, since the timings are summed over PP ranks.
+ * The kernel layout is only tuned without domain decomposition,
+ * as the state is sorted using the grid order of the search object.
+ */
+class KernelTuning
+{
+public:
+    /*! \brief Constructor, logs what will be tuned
+     *
+     * \param[in] mdlog              Logger
+     * \param[in] cr                 Communication record
+     * \param[in] ir                 The input parameter record
+     * \param[in] fr                 The force record with the initial non-bonded setup
+     * \param[in] mtop               The global topology
+     * \param[in] pmeTuningIsActive  Whether PP-PME load balancing is active, then we do not tune
+     */
+    KernelTuning(const gmx::MDLogger& mdlog,
+                 const t_commrec*     cr,
+                 const t_inputrec&    ir,
+                 const t_forcerec&    fr,
+                 const gmx_mtop_t&    mtop,
+                 bool                 pmeTuningIsActive);
+
+    ~KernelTuning();
+
+    //! Returns whether the tuning is still in progress
+    bool isActive() const;
+
+    /*! \brief Times the last interval and switches setup when needed
+     *
+     * Should be called at every search step before the domain
+     * decomposition and force calculation, at intervals of nstlist steps.
+     * Can replace fr->nbv when switching the kernel layout.
+     *
+     * \param[in]     cr        Communication record
+     * \param[in]     fp_err    Stream for verbose output of each timing, can be nullptr
+     * \param[in]     fp_log    Log file for each timing, can be nullptr
+     * \param[in]     mdlog     Logger for the tuning results
+     * \param[in]     ir        The input parameter record
+     * \param[in,out] fr        The force record
+     * \param[in]     mtop      The global topology
+     * \param[in]     box       The unit cell
+     * \param[in]     wcycle    The wallcycle counters, used for timing
+     * \param[in]     step      The MD step
+     * \param[in]     step_rel  The MD step relative to the start of the run
+     */
+    void tune(const t_commrec*     cr,
+              FILE*                fp_err,
+              FILE*                fp_log,
+              const gmx::MDLogger& mdlog,
+              const t_inputrec&    ir,
+              t_forcerec*          fr,
+              const gmx_mtop_t&    mtop,
+              matrix               box,
+              gmx_wallcycle*       wcycle,
+              int64_t              step,
+              int64_t              step_rel);
+
+    //! Logs a note when the run ended before the tuning finished
+    void done(const gmx::MDLogger& mdlog) const;
+
+private:
+    class Impl;
+
+    gmx::PrivateImplPointer<Impl> impl_;
+};
+
+} // namespace Nbnxm
+
+#endif
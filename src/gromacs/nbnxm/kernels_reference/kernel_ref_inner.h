@@ -48,7 +48,7 @@
 #endif
     int i;
 
-    cj = l_cj[cjind].cj;
+    cj = l_cj[cjind];
 
 #ifdef ENERGY_GROUPS
     egp_cj = nbatParams.energrp[cj];
@@ -101,7 +101,8 @@
             /* A multiply mask used to zero an interaction
              * when that interaction should be excluded
              * (e.g. because of bonding). */
-            real interact = static_cast<real>((l_cj[cjind].excl >> (i * UNROLLI + j)) & 1);
+            real interact =
+                    static_cast<real>((l_masks[cjind] >> (i * UNROLLI + j)) & 1);
 #    ifndef EXCL_FORCES
             skipmask = interact;
 #    else
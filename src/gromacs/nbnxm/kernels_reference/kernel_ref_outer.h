@@ -110,8 +110,9 @@ void
     real* Vc   = out->Vc.data();
 #endif
 
-    const nbnxn_cj_t* l_cj;
-    real              rcut2;
+    const int*             l_cj;
+    JClusterList::MaskView l_masks;
+    real                   rcut2;
 #ifdef VDW_CUTOFF_CHECK
     real rvdw2;
 #endif
@@ -228,7 +229,8 @@ void
     const real* shiftvec = shift_vec[0];
     const real* x        = nbat->x().data();
 
-    l_cj = nbl->cj.data();
+    l_cj    = nbl->cj.cjList().data();
+    l_masks = nbl->cj.maskView();
 
     for (const nbnxn_ci_t& ciEntry : nbl->ci)
     {
@@ -299,7 +301,7 @@ void
 #        endif
 #    endif
 
-            if (l_cj[ciEntry.cj_ind_start].cj == ci_sh)
+            if (l_cj[ciEntry.cj_ind_start] == ci_sh)
             {
                 for (i = 0; i < UNROLLI; i++)
                 {
@@ -326,7 +328,7 @@ void
 #endif /* CALC_ENERGIES */
 
         cjind = cjind0;
-        while (cjind < cjind1 && nbl->cj[cjind].excl != 0xffff)
+        while (cjind < cjind1 && l_masks[cjind] != 0xffff)
         {
 #define CHECK_EXCLS
             if (half_LJ)
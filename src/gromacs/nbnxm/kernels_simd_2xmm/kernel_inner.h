@@ -207,7 +207,7 @@
 #endif /* CALC_LJ */
 
     /* j-cluster index */
-    cj = l_cj[cjind].cj;
+    cj = l_cj[cjind];
 
     /* Atom indices (of the first atom in the cluster) */
     aj = cj * UNROLLJ;
@@ -219,8 +219,8 @@
     ajz = ajy + STRIDE;
 
 #ifdef CHECK_EXCLS
-    gmx_load_simd_2xnn_interactions(static_cast<int>(l_cj[cjind].excl), filter_S0, filter_S2,
-                                    &interact_S0, &interact_S2);
+    gmx_load_simd_2xnn_interactions(static_cast<int>(l_masks[cjind]), filter_S0,
+                                    filter_S2, &interact_S0, &interact_S2);
 #endif /* CHECK_EXCLS */
 
     /* load j atom coordinates */
@@ -51,11 +51,12 @@
 #    endif
 #endif
 
-    const nbnxn_cj_t* l_cj;
-    int               ci, ci_sh;
-    int               ish, ish3;
-    gmx_bool          do_LJ, half_LJ, do_coul;
-    int               cjind0, cjind1, cjind;
+    const int*             l_cj;
+    JClusterList::MaskView l_masks;
+    int                    ci, ci_sh;
+    int                    ish, ish3;
+    gmx_bool               do_LJ, half_LJ, do_coul;
+    int                    cjind0, cjind1, cjind;
 
 #ifdef ENERGY_GROUPS
     int   Vstride_i;
@@ -352,7 +353,8 @@
     Vstride_i = nbatParams.nenergrp * (1 << nbatParams.neg_2log) * egps_jstride;
 #endif
 
-    l_cj = nbl->cj.data();
+    l_cj    = nbl->cj.cjList().data();
+    l_masks = nbl->cj.maskView();
 
     ninner = 0;
     for (const nbnxn_ci_t& ciEntry : nbl->ci)
@@ -414,10 +416,10 @@
         gmx_bool do_self = do_coul;
 #    endif
 #    if UNROLLJ == 4
-        if (do_self && l_cj[ciEntry.cj_ind_start].cj == ci_sh)
+        if (do_self && l_cj[ciEntry.cj_ind_start] == ci_sh)
 #    endif
 #    if UNROLLJ == 8
-            if (do_self && l_cj[ciEntry.cj_ind_start].cj == (ci_sh >> 1))
+            if (do_self && l_cj[ciEntry.cj_ind_start] == (ci_sh >> 1))
 #    endif
             {
                 if (do_coul)
@@ -571,7 +573,7 @@
 #define CALC_COULOMB
 #define HALF_LJ
 #define CHECK_EXCLS
-            while (cjind < cjind1 && nbl->cj[cjind].excl != NBNXN_INTERACTION_MASK_ALL)
+            while (cjind < cjind1 && !l_masks.isFullMask(cjind))
             {
 #include "kernel_inner.h"
                 cjind++;
@@ -589,7 +591,7 @@
             /* Coulomb: all i-atoms, LJ: all i-atoms */
 #define CALC_COULOMB
 #define CHECK_EXCLS
-            while (cjind < cjind1 && nbl->cj[cjind].excl != NBNXN_INTERACTION_MASK_ALL)
+            while (cjind < cjind1 && !l_masks.isFullMask(cjind))
             {
 #include "kernel_inner.h"
                 cjind++;
@@ -605,7 +607,7 @@
         {
             /* Coulomb: none, LJ: all i-atoms */
 #define CHECK_EXCLS
-            while (cjind < cjind1 && nbl->cj[cjind].excl != NBNXN_INTERACTION_MASK_ALL)
+            while (cjind < cjind1 && !l_masks.isFullMask(cjind))
             {
 #include "kernel_inner.h"
                 cjind++;
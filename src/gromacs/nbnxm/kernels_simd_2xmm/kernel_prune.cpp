@@ -58,13 +58,14 @@ void nbnxn_kernel_prune_2xnn(NbnxnPairlistCpu*       nbl,
 
     /* We avoid push_back() for efficiency reasons and resize after filling */
     nbl->ci.resize(nbl->ciOuter.size());
-    nbl->cj.resize(nbl->cjOuter.size());
+    nbl->cj.prepareForPruning(nbl->cjOuter);
 
     const nbnxn_ci_t* gmx_restrict ciOuter = nbl->ciOuter.data();
     nbnxn_ci_t* gmx_restrict ciInner       = nbl->ci.data();
 
-    const nbnxn_cj_t* gmx_restrict cjOuter = nbl->cjOuter.data();
-    nbnxn_cj_t* gmx_restrict cjInner       = nbl->cj.data();
+    const JClusterList&     jListOuter = nbl->cjOuter;
+    JClusterList*           jListInner = &nbl->cj;
+    const int* gmx_restrict cjOuter    = jListOuter.cjList().data();
 
     const real* gmx_restrict shiftvec = shift_vec[0];
     const real* gmx_restrict x        = nbat->x().data();
@@ -112,7 +113,7 @@ void nbnxn_kernel_prune_2xnn(NbnxnPairlistCpu*       nbl,
         for (int cjind = ciEntry->cj_ind_start; cjind < ciEntry->cj_ind_end; cjind++)
         {
             /* j-cluster index */
-            int cj = cjOuter[cjind].cj;
+            int cj = cjOuter[cjind];
 
             /* Atom indices (of the first atom in the cluster) */
 #    if UNROLLJ == STRIDE
@@ -148,7 +149,7 @@ void nbnxn_kernel_prune_2xnn(NbnxnPairlistCpu*       nbl,
             wco_S0 = wco_S0 || wco_S2;
 
             /* Putting the assignment inside the conditional is slower */
-            cjInner[ncjInner] = cjOuter[cjind];
+            jListInner->setFromOuter(ncjInner, jListOuter, cjind);
             if (anyTrue(wco_S0))
             {
                 ncjInner++;
@@ -249,7 +249,7 @@
 #    endif /* CALC_LJ */
 
     /* j-cluster index */
-    cj = l_cj[cjind].cj;
+    cj = l_cj[cjind];
 
     /* Atom indices (of the first atom in the cluster) */
     aj = cj * UNROLLJ;
@@ -269,9 +269,10 @@
     ajz = ajy + STRIDE;
 
 #    ifdef CHECK_EXCLS
-    gmx_load_simd_4xn_interactions(static_cast<int>(l_cj[cjind].excl), filter_S0, filter_S1,
-                                   filter_S2, filter_S3, nbat->simdMasks.interaction_array.data(),
-                                   &interact_S0, &interact_S1, &interact_S2, &interact_S3);
+    gmx_load_simd_4xn_interactions(static_cast<int>(l_masks[cjind]), filter_S0,
+                                   filter_S1, filter_S2, filter_S3,
+                                   nbat->simdMasks.interaction_array.data(), &interact_S0,
+                                   &interact_S1, &interact_S2, &interact_S3);
 #    endif /* CHECK_EXCLS */
 
     /* load j atom coordinates */
@@ -48,6 +48,7 @@
 #include "gromacs/domdec/domdec_struct.h"
 #include "gromacs/nbnxm/atomdata.h"
 #include "gromacs/timing/wallcycle.h"
+#include "gromacs/utility/gmxassert.h"
 
 #include "nbnxm_gpu.h"
 #include "pairlistsets.h"
@@ -238,6 +239,21 @@ void nonbonded_verlet_t::changePairlistRadii(real rlistOuter, real rlistInner)
     pairlistSets_->changePairlistRadii(rlistOuter, rlistInner);
 }
 
+void nonbonded_verlet_t::changeDynamicPruning(const int nstlistPrune, const real rlistInner)
+{
+    GMX_RELEASE_ASSERT(pairlistIsSimple(), "Can only change dynamic pruning of CPU pair-lists");
+
+    pairlistSets_->changeDynamicPruning(nstlistPrune, rlistInner);
+}
+
+void nonbonded_verlet_t::changeEwaldExclusionType(Nbnxm::EwaldExclusionType ewaldExclusionType)
+{
+    GMX_RELEASE_ASSERT(pairlistIsSimple(),
+                       "Can only change the Ewald exclusion type of CPU kernels");
+
+    kernelSetup_.ewaldExclusionType = ewaldExclusionType;
+}
+
 void nonbonded_verlet_t::setupGpuShortRangeWork(const gmx::GpuBonded*          gpuBonded,
                                                 const gmx::InteractionLocality iLocality)
 {
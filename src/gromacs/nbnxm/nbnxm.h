@@ -379,6 +379,16 @@ public:
     //! Changes the pair-list outer and inner radius
     void changePairlistRadii(real rlistOuter, real rlistInner);
 
+    /*! \brief Changes the dynamic pruning interval and inner radius, CPU only
+     *
+     * Dynamic pruning is turned off with \p nstlistPrune < 0.
+     * Should only be called at search steps before the pair-lists are constructed.
+     */
+    void changeDynamicPruning(int nstlistPrune, real rlistInner);
+
+    //! Changes the Ewald exclusion correction used in the CPU SIMD kernels
+    void changeEwaldExclusionType(Nbnxm::EwaldExclusionType ewaldExclusionType);
+
     //! Set up internal flags that indicate what type of short-range work there is.
     void setupGpuShortRangeWork(const gmx::GpuBonded* gpuBonded, gmx::InteractionLocality iLocality);
 
@@ -417,6 +427,21 @@ std::unique_ptr<nonbonded_verlet_t> init_nb_verlet(const gmx::MDLogger& mdlog,
                                                    matrix                          box,
                                                    gmx_wallcycle*                  wcycle);
 
+/*! \brief Creates an Nbnxm object for CPU non-bonded kernels with the given kernel setup
+ *
+ * This is used to switch between CPU kernel layouts during a run,
+ * which requires a different search grid, atom data and pair-list layout.
+ * The atoms need to be put on the grid before the object can be used.
+ */
+std::unique_ptr<nonbonded_verlet_t> init_nb_verlet(const gmx::MDLogger& mdlog,
+                                                   const KernelSetup&   kernelSetup,
+                                                   const t_inputrec*    ir,
+                                                   const t_forcerec*    fr,
+                                                   const t_commrec*     cr,
+                                                   const gmx_mtop_t*    mtop,
+                                                   matrix               box,
+                                                   gmx_wallcycle*       wcycle);
+
 } // namespace Nbnxm
 
 /*! \brief Put the atoms on the pair search grid.
@@ -357,38 +357,32 @@ static int getMinimumIlistCountForGpuBalancing(NbnxmGpu* nbnxmGpu)
     return minimumIlistCount;
 }
 
-std::unique_ptr<nonbonded_verlet_t> init_nb_verlet(const gmx::MDLogger& mdlog,
-                                                   const t_inputrec*    ir,
-                                                   const t_forcerec*    fr,
-                                                   const t_commrec*     cr,
-                                                   const gmx_hw_info_t& hardwareInfo,
-                                                   const bool           useGpuForNonbonded,
-                                                   const gmx::DeviceStreamManager* deviceStreamManager,
-                                                   const gmx_mtop_t*               mtop,
-                                                   matrix                          box,
-                                                   gmx_wallcycle*                  wcycle)
+/*! \brief Creates an Nbnxm object for the given kernel setup
+ *
+ * \param[in] mdlog               Logger
+ * \param[in] kernelSetup         The non-bonded kernel setup to use
+ * \param[in] ir                  The input parameter record
+ * \param[in] fr                  The force record
+ * \param[in] cr                  Communication record
+ * \param[in] useGpuForNonbonded  Whether the non-bondeds are computed on a GPU
+ * \param[in] deviceStreamManager The device stream manager, only used with a GPU
+ * \param[in] mtop                The global topology
+ * \param[in] box                 The unit cell
+ * \param[in] wcycle              Pointer to the wallcycle structure
+ */
+static std::unique_ptr<nonbonded_verlet_t>
+makeNonbondedVerlet(const gmx::MDLogger&            mdlog,
+                    const KernelSetup&              kernelSetup,
+                    const t_inputrec*               ir,
+                    const t_forcerec*               fr,
+                    const t_commrec*                cr,
+                    const bool                      useGpuForNonbonded,
+                    const gmx::DeviceStreamManager* deviceStreamManager,
+                    const gmx_mtop_t*               mtop,
+                    matrix                          box,
+                    gmx_wallcycle*                  wcycle)
 {
-    const bool emulateGpu = (getenv("GMX_EMULATE_GPU") != nullptr);
-
-    GMX_RELEASE_ASSERT(!(emulateGpu && useGpuForNonbonded),
-                       "When GPU emulation is active, there cannot be a GPU assignment");
-
-    NonbondedResource nonbondedResource;
-    if (useGpuForNonbonded)
-    {
-        nonbondedResource = NonbondedResource::Gpu;
-    }
-    else if (emulateGpu)
-    {
-        nonbondedResource = NonbondedResource::EmulateGpu;
-    }
-    else
-    {
-        nonbondedResource = NonbondedResource::Cpu;
-    }
-
-    Nbnxm::KernelSetup kernelSetup = pick_nbnxn_kernel(mdlog, fr->use_simd_kernels, hardwareInfo,
-                                                       nonbondedResource, ir, fr->bNonbonded);
+    const bool emulateGpu = (kernelSetup.kernelType == KernelType::Cpu8x8x8_PlainC);
 
     const bool haveMultipleDomains = havePPDomainDecomposition(cr);
 
@@ -467,6 +461,60 @@ std::unique_ptr<nonbonded_verlet_t> init_nb_verlet(const gmx::MDLogger& mdlog,
                                                 std::move(nbat), kernelSetup, gpu_nbv, wcycle);
 }
 
+std::unique_ptr<nonbonded_verlet_t> init_nb_verlet(const gmx::MDLogger& mdlog,
+                                                   const t_inputrec*    ir,
+                                                   const t_forcerec*    fr,
+                                                   const t_commrec*     cr,
+                                                   const gmx_hw_info_t& hardwareInfo,
+                                                   const bool           useGpuForNonbonded,
+                                                   const gmx::DeviceStreamManager* deviceStreamManager,
+                                                   const gmx_mtop_t*               mtop,
+                                                   matrix                          box,
+                                                   gmx_wallcycle*                  wcycle)
+{
+    const bool emulateGpu = (getenv("GMX_EMULATE_GPU") != nullptr);
+
+    GMX_RELEASE_ASSERT(!(emulateGpu && useGpuForNonbonded),
+                       "When GPU emulation is active, there cannot be a GPU assignment");
+
+    NonbondedResource nonbondedResource;
+    if (useGpuForNonbonded)
+    {
+        nonbondedResource = NonbondedResource::Gpu;
+    }
+    else if (emulateGpu)
+    {
+        nonbondedResource = NonbondedResource::EmulateGpu;
+    }
+    else
+    {
+        nonbondedResource = NonbondedResource::Cpu;
+    }
+
+    Nbnxm::KernelSetup kernelSetup = pick_nbnxn_kernel(mdlog, fr->use_simd_kernels, hardwareInfo,
+                                                       nonbondedResource, ir, fr->bNonbonded);
+
+    return makeNonbondedVerlet(mdlog, kernelSetup, ir, fr, cr, useGpuForNonbonded,
+                               deviceStreamManager, mtop, box, wcycle);
+}
+
+std::unique_ptr<nonbonded_verlet_t> init_nb_verlet(const gmx::MDLogger& mdlog,
+                                                   const KernelSetup&   kernelSetup,
+                                                   const t_inputrec*    ir,
+                                                   const t_forcerec*    fr,
+                                                   const t_commrec*     cr,
+                                                   const gmx_mtop_t*    mtop,
+                                                   matrix               box,
+                                                   gmx_wallcycle*       wcycle)
+{
+    GMX_RELEASE_ASSERT(kernelSetup.kernelType == KernelType::Cpu4x4_PlainC
+                               || kernelSetup.kernelType == KernelType::Cpu4xN_Simd_4xN
+                               || kernelSetup.kernelType == KernelType::Cpu4xN_Simd_2xNN,
+                       "Only CPU kernel setups can be passed here");
+
+    return makeNonbondedVerlet(mdlog, kernelSetup, ir, fr, cr, false, nullptr, mtop, box, wcycle);
+}
+
 } // namespace Nbnxm
 
 nonbonded_verlet_t::nonbonded_verlet_t(std::unique_ptr<PairlistSets>     pairlistSets,
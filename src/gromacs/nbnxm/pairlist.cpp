@@ -45,6 +45,7 @@
 #include <cstring>
 
 #include <algorithm>
+#include <limits>
 
 #include "gromacs/domdec/domdec_struct.h"
 #include "gromacs/gmxlib/nrnb.h"
@@ -624,9 +625,9 @@ clusterpair_in_range(const NbnxnPairlistGpuWork& work, int si, int csj, int stri
 }
 
 /* Returns the j-cluster index for index cjIndex in a cj list */
-static inline int nblCj(gmx::ArrayRef<const nbnxn_cj_t> cjList, int cjIndex)
+static inline int nblCj(gmx::ArrayRef<const int> cjList, int cjIndex)
 {
-    return cjList[cjIndex].cj;
+    return cjList[cjIndex];
 }
 
 /* Returns the j-cluster index for index cjIndex in a cj4 list */
@@ -641,6 +642,115 @@ static unsigned int nbl_imask0(const NbnxnPairlistGpu* nbl, int cj_ind)
     return nbl->cj4[cj_ind / c_nbnxnGpuJgroupSize].imei[0].imask;
 }
 
+JClusterList::JClusterList() : masks_({ NBNXN_INTERACTION_MASK_ALL }) {}
+
+void JClusterList::resize(size_t numEntries)
+{
+    cj_.resize(numEntries);
+    maskIndex_.resize(numEntries);
+    if (gmx::index(numEntries) < numClosed_)
+    {
+        numClosed_ = numEntries;
+        openExcl_.clear();
+        if (!usesMaskDictionary_)
+        {
+            rawExcl_.resize(numEntries);
+        }
+    }
+    else
+    {
+        openExcl_.resize(numEntries - numClosed_);
+    }
+}
+
+void JClusterList::clear()
+{
+    cj_.clear();
+    maskIndex_.clear();
+    masks_.assign(1, NBNXN_INTERACTION_MASK_ALL);
+    maskLookup_.clear();
+    numClosed_ = 0;
+    openExcl_.clear();
+    usesMaskDictionary_ = true;
+    rawExcl_.clear();
+}
+
+void JClusterList::switchToRawMasks(gmx::index numIndexed)
+{
+    rawExcl_.resize(numIndexed);
+    for (gmx::index i = 0; i < numIndexed; i++)
+    {
+        rawExcl_[i] = masks_[maskIndex_[i]];
+        if (maskIndex_[i] != c_maskIndexAll)
+        {
+            maskIndex_[i] = c_maskIndexRaw;
+        }
+    }
+    masks_.assign(1, NBNXN_INTERACTION_MASK_ALL);
+    maskLookup_.clear();
+    usesMaskDictionary_ = false;
+}
+
+void JClusterList::closeEntries()
+{
+    for (size_t i = 0; i < openExcl_.size(); i++)
+    {
+        const unsigned int mask      = openExcl_[i];
+        MaskIndex          maskIndex = c_maskIndexAll;
+        if (mask != NBNXN_INTERACTION_MASK_ALL && usesMaskDictionary_)
+        {
+            const auto entry = maskLookup_.find(mask);
+            if (entry != maskLookup_.end())
+            {
+                maskIndex = entry->second;
+            }
+            else if (masks_.size() <= std::numeric_limits<MaskIndex>::max())
+            {
+                maskIndex = masks_.size();
+                masks_.push_back(mask);
+                maskLookup_.emplace(mask, maskIndex);
+            }
+            else
+            {
+                switchToRawMasks(numClosed_ + i);
+            }
+        }
+        if (!usesMaskDictionary_)
+        {
+            rawExcl_.push_back(mask);
+            if (mask != NBNXN_INTERACTION_MASK_ALL)
+            {
+                maskIndex = c_maskIndexRaw;
+            }
+        }
+        maskIndex_[numClosed_ + i] = maskIndex;
+    }
+    numClosed_ = cj_.size();
+    openExcl_.clear();
+}
+
+void JClusterList::appendEntries(const JClusterList& src, gmx::index begin, gmx::index end)
+{
+    for (gmx::index j = begin; j < end; j++)
+    {
+        push_back(src[j]);
+    }
+    closeEntries();
+}
+
+void JClusterList::prepareForPruning(const JClusterList& outerList)
+{
+    /* The pruned list is not extended, so we do not need the lookup */
+    masks_ = outerList.masks_;
+    maskLookup_.clear();
+    cj_.resize(outerList.size());
+    maskIndex_.resize(outerList.size());
+    numClosed_ = outerList.size();
+    openExcl_.clear();
+    usesMaskDictionary_ = outerList.usesMaskDictionary_;
+    rawExcl_.resize(usesMaskDictionary_ ? 0 : outerList.size());
+}
+
 NbnxnPairlistCpu::NbnxnPairlistCpu() :
     na_ci(c_nbnxnCpuIClusterSize),
     na_cj(0),
@@ -769,7 +879,7 @@ static void print_nblist_statistics(FILE*                   fp,
         cs[ciEntry.shift & NBNXN_CI_SHIFT] += ciEntry.cj_ind_end - ciEntry.cj_ind_start;
 
         int j = ciEntry.cj_ind_start;
-        while (j < ciEntry.cj_ind_end && nbl.cj[j].excl != NBNXN_INTERACTION_MASK_ALL)
+        while (j < ciEntry.cj_ind_end && nbl.cj.excl(j) != NBNXN_INTERACTION_MASK_ALL)
         {
             npexcl++;
             j++;
@@ -1377,7 +1487,8 @@ static void setExclusionsForIEntry(const Nbnxm::GridSet&   gridSet,
         return;
     }
 
-    const JListRanges ranges(iEntry.cj_ind_start, iEntry.cj_ind_end, gmx::makeConstArrayRef(nbl->cj));
+    const JListRanges ranges(iEntry.cj_ind_start, iEntry.cj_ind_end,
+                             gmx::makeConstArrayRef(nbl->cj.cjList()));
 
     const int iCluster = iEntry.ci;
 
@@ -1417,7 +1528,8 @@ static void setExclusionsForIEntry(const Nbnxm::GridSet&   gridSet,
                 if (jCluster >= ranges.cjFirst && jCluster <= ranges.cjLast)
                 {
                     const int index =
-                            findJClusterInJList(jCluster, ranges, gmx::makeConstArrayRef(nbl->cj));
+                            findJClusterInJList(jCluster, ranges,
+                                                gmx::makeConstArrayRef(nbl->cj.cjList()));
 
                     if (index >= 0)
                     {
@@ -1426,7 +1538,7 @@ static void setExclusionsForIEntry(const Nbnxm::GridSet&   gridSet,
                          */
                         const int innerJ = jIndex - (jCluster << na_cj_2log);
 
-                        nbl->cj[index].excl &= ~(1U << ((i << na_cj_2log) + innerJ));
+                        nbl->cj.openExcl(index) &= ~(1U << ((i << na_cj_2log) + innerJ));
                     }
                 }
             }
@@ -1577,7 +1689,7 @@ static void make_fep_list(gmx::ArrayRef<const int> atomIndices,
             {
                 unsigned int fep_cj;
 
-                cja = nbl->cj[cj_ind].cj;
+                cja = nbl->cj.cj(cj_ind);
 
                 if (numAtomsJCluster == jGrid.geometry().numAtomsICluster)
                 {
@@ -1646,7 +1758,7 @@ static void make_fep_list(gmx::ArrayRef<const int> atomIndices,
                             /* Add it to the FEP list */
                             nlist->jjnr[nlist->nrj] = aj;
                             nlist->excl_fep[nlist->nrj] =
-                                    (nbl->cj[cj_ind].excl >> (i * nbl->na_cj + j)) & 1;
+                                    (nbl->cj.excl(cj_ind) >> (i * nbl->na_cj + j)) & 1;
                             nlist->nrj++;
 
                             /* Exclude it from the normal list.
@@ -1654,7 +1766,7 @@ static void make_fep_list(gmx::ArrayRef<const int> atomIndices,
                              * but we need to avoid 0/0, as perturbed atoms
                              * can be on top of each other.
                              */
-                            nbl->cj[cj_ind].excl &= ~(1U << (i * nbl->na_cj + j));
+                            nbl->cj.openExcl(cj_ind) &= ~(1U << (i * nbl->na_cj + j));
                         }
                     }
                 }
@@ -1996,35 +2108,35 @@ static void addNewIEntry(NbnxnPairlistGpu* nbl, int sci, int shift, int gmx_unus
     nbl->sci.push_back(sciEntry);
 }
 
-/* Sort the simple j-list cj on exclusions.
+/* Sort the ncj entries starting at cjStart in the simple j-list cj on exclusions.
  * Entries with exclusions will all be sorted to the beginning of the list.
  */
-static void sort_cj_excl(nbnxn_cj_t* cj, int ncj, NbnxnPairlistCpuWork* work)
+static void sort_cj_excl(JClusterList* cj, int cjStart, int ncj, NbnxnPairlistCpuWork* work)
 {
     work->cj.resize(ncj);
 
     /* Make a list of the j-cells involving exclusions */
     int jnew = 0;
-    for (int j = 0; j < ncj; j++)
+    for (int j = cjStart; j < cjStart + ncj; j++)
     {
-        if (cj[j].excl != NBNXN_INTERACTION_MASK_ALL)
+        if (cj->excl(j) != NBNXN_INTERACTION_MASK_ALL)
         {
-            work->cj[jnew++] = cj[j];
+            work->cj[jnew++] = (*cj)[j];
         }
     }
     /* Check if there are exclusions at all or not just the first entry */
-    if (!((jnew == 0) || (jnew == 1 && cj[0].excl != NBNXN_INTERACTION_MASK_ALL)))
+    if (!((jnew == 0) || (jnew == 1 && cj->excl(cjStart) != NBNXN_INTERACTION_MASK_ALL)))
     {
-        for (int j = 0; j < ncj; j++)
+        for (int j = cjStart; j < cjStart + ncj; j++)
         {
-            if (cj[j].excl == NBNXN_INTERACTION_MASK_ALL)
+            if (cj->excl(j) == NBNXN_INTERACTION_MASK_ALL)
             {
-                work->cj[jnew++] = cj[j];
+                work->cj[jnew++] = (*cj)[j];
             }
         }
         for (int j = 0; j < ncj; j++)
         {
-            cj[j] = work->cj[j];
+            cj->set(cjStart + j, work->cj[j]);
         }
     }
 }
@@ -2045,7 +2157,8 @@ static void closeIEntry(NbnxnPairlistCpu* nbl,
     const int jlen = ciEntry.cj_ind_end - ciEntry.cj_ind_start;
     if (jlen > 0)
     {
-        sort_cj_excl(nbl->cj.data() + ciEntry.cj_ind_start, jlen, nbl->work.get());
+        sort_cj_excl(&nbl->cj, ciEntry.cj_ind_start, jlen, nbl->work.get());
+        nbl->cj.closeEntries();
 
         /* The counts below are used for non-bonded pair/flop counts
          * and should therefore match the available kernel setups.
@@ -2596,7 +2709,7 @@ static void print_nblist_ci_cj(FILE* fp, const NbnxnPairlistCpu& nbl)
 
         for (int j = ciEntry.cj_ind_start; j < ciEntry.cj_ind_end; j++)
         {
-            fprintf(fp, "  cj %5d  imask %x\n", nbl.cj[j].cj, nbl.cj[j].excl);
+            fprintf(fp, "  cj %5d  imask %x\n", nbl.cj.cj(j), nbl.cj.excl(j));
         }
     }
 }
@@ -3053,8 +3166,8 @@ static void setBufferFlags(const NbnxnPairlistCpu& nbl,
 {
     if (gmx::ssize(nbl.cj) > ncj_old_j)
     {
-        int cbFirst = nbl.cj[ncj_old_j].cj >> gridj_flag_shift;
-        int cbLast  = nbl.cj.back().cj >> gridj_flag_shift;
+        int cbFirst = nbl.cj.cj(ncj_old_j) >> gridj_flag_shift;
+        int cbLast  = nbl.cj.cj(nbl.cj.size() - 1) >> gridj_flag_shift;
         for (int cb = cbFirst; cb <= cbLast; cb++)
         {
             bitmask_init_bit(&gridj_flag[cb], th);
@@ -3599,23 +3712,14 @@ static void reduce_buffer_flags(gmx::ArrayRef<PairsearchWork> searchWork,
 
 static void print_reduction_cost(gmx::ArrayRef<const gmx_bitmask_t> flags, int nout)
 {
-    int           nelem, nkeep, ncopy, nred, out;
-    gmx_bitmask_t mask_0;
+    int nelem, nkeep, nred, out;
 
     nelem = 0;
     nkeep = 0;
-    ncopy = 0;
     nred  = 0;
-    bitmask_init_bit(&mask_0, 0);
     for (const gmx_bitmask_t& flag_mask : flags)
     {
-        if (bitmask_is_equal(flag_mask, mask_0))
-        {
-            /* Only flag 0 is set, no copy of reduction required */
-            nelem++;
-            nkeep++;
-        }
-        else if (!bitmask_is_zero(flag_mask))
+        if (!bitmask_is_zero(flag_mask))
         {
             int c = 0;
             for (out = 0; out < nout; out++)
@@ -3628,7 +3732,8 @@ static void print_reduction_cost(gmx::ArrayRef<const gmx_bitmask_t> flags, int n
             nelem += c;
             if (c == 1)
             {
-                ncopy++;
+                /* Only one output contributes, the reduction leaves it in place */
+                nkeep++;
             }
             else
             {
@@ -3637,9 +3742,8 @@ static void print_reduction_cost(gmx::ArrayRef<const gmx_bitmask_t> flags, int n
         }
     }
     const auto numFlags = static_cast<double>(flags.size());
-    fprintf(debug,
-            "nbnxn reduction: #flag %lu #list %d elem %4.2f, keep %4.2f copy %4.2f red %4.2f\n",
-            flags.size(), nout, nelem / numFlags, nkeep / numFlags, ncopy / numFlags, nred / numFlags);
+    fprintf(debug, "nbnxn reduction: #flag %lu #list %d elem %4.2f, keep %4.2f red %4.2f\n",
+            flags.size(), nout, nelem / numFlags, nkeep / numFlags, nred / numFlags);
 }
 
 /* Copies the list entries from src to dest when cjStart <= *cjGlobal < cjEnd.
@@ -3666,18 +3770,18 @@ static void copySelectedListRange(const nbnxn_ci_t* gmx_restrict srcCi,
         bitmask_init_bit(&flag[srcCi->ci >> iFlagShift], t);
     }
 
-    for (int j = srcCi->cj_ind_start; j < srcCi->cj_ind_end; j++)
-    {
-        dest->cj.push_back(src->cj[j]);
+    dest->cj.appendEntries(src->cj, srcCi->cj_ind_start, srcCi->cj_ind_end);
 
-        if (setFlags)
+    if (setFlags)
+    {
+        for (int j = srcCi->cj_ind_start; j < srcCi->cj_ind_end; j++)
         {
             /* NOTE: This is relatively expensive, since this
              * operation is done for all elements in the list,
              * whereas at list generation this is done only
              * once for each flag entry.
              */
-            bitmask_init_bit(&flag[src->cj[j].cj >> jFlagShift], t);
+            bitmask_init_bit(&flag[src->cj.cj(j) >> jFlagShift], t);
         }
     }
 }
@@ -39,12 +39,16 @@
 
 #include <cstddef>
 
+#include <unordered_map>
+
 #include "gromacs/gpu_utils/hostallocator.h"
 #include "gromacs/math/vectypes.h"
 #include "gromacs/mdtypes/locality.h"
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/basedefinitions.h"
 #include "gromacs/utility/defaultinitializationallocator.h"
 #include "gromacs/utility/enumerationhelpers.h"
+#include "gromacs/utility/gmxassert.h"
 #include "gromacs/utility/real.h"
 
 #include "pairlistparams.h"
@@ -91,6 +95,167 @@ struct nbnxn_cj_t
     unsigned int excl;
 };
 
+/*! \brief The j-cluster list of a CPU pairlist
+ *
+ * Stores the same information as a list of nbnxn_cj_t, but with
+ * the j-cluster indices and the interaction masks in separate arrays.
+ * The masks are stored as 16-bit indices into a dictionary of the distinct
+ * masks in the list, where index 0 is the full mask. As the entries with
+ * exclusions are sorted to the front of each i-entry, the kernels only read
+ * mask indices for the first few j-entries and traverse the bulk of the list
+ * reading only 4 instead of 8 bytes per j-cluster.
+ *
+ * Large systems with many different exclusion patterns can have more
+ * distinct masks than the index can address. When the dictionary overflows,
+ * the list switches to storing the raw masks of all entries. The indices
+ * then only tell whether the mask is full. The list stays in this mode
+ * until clear() is called.
+ *
+ * Entries are appended as open entries with full 32-bit masks, which can
+ * be modified and sorted. closeEntries() converts the masks of all open
+ * entries to dictionary indices, this should be called after completing
+ * each i-entry.
+ */
+class JClusterList
+{
+public:
+    //! The type of the index into the mask dictionary
+    using MaskIndex = unsigned short;
+    //! The mask index of the full interaction mask
+    static constexpr MaskIndex c_maskIndexAll = 0;
+    //! The mask index of entries with other masks when raw masks are stored
+    static constexpr MaskIndex c_maskIndexRaw = 1;
+
+    /*! \brief View of the interaction masks of the closed entries, for use in kernels
+     *
+     * The raw masks are only used when the mask dictionary overflowed.
+     */
+    struct MaskView
+    {
+        //! Returns whether entry \p index has the full interaction mask
+        bool isFullMask(int index) const { return maskIndex[index] == c_maskIndexAll; }
+        //! Returns the interaction mask of entry \p index
+        unsigned int operator[](int index) const
+        {
+            return (rawMasks ? rawMasks[index] : dictionary[maskIndex[index]]);
+        }
+
+        //! The mask indices of all entries
+        const MaskIndex* maskIndex;
+        //! The mask dictionary
+        const unsigned int* dictionary;
+        //! The raw masks of all entries, nullptr when the dictionary is used
+        const unsigned int* rawMasks;
+    };
+
+    JClusterList();
+
+    //! Returns the j-cluster of entry \p index
+    int cj(gmx::index index) const { return cj_[index]; }
+    //! Returns the interaction mask of entry \p index
+    unsigned int excl(gmx::index index) const
+    {
+        if (index >= numClosed_)
+        {
+            return openExcl_[index - numClosed_];
+        }
+        return (usesMaskDictionary_ ? masks_[maskIndex_[index]] : rawExcl_[index]);
+    }
+    //! Returns a reference to the interaction mask of open entry \p index
+    unsigned int& openExcl(gmx::index index)
+    {
+        GMX_ASSERT(index >= numClosed_, "Only masks of open entries can be modified");
+        return openExcl_[index - numClosed_];
+    }
+    //! Returns entry \p index
+    nbnxn_cj_t operator[](gmx::index index) const { return { cj_[index], excl(index) }; }
+    //! Sets open entry \p index to \p entry
+    void set(gmx::index index, const nbnxn_cj_t& entry)
+    {
+        GMX_ASSERT(index >= numClosed_, "Only open entries can be set");
+        cj_[index]                    = entry.cj;
+        openExcl_[index - numClosed_] = entry.excl;
+    }
+
+    //! Returns the j-clusters of all entries
+    gmx::ArrayRef<const int> cjList() const { return cj_; }
+    //! Returns the j-clusters of all entries
+    gmx::ArrayRef<int> cjList() { return cj_; }
+    //! Returns the mask indices of all entries, only valid for closed entries
+    gmx::ArrayRef<const MaskIndex> maskIndexList() const { return maskIndex_; }
+    //! Returns the dictionary of interaction masks
+    gmx::ArrayRef<const unsigned int> maskDictionary() const { return masks_; }
+    //! Returns whether the masks are stored in the dictionary, false after an overflow
+    bool usesMaskDictionary() const { return usesMaskDictionary_; }
+    //! Returns a view of the interaction masks of the closed entries
+    MaskView maskView() const
+    {
+        return { maskIndex_.data(), masks_.data(),
+                 usesMaskDictionary_ ? nullptr : rawExcl_.data() };
+    }
+
+    //! Returns the number of entries
+    size_t size() const { return cj_.size(); }
+    //! Returns whether the list is empty
+    bool empty() const { return cj_.empty(); }
+    //! Resizes the list, new entries are open and not initialized
+    void resize(size_t numEntries);
+    //! Removes all entries and clears the mask dictionary
+    void clear();
+    //! Appends \p entry as an open entry to the list
+    void push_back(const nbnxn_cj_t& entry)
+    {
+        cj_.push_back(entry.cj);
+        maskIndex_.push_back(c_maskIndexAll);
+        openExcl_.push_back(entry.excl);
+    }
+    //! Converts the masks of all open entries to dictionary indices
+    void closeEntries();
+    //! Appends entries \p begin to \p end of \p src to the list and closes them
+    void appendEntries(const JClusterList& src, gmx::index begin, gmx::index end);
+    /*! \brief Prepares the list for pruning \p outerList into it
+     *
+     * Takes over the mask storage mode and dictionary and sizes the list
+     * to the size of \p outerList with closed entries. The pruning should
+     * set the entries with setFromOuter() and then shrink the list.
+     */
+    void prepareForPruning(const JClusterList& outerList);
+    /*! \brief Sets closed entry \p index to entry \p outerIndex of \p outerList
+     *
+     * prepareForPruning(outerList) should have been called.
+     */
+    void setFromOuter(gmx::index index, const JClusterList& outerList, gmx::index outerIndex)
+    {
+        cj_[index]        = outerList.cj_[outerIndex];
+        maskIndex_[index] = outerList.maskIndex_[outerIndex];
+        if (!usesMaskDictionary_)
+        {
+            rawExcl_[index] = outerList.rawExcl_[outerIndex];
+        }
+    }
+
+private:
+    //! Switches to raw mask storage, with \p numIndexed entries already indexed
+    void switchToRawMasks(gmx::index numIndexed);
+
+    //! The j-cluster indices
+    FastVector<int> cj_;
+    //! The indices in masks_ of the interaction masks, or c_maskIndexRaw with raw masks
+    FastVector<MaskIndex> maskIndex_;
+    //! The distinct interaction masks, the first is the full mask
+    FastVector<unsigned int> masks_;
+    //! Lookup of the index in masks_ of masks other than the full mask
+    std::unordered_map<unsigned int, MaskIndex> maskLookup_;
+    //! The number of entries with masks stored in the dictionary, the rest are open
+    gmx::index numClosed_ = 0;
+    //! The interaction masks of the open entries, indexed i-major, j-minor
+    FastVector<unsigned int> openExcl_;
+    //! Whether the masks of closed entries are stored in the dictionary
+    bool usesMaskDictionary_ = true;
+    //! The raw masks of the closed entries, only used without dictionary
+    FastVector<unsigned int> rawExcl_;
+};
+
 /*! \brief Constants for interpreting interaction flags
  *
  * In nbnxn_ci_t the integer shift contains the shift in the lower 7 bits.
@@ -242,9 +407,9 @@ struct NbnxnPairlistCpu
     FastVector<nbnxn_ci_t> ciOuter;
 
     //! The j-cluster list, size ncj
-    FastVector<nbnxn_cj_t> cj;
+    JClusterList cj;
     //! The outer, unpruned j-cluster list
-    FastVector<nbnxn_cj_t> cjOuter;
+    JClusterList cjOuter;
     //! The number of j-clusters that are used by ci entries in this list, will be <= cj.size()
     int ncjInUse;
 
@@ -50,12 +50,15 @@
 #include <cstdlib>
 
 #include <algorithm>
+#include <optional>
 #include <string>
+#include <vector>
 
 #include "gromacs/domdec/domdec.h"
 #include "gromacs/hardware/cpuinfo.h"
 #include "gromacs/math/vec.h"
 #include "gromacs/mdlib/calc_verletbuf.h"
+#include "gromacs/mdlib/gmx_omp_nthreads.h"
 #include "gromacs/mdtypes/commrec.h"
 #include "gromacs/mdtypes/inputrec.h"
 #include "gromacs/mdtypes/interaction_const.h"
@@ -248,14 +251,33 @@ void increaseNstlist(FILE*               fp,
             (useOrEmulateGpuForNonbondeds ? ListSetupType::Gpu : ListSetupType::CpuSimdWhenSupported);
     VerletbufListSetup listSetup = verletbufGetSafeListSetup(listType);
 
+    /* Compute the buffer sizes for the reference value for nstlist (10)
+     * and for all nstlist values we might try in one go, so the atom type
+     * statistics are extracted from the topology only once.
+     * This is called before the OpenMP setup, so we use a single thread.
+     */
+    std::vector<VerletbufCandidate> candidates;
+    candidates.push_back({ nbnxnReferenceNstlist, nbnxnReferenceNstlist - 1, -1, listSetup });
+    const size_t firstNstlistInd = nstlist_ind;
+    if (nstlist_cmdline > 0)
+    {
+        candidates.push_back({ ir->nstlist, ir->nstlist - 1, -1, listSetup });
+    }
+    else
+    {
+        for (size_t i = firstNstlistInd; i < NNSTL; i++)
+        {
+            candidates.push_back({ nstlist_try[i], nstlist_try[i] - 1, -1, listSetup });
+        }
+    }
+    const VerletBufferEstimator verletBufferEstimator(*mtop, *ir);
+    const std::vector<real>     rlistPerCandidate =
+            verletBufferEstimator.calcBufferSizes(det(box), *ir, candidates);
+
     /* Allow rlist to make the list a given factor larger than the list
-     * would be with the reference value for nstlist (10).
+     * would be with the reference value for nstlist.
      */
-    nstlist_prev = ir->nstlist;
-    ir->nstlist  = nbnxnReferenceNstlist;
-    const real rlistWithReferenceNstlist =
-            calcVerletBufferSize(*mtop, det(box), *ir, ir->nstlist, ir->nstlist - 1, -1, listSetup);
-    ir->nstlist = nstlist_prev;
+    const real rlistWithReferenceNstlist = rlistPerCandidate[0];
 
     /* Determine the pair list size increase due to zero interactions */
     rlist_inc = nbnxn_get_rlist_effective_inc(listSetup.cluster_size_j, mtop->natoms / det(box));
@@ -277,7 +299,7 @@ void increaseNstlist(FILE*               fp,
         }
 
         /* Set the pair-list buffer size in ir */
-        rlist_new = calcVerletBufferSize(*mtop, det(box), *ir, ir->nstlist, ir->nstlist - 1, -1, listSetup);
+        rlist_new = rlistPerCandidate[1 + nstlist_ind - firstNstlistInd];
 
         /* Does rlist fit in the box? */
         bBox = (gmx::square(rlist_new) < max_cutoff2(ir->pbcType, box));
@@ -373,6 +395,7 @@ static const int c_nbnxnDynamicListPruningMinLifetime = 4;
  *
  * \param[in]     ir          The input parameter record
  * \param[in]     mtop        The global topology
+ * \param[in]     verletBufferEstimator  The Verlet buffer estimator for \p mtop
  * \param[in]     box         The unit cell
  * \param[in]     useGpuList  Tells if we are using a GPU type pairlist
  * \param[in]     listSetup   The nbnxn pair list setup
@@ -380,42 +403,54 @@ static const int c_nbnxnDynamicListPruningMinLifetime = 4;
  * \param[in] ic              The nonbonded interactions constants
  * \param[in,out] listParams  The list setup parameters
  */
-static void setDynamicPairlistPruningParameters(const t_inputrec*          ir,
-                                                const gmx_mtop_t*          mtop,
-                                                const matrix               box,
-                                                const bool                 useGpuList,
-                                                const VerletbufListSetup&  listSetup,
-                                                const bool                 userSetNstlistPrune,
-                                                const interaction_const_t* ic,
-                                                PairlistParams*            listParams)
+static void setDynamicPairlistPruningParameters(const t_inputrec*            ir,
+                                                const gmx_mtop_t*            mtop,
+                                                const VerletBufferEstimator& verletBufferEstimator,
+                                                const matrix                 box,
+                                                const bool                   useGpuList,
+                                                const VerletbufListSetup&    listSetup,
+                                                const bool                   userSetNstlistPrune,
+                                                const interaction_const_t*   ic,
+                                                PairlistParams*              listParams)
 {
     listParams->lifetime = ir->nstlist - 1;
 
-    /* When nstlistPrune was set by the user, we need to execute one loop
-     * iteration to determine rlistInner.
+    /* When nstlistPrune was set by the user, we only need to determine
+     * rlistInner for that value.
      * Otherwise we compute rlistInner and increase nstlist as long as
      * we have a pairlist buffer of length 0 (i.e. rlistInner == cutoff).
+     * We compute the inner list buffers for all candidate values at once.
      */
-    const real interactionCutoff = std::max(ic->rcoulomb, ic->rvdw);
-    int        tunedNstlistPrune = listParams->nstlistPrune;
+    const real                      interactionCutoff = std::max(ic->rcoulomb, ic->rvdw);
+    std::vector<VerletbufCandidate> candidates;
+    int                             tunedNstlistPrune = listParams->nstlistPrune;
     do
     {
         /* Dynamic pruning on the GPU is performed on the list for
          * the next step on the coordinates of the current step,
          * so the list lifetime is nstlistPrune (not the usual nstlist-1).
          */
-        int listLifetime         = tunedNstlistPrune - (useGpuList ? 0 : 1);
-        listParams->nstlistPrune = tunedNstlistPrune;
-        listParams->rlistInner   = calcVerletBufferSize(*mtop, det(box), *ir, tunedNstlistPrune,
-                                                      listLifetime, -1, listSetup);
+        int listLifetime = tunedNstlistPrune - (useGpuList ? 0 : 1);
+        candidates.push_back({ tunedNstlistPrune, listLifetime, -1, listSetup });
 
         /* On the GPU we apply the dynamic pruning in a rolling fashion
          * every c_nbnxnGpuRollingListPruningInterval steps,
          * so keep nstlistPrune a multiple of the interval.
          */
         tunedNstlistPrune += useGpuList ? c_nbnxnGpuRollingListPruningInterval : 1;
-    } while (!userSetNstlistPrune && tunedNstlistPrune < ir->nstlist
-             && listParams->rlistInner == interactionCutoff);
+    } while (!userSetNstlistPrune && tunedNstlistPrune < ir->nstlist);
+
+    const std::vector<real> rlistInnerPerCandidate =
+            verletBufferEstimator.calcBufferSizes(det(box), *ir, candidates);
+    for (size_t i = 0; i < candidates.size(); i++)
+    {
+        listParams->nstlistPrune = candidates[i].nstlist;
+        listParams->rlistInner   = rlistInnerPerCandidate[i];
+        if (listParams->rlistInner != interactionCutoff)
+        {
+            break;
+        }
+    }
 
     if (userSetNstlistPrune)
     {
@@ -496,6 +531,13 @@ void setupDynamicPairlistPruning(const gmx::MDLogger&       mdlog,
     /* Currently emulation mode does not support dual pair-lists */
     const bool useGpuList = (listParams->pairlistType == PairlistType::HierarchicalNxN);
 
+    /* The atom type statistics are shared by all buffer estimates below */
+    std::optional<VerletBufferEstimator> verletBufferEstimator;
+    if (supportsDynamicPairlistGenerationInterval(*ir))
+    {
+        verletBufferEstimator.emplace(*mtop, *ir, gmx_omp_nthreads_get(emntDefault));
+    }
+
     if (supportsDynamicPairlistGenerationInterval(*ir) && getenv("GMX_DISABLE_DYNAMICPRUNING") == nullptr)
     {
         /* Note that nstlistPrune can have any value independently of nstlist.
@@ -529,8 +571,8 @@ void setupDynamicPairlistPruning(const gmx::MDLogger&       mdlog,
             listParams->nstlistPrune = c_nbnxnDynamicListPruningMinLifetime;
         }
 
-        setDynamicPairlistPruningParameters(ir, mtop, box, useGpuList, ls, userSetNstlistPrune, ic,
-                                            listParams);
+        setDynamicPairlistPruningParameters(ir, mtop, *verletBufferEstimator, box, useGpuList, ls,
+                                            userSetNstlistPrune, ic, listParams);
 
         if (listParams->useDynamicPruning && useGpuList)
         {
@@ -570,16 +612,19 @@ void setupDynamicPairlistPruning(const gmx::MDLogger&       mdlog,
     }
     if (supportsDynamicPairlistGenerationInterval(*ir))
     {
-        const VerletbufListSetup listSetup1x1 = { 1, 1 };
-        const real rlistOuter = calcVerletBufferSize(*mtop, det(box), *ir, ir->nstlist,
-                                                     ir->nstlist - 1, -1, listSetup1x1);
-        real       rlistInner = rlistOuter;
+        const VerletbufListSetup        listSetup1x1 = { 1, 1 };
+        std::vector<VerletbufCandidate> candidates   = {
+            { ir->nstlist, ir->nstlist - 1, -1, listSetup1x1 }
+        };
         if (listParams->useDynamicPruning)
         {
             int listLifeTime = listParams->nstlistPrune - (useGpuList ? 0 : 1);
-            rlistInner       = calcVerletBufferSize(*mtop, det(box), *ir, listParams->nstlistPrune,
-                                              listLifeTime, -1, listSetup1x1);
+            candidates.push_back({ listParams->nstlistPrune, listLifeTime, -1, listSetup1x1 });
         }
+        const std::vector<real> rlists =
+                verletBufferEstimator->calcBufferSizes(det(box), *ir, candidates);
+        const real rlistOuter = rlists[0];
+        const real rlistInner = rlists.back();
 
         mesg += gmx::formatString(
                 "At tolerance %g kJ/mol/ps per atom, equivalent classical 1x1 list would be:\n",
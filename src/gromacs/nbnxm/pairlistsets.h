@@ -119,6 +119,19 @@ public:
         params_.rlistInner = rlistInner;
     }
 
+    /*! \brief Changes the dynamic pruning interval and inner radius of CPU pair-lists
+     *
+     * Should only be called before constructing new pair-lists, since
+     * the dynamic pruning setup affects the pair-list construction.
+     * Dynamic pruning is turned off with \p nstlistPrune < 0.
+     */
+    void changeDynamicPruning(int nstlistPrune, real rlistInner)
+    {
+        params_.useDynamicPruning = (nstlistPrune > 0);
+        params_.nstlistPrune      = params_.useDynamicPruning ? nstlistPrune : -1;
+        params_.rlistInner        = params_.useDynamicPruning ? rlistInner : params_.rlistOuter;
+    }
+
     //! Returns the pair-list set for the given locality
     const PairlistSet& pairlistSet(gmx::InteractionLocality iLocality) const
     {
@@ -0,0 +1,285 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+/*! \internal \file
+ * \brief
+ * Tests for the j-cluster list of the CPU pairlist.
+ *
+ * \ingroup module_nbnxm
+ */
+#include "gmxpre.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/nbnxm/pairlist.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+//! Some masks with exclusions, as in a list for 4x4 clusters
+const std::vector<unsigned int> c_masks = { 0x0000fffe, 0x0000fcec, 0x0000fffe, 0x00008000,
+                                            0x0000fcec, 0x00007fff };
+
+//! Appends entries with masks \p masks and j-clusters starting at \p firstCj to \p list
+void appendEntries(JClusterList* list, const std::vector<unsigned int>& masks, int firstCj)
+{
+    for (size_t i = 0; i < masks.size(); i++)
+    {
+        list->push_back({ firstCj + static_cast<int>(i), masks[i] });
+    }
+}
+
+//! Checks that \p list contains the j-clusters starting at \p firstCj and \p masks
+void checkEntries(const JClusterList& list, const std::vector<unsigned int>& masks, int firstCj)
+{
+    ASSERT_EQ(list.size(), masks.size());
+    const JClusterList::MaskView maskView = list.maskView();
+    for (size_t i = 0; i < masks.size(); i++)
+    {
+        EXPECT_EQ(list.cj(i), firstCj + static_cast<int>(i));
+        EXPECT_EQ(list.excl(i), masks[i]);
+        EXPECT_EQ(maskView[i], masks[i]);
+        EXPECT_EQ(maskView.isFullMask(i), masks[i] == NBNXN_INTERACTION_MASK_ALL);
+    }
+}
+
+//! Returns \p count distinct masks, more than a dictionary can hold when count is large
+std::vector<unsigned int> distinctMasks(int count)
+{
+    std::vector<unsigned int> masks(count);
+    for (int i = 0; i < count; i++)
+    {
+        masks[i] = i;
+    }
+    return masks;
+}
+
+TEST(JClusterListTest, ClosedEntriesShareDictionaryMasks)
+{
+    std::vector<unsigned int> masks = c_masks;
+    masks.push_back(NBNXN_INTERACTION_MASK_ALL);
+    masks.push_back(NBNXN_INTERACTION_MASK_ALL);
+
+    JClusterList list;
+    appendEntries(&list, masks, 10);
+    list.closeEntries();
+
+    checkEntries(list, masks, 10);
+    EXPECT_TRUE(list.usesMaskDictionary());
+    // The full mask and the four distinct masks with exclusions
+    EXPECT_EQ(list.maskDictionary().size(), 5);
+    gmx::ArrayRef<const JClusterList::MaskIndex> maskIndex = list.maskIndexList();
+    EXPECT_EQ(maskIndex[0], maskIndex[2]);
+    EXPECT_EQ(maskIndex[1], maskIndex[4]);
+    EXPECT_NE(maskIndex[0], maskIndex[1]);
+    EXPECT_EQ(maskIndex[6], JClusterList::c_maskIndexAll);
+    EXPECT_EQ(maskIndex[7], JClusterList::c_maskIndexAll);
+}
+
+TEST(JClusterListTest, OpenEntriesCanBeModifiedBeforeClosing)
+{
+    JClusterList list;
+    appendEntries(&list, c_masks, 0);
+    list.closeEntries();
+
+    // Add a second i-entry and change its masks before closing it
+    appendEntries(&list, { NBNXN_INTERACTION_MASK_ALL, 0x0000fffe }, c_masks.size());
+    list.openExcl(c_masks.size()) &= ~1U;
+    list.set(c_masks.size() + 1, { static_cast<int>(c_masks.size()) + 1, 0x00000ff0 });
+    EXPECT_EQ(list.excl(c_masks.size()), NBNXN_INTERACTION_MASK_ALL & ~1U);
+    list.closeEntries();
+
+    std::vector<unsigned int> masks = c_masks;
+    masks.push_back(NBNXN_INTERACTION_MASK_ALL & ~1U);
+    masks.push_back(0x00000ff0);
+    checkEntries(list, masks, 0);
+}
+
+TEST(JClusterListTest, ResizeAndClearWork)
+{
+    JClusterList list;
+    appendEntries(&list, c_masks, 0);
+    list.closeEntries();
+
+    // Shrinking keeps the closed entries
+    list.resize(3);
+    checkEntries(list, { c_masks.begin(), c_masks.begin() + 3 }, 0);
+
+    // Growing adds open entries that can be set
+    list.resize(5);
+    list.set(3, { 3, 0x000000ff });
+    list.set(4, { 4, NBNXN_INTERACTION_MASK_ALL });
+    list.closeEntries();
+    checkEntries(list,
+                 { c_masks[0], c_masks[1], c_masks[2], 0x000000ff, NBNXN_INTERACTION_MASK_ALL }, 0);
+
+    list.clear();
+    EXPECT_TRUE(list.empty());
+    EXPECT_TRUE(list.usesMaskDictionary());
+    EXPECT_EQ(list.maskDictionary().size(), 1);
+    EXPECT_EQ(list.maskDictionary()[0], NBNXN_INTERACTION_MASK_ALL);
+
+    appendEntries(&list, { 0x0000000f }, 7);
+    list.closeEntries();
+    checkEntries(list, { 0x0000000f }, 7);
+}
+
+//! Prunes \p outer into \p inner, keeping the entries for which \p keep is true
+void prune(const JClusterList& outer, const std::vector<bool>& keep, JClusterList* inner)
+{
+    inner->prepareForPruning(outer);
+    int numInner = 0;
+    for (size_t i = 0; i < outer.size(); i++)
+    {
+        inner->setFromOuter(numInner, outer, i);
+        if (keep[i])
+        {
+            numInner++;
+        }
+    }
+    inner->resize(numInner);
+}
+
+TEST(JClusterListTest, PruningKeepsSelectedEntries)
+{
+    JClusterList outer;
+    appendEntries(&outer, c_masks, 0);
+    outer.closeEntries();
+
+    JClusterList inner;
+    // The inner list should not depend on what the list contained before
+    appendEntries(&inner, { 0x00000001, 0x00000002 }, 20);
+    inner.closeEntries();
+
+    prune(outer, { true, false, true, true, false, true }, &inner);
+
+    EXPECT_EQ(inner.size(), 4);
+    const std::vector<int> cj = { 0, 2, 3, 5 };
+    for (size_t i = 0; i < cj.size(); i++)
+    {
+        EXPECT_EQ(inner.cj(i), cj[i]);
+        EXPECT_EQ(inner.excl(i), c_masks[cj[i]]);
+        EXPECT_EQ(inner.maskView()[i], c_masks[cj[i]]);
+    }
+}
+
+TEST(JClusterListTest, AppendingEntriesConvertsMasksToOwnDictionary)
+{
+    // This is how copySelectedListRange() moves ranges between lists
+    JClusterList src;
+    appendEntries(&src, c_masks, 1);
+    src.closeEntries();
+
+    JClusterList dest;
+    appendEntries(&dest, { 0x00007fff, 0x00000003 }, 0);
+    dest.closeEntries();
+
+    dest.appendEntries(src, 1, 5);
+
+    checkEntries(dest,
+                 { 0x00007fff, 0x00000003, c_masks[1], c_masks[2], c_masks[3], c_masks[4] }, 0);
+    // Besides the full mask, dest holds its two masks and three new ones from src
+    EXPECT_EQ(dest.maskDictionary().size(), 6);
+}
+
+TEST(JClusterListTest, SwitchesToRawMasksWhenDictionaryOverflows)
+{
+    // One more than the dictionary can hold, as it also contains the full mask
+    const int numMasks = std::numeric_limits<JClusterList::MaskIndex>::max() + 1;
+    const std::vector<unsigned int> masks = distinctMasks(numMasks);
+
+    JClusterList list;
+    // Close in chunks, the overflow then happens inside a chunk
+    const int chunkSize = 1000;
+    for (int start = 0; start < numMasks; start += chunkSize)
+    {
+        const int end = std::min(start + chunkSize, numMasks);
+        appendEntries(&list, { masks.begin() + start, masks.begin() + end }, start);
+        list.closeEntries();
+    }
+    EXPECT_FALSE(list.usesMaskDictionary());
+    checkEntries(list, masks, 0);
+
+    // Entries added after the overflow are also stored as raw masks
+    std::vector<unsigned int> moreMasks = masks;
+    moreMasks.push_back(NBNXN_INTERACTION_MASK_ALL);
+    moreMasks.push_back(c_masks[0]);
+    appendEntries(&list, { NBNXN_INTERACTION_MASK_ALL, c_masks[0] }, numMasks);
+    list.closeEntries();
+    checkEntries(list, moreMasks, 0);
+
+    // Pruning and appending also work with raw masks
+    std::vector<bool>         keep(moreMasks.size());
+    std::vector<unsigned int> keptMasks;
+    for (size_t i = 0; i < moreMasks.size(); i++)
+    {
+        keep[i] = (i % 3 == 0);
+        if (keep[i])
+        {
+            keptMasks.push_back(moreMasks[i]);
+        }
+    }
+    JClusterList inner;
+    prune(list, keep, &inner);
+    EXPECT_FALSE(inner.usesMaskDictionary());
+    ASSERT_EQ(inner.size(), keptMasks.size());
+    for (size_t i = 0; i < keptMasks.size(); i++)
+    {
+        EXPECT_EQ(inner.excl(i), keptMasks[i]);
+        EXPECT_EQ(inner.maskView()[i], keptMasks[i]);
+    }
+
+    JClusterList dest;
+    dest.appendEntries(list, numMasks - 10, moreMasks.size());
+    EXPECT_TRUE(dest.usesMaskDictionary());
+    checkEntries(dest, { moreMasks.end() - 12, moreMasks.end() }, numMasks - 10);
+
+    list.clear();
+    EXPECT_TRUE(list.usesMaskDictionary());
+    appendEntries(&list, c_masks, 0);
+    list.closeEntries();
+    checkEntries(list, c_masks, 0);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -44,6 +44,7 @@
 #include "gmxpre.h"
 
 #include <cctype>
+#include <vector>
 
 #include "gromacs/topology/mtop_lookup.h"
 #include "gromacs/topology/topology.h"
@@ -407,6 +408,20 @@ gmx_ana_selmethod_t sm_z = {
     nullptr, nullptr,    nullptr,       nullptr, nullptr, &evaluate_z,
 };
 
+/*! \brief
+ * Looks up the molecule block location of all atoms in \p g.
+ *
+ * Used by keywords that need per-atom parameters from the molecule type,
+ * so that the lookup is done in one batched pass over the group.
+ */
+static std::vector<MolblockAtomLocation> lookupAtomLocations(const gmx_mtop_t&      top,
+                                                             const gmx_ana_index_t& g)
+{
+    std::vector<MolblockAtomLocation> locations(g.isize);
+    mtopGetMolblockIndices(top, gmx::constArrayRefFromArray(g.index, g.isize), locations);
+    return locations;
+}
+
 /*!
  * See sel_updatefunc() for description of the parameters.
  * \p data is not used.
@@ -590,14 +605,13 @@ static void evaluate_atomtype(const gmx::SelMethodEvalContext& context,
                               gmx_ana_selvalue_t*              out,
                               void* /* data */)
 {
-    out->nr  = g->isize;
-    int molb = 0;
+    out->nr              = g->isize;
+    const auto locations = lookupAtomLocations(*context.top, *g);
     for (int i = 0; i < g->isize; ++i)
     {
-        int atomIndexInMolecule;
-        mtopGetMolblockIndex(context.top, g->index[i], &molb, nullptr, &atomIndexInMolecule);
+        const int            molb    = locations[i].moleculeBlock;
         const gmx_moltype_t& moltype = context.top->moltype[context.top->molblock[molb].type];
-        out->u.s[i]                  = *moltype.atoms.atomtype[atomIndexInMolecule];
+        out->u.s[i]                  = *moltype.atoms.atomtype[locations[i].atomIndexInMolecule];
     }
 }
 
@@ -670,11 +684,11 @@ static void evaluate_mass(const gmx::SelMethodEvalContext& context,
                           void* /* data */)
 {
     GMX_RELEASE_ASSERT(gmx_mtop_has_masses(context.top), "Masses not available for evaluation");
-    out->nr  = g->isize;
-    int molb = 0;
+    out->nr              = g->isize;
+    const auto locations = lookupAtomLocations(*context.top, *g);
     for (int i = 0; i < g->isize; ++i)
     {
-        out->u.r[i] = mtopGetAtomMass(context.top, g->index[i], &molb);
+        out->u.r[i] = mtopGetAtomParameters(*context.top, locations[i]).m;
     }
 }
 
@@ -698,11 +712,11 @@ static void evaluate_charge(const gmx::SelMethodEvalContext& context,
                             gmx_ana_selvalue_t*              out,
                             void* /* data */)
 {
-    out->nr  = g->isize;
-    int molb = 0;
+    out->nr              = g->isize;
+    const auto locations = lookupAtomLocations(*context.top, *g);
     for (int i = 0; i < g->isize; ++i)
     {
-        out->u.r[i] = mtopGetAtomParameters(context.top, g->index[i], &molb).q;
+        out->u.r[i] = mtopGetAtomParameters(*context.top, locations[i]).q;
     }
 }
 
@@ -68,11 +68,15 @@ SimulationWorkload createSimulationWorkload(const t_inputrec& inputrec,
     simulationWorkload.useGpuPmeFft             = (pmeRunMode == PmeRunMode::Mixed);
     simulationWorkload.useGpuBonded             = useGpuForBonded;
     simulationWorkload.useGpuUpdate             = useGpuForUpdate;
-    simulationWorkload.useGpuBufferOps          = useGpuForBufferOps || useGpuForUpdate;
+    // With MTS the slow forces are combined with the other forces on the CPU
+    simulationWorkload.useGpuBufferOps =
+            (useGpuForBufferOps || useGpuForUpdate) && !inputrec.useMts;
     simulationWorkload.useGpuHaloExchange       = useGpuHaloExchange;
     simulationWorkload.useGpuPmePpCommunication = useGpuPmePpComm && (pmeRunMode == PmeRunMode::GPU);
     simulationWorkload.useGpuDirectCommunication    = useGpuHaloExchange || useGpuPmePpComm;
     simulationWorkload.haveEwaldSurfaceContribution = haveEwaldSurfaceContribution(inputrec);
+    simulationWorkload.useMts                       = inputrec.useMts;
+    simulationWorkload.mtsFactor                    = (inputrec.useMts ? inputrec.mtsFactor : 1);
 
     return simulationWorkload;
 }
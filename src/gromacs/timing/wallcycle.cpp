@@ -172,6 +172,8 @@ static const char* wcsn[ewcsNR] = {
     "Launch PME GPU tasks",
     "Launch state copy",
     "Ewald F correction",
+    "PME 3D-FFT compute",
+    "PME 3D-FFT comm.",
     "NB X buffer ops.",
     "NB F buffer ops.",
     "Clear force buffer",
@@ -124,6 +124,8 @@ enum
     ewcsLAUNCH_GPU_PME,
     ewcsLAUNCH_STATE_PROPAGATOR_DATA,
     ewcsEWALD_CORRECTION,
+    ewcsPME_FFT_COMPUTE,
+    ewcsPME_FFT_COMM,
     ewcsNB_X_BUF_OPS,
     ewcsNB_F_BUF_OPS,
     ewcsCLEAR_FORCE_BUFFER,
@@ -102,10 +102,28 @@ void list_tpr(const char* fn,
     gmx_mtop_t mtop;
     t_topology top;
 
-    TpxFileHeader tpx = readTpxHeader(fn, true);
+    TprFileReader reader(fn, true);
+    TpxFileHeader tpx = reader.header();
     t_inputrec    ir;
 
-    read_tpx_state(fn, tpx.bIr ? &ir : nullptr, &state, tpx.bTop ? &mtop : nullptr);
+    // Writing an mdp file only needs the input record
+    if (tpx.bIr)
+    {
+        reader.readInputrec(&ir);
+    }
+    if (!mdpfn)
+    {
+        if (tpx.bTop)
+        {
+            reader.readTopology(&mtop);
+        }
+        reader.readState(&state);
+        if (tpx.bIr && state.ngtc == 0)
+        {
+            /* Reading old version without tcoupl state data: set it */
+            init_gtc_state(&state, ir.opts.ngtc, 0, ir.opts.nhchainlength);
+        }
+    }
     if (tpx.bIr && !bOriginalInputrec)
     {
         MDModules().adjustInputrecBasedOnModules(&ir);
@@ -45,6 +45,7 @@
 #include <ctime>
 
 #include <algorithm>
+#include <optional>
 #include <string>
 
 #ifdef HAVE_SYS_TIME_H
@@ -58,6 +59,7 @@
 #include "gromacs/fileio/tpxio.h"
 #include "gromacs/math/utilities.h"
 #include "gromacs/math/vec.h"
+#include "gromacs/mdlib/calc_verletbuf.h"
 #include "gromacs/mdlib/perf_est.h"
 #include "gromacs/mdtypes/commrec.h"
 #include "gromacs/mdtypes/inputrec.h"
@@ -941,6 +943,17 @@ static void make_benchmark_tprs(const char* fn_sim_tpr,  /* READ : User-provided
     /* For PME-switch potentials, keep the radial distance of the buffer region */
     nlist_buffer = ir->rlist - ir->rcoulomb;
 
+    /* With the Verlet scheme and a buffer tolerance the buffer depends on
+     * the cut-off, so we compute the rlist mdrun will use for each setting.
+     * The atom type statistics are extracted from the topology only once.
+     */
+    std::optional<VerletBufferEstimator> verletBufferEstimator;
+    if (ir->cutoff_scheme == ecutsVERLET && ir->verletbuf_tol > 0 && EI_DYNAMICS(ir->eI)
+        && !(EI_MD(ir->eI) && ir->etc == etcNO))
+    {
+        verletBufferEstimator.emplace(mtop, *ir);
+    }
+
     /* Determine length of triclinic box vectors */
     for (d = 0; d < DIM; d++)
     {
@@ -1073,6 +1086,14 @@ static void make_benchmark_tprs(const char* fn_sim_tpr,  /* READ : User-provided
                     ir->rvdw = std::max(info->rvdw[0], ir->rlist);
                 }
             }
+
+            if (verletBufferEstimator)
+            {
+                const VerletbufCandidate candidate = {
+                    ir->nstlist, ir->nstlist - 1, -1, verletbufGetSafeListSetup(ListSetupType::CpuNoSimd)
+                };
+                ir->rlist = verletBufferEstimator->calcBufferSize(det(state.box), *ir, candidate);
+            }
         } /* end of "if (j != 0)" */
 
         /* for j==0: Save the original settings
@@ -46,6 +46,7 @@
 #define GMX_TOPOLOGY_MTOP_LOOKUP_H
 
 #include "gromacs/topology/topology.h"
+#include "gromacs/utility/arrayref.h"
 #include "gromacs/utility/basedefinitions.h"
 #include "gromacs/utility/gmxassert.h"
 
@@ -62,6 +63,9 @@ struct t_atom;
  * For subsequent calls to this function, e.g. in a loop, pass in the previously
  * returned value for best performance. Atoms in a group tend to be in the same
  * molecule(block), so this minimizes the search time.
+ * When \p mtop has been finalized, the search is restricted using a coarse
+ * atom to molecule block table, which makes the lookup constant time
+ * for a reasonably uniform distribution of molecule blocks.
  *
  * \param[in]     mtop                 The molecule topology
  * \param[in]     globalAtomIndex      The global atom index to look up
@@ -88,6 +92,18 @@ static inline void mtopGetMolblockIndex(const gmx_mtop_t* mtop,
     int molBlock0 = -1;
     int molBlock1 = mtop->molblock.size();
 
+    if (!mtop->moleculeBlockOfAtomChunk.empty())
+    {
+        /* Restrict the search to the blocks overlapping with the chunk of the atom */
+        const int chunk = (globalAtomIndex >> mtop->atomChunkShift);
+        molBlock0       = mtop->moleculeBlockOfAtomChunk[chunk] - 1;
+        molBlock1       = mtop->moleculeBlockOfAtomChunk[chunk + 1] + 1;
+        if (*moleculeBlock <= molBlock0 || *moleculeBlock >= molBlock1)
+        {
+            *moleculeBlock = molBlock0 + 1;
+        }
+    }
+
     int globalAtomStart;
     while (TRUE)
     {
@@ -120,6 +136,54 @@ static inline void mtopGetMolblockIndex(const gmx_mtop_t* mtop,
     }
 }
 
+//! The location of a global atom in the molecule blocks, see mtopGetMolblockIndices()
+struct MolblockAtomLocation
+{
+    //! The molecule block index
+    int moleculeBlock;
+    //! The index of the molecule in the block
+    int moleculeIndex;
+    //! The atom index in the molecule
+    int atomIndexInMolecule;
+};
+
+/*! \brief Look up the molecule block locations of a list of global atom indices
+ *
+ * Equivalent to calling mtopGetMolblockIndex() for each atom, passing
+ * on the molecule block as starting value for the next atom.
+ *
+ * \param[in]  mtop               The molecule topology
+ * \param[in]  globalAtomIndices  The global atom indices to look up
+ * \param[out] locations          The locations, should have the same size as \p globalAtomIndices
+ */
+static inline void mtopGetMolblockIndices(const gmx_mtop_t&                   mtop,
+                                          gmx::ArrayRef<const int>            globalAtomIndices,
+                                          gmx::ArrayRef<MolblockAtomLocation> locations)
+{
+    GMX_ASSERT(locations.size() == globalAtomIndices.size(),
+               "We need an output location for each atom index");
+
+    int moleculeBlock = 0;
+    for (gmx::index i = 0; i < globalAtomIndices.ssize(); i++)
+    {
+        MolblockAtomLocation& location = locations[i];
+        mtopGetMolblockIndex(&mtop, globalAtomIndices[i], &moleculeBlock, &location.moleculeIndex,
+                             &location.atomIndexInMolecule);
+        location.moleculeBlock = moleculeBlock;
+    }
+}
+
+/*! \brief Returns the atom data of an atom located with mtopGetMolblockIndices()
+ *
+ * \param[in] mtop      The molecule topology
+ * \param[in] location  The location of the atom
+ */
+static inline const t_atom& mtopGetAtomParameters(const gmx_mtop_t& mtop, const MolblockAtomLocation& location)
+{
+    const gmx_moltype_t& moltype = mtop.moltype[mtop.molblock[location.moleculeBlock].type];
+    return moltype.atoms.atom[location.atomIndexInMolecule];
+}
+
 /*! \brief Returns the global molecule index of a global atom index
  *
  * The atom index has to be in range: 0 <= \p globalAtomIndex < \p mtop->natoms.
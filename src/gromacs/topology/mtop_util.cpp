@@ -44,6 +44,8 @@
 #include <cstdlib>
 #include <cstring>
 
+#include <algorithm>
+
 #include "gromacs/math/vectypes.h"
 #include "gromacs/topology/atoms.h"
 #include "gromacs/topology/block.h"
@@ -107,6 +109,32 @@ static void buildMolblockIndices(gmx_mtop_t* mtop)
         indices.moleculeIndexStart = moleculeIndexStart;
         moleculeIndexStart += molb.nmol;
     }
+
+    /* Set up a coarse atom to block lookup table with a size of at most
+     * a few entries per block. With uniformly sized blocks this leaves
+     * at most one block boundary per chunk, so lookup is constant time.
+     */
+    const int c_maxChunksPerMolblock = 4;
+    const int numMolblocks           = static_cast<int>(mtop->molblock.size());
+    const int maxNumChunks           = std::max(c_maxChunksPerMolblock * numMolblocks, 1);
+    mtop->atomChunkShift             = 0;
+    while ((atomIndex >> mtop->atomChunkShift) > maxNumChunks)
+    {
+        mtop->atomChunkShift++;
+    }
+    const int numChunks = ((atomIndex - 1) >> mtop->atomChunkShift) + 1;
+    mtop->moleculeBlockOfAtomChunk.resize(std::max(numChunks, 0) + 1);
+    int mb = 0;
+    for (int c = 0; c < numChunks; c++)
+    {
+        const int chunkAtomStart = c << mtop->atomChunkShift;
+        while (chunkAtomStart >= mtop->moleculeBlockIndices[mb].globalAtomEnd)
+        {
+            mb++;
+        }
+        mtop->moleculeBlockOfAtomChunk[c] = mb;
+    }
+    mtop->moleculeBlockOfAtomChunk.back() = std::max(numMolblocks - 1, 0);
 }
 
 void gmx_mtop_finalize(gmx_mtop_t* mtop)
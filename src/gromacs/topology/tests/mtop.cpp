@@ -41,10 +41,18 @@
  */
 #include "gmxpre.h"
 
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
 #include <gtest/gtest.h>
 
+#include "gromacs/topology/mtop_lookup.h"
 #include "gromacs/topology/mtop_util.h"
 #include "gromacs/utility/basedefinitions.h"
+#include "gromacs/utility/smalloc.h"
 
 namespace gmx
 {
@@ -106,6 +114,57 @@ std::vector<gmx::Range<int>> createTwoResidueTopology(gmx_mtop_t* mtop)
     return residueRange;
 }
 
+/*! \brief
+ * Creates a topology with many molecule blocks of varying size.
+ *
+ * Blocks with zero molecules and molecule types without atoms are
+ * included to check that lookup skips empty blocks.
+ */
+void createManyBlockTopology(gmx_mtop_t* mtop, int numBlocks)
+{
+    const std::vector<int> moltypeSizes = { 1, 3, 0, 17, 2, 250 };
+    // gmx_moltype_t is not safe to reallocate, so we allocate all entries at once
+    mtop->moltype.resize(moltypeSizes.size());
+    for (size_t mt = 0; mt < moltypeSizes.size(); mt++)
+    {
+        mtop->moltype[mt].atoms.nr = moltypeSizes[mt];
+        snew(mtop->moltype[mt].atoms.atom, moltypeSizes[mt]);
+    }
+
+    std::default_random_engine         rng(12345);
+    std::uniform_int_distribution<int> moltypeDist(0, gmx::ssize(moltypeSizes) - 1);
+    std::uniform_int_distribution<int> nmolDist(0, 40);
+    mtop->natoms = 0;
+    for (int b = 0; b < numBlocks; b++)
+    {
+        gmx_molblock_t& molblock = mtop->molblock.emplace_back();
+        molblock.type            = moltypeDist(rng);
+        // Make one large block to get a non-uniform distribution of atoms over blocks
+        molblock.nmol = (b == numBlocks / 3) ? 1000 : nmolDist(rng);
+        mtop->natoms += molblock.nmol * moltypeSizes[molblock.type];
+    }
+    gmx_mtop_finalize(mtop);
+}
+
+//! Returns the molecule block, molecule and atom index of \p globalAtomIndex using a linear search
+MolblockAtomLocation referenceLocation(const gmx_mtop_t& mtop, int globalAtomIndex)
+{
+    int start = 0;
+    for (size_t mb = 0; mb < mtop.molblock.size(); mb++)
+    {
+        const int numAtomsPerMol = mtop.moltype[mtop.molblock[mb].type].atoms.nr;
+        const int numAtoms       = mtop.molblock[mb].nmol * numAtomsPerMol;
+        if (globalAtomIndex < start + numAtoms)
+        {
+            const int offset = globalAtomIndex - start;
+            return { static_cast<int>(mb), offset / numAtomsPerMol, offset % numAtomsPerMol };
+        }
+        start += numAtoms;
+    }
+    GMX_RELEASE_ASSERT(false, "Atom index out of range");
+    return { -1, -1, -1 };
+}
+
 TEST(MtopTest, RangeBasedLoop)
 {
     gmx_mtop_t mtop;
@@ -163,6 +222,56 @@ TEST(MtopTest, CanFindResidueStartAndEndAtoms)
     }
 }
 
+TEST(MtopTest, MolblockLookupMatchesLinearSearch)
+{
+    for (int numBlocks : { 1, 2, 7, 100 })
+    {
+        SCOPED_TRACE("Number of molecule blocks: " + std::to_string(numBlocks));
+        gmx_mtop_t mtop;
+        createManyBlockTopology(&mtop, numBlocks);
+        ASSERT_GT(mtop.natoms, 0);
+
+        // Look up with the default start, with the hint from the previous atom
+        // and with a hint from an arbitrary other block.
+        int hint = 0;
+        for (int a = 0; a < mtop.natoms; a++)
+        {
+            const MolblockAtomLocation ref = referenceLocation(mtop, a);
+            for (int start : { 0, hint, numBlocks - 1 })
+            {
+                int molb = start;
+                int molIndex, atomIndex;
+                mtopGetMolblockIndex(&mtop, a, &molb, &molIndex, &atomIndex);
+                ASSERT_EQ(ref.moleculeBlock, molb);
+                ASSERT_EQ(ref.moleculeIndex, molIndex);
+                ASSERT_EQ(ref.atomIndexInMolecule, atomIndex);
+            }
+            hint = ref.moleculeBlock;
+        }
+
+        // Look up shuffled indices with the batched lookup
+        std::vector<int> indices(mtop.natoms);
+        std::iota(indices.begin(), indices.end(), 0);
+        std::shuffle(indices.begin(), indices.end(), std::default_random_engine(numBlocks));
+        std::vector<MolblockAtomLocation> locations(indices.size());
+        mtopGetMolblockIndices(mtop, indices, locations);
+        for (size_t i = 0; i < indices.size(); i++)
+        {
+            const MolblockAtomLocation ref = referenceLocation(mtop, indices[i]);
+            ASSERT_EQ(ref.moleculeBlock, locations[i].moleculeBlock);
+            ASSERT_EQ(ref.moleculeIndex, locations[i].moleculeIndex);
+            ASSERT_EQ(ref.atomIndexInMolecule, locations[i].atomIndexInMolecule);
+        }
+    }
+}
+
+TEST(MtopTest, MolblockLookupTableIsCompact)
+{
+    gmx_mtop_t mtop;
+    createManyBlockTopology(&mtop, 50);
+    EXPECT_LE(mtop.moleculeBlockOfAtomChunk.size(), 4 * mtop.molblock.size() + 1);
+}
+
 } // namespace
 
 } // namespace gmx
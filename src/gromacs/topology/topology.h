@@ -197,6 +197,15 @@ struct gmx_mtop_t //NOLINT(clang-analyzer-optin.performance.Padding)
     /* Derived data  below */
     //! Indices for each molblock entry for fast lookup of atom properties
     std::vector<MoleculeBlockIndices> moleculeBlockIndices;
+    //! Log2 of the number of atoms per entry in \p moleculeBlockOfAtomChunk
+    int atomChunkShift = 0;
+    /*! \brief Coarse lookup table from global atom index to molecule block
+     *
+     * Entry c holds the molecule block of atom c << atomChunkShift,
+     * the last entry holds the last molecule block. The number of entries
+     * is proportional to the number of molecule blocks, not atoms.
+     */
+    std::vector<int> moleculeBlockOfAtomChunk;
 };
 
 /*! \brief
@@ -307,6 +307,11 @@ bool InMemoryDeserializer::sourceIsDouble() const
     return impl_->sourceIsDouble_;
 }
 
+std::size_t InMemoryDeserializer::position() const
+{
+    return impl_->pos_;
+}
+
 void InMemoryDeserializer::doBool(bool* value)
 {
     impl_->doValue(value);
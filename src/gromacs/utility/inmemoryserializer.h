@@ -109,6 +109,8 @@ public:
 
     //! Get if the source data was written in double precsion
     bool sourceIsDouble() const;
+    //! Get the number of bytes that have been deserialized so far
+    std::size_t position() const;
 
     // From ISerializer
     bool reading() const override { return true; }
@@ -263,6 +263,25 @@ TEST_F(InMemorySerializerTest, SizeIsCorrect)
     EXPECT_EQ(buffer.size(), 56);
 }
 
+TEST_F(InMemorySerializerTest, DeserializerPositionIsCorrect)
+{
+    std::string        stringValue = "position";
+    InMemorySerializer serializer;
+    serializer.doInt32(&defaultValues_.int32Value_);
+    serializer.doDouble(&defaultValues_.doubleValue_);
+    serializer.doString(&stringValue);
+    auto buffer = serializer.finishAndGetBuffer();
+
+    InMemoryDeserializer deserializer(buffer, false);
+    EXPECT_EQ(deserializer.position(), 0);
+    deserializer.doInt32(&defaultValues_.int32Value_);
+    EXPECT_EQ(deserializer.position(), 4);
+    deserializer.doDouble(&defaultValues_.doubleValue_);
+    EXPECT_EQ(deserializer.position(), 12);
+    deserializer.doString(&stringValue);
+    EXPECT_EQ(deserializer.position(), buffer.size());
+}
+
 } // namespace
 } // namespace test
 } // namespace gmx
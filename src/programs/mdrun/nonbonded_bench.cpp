@@ -152,7 +152,13 @@ void NonbondedBenchmark::initOptions(IOptionsContainer* options, ICommandLineOpt
         "In the MD engine, any clusters where at most half of the atoms",
         "have LJ interactions will automatically use this kernel.",
         "And finally, the [TT]-energy[tt] option selects the computation",
-        "of energies, which are usually only needed infrequently."
+        "of energies, which are usually only needed infrequently.[PAR]",
+        "With [TT]-search[tt] the pair search is benchmarked instead of",
+        "the kernels. Each iteration puts all atoms on the grid and",
+        "constructs the cluster pair list. The tool reports the cycles",
+        "and the number of cluster pairs in the list per kilo cycle.",
+        "Only the [TT]-simd[tt] and [TT]-halflj[tt] options affect",
+        "the pair search."
     };
 
     settings->setHelpText(desc);
@@ -208,6 +214,9 @@ void NonbondedBenchmark::initOptions(IOptionsContainer* options, ICommandLineOpt
     options->addOption(BooleanOption("cycles")
                                .store(&benchmarkOptions_.cyclesPerPair)
                                .description("Report cycles/pair instead of pairs/cycle"));
+    options->addOption(BooleanOption("search")
+                               .store(&benchmarkOptions_.benchmarkPairSearch)
+                               .description("Benchmark the pair search instead of the kernels"));
 }
 
 void NonbondedBenchmark::optionsFinished()
@@ -0,0 +1,219 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+
+/*! \internal \file
+ * \brief
+ * Tests for multiple time stepping of the PME mesh forces
+ *
+ * \ingroup module_mdrun_integration_tests
+ */
+#include "gmxpre.h"
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/topology/ifunc.h"
+#include "gromacs/utility/strconvert.h"
+#include "gromacs/utility/stringutil.h"
+
+#include "testutils/mpitest.h"
+#include "testutils/simulationdatabase.h"
+
+#include "moduletest.h"
+#include "simulatorcomparison.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+/*! \brief Test fixture for multiple time stepping
+ *
+ * With MTS the energies, the virial and the output forces contain
+ * the full, unscaled slow forces, only the integration uses the slow
+ * forces as an impulse. The test parameter is the MTS factor.
+ */
+class MultipleTimeSteppingTest : public MdrunTestFixture, public ::testing::WithParamInterface<int>
+{
+public:
+    //! Returns mdp field values for spc216 with PME and the given MTS setup and output interval
+    static MdpFieldValues mdpFieldValues(int mtsFactor, int nsteps, int outputInterval)
+    {
+        auto mdpFieldValues = prepareMdpFieldValues("spc216", "md", "no", "no");
+        mdpFieldValues["coulombtype"]   = "PME";
+        mdpFieldValues["nsteps"]        = toString(nsteps);
+        mdpFieldValues["nstcalcenergy"] = toString(outputInterval);
+        mdpFieldValues["nstenergy"]     = toString(outputInterval);
+        mdpFieldValues["nstxout"]       = toString(outputInterval);
+        mdpFieldValues["nstvout"]       = "0";
+        mdpFieldValues["nstfout"]       = toString(outputInterval);
+        mdpFieldValues["nstdhdl"]       = "0";
+        // The default nstlog is not a multiple of all MTS factors
+        mdpFieldValues["other"] = "nstlog = 0";
+        if (mtsFactor > 1)
+        {
+            mdpFieldValues["other"] += formatString("\nmts = yes\nmts-factor = %d", mtsFactor);
+        }
+
+        return mdpFieldValues;
+    }
+
+    //! Runs grompp with \p mdpFieldValues to produce \p tprFileName
+    void runGromppWithMdp(const MdpFieldValues& mdpFieldValues, const std::string& tprFileName)
+    {
+        runner_.tprFileName_ = tprFileName;
+        runner_.useTopGroAndNdxFromDatabase("spc216");
+        runner_.useStringAsMdpFile(prepareMdpFileContents(mdpFieldValues));
+        runGrompp(&runner_);
+    }
+};
+
+/* Forces and energies of an MTS run are written at MTS steps only.
+ * A rerun of the trajectory with single time stepping computes
+ * all forces every step and should reproduce them.
+ */
+TEST_P(MultipleTimeSteppingTest, RerunWithSingleTimeSteppingReproducesForcesAndEnergies)
+{
+    const int mtsFactor = GetParam();
+
+    if (!isNumberOfPpRanksSupported("spc216", getNumberOfTestMpiRanks()))
+    {
+        return;
+    }
+
+    auto mtsTprFileName        = fileManager_.getTemporaryFilePath("mts.tpr");
+    auto mtsTrajectoryFileName = fileManager_.getTemporaryFilePath("mts.trr");
+    auto mtsEdrFileName        = fileManager_.getTemporaryFilePath("mts.edr");
+    auto stsTprFileName        = fileManager_.getTemporaryFilePath("sts.tpr");
+    auto rerunTrajectoryName   = fileManager_.getTemporaryFilePath("rerun.trr");
+    auto rerunEdrFileName      = fileManager_.getTemporaryFilePath("rerun.edr");
+
+    const int nsteps = 4 * mtsFactor;
+    runGromppWithMdp(mdpFieldValues(mtsFactor, nsteps, mtsFactor), mtsTprFileName);
+    runGromppWithMdp(mdpFieldValues(1, nsteps, mtsFactor), stsTprFileName);
+
+    runner_.tprFileName_                     = mtsTprFileName;
+    runner_.fullPrecisionTrajectoryFileName_ = mtsTrajectoryFileName;
+    runner_.edrFileName_                     = mtsEdrFileName;
+    runMdrun(&runner_);
+
+    runner_.tprFileName_                     = stsTprFileName;
+    runner_.fullPrecisionTrajectoryFileName_ = rerunTrajectoryName;
+    runner_.edrFileName_                     = rerunEdrFileName;
+    runMdrun(&runner_, { SimulationOptionTuple("-rerun", mtsTrajectoryFileName) });
+
+    EnergyTermsToCompare energyTermsToCompare{ {
+            { interaction_function[F_EPOT].longname,
+              relativeToleranceAsPrecisionDependentUlp(10.0, 24, 40) },
+            { interaction_function[F_COUL_RECIP].longname,
+              relativeToleranceAsPrecisionDependentUlp(10.0, 24, 40) },
+    } };
+    compareEnergies(mtsEdrFileName, rerunEdrFileName, energyTermsToCompare);
+
+    TrajectoryFrameMatchSettings trajectoryMatchSettings{ true,
+                                                          true,
+                                                          true,
+                                                          ComparisonConditions::MustCompare,
+                                                          ComparisonConditions::NoComparison,
+                                                          ComparisonConditions::MustCompare };
+    TrajectoryComparison trajectoryComparison{ trajectoryMatchSettings,
+                                               TrajectoryComparison::s_defaultTrajectoryTolerances };
+    compareTrajectories(mtsTrajectoryFileName, rerunTrajectoryName, trajectoryComparison);
+}
+
+/* An MTS run should stay close to a run with single time stepping.
+ * Over the 20 MTS intervals of this run the potential energies and
+ * forces deviate by at most half of the tolerances used here,
+ * whereas applying the slow forces without the MTS factor exceeds the
+ * tolerances several times over. Positions are not compared, since
+ * atoms close to the box edge can be put in the box in only one of
+ * the runs. The run ends with a step that is not an MTS step, but
+ * needs the slow forces for the energies.
+ */
+TEST_P(MultipleTimeSteppingTest, MatchesSingleTimeStepping)
+{
+    const int mtsFactor = GetParam();
+
+    if (!isNumberOfPpRanksSupported("spc216", getNumberOfTestMpiRanks()))
+    {
+        return;
+    }
+
+    auto mtsTprFileName        = fileManager_.getTemporaryFilePath("mts.tpr");
+    auto mtsTrajectoryFileName = fileManager_.getTemporaryFilePath("mts.trr");
+    auto mtsEdrFileName        = fileManager_.getTemporaryFilePath("mts.edr");
+    auto stsTprFileName        = fileManager_.getTemporaryFilePath("sts.tpr");
+    auto stsTrajectoryFileName = fileManager_.getTemporaryFilePath("sts.trr");
+    auto stsEdrFileName        = fileManager_.getTemporaryFilePath("sts.edr");
+
+    const int nsteps = 20 * mtsFactor + 1;
+    runGromppWithMdp(mdpFieldValues(mtsFactor, nsteps, mtsFactor), mtsTprFileName);
+    runGromppWithMdp(mdpFieldValues(1, nsteps, mtsFactor), stsTprFileName);
+
+    runner_.tprFileName_                     = mtsTprFileName;
+    runner_.fullPrecisionTrajectoryFileName_ = mtsTrajectoryFileName;
+    runner_.edrFileName_                     = mtsEdrFileName;
+    runMdrun(&runner_);
+
+    runner_.tprFileName_                     = stsTprFileName;
+    runner_.fullPrecisionTrajectoryFileName_ = stsTrajectoryFileName;
+    runner_.edrFileName_                     = stsEdrFileName;
+    runMdrun(&runner_);
+
+    EnergyTermsToCompare energyTermsToCompare{ {
+            { interaction_function[F_EPOT].longname, absoluteTolerance(5.0 * mtsFactor) },
+    } };
+    compareEnergies(mtsEdrFileName, stsEdrFileName, energyTermsToCompare);
+
+    TrajectoryFrameMatchSettings trajectoryMatchSettings{ true,
+                                                          true,
+                                                          true,
+                                                          ComparisonConditions::NoComparison,
+                                                          ComparisonConditions::NoComparison,
+                                                          ComparisonConditions::MustCompare };
+    TrajectoryTolerances trajectoryTolerances = TrajectoryComparison::s_defaultTrajectoryTolerances;
+    trajectoryTolerances.forces               = absoluteTolerance(25.0 * mtsFactor);
+    TrajectoryComparison trajectoryComparison{ trajectoryMatchSettings, trajectoryTolerances };
+    compareTrajectories(mtsTrajectoryFileName, stsTrajectoryFileName, trajectoryComparison);
+}
+
+INSTANTIATE_TEST_CASE_P(WithMtsFactor, MultipleTimeSteppingTest, ::testing::Values(2, 3));
+
+} // namespace
+} // namespace test
+} // namespace gmx
@@ -67,6 +67,16 @@ TEST(NonbondedBenchTest, BasicEndToEndTest)
                          &gmx::NonbondedBenchmarkInfo::create, &cmdline));
 }
 
+TEST(NonbondedBenchTest, PairSearchEndToEndTest)
+{
+    const char* const command[] = { "nonbonded-benchmark" };
+    CommandLine       cmdline(command);
+    cmdline.addOption("-iter", 1);
+    cmdline.addOption("-search");
+    EXPECT_EQ(0, gmx::test::CommandLineTestHelper::runModuleFactory(
+                         &gmx::NonbondedBenchmarkInfo::create, &cmdline));
+}
+
 } // namespace
 } // namespace test
 } // namespace gmx
@@ -0,0 +1,202 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+
+/*! \internal \file
+ * \brief
+ * Tests for the run-time tuning of the CPU non-bonded kernel setup with mdrun -tunenb
+ *
+ * \ingroup module_mdrun_integration_tests
+ */
+#include "gmxpre.h"
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/topology/ifunc.h"
+#include "gromacs/utility/stringutil.h"
+#include "gromacs/utility/textreader.h"
+
+#include "testutils/cmdlinetest.h"
+#include "testutils/mpitest.h"
+#include "testutils/simulationdatabase.h"
+
+#include "moduletest.h"
+#include "simulatorcomparison.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+/*! \brief Test fixture for mdrun -tunenb
+ *
+ * A run with tuning is long enough for the tuning to finish. The log
+ * should report the timed setups and a selected setup. Since the tuned
+ * setups only change the order and approximation of the non-bonded
+ * computation, a rerun of the trajectory with the default setup should
+ * reproduce the potential energies and forces, also after the kernel
+ * layout, Ewald correction or pruning interval has been switched.
+ */
+class NonbondedKernelTuningTest : public MdrunTestFixture
+{
+};
+
+//! Returns the number of times \p substring occurs in \p text
+int countOccurrences(const std::string& text, const std::string& substring)
+{
+    int count = 0;
+    for (size_t pos = text.find(substring); pos != std::string::npos;
+         pos        = text.find(substring, pos + substring.size()))
+    {
+        count++;
+    }
+    return count;
+}
+
+TEST_F(NonbondedKernelTuningTest, SelectsSetupAndReproducesUntunedForces)
+{
+    const std::string simulationName = "spc216";
+
+    int numRanksAvailable = getNumberOfTestMpiRanks();
+    if (!isNumberOfPpRanksSupported(simulationName, numRanksAvailable))
+    {
+        fprintf(stdout,
+                "Test system '%s' cannot run with %d ranks.\n"
+                "The supported numbers are: %s\n",
+                simulationName.c_str(), numRanksAvailable,
+                reportNumbersOfPpRanksSupported(simulationName).c_str());
+        return;
+    }
+
+    /* With nstlist=20 there are at most 13 setups to time, each taking
+     * 3 list lifetimes, so the tuning finishes within 800 steps.
+     * mdrun only changes nstlist with temperature coupling.
+     */
+    auto mdpFieldValues = prepareMdpFieldValues(simulationName, "md", "v-rescale", "no");
+    mdpFieldValues["coulombtype"]   = "PME";
+    mdpFieldValues["nsteps"]        = "1000";
+    mdpFieldValues["nstenergy"]     = "100";
+    mdpFieldValues["nstcalcenergy"] = "100";
+    mdpFieldValues["nstxout"]       = "100";
+    mdpFieldValues["nstvout"]       = "0";
+    mdpFieldValues["nstfout"]       = "100";
+    mdpFieldValues["nstdhdl"]       = "0";
+
+    auto tunedTrajectoryFileName = fileManager_.getTemporaryFilePath("tuned.trr");
+    auto tunedEdrFileName        = fileManager_.getTemporaryFilePath("tuned.edr");
+    auto rerunTrajectoryFileName = fileManager_.getTemporaryFilePath("rerun.trr");
+    auto rerunEdrFileName        = fileManager_.getTemporaryFilePath("rerun.edr");
+    auto rerunLogFileName        = fileManager_.getTemporaryFilePath("rerun.log");
+
+    runner_.tprFileName_ = fileManager_.getTemporaryFilePath("sim.tpr");
+    runner_.useTopGroAndNdxFromDatabase(simulationName);
+    runner_.useStringAsMdpFile(prepareMdpFileContents(mdpFieldValues));
+    runGrompp(&runner_);
+
+    runner_.fullPrecisionTrajectoryFileName_ = tunedTrajectoryFileName;
+    runner_.edrFileName_                     = tunedEdrFileName;
+    {
+        CommandLine caller;
+        caller.append("mdrun");
+        caller.addOption("-nstlist", 20);
+        caller.addOption("-tunenb");
+        ASSERT_EQ(0, runner_.callMdrun(caller));
+    }
+
+    const std::string logFileContents = TextReader::readFileToString(runner_.logFileName_);
+    if (logFileContents.find("Not tuning the non-bonded kernel setup") != std::string::npos)
+    {
+        fprintf(stdout, "The non-bonded kernel setup can not be tuned with this build\n");
+        return;
+    }
+    EXPECT_NE(std::string::npos,
+              logFileContents.find("Will tune the non-bonded kernel setup during the first part"))
+            << "tuning did not start";
+    EXPECT_EQ(std::string::npos, logFileContents.find("ended before the non-bonded kernel tuning"))
+            << "tuning did not finish";
+
+    // The results table marks exactly one setup as the fastest, which is the one used
+    const size_t tableStart = logFileContents.find("Non-bonded kernel tuning, M-cycles per step");
+    ASSERT_NE(std::string::npos, tableStart) << "tuning results were not logged";
+    const size_t usingStart = logFileContents.find("\nUsing ", tableStart);
+    ASSERT_NE(std::string::npos, usingStart) << "the selected setup was not logged";
+    const std::string table = logFileContents.substr(tableStart, usingStart - tableStart);
+    EXPECT_EQ(1, countOccurrences(table, "  *\n"));
+    const size_t      usingEnd = logFileContents.find('\n', usingStart + 1);
+    const std::string selected = logFileContents.substr(usingStart + 1, usingEnd - usingStart - 1);
+    const bool usesSimdKernels = (selected.find("Using SIMD ") == 0);
+    EXPECT_TRUE(usesSimdKernels || selected.find("Using plain C") == 0)
+            << "unexpected kernel in: " << selected;
+    if (usesSimdKernels)
+    {
+        EXPECT_TRUE(selected.find("analytical Ewald correction") != std::string::npos
+                    || selected.find("tabulated Ewald correction") != std::string::npos)
+                << "no valid Ewald exclusion correction in: " << selected;
+    }
+    EXPECT_TRUE(selected.find("pruning every") != std::string::npos
+                || selected.find("no dynamic pruning") != std::string::npos)
+            << "no valid pruning setup in: " << selected;
+
+    runner_.fullPrecisionTrajectoryFileName_ = rerunTrajectoryFileName;
+    runner_.edrFileName_                     = rerunEdrFileName;
+    runner_.logFileName_                     = rerunLogFileName;
+    runMdrun(&runner_, { SimulationOptionTuple("-rerun", tunedTrajectoryFileName) });
+
+    /* The tabulated and analytical Ewald corrections differ at the level
+     * of the table accuracy, otherwise we only change the summation order.
+     */
+    EnergyTermsToCompare energyTermsToCompare{ {
+            { interaction_function[F_EPOT].longname,
+              relativeToleranceAsPrecisionDependentFloatingPoint(10.0, 1e-5, 1e-10) },
+    } };
+    compareEnergies(tunedEdrFileName, rerunEdrFileName, energyTermsToCompare);
+
+    TrajectoryFrameMatchSettings trajectoryMatchSettings{ true,
+                                                          true,
+                                                          true,
+                                                          ComparisonConditions::MustCompare,
+                                                          ComparisonConditions::NoComparison,
+                                                          ComparisonConditions::MustCompare };
+    TrajectoryComparison trajectoryComparison{ trajectoryMatchSettings,
+                                               TrajectoryComparison::s_defaultTrajectoryTolerances };
+    compareTrajectories(tunedTrajectoryFileName, rerunTrajectoryFileName, trajectoryComparison);
+}
+
+} // namespace
+} // namespace test
+} // namespace gmx
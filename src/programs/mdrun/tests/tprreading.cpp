@@ -0,0 +1,156 @@
+/*
+ * This file is part of the GROMACS molecular simulation package.
+ *
+ * Copyright (c) 2020, by the GROMACS development team, led by
+ * Mark Abraham, David van der Spoel, Berk Hess, and Erik Lindahl,
+ * and including many others, as listed in the AUTHORS file in the
+ * top-level source directory and at http://www.gromacs.org.
+ *
+ * GROMACS is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public License
+ * as published by the Free Software Foundation; either version 2.1
+ * of the License, or (at your option) any later version.
+ *
+ * GROMACS is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with GROMACS; if not, see
+ * http://www.gnu.org/licenses, or write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA.
+ *
+ * If you want to redistribute modifications to GROMACS, please
+ * consider that scientific software is very special. Version
+ * control is crucial - bugs must be traceable. We will be happy to
+ * consider code for inclusion in the official distribution, but
+ * derived work must not be called official GROMACS. Details are found
+ * in the README & COPYING files - if they are missing, get the
+ * official version at http://www.gromacs.org.
+ *
+ * To help us fund GROMACS development, we humbly ask that you cite
+ * the research papers on the package. Check out http://www.gromacs.org.
+ */
+
+/*! \internal \file
+ * \brief
+ * Tests that reading the tpr file on all ranks gives the same run as broadcasting it
+ *
+ * \ingroup module_mdrun_integration_tests
+ */
+#include "gmxpre.h"
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+#include "gromacs/topology/ifunc.h"
+#include "gromacs/utility/stringutil.h"
+
+#include "testutils/cmdlinetest.h"
+#include "testutils/mpitest.h"
+#include "testutils/setenv.h"
+#include "testutils/simulationdatabase.h"
+
+#include "moduletest.h"
+#include "simulatorcomparison.h"
+
+namespace gmx
+{
+namespace test
+{
+namespace
+{
+
+/*! \brief Test fixture for GMX_TPR_READ_ON_ALL_RANKS
+ *
+ * With the environment variable set, each rank reads the topology
+ * and inputrec from the tpr file instead of receiving them from the
+ * master rank. The run should be identical to the default run.
+ * The test parameter is the number of separate PME ranks.
+ */
+class TprReadOnAllRanksTest : public MdrunTestFixture, public ::testing::WithParamInterface<int>
+{
+public:
+    //! Runs mdrun with fixed domain decomposition and PME setups
+    void runMdrunWithFixedSetup(int numPmeRanks)
+    {
+        CommandLine caller;
+        caller.append("mdrun");
+        caller.addOption("-npme", numPmeRanks);
+        caller.addOption("-dlb", "no");
+        caller.addOption("-notunepme");
+        ASSERT_EQ(0, runner_.callMdrun(caller));
+    }
+};
+
+TEST_P(TprReadOnAllRanksTest, MatchesBroadcast)
+{
+    const std::string simulationName = "spc216";
+    const int         numPmeRanks    = GetParam();
+
+    const int numRanks = getNumberOfTestMpiRanks();
+    if (numRanks < 2 || !isNumberOfPpRanksSupported(simulationName, numRanks - numPmeRanks))
+    {
+        fprintf(stdout,
+                "Test system '%s' with %d separate PME ranks needs at least 2 ranks, not %d.\n"
+                "The supported numbers of PP ranks are: %s\n",
+                simulationName.c_str(), numPmeRanks, numRanks,
+                reportNumbersOfPpRanksSupported(simulationName).c_str());
+        return;
+    }
+    SCOPED_TRACE(formatString("Running on %d ranks, of which %d separate PME ranks", numRanks,
+                              numPmeRanks));
+
+    auto mdpFieldValues = prepareMdpFieldValues(simulationName, "md", "no", "no");
+    mdpFieldValues["coulombtype"] = "PME";
+    mdpFieldValues["nsteps"]      = "20";
+
+    runner_.tprFileName_ = fileManager_.getTemporaryFilePath("sim.tpr");
+    runner_.useTopGroAndNdxFromDatabase(simulationName);
+    runner_.useStringAsMdpFile(prepareMdpFileContents(mdpFieldValues));
+    runGrompp(&runner_);
+
+    auto broadcastTrajectoryFileName = fileManager_.getTemporaryFilePath("broadcast.trr");
+    auto broadcastEdrFileName        = fileManager_.getTemporaryFilePath("broadcast.edr");
+    auto readTrajectoryFileName      = fileManager_.getTemporaryFilePath("read.trr");
+    auto readEdrFileName             = fileManager_.getTemporaryFilePath("read.edr");
+
+    const char* environmentVariable = "GMX_TPR_READ_ON_ALL_RANKS";
+    gmxUnsetenv(environmentVariable);
+
+    runner_.fullPrecisionTrajectoryFileName_ = broadcastTrajectoryFileName;
+    runner_.edrFileName_                     = broadcastEdrFileName;
+    runMdrunWithFixedSetup(numPmeRanks);
+
+    gmxSetenv(environmentVariable, "1", 1);
+    runner_.fullPrecisionTrajectoryFileName_ = readTrajectoryFileName;
+    runner_.edrFileName_                     = readEdrFileName;
+    runMdrunWithFixedSetup(numPmeRanks);
+    gmxUnsetenv(environmentVariable);
+
+    EnergyTermsToCompare energyTermsToCompare{ {
+            { interaction_function[F_EPOT].longname, defaultRealTolerance() },
+            { interaction_function[F_EKIN].longname, defaultRealTolerance() },
+            { interaction_function[F_PRES].longname, defaultRealTolerance() },
+    } };
+    compareEnergies(broadcastEdrFileName, readEdrFileName, energyTermsToCompare);
+
+    TrajectoryFrameMatchSettings trajectoryMatchSettings{ true,
+                                                          true,
+                                                          true,
+                                                          ComparisonConditions::MustCompare,
+                                                          ComparisonConditions::MustCompare,
+                                                          ComparisonConditions::MustCompare };
+    TrajectoryTolerances trajectoryTolerances{ defaultRealTolerance(), defaultRealTolerance(),
+                                               defaultRealTolerance(), defaultRealTolerance() };
+    TrajectoryComparison trajectoryComparison{ trajectoryMatchSettings, trajectoryTolerances };
+    compareTrajectories(broadcastTrajectoryFileName, readTrajectoryFileName, trajectoryComparison);
+}
+
+INSTANTIATE_TEST_CASE_P(WithAndWithoutPmeRank, TprReadOnAllRanksTest, ::testing::Values(0, 1));
+
+} // namespace
+} // namespace test
+} // namespace gmx